@@ -11,10 +11,6 @@ namespace ClassGame {
         bool gameOver = false;
         int gameWinner = -1;
 
-        // Frame rate limiter for AstroBots (30Hz = 33.33ms per frame)
-        static auto lastAstroBotsUpdate = std::chrono::steady_clock::now();
-        static constexpr double ASTROBOTS_UPDATE_INTERVAL_MS = 1000.0 / 30.0;  // 30 Hz
-
         //
         // game starting point
         // this is called by the main render loop in main.cpp
@@ -55,12 +51,8 @@ namespace ClassGame {
                 } else {
                     AstroBots *astroGame = dynamic_cast<AstroBots*>(game);
                     if (astroGame) {
-                        auto now = std::chrono::steady_clock::now();
-                        double elapsedMs = std::chrono::duration<double, std::milli>(now - lastAstroBotsUpdate).count();
-                        if (elapsedMs >= ASTROBOTS_UPDATE_INTERVAL_MS) {
-                            astroGame->endTurn();
-                            lastAstroBotsUpdate = now;
-                        }
+                        // AstroBots plays its turns on a worker thread; pick up the newest one
+                        astroGame->advance();
                     } else {
                         ImGui::Text("Current Player Number: %d", game->getCurrentPlayer()->playerNumber());
                         std::string stateString = game->stateString();
@@ -0,0 +1,237 @@
+#include "AstroArchive.h"
+#include "AstroArena.h"
+#include "AstroShips.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#define ASTRO_ARCHIVE_NO_MMAP 1
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr uint32_t ARCHIVE_MAGIC = 0x43524141; // "AARC"
+static constexpr uint32_t ARCHIVE_VERSION = 1;
+static constexpr size_t ARCHIVE_ALIGN = 64;
+
+enum ArchiveColumn {
+    COL_TURN, COL_X, COL_Y, COL_VX, COL_VY, COL_ANGLE, COL_FUEL, COL_SCAN_DIST, COL_SCAN_ANGLE,
+    COL_HP, COL_PHASER_CD, COL_PHOTON_CD, COL_SCAN_HIT, COL_ALIVE,
+    COL_COUNT
+};
+static constexpr size_t COLUMN_WIDTH[COL_COUNT] = { 4, 4, 4, 4, 4, 4, 4, 4, 4, 2, 2, 2, 1, 1 };
+
+namespace {
+struct ArchiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t matchCount;
+    uint64_t trackCount;
+    uint64_t rowCount;
+    uint64_t columnOffset[COL_COUNT]; // from the start of the file
+};
+}
+
+static_assert(sizeof(ArchiveMatch) == 32, "ArchiveMatch is an on-disk record");
+static_assert(sizeof(ArchiveTrack) == 56, "ArchiveTrack is an on-disk record");
+
+// ===== Writer =====
+void AstroArchiveWriter::BeginMatch(const AstroArena& arena) {
+    ArchiveMatch m{};
+    m.seed = arena.seed;
+    m.winner = -1;
+    m.firstTrack = (uint32_t)_tracks.size();
+    m.shipCount = (uint32_t)arena.ships.size();
+    for (size_t i = 0; i < arena.ships.size(); ++i) {
+        ArchiveTrack t{};
+        t.match = (uint32_t)_matches.size();
+        t.ship = (uint32_t)i;
+        t.killedBy = -1;
+        const std::string& name = (i < arena.programs.size() && arena.programs[i]) ? arena.programs[i]->name : std::string();
+        std::strncpy(t.name, name.c_str(), ASTRO_ARCHIVE_NAME_LEN - 1);
+        _tracks.push_back(t);
+        _rows.emplace_back();
+    }
+    _matches.push_back(m);
+}
+
+void AstroArchiveWriter::RecordTurn(const AstroArena& arena) {
+    if (_matches.empty()) return;
+    const ArchiveMatch& m = _matches.back();
+    for (size_t i = 0; i < m.shipCount && i < arena.ships.size(); ++i) {
+        const auto& s = arena.ships[i];
+        _rows[m.firstTrack + i].push_back({ arena.turn, s.x, s.y, s.vx, s.vy, s.angle, s.fuel,
+                                            s.ScanDist(), s.ScanAngle(),
+                                            (int16_t)s.hp, (int16_t)s.phaser_cooldown, (int16_t)s.photon_cooldown,
+                                            (uint8_t)(s.scan_hit ? 1 : 0), (uint8_t)(s.alive ? 1 : 0) });
+    }
+}
+
+void AstroArchiveWriter::EndMatch(const AstroArena& arena) {
+    if (_matches.empty()) return;
+    ArchiveMatch& m = _matches.back();
+    m.turns = arena.turn;
+    m.checksum = arena.Checksum();
+    if (arena.AliveCount() == 1) {
+        for (size_t i = 0; i < arena.ships.size(); ++i) {
+            if (arena.ships[i].alive) m.winner = (int32_t)i;
+        }
+    }
+    for (size_t i = 0; i < m.shipCount && i < arena.ships.size(); ++i) {
+        ArchiveTrack& t = _tracks[m.firstTrack + i];
+        t.deathTurn = arena.ships[i].deathTurn;
+        t.killedBy = arena.ships[i].killedBy;
+        t.damageDealt = arena.ships[i].damageDealt;
+    }
+}
+
+bool AstroArchiveWriter::Write(const std::string& path, std::string* error) const {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    // row ranges and column offsets
+    std::vector<ArchiveTrack> tracks = _tracks;
+    uint64_t rows = 0;
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        tracks[t].firstRow = rows;
+        tracks[t].rowCount = (uint32_t)_rows[t].size();
+        rows += _rows[t].size();
+    }
+    static constexpr size_t fieldOffset[COL_COUNT] = {
+        offsetof(Row, turn), offsetof(Row, x), offsetof(Row, y), offsetof(Row, vx), offsetof(Row, vy),
+        offsetof(Row, angle), offsetof(Row, fuel), offsetof(Row, scanDist), offsetof(Row, scanAngle),
+        offsetof(Row, hp), offsetof(Row, phaserCooldown), offsetof(Row, photonCooldown),
+        offsetof(Row, scanHit), offsetof(Row, alive)
+    };
+    ArchiveHeader header{};
+    header.magic = ARCHIVE_MAGIC;
+    header.version = ARCHIVE_VERSION;
+    header.matchCount = _matches.size();
+    header.trackCount = tracks.size();
+    header.rowCount = rows;
+    uint64_t offset = sizeof(ArchiveHeader) + _matches.size() * sizeof(ArchiveMatch) + tracks.size() * sizeof(ArchiveTrack);
+    for (int c = 0; c < COL_COUNT; ++c) {
+        offset = (offset + ARCHIVE_ALIGN - 1) & ~(uint64_t)(ARCHIVE_ALIGN - 1);
+        header.columnOffset[c] = offset;
+        offset += rows * COLUMN_WIDTH[c];
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    if (!_matches.empty()) ok = ok && std::fwrite(_matches.data(), sizeof(ArchiveMatch), _matches.size(), f) == _matches.size();
+    if (!tracks.empty()) ok = ok && std::fwrite(tracks.data(), sizeof(ArchiveTrack), tracks.size(), f) == tracks.size();
+    uint64_t written = sizeof(ArchiveHeader) + _matches.size() * sizeof(ArchiveMatch) + tracks.size() * sizeof(ArchiveTrack);
+    const char zeros[ARCHIVE_ALIGN] = {};
+    std::vector<uint8_t> buf;
+    for (int c = 0; c < COL_COUNT && ok; ++c) {
+        ok = std::fwrite(zeros, 1, header.columnOffset[c] - written, f) == header.columnOffset[c] - written;
+        written = header.columnOffset[c];
+        for (const std::vector<Row>& track : _rows) {
+            buf.resize(track.size() * COLUMN_WIDTH[c]);
+            uint8_t* out = buf.data();
+            for (const Row& r : track) {
+                std::memcpy(out, (const uint8_t*)&r + fieldOffset[c], COLUMN_WIDTH[c]);
+                out += COLUMN_WIDTH[c];
+            }
+            if (!buf.empty()) ok = ok && std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+            written += buf.size();
+        }
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok && error) *error = "cannot write " + path;
+    return ok;
+}
+
+// ===== Reader =====
+AstroArchive::~AstroArchive() {
+    Close();
+}
+
+void AstroArchive::Close() {
+#if !defined(ASTRO_ARCHIVE_NO_MMAP)
+    if (_data && _fallback.empty()) munmap((void*)_data, _size);
+#endif
+    _fallback.clear();
+    _data = nullptr;
+    _size = 0;
+    _matchCount = _trackCount = 0;
+    _rowCount = 0;
+}
+
+bool AstroArchive::Open(const std::string& path, std::string* error) {
+    Close();
+    auto fail = [this, error](const std::string& msg) {
+        Close();
+        if (error) *error = msg;
+        return false;
+    };
+#if defined(ASTRO_ARCHIVE_NO_MMAP)
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return fail("cannot open " + path);
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) _fallback.insert(_fallback.end(), chunk, chunk + n);
+    std::fclose(f);
+    _data = _fallback.data();
+    _size = _fallback.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail("cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(ArchiveHeader)) {
+        ::close(fd);
+        return fail("not a trajectory archive");
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return fail("cannot map " + path);
+    _data = (const uint8_t*)p;
+    _size = (size_t)st.st_size;
+#endif
+    if (_size < sizeof(ArchiveHeader)) return fail("not a trajectory archive");
+    ArchiveHeader header;
+    std::memcpy(&header, _data, sizeof(header));
+    if (header.magic != ARCHIVE_MAGIC) return fail("not a trajectory archive");
+    if (header.version != ARCHIVE_VERSION) return fail("unsupported archive version " + std::to_string(header.version));
+    uint64_t tables = sizeof(ArchiveHeader) + header.matchCount * sizeof(ArchiveMatch) + header.trackCount * sizeof(ArchiveTrack);
+    if (tables > _size) return fail("truncated archive");
+    for (int c = 0; c < COL_COUNT; ++c) {
+        if (header.columnOffset[c] % ARCHIVE_ALIGN != 0 || header.columnOffset[c] < tables ||
+            header.columnOffset[c] + header.rowCount * COLUMN_WIDTH[c] > _size) {
+            return fail("truncated archive");
+        }
+    }
+    _matchCount = header.matchCount;
+    _trackCount = header.trackCount;
+    _rowCount = header.rowCount;
+    _matchTable = (const ArchiveMatch*)(_data + sizeof(ArchiveHeader));
+    _trackTable = (const ArchiveTrack*)(_data + sizeof(ArchiveHeader) + _matchCount * sizeof(ArchiveMatch));
+    const uint64_t* at = header.columnOffset;
+    _turn = (const int32_t*)(_data + at[COL_TURN]);
+    _x = (const float*)(_data + at[COL_X]);
+    _y = (const float*)(_data + at[COL_Y]);
+    _vx = (const float*)(_data + at[COL_VX]);
+    _vy = (const float*)(_data + at[COL_VY]);
+    _angle = (const float*)(_data + at[COL_ANGLE]);
+    _fuel = (const float*)(_data + at[COL_FUEL]);
+    _scanDist = (const float*)(_data + at[COL_SCAN_DIST]);
+    _scanAngle = (const float*)(_data + at[COL_SCAN_ANGLE]);
+    _hp = (const int16_t*)(_data + at[COL_HP]);
+    _phaserCooldown = (const int16_t*)(_data + at[COL_PHASER_CD]);
+    _photonCooldown = (const int16_t*)(_data + at[COL_PHOTON_CD]);
+    _scanHit = _data + at[COL_SCAN_HIT];
+    _alive = _data + at[COL_ALIVE];
+    // the index has to agree with the columns before anyone follows it
+    for (size_t m = 0; m < _matchCount; ++m) {
+        if ((uint64_t)_matchTable[m].firstTrack + _matchTable[m].shipCount > _trackCount) return fail("corrupt match index");
+    }
+    for (size_t t = 0; t < _trackCount; ++t) {
+        if (_trackTable[t].firstRow + _trackTable[t].rowCount > _rowCount) return fail("corrupt track index");
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct AstroArena;
+
+// ===== Trajectory archive =====
+// Per-turn ship state for many matches in one file, laid out for bulk scans: every
+// field is its own column (one array over all rows), rows are grouped by track (one
+// ship in one match) and tracks are ordered by match, then ship. The file is mapped
+// read-only and the columns are used in place; nothing is parsed on open beyond the
+// header.
+//
+// File layout (version 1, host byte order):
+//   ArchiveHeader
+//   ArchiveMatch[matchCount]
+//   ArchiveTrack[trackCount]
+//   columns, each 64-byte aligned: turn, x, y, vx, vy, angle, fuel, scanDist, scanAngle,
+//   hp, phaserCooldown, photonCooldown, scanHit, alive
+
+static constexpr int ASTRO_ARCHIVE_NAME_LEN = 24;
+
+struct ArchiveMatch {
+    uint32_t seed;
+    int32_t turns;        // turns played
+    int32_t winner;       // ship index, -1 for a draw
+    uint32_t firstTrack;  // tracks [firstTrack, firstTrack + shipCount)
+    uint32_t shipCount;
+    uint64_t checksum;    // AstroArena::Checksum() at the end
+};
+
+struct ArchiveTrack {
+    uint32_t match;
+    uint32_t ship;        // index in the match
+    uint64_t firstRow;    // rows [firstRow, firstRow + rowCount), one per turn from turn 1
+    uint32_t rowCount;
+    int32_t deathTurn;    // 0 if the ship survived
+    int32_t killedBy;     // ship whose weapon destroyed it; -1 if it survived or hit an asteroid
+    int32_t damageDealt;
+    char name[ASTRO_ARCHIVE_NAME_LEN]; // zero-padded
+};
+
+// Collects tracks while matches run; Write() lays them out as above. Rows are kept in
+// memory until then, so write one archive per batch of matches.
+class AstroArchiveWriter {
+public:
+    // Call after AstroArena::Setup(), then RecordTurn() after every Step() and EndMatch() at the end.
+    void BeginMatch(const AstroArena& arena);
+    void RecordTurn(const AstroArena& arena);
+    void EndMatch(const AstroArena& arena);
+    size_t MatchCount() const { return _matches.size(); }
+    bool Write(const std::string& path, std::string* error = nullptr) const;
+
+private:
+    struct Row {
+        int32_t turn;
+        float x, y, vx, vy, angle, fuel, scanDist, scanAngle;
+        int16_t hp, phaserCooldown, photonCooldown;
+        uint8_t scanHit, alive;
+    };
+    std::vector<ArchiveMatch> _matches;
+    std::vector<ArchiveTrack> _tracks;
+    std::vector<std::vector<Row>> _rows; // per track
+};
+
+// Read-only view of an archive file. Column pointers stay valid while the archive is open.
+class AstroArchive {
+public:
+    AstroArchive() = default;
+    ~AstroArchive();
+    AstroArchive(const AstroArchive&) = delete;
+    AstroArchive& operator=(const AstroArchive&) = delete;
+
+    bool Open(const std::string& path, std::string* error = nullptr);
+    void Close();
+
+    size_t MatchCount() const { return _matchCount; }
+    size_t TrackCount() const { return _trackCount; }
+    uint64_t RowCount() const { return _rowCount; }
+    const ArchiveMatch& Match(size_t m) const { return _matchTable[m]; }
+    const ArchiveTrack& Track(size_t t) const { return _trackTable[t]; }
+    // the track of ship s in match m
+    const ArchiveTrack& Track(size_t m, size_t s) const { return _trackTable[_matchTable[m].firstTrack + s]; }
+
+    // whole columns, RowCount() entries each; index with ArchiveTrack::firstRow + i
+    const int32_t* Turn() const { return _turn; }
+    const float* X() const { return _x; }
+    const float* Y() const { return _y; }
+    const float* VX() const { return _vx; }
+    const float* VY() const { return _vy; }
+    const float* Angle() const { return _angle; }
+    const float* Fuel() const { return _fuel; }
+    const float* ScanDist() const { return _scanDist; }
+    const float* ScanAngle() const { return _scanAngle; }
+    const int16_t* HP() const { return _hp; }
+    const int16_t* PhaserCooldown() const { return _phaserCooldown; }
+    const int16_t* PhotonCooldown() const { return _photonCooldown; }
+    const uint8_t* ScanHit() const { return _scanHit; }
+    const uint8_t* Alive() const { return _alive; }
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+    std::vector<uint8_t> _fallback; // file contents when mapping isn't available
+    size_t _matchCount = 0, _trackCount = 0;
+    uint64_t _rowCount = 0;
+    const ArchiveMatch* _matchTable = nullptr;
+    const ArchiveTrack* _trackTable = nullptr;
+    const int32_t* _turn = nullptr;
+    const float *_x = nullptr, *_y = nullptr, *_vx = nullptr, *_vy = nullptr, *_angle = nullptr;
+    const float *_fuel = nullptr, *_scanDist = nullptr, *_scanAngle = nullptr;
+    const int16_t *_hp = nullptr, *_phaserCooldown = nullptr, *_photonCooldown = nullptr;
+    const uint8_t *_scanHit = nullptr, *_alive = nullptr;
+};
@@ -2,19 +2,22 @@
 #include <iostream>
 #include "AstroTypes.h"
 #include "AstroArena.h"
-#include "AstroBots.h"
+#include "AstroShips.h"
+#include "AstroSimd.h"
+#include "AstroMath.h"
+#include "AstroReplay.h"
+#include "AstroThreadPool.h"
+#include "AstroProfile.h"
 #include <random>
 #include <algorithm>
+#include <limits>
+#include <unordered_map>
 #include <cmath> 
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// RNG for arena systems
-static std::random_device rd_arena;
-static std::mt19937 rng(rd_arena());
-
 // ===== Helper functions (arena-local) =====
 static float NormalizeAngle(float angle) {
     while (angle < 0) angle += 360.0f;
@@ -32,18 +35,28 @@ static float Distance(float x1, float y1, float x2, float y2) {
     float dy = y2 - y1;
     return std::sqrt(dx*dx + dy*dy);
 }
-static float AngleTo(float x1, float y1, float x2, float y2) {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    return std::atan2(dy, dx) * 180.0f / M_PI;
+// shortest signed offset along one axis of the torus
+static float WrapDelta(float d, float extent) {
+    if (d > extent * 0.5f) d -= extent;
+    else if (d < -extent * 0.5f) d += extent;
+    return d;
 }
 
 // ===== cute_c2 helpers for ship/torpedo shapes =====
-static c2Capsule MakeShipCapsule(const AstroArena::ShipState& s) {
-    const float halfLen = 15.0f;
-    const float radius = 7.5f;
-    float ang = s.angle * (float)M_PI / 180.0f;
-    float dx = std::cos(ang), dy = std::sin(ang);
+static constexpr float SHIP_CAPSULE_HALF_LEN = 15.0f;
+static constexpr float SHIP_CAPSULE_RADIUS = 7.5f;
+
+static c2AABB CapsuleBounds(const c2Capsule& cap) {
+    c2AABB box;
+    box.min = c2V(std::min(cap.a.x, cap.b.x) - cap.r, std::min(cap.a.y, cap.b.y) - cap.r);
+    box.max = c2V(std::max(cap.a.x, cap.b.x) + cap.r, std::max(cap.a.y, cap.b.y) + cap.r);
+    return box;
+}
+
+// (dx, dy): the ship's heading as a unit vector
+static c2Capsule MakeShipCapsule(const AstroArena::ShipState& s, float dx, float dy) {
+    const float halfLen = SHIP_CAPSULE_HALF_LEN;
+    const float radius = SHIP_CAPSULE_RADIUS;
     c2Capsule cap;
     cap.a = c2V(s.x - dx * halfLen, s.y - dy * halfLen);
     cap.b = c2V(s.x + dx * halfLen, s.y + dy * halfLen);
@@ -58,89 +71,218 @@ static c2Circle MakeShipCircle(const AstroArena::ShipState& s) {
     return c;
 }
 
+static constexpr float TORPEDO_RADIUS = 5.0f;
+
 static c2Circle MakeTorpedoCircle(const PhotonTorpedo& t) {
     c2Circle c;
     c.p = c2V(t.x, t.y);
-    c.r = 5.0f;
+    c.r = TORPEDO_RADIUS;
     return c;
 }
 
-static void BuildWrapTransforms(float x, float y, std::array<c2x, 9>& out_tr, int& out_count) {
-    out_count = 0;
-    for (int oy = -1; oy <= 1; ++oy) {
-        for (int ox = -1; ox <= 1; ++ox) {
-            c2x tr = c2xIdentity();
-            tr.p = c2V(x + ox * ASTROBOTS_W, y + oy * ASTROBOTS_H);
-            out_tr[out_count++] = tr;
-        }
+// ===== Torus ghost copies =====
+// An object's copy at whole-world offset (ox, oy) can only touch a query if their boxes
+// overlap, so narrowphase only needs those copies: one away from the edges, at most four
+// near a corner, none if the boxes miss. Offsets come out oy-major, ox ascending, the
+// order of a full 3x3 loop, so first-found tie breaks are unchanged. pad absorbs
+// narrowphase tolerances.
+static constexpr float NARROWPHASE_PAD = 1.0f;
+// how much of a gap in HandleCollisions' pair cache is kept back for the rounding in GJK's
+// distance
+static constexpr float PAIR_CACHE_MARGIN = 0.05f;
+
+struct WrapOffsets {
+    std::array<std::pair<int, int>, 9> at;
+    int count = 0;
+};
+
+static int WrapAxis(float lo, float hi, float qMin, float qMax, float extent, std::array<int, 3>& out) {
+    int n = 0;
+    for (int k = -1; k <= 1; ++k) {
+        if (hi + k * extent >= qMin && lo + k * extent <= qMax) out[n++] = k;
     }
+    return n;
 }
 
-// ===== Broad-phase uniform grid =====
-void AstroArena::RebuildBroadphase() {
-    gridCols = (int)std::ceil(ASTROBOTS_W / (float)gridCellSize);
-    gridRows = (int)std::ceil(ASTROBOTS_H / (float)gridCellSize);
-    gridAsteroids.assign(gridCols * gridRows, {});
-    gridShips.assign(gridCols * gridRows, {});
-    // Bin asteroids
-    for (size_t i = 0; i < asteroids.size(); ++i) {
-        if (!asteroids[i].alive) continue;
-        int cx, cy; PosToCell(asteroids[i].x, asteroids[i].y, cx, cy);
-        int idx = CellIndex(cx, cy);
-        if (idx >= 0) gridAsteroids[idx].push_back((int)i);
+// object box (at its unwrapped position) against the query box q, on a world.x by world.y torus
+static WrapOffsets FindWrapOffsets(const c2AABB& box, const c2AABB& q, c2v world, float pad = NARROWPHASE_PAD) {
+    std::array<int, 3> kx, ky;
+    int nx = WrapAxis(box.min.x - pad, box.max.x + pad, q.min.x, q.max.x, world.x, kx);
+    int ny = WrapAxis(box.min.y - pad, box.max.y + pad, q.min.y, q.max.y, world.y, ky);
+    WrapOffsets w;
+    for (int j = 0; j < ny; ++j) {
+        for (int i = 0; i < nx; ++i) w.at[w.count++] = { kx[i], ky[j] };
     }
-    // Bin ships
-    for (size_t i = 0; i < ships.size(); ++i) {
-        if (!ships[i].alive) continue;
-        int cx, cy; PosToCell(ships[i].x, ships[i].y, cx, cy);
-        int idx = CellIndex(cx, cy);
-        if (idx >= 0) gridShips[idx].push_back((int)i);
+    return w;
+}
+
+static void BuildWrapTransforms(float x, float y, const WrapOffsets& offsets, c2v world, std::array<c2x, 9>& out_tr, int& out_count) {
+    out_count = 0;
+    for (int i = 0; i < offsets.count; ++i) {
+        c2x tr = c2xIdentity();
+        tr.p = c2V(x + offsets.at[i].first * world.x, y + offsets.at[i].second * world.y);
+        out_tr[out_count++] = tr;
     }
 }
 
-void AstroArena::CollectNearCells(int cx, int cy, std::vector<int>& outCellIdx) const {
-    outCellIdx.clear();
-    for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            int idx = CellIndex(cx + dx, cy + dy);
-            if (idx >= 0) outCellIdx.push_back(idx);
-        }
+
+// ===== Broadphase =====
+void AstroArena::RebuildBroadphase() {
+    if (!broadphase) broadphase = AstroMakeBroadphase(config, ships.size());
+    const size_t n = ships.size();
+    shipCapsules.resize(n);
+    shipBounds.resize(n);
+    // every heading's sin and cos in one batch
+    shipTrig.resize(3 * n);
+    float* rad = shipTrig.data();
+    float* sn = rad + n;
+    float* cs = sn + n;
+    for (size_t i = 0; i < n; ++i) rad[i] = ships[i].angle * (float)M_PI / 180.0f;
+    if (config.fixedPoint) {
+        for (size_t i = 0; i < n; ++i) AstroFastSinCos(rad[i], sn[i], cs[i]);
+    } else {
+        AstroSinCosN(rad, sn, cs, n);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        shipCapsules[i] = MakeShipCapsule(ships[i], cs[i], sn[i]);
+        shipBounds[i] = CapsuleBounds(shipCapsules[i]);
+    }
+    asteroidBounds.resize(asteroids.size());
+    for (size_t i = 0; i < asteroids.size(); ++i) {
+        const c2AABB& local = asteroids.Shape(i).bounds;
+        asteroidBounds[i].min = c2V(asteroids.x[i] + local.min.x, asteroids.y[i] + local.min.y);
+        asteroidBounds[i].max = c2V(asteroids.x[i] + local.max.x, asteroids.y[i] + local.max.y);
     }
+    broadphase->Build(*this);
+    broadphaseEpoch = worldEpoch;
 }
 
 // Collision helpers (legacy) removed in favor of cute_c2
 
 // ===== Asteroid implementation =====
-void Asteroid::GenerateShape(int sides, float radius) {
-    shape.clear();
-    std::uniform_real_distribution<float> radiusDist(radius * 0.7f, radius * 1.3f);
+void AsteroidShape::Generate(int sides, float radius, float phase, std::mt19937& rng, bool portable) {
+    outline.clear();
+    const float lo = radius * 0.7f, hi = radius * ASTEROID_MAX_RADIUS_SCALE;
+    std::uniform_real_distribution<float> radiusDist(lo, hi);
     for (int i = 0; i < sides; ++i) {
-        float angle = (float)i / sides * 2.0f * M_PI;
-        float r = radiusDist(rng);
-        shape.push_back(ImVec2(std::cos(angle) * r, std::sin(angle) * r));
+        float angle = phase + (float)i / sides * 2.0f * M_PI;
+        float r, s, c;
+        if (portable) {
+            r = lo + (hi - lo) * AstroUnitFloat(rng());
+            AstroFastSinCos(angle, s, c);
+        } else {
+            r = radiusDist(rng);
+            AstroSinCos(angle, s, c);
+        }
+        outline.push_back(ImVec2(c * r, s * r));
     }
     // Build cute_c2 convex poly (local space)
-    int n = (int)shape.size();
+    int n = (int)outline.size();
     if (n > C2_MAX_POLYGON_VERTS) n = C2_MAX_POLYGON_VERTS;
     poly.count = n;
     for (int i = 0; i < n; ++i) {
-        poly.verts[i] = c2V(shape[i].x, shape[i].y);
+        poly.verts[i] = c2V(outline[i].x, outline[i].y);
     }
     c2MakePoly(&poly);
-    hasPoly = true;
+    ComputeBounds();
+}
+
+void AsteroidShape::ComputeBounds() {
+    bounds.min = bounds.max = poly.count > 0 ? poly.verts[0] : c2V(0, 0);
+    for (int i = 1; i < poly.count; ++i) {
+        bounds.min = c2Minv(bounds.min, poly.verts[i]);
+        bounds.max = c2Maxv(bounds.max, poly.verts[i]);
+    }
+}
+
+// size class: 0 large, 1 medium, 2 small
+static int AsteroidSizeClass(float sz) {
+    return sz > MEDIUM_ASTEROID_SIZE ? 0 : sz > SMALL_ASTEROID_SIZE ? 1 : 2;
+}
+
+AsteroidShapeLibrary::AsteroidShapeLibrary() {
+    static constexpr float sizes[3] = { LARGE_ASTEROID_SIZE, MEDIUM_ASTEROID_SIZE, SMALL_ASTEROID_SIZE };
+    static constexpr int sides[3] = { 8, 7, 6 };
+    std::mt19937 rng(0x41535452u); // fixed: shape ids are saved in snapshots
+    _shapes.resize(6 * SHAPES_PER_CLASS);
+    for (int c = 0; c < 3; ++c) {
+        std::uniform_real_distribution<float> phaseDist(0.0f, 2.0f * (float)M_PI / sides[c]);
+        for (int v = 0; v < SHAPES_PER_CLASS; ++v) {
+            _shapes[c * SHAPES_PER_CLASS + v].Generate(sides[c], sizes[c], phaseDist(rng), rng, false);
+        }
+    }
+    std::mt19937 portableRng(0x41535446u);
+    for (int c = 0; c < 3; ++c) {
+        const float phaseRange = 2.0f * (float)M_PI / sides[c];
+        for (int v = 0; v < SHAPES_PER_CLASS; ++v) {
+            const float phase = phaseRange * AstroUnitFloat(portableRng());
+            _shapes[(3 + c) * SHAPES_PER_CLASS + v].Generate(sides[c], sizes[c], phase, portableRng, true);
+        }
+    }
+}
+
+const AsteroidShapeLibrary AsteroidShapeLibrary::_library;
+
+uint16_t AsteroidShapeLibrary::Pick(float sz, int variant, bool fixedPoint) const {
+    return (uint16_t)(((fixedPoint ? 3 : 0) + AsteroidSizeClass(sz)) * SHAPES_PER_CLASS + variant);
 }
 
 // ===== Arena mechanics =====
 void AstroArena::WrapPosition(float& x, float& y) {
-    x = std::fmod(x, ASTROBOTS_W);
-    if (x < 0) x += ASTROBOTS_W;
-    y = std::fmod(y, ASTROBOTS_H);
-    if (y < 0) y += ASTROBOTS_H;
-    if (x >= ASTROBOTS_W) x = 0;
-    if (y >= ASTROBOTS_H) y = 0;
+    if (config.fixedPoint) {
+        x = FixedCoord(AstroFixedWrap(AstroToFixed(x), AstroToFixed(config.width)), config.width);
+        y = FixedCoord(AstroFixedWrap(AstroToFixed(y), AstroToFixed(config.height)), config.height);
+        return;
+    }
+    x = AstroWrapCoord(x, config.width);
+    y = AstroWrapCoord(y, config.height);
+}
+
+float AstroArena::FixedCoord(AstroFixed v, float extent) {
+    float f = AstroFromFixed(v);
+    return f >= extent ? 0.0f : f; // the last grid steps below extent can round up to it
+}
+
+void AstroArena::SinCos(float rad, float& s, float& c) const {
+    if (config.fixedPoint) AstroFastSinCos(rad, s, c);
+    else AstroSinCos(rad, s, c);
+}
+
+float AstroArena::Atan2(float y, float x) const {
+    return config.fixedPoint ? AstroFastAtan2(y, x) : AstroAtan2(y, x);
+}
+
+float AstroArena::AngleTo(float x1, float y1, float x2, float y2) const {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    return Atan2(dy, dx) * 180.0f / M_PI;
+}
+
+float AstroArena::RandomFloat(float lo, float hi) {
+    if (config.fixedPoint) return lo + (hi - lo) * AstroUnitFloat(rng());
+    return std::uniform_real_distribution<float>(lo, hi)(rng);
+}
+
+int AstroArena::RandomInt(int lo, int hi) {
+    if (config.fixedPoint) return lo + (int)(((uint64_t)rng() * (uint64_t)(hi - lo + 1)) >> 32);
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+}
+
+uint16_t AstroArena::PickShape(float sz) {
+    return AsteroidShapeLibrary::Get().Pick(sz, RandomInt(0, AsteroidShapeLibrary::SHAPES_PER_CLASS - 1), config.fixedPoint);
 }
 
 void AstroArena::UpdatePhysics() {
+    MoveShips();
+    MoveWorld();
+}
+
+void AstroArena::MoveShips() {
+    ASTRO_PROFILE_SCOPE(profiler, ASTRO_PHASE_MOVE_SHIPS);
+    if (config.fixedPoint) {
+        MoveShipsFixed();
+        return;
+    }
     for (auto& s : ships) {
         if (!s.alive) continue;
         float angleDiff = AngleDifference(s.angle, s.targetAngle);
@@ -155,22 +297,65 @@ void AstroArena::UpdatePhysics() {
         WrapPosition(s.x, s.y);
         s.vx *= DRAG;
         s.vy *= DRAG;
-        const float MIN_VELOCITY = 0.001f;
         if (std::abs(s.vx) < MIN_VELOCITY) s.vx = 0;
         if (std::abs(s.vy) < MIN_VELOCITY) s.vy = 0;
     }
-    for (auto& a : asteroids) {
-        if (!a.alive) continue;
-        a.x += a.vx;
-        a.y += a.vy;
-        WrapPosition(a.x, a.y);
+}
+
+// MoveShips() on the 16.16 grid: the same turn, drag, snap and wrap in integers
+void AstroArena::MoveShipsFixed() {
+    constexpr AstroFixed rotation = AstroFixedConst(ROTATION_SPEED);
+    constexpr AstroFixed drag = AstroFixedConst(DRAG);
+    constexpr AstroFixed minVelocity = AstroFixedConst(MIN_VELOCITY);
+    const AstroFixed w = AstroToFixed(config.width), h = AstroToFixed(config.height);
+    for (auto& s : ships) {
+        if (!s.alive) continue;
+        AstroFixed angle = AstroToFixed(s.angle);
+        const AstroFixed target = AstroToFixed(s.targetAngle);
+        const AstroFixed angleDiff = AstroFixedWrap(target - angle + ASTRO_FIXED_180, ASTRO_FIXED_360) - ASTRO_FIXED_180;
+        if (std::abs(angleDiff) > rotation) {
+            angle += (angleDiff > 0 ? rotation : -rotation);
+        } else {
+            angle = target;
+        }
+        s.angle = AstroFromFixed(AstroFixedWrap(angle, ASTRO_FIXED_360));
+        if (s.angle >= 360.0f) s.angle = 0.0f;
+        AstroFixed vx = AstroToFixed(s.vx), vy = AstroToFixed(s.vy);
+        s.x = FixedCoord(AstroFixedWrap(AstroToFixed(s.x) + vx, w), config.width);
+        s.y = FixedCoord(AstroFixedWrap(AstroToFixed(s.y) + vy, h), config.height);
+        vx = AstroFixedMul(vx, drag);
+        vy = AstroFixedMul(vy, drag);
+        s.vx = std::abs(vx) < minVelocity ? 0.0f : AstroFromFixed(vx);
+        s.vy = std::abs(vy) < minVelocity ? 0.0f : AstroFromFixed(vy);
+    }
+}
+
+void AstroArena::MoveWorld() {
+    ASTRO_PROFILE_SCOPE(profiler, ASTRO_PHASE_MOVE_WORLD);
+    worldEpoch++;
+    if (config.fixedPoint) {
+        const AstroFixed w = AstroToFixed(config.width), h = AstroToFixed(config.height);
+        for (size_t i = 0; i < asteroids.size(); ++i) {
+            if (!asteroids.alive[i]) continue;
+            asteroids.x[i] = FixedCoord(AstroFixedWrap(AstroToFixed(asteroids.x[i]) + AstroToFixed(asteroids.vx[i]), w), config.width);
+            asteroids.y[i] = FixedCoord(AstroFixedWrap(AstroToFixed(asteroids.y[i]) + AstroToFixed(asteroids.vy[i]), h), config.height);
+        }
+    } else {
+        AstroIntegrateWrap(asteroids.x.data(), asteroids.y.data(), asteroids.vx.data(), asteroids.vy.data(),
+                           asteroids.alive.data(), asteroids.size(), config.width, config.height);
     }
     for (auto& t : torpedoes) {
         if (!t.alive) continue;
         t.prevX = t.x;
         t.prevY = t.y;
-        t.x += t.vx;
-        t.y += t.vy;
+        if (config.fixedPoint) {
+            // unwrapped until FinishStep(), like the float path
+            t.x = AstroFromFixed(AstroToFixed(t.x) + AstroToFixed(t.vx));
+            t.y = AstroFromFixed(AstroToFixed(t.y) + AstroToFixed(t.vy));
+        } else {
+            t.x += t.vx;
+            t.y += t.vy;
+        }
         t.anim += 1.0f;
         t.lifetime--;
         if (t.lifetime <= 0) t.alive = false;
@@ -180,18 +365,10 @@ void AstroArena::UpdatePhysics() {
         beam.lifetime--;
         if (beam.lifetime <= 0) beam.alive = false;
     }
-    for (auto& p : particles) {
-        if (!p.alive) continue;
-        p.x += p.vx;
-        p.y += p.vy;
-        if (PARTICLE_WRAP) {
-            WrapPosition(p.x, p.y);
-        }
-        p.vx *= PARTICLE_DRAG;
-        p.vy *= PARTICLE_DRAG;
-        p.lifetime--;
-        if (p.lifetime <= 0) p.alive = false;
-    }
+    AstroIntegrateParticles(particles.x.data(), particles.y.data(), particles.vx.data(), particles.vy.data(),
+                            particles.lifetime.data(), particles.alive.data(), particles.size(),
+                            PARTICLE_DRAG, PARTICLE_WRAP != 0, config.width, config.height);
+    particles.Recycle();
     // Update ship debris segments (no wrapping; let them drift off-screen)
     for (auto& d : shipDebris) {
         if (!d.alive) continue;
@@ -202,8 +379,8 @@ void AstroArena::UpdatePhysics() {
         if (std::abs(d.angVel) > 1e-6f) {
             float mx = (d.x1 + d.x2) * 0.5f;
             float my = (d.y1 + d.y2) * 0.5f;
-            float c = std::cos(d.angVel);
-            float s = std::sin(d.angVel);
+            float c, s;
+            AstroSinCos(d.angVel, s, c);
             float rx = d.x1 - mx, ry = d.y1 - my;
             float nx = rx * c - ry * s;
             float ny = rx * s + ry * c;
@@ -244,9 +421,13 @@ void AstroArena::Thrust(int self, float power) {
             s.fuel = 0.0f;
         }
     }
+    if (config.fixedPoint) {
+        ThrustFixed(s, effectivePower);
+        return;
+    }
     float angleRad = s.angle * M_PI / 180.0f;
-    float thrustX = std::cos(angleRad) * effectivePower * THRUST_POWER;
-    float thrustY = std::sin(angleRad) * effectivePower * THRUST_POWER;
+    float thrustX = AstroCos(angleRad) * effectivePower * THRUST_POWER;
+    float thrustY = AstroSin(angleRad) * effectivePower * THRUST_POWER;
     s.vx += thrustX;
     s.vy += thrustY;
     float speed = std::sqrt(s.vx * s.vx + s.vy * s.vy);
@@ -256,6 +437,24 @@ void AstroArena::Thrust(int self, float power) {
     }
 }
 
+// Thrust() on the 16.16 grid, fuel aside: the push from the sine table and the speed
+// limit from an integer square root
+void AstroArena::ThrustFixed(ShipState& s, float effectivePower) {
+    constexpr AstroFixed maxVelocity = AstroFixedConst(MAX_VELOCITY);
+    const AstroFixed push = AstroToFixed(effectivePower * THRUST_POWER);
+    const AstroFixed angle = AstroToFixed(s.angle);
+    AstroFixed vx = AstroToFixed(s.vx) + AstroFixedMul(AstroFixedCosDeg(angle), push);
+    AstroFixed vy = AstroToFixed(s.vy) + AstroFixedMul(AstroFixedSinDeg(angle), push);
+    const uint64_t speedSq = (uint64_t)((int64_t)vx * vx) + (uint64_t)((int64_t)vy * vy); // 32.32
+    if (speedSq > (uint64_t)((int64_t)maxVelocity * maxVelocity)) {
+        const int64_t speed = AstroIsqrt(speedSq);
+        vx = (AstroFixed)((int64_t)vx * maxVelocity / speed);
+        vy = (AstroFixed)((int64_t)vy * maxVelocity / speed);
+    }
+    s.vx = AstroFromFixed(vx);
+    s.vy = AstroFromFixed(vy);
+}
+
 void AstroArena::TurnDeg(int self, int degrees) {
     auto& s = ships[self];
     if (!s.alive) return;
@@ -266,84 +465,127 @@ void AstroArena::FirePhaser(int self) {
     auto& s = ships[self];
     if (!s.alive || s.phaser_cooldown > 0) return;
     s.phaser_cooldown = PHASER_COOLDOWN;
+    EnsureBroadphase();
+    PhaserTrace trace = TracePhaser(self);
+    if (deferActions) intents[self].push_back({ ShipIntent::PHASER, trace });
+    else ResolvePhaser(self, trace);
+}
+
+AstroArena::PhaserTrace AstroArena::TracePhaser(int self) const {
+    const auto& s = ships[self];
     float angleRad = s.angle * M_PI / 180.0f;
-    float dirX = std::cos(angleRad);
-    float dirY = std::sin(angleRad);
+    float dirX, dirY;
+    SinCos(angleRad, dirY, dirX);
+    c2Ray ray; ray.p = c2V(s.x, s.y); ray.d = c2V(dirX, dirY); ray.t = PHASER_RANGE;
+
+    // Closest hit wins; exact ties go to ships, then to the lower index, which is the
+    // order the original all-pairs loops found them in.
     float closestDist = PHASER_RANGE;
     int hitShip = -1;
     int hitAsteroid = -1;
-    float hitX = s.x + dirX * PHASER_RANGE;
-    float hitY = s.y + dirY * PHASER_RANGE;
-    c2Ray ray; ray.p = c2V(s.x, s.y); ray.d = c2V(dirX, dirY); ray.t = PHASER_RANGE;
-    c2Raycast rc;
-    // Ships
-    for (size_t i = 0; i < ships.size(); ++i) {
-        if (i == (size_t)self || !ships[i].alive) continue;
-        c2Capsule cap = MakeShipCapsule(ships[i]);
-        for (int oy = -1; oy <= 1; ++oy) {
-            for (int ox = -1; ox <= 1; ++ox) {
-                c2Capsule wcap = cap;
-                wcap.a = c2Add(wcap.a, c2V(ox * ASTROBOTS_W, oy * ASTROBOTS_H));
-                wcap.b = c2Add(wcap.b, c2V(ox * ASTROBOTS_W, oy * ASTROBOTS_H));
-                c2Raycast out;
-                if (c2RaytoCapsule(ray, wcap, &out)) {
-                    if (out.t < closestDist) {
-                        closestDist = out.t;
-                        hitShip = (int)i;
-                        hitAsteroid = -1;
-                        c2v hp = c2Impact(ray, out.t);
-                        hitX = hp.x; hitY = hp.y;
-                    }
-                }
-            }
+    auto consider = [&](float t, bool isShip, int index) {
+        if (t >= PHASER_RANGE) return;
+        if (t < closestDist || (hitShip < 0 && hitAsteroid < 0)) {
+            closestDist = t;
+        } else if (t == closestDist) {
+            int bestIndex = hitShip >= 0 ? hitShip : hitAsteroid;
+            bool better = (isShip && hitShip < 0) || (isShip == (hitShip >= 0) && index < bestIndex);
+            if (!better) return;
+        } else {
+            return;
         }
-    }
-    // Asteroids
-    for (size_t i = 0; i < asteroids.size(); ++i) {
-        if (!asteroids[i].alive || !asteroids[i].hasPoly) continue;
-        std::array<c2x, 9> tr;
-        int trCount = 0;
-        BuildWrapTransforms(asteroids[i].x, asteroids[i].y, tr, trCount);
-        for (int ti = 0; ti < trCount; ++ti) {
+        hitShip = isShip ? index : -1;
+        hitAsteroid = isShip ? -1 : index;
+    };
+    const c2v world = c2V(config.width, config.height);
+    // each torus copy of an object whose box meets seg: copies outside it can't be hit there
+    c2AABB seg;
+    auto testShip = [&](int i) {
+        if (i == self || !ships[i].alive) return;
+        WrapOffsets offsets = FindWrapOffsets(shipBounds[i], seg, world);
+        for (int oi = 0; oi < offsets.count; ++oi) {
+            c2v shift = c2V(offsets.at[oi].first * config.width, offsets.at[oi].second * config.height);
+            c2Capsule wcap = shipCapsules[i];
+            wcap.a = c2Add(wcap.a, shift);
+            wcap.b = c2Add(wcap.b, shift);
             c2Raycast out;
-            if (c2RaytoPoly(ray, &asteroids[i].poly, &tr[ti], &out)) {
-                if (out.t < closestDist) {
-                    closestDist = out.t;
-                    hitAsteroid = (int)i;
-                    hitShip = -1;
-                    c2v hp = c2Impact(ray, out.t);
-                    hitX = hp.x; hitY = hp.y;
-                }
-            }
+            if (c2RaytoCapsule(ray, wcap, &out)) consider(out.t, true, i);
         }
+    };
+    auto testAsteroid = [&](int i) {
+        if (!asteroids.alive[i]) return;
+        WrapOffsets offsets = FindWrapOffsets(asteroidBounds[i], seg, world);
+        for (int oi = 0; oi < offsets.count; ++oi) {
+            c2x tr = c2xIdentity();
+            tr.p = c2V(asteroids.x[i] + offsets.at[oi].first * config.width, asteroids.y[i] + offsets.at[oi].second * config.height);
+            c2Raycast out;
+            if (c2RaytoPoly(ray, &asteroids.Shape(i).poly, &tr, &out)) consider(out.t, false, i);
+        }
+    };
+    auto visit = [&](AstroBodyKind kind, int index) {
+        if (kind == ASTRO_BODY_SHIP) testShip(index);
+        else testAsteroid(index);
+    };
+
+    // The ray in ASTRO_BROADPHASE_STEP pieces, nearest first: whatever the ray touches up
+    // to the end of a piece meets that piece's box, so once the closest hit so far is no
+    // further than that, nothing past it can beat it. Objects near a join get tested for
+    // both pieces, which consider() shrugs off.
+    for (float t0 = 0.0f;;) {
+        float t1 = std::min(PHASER_RANGE, t0 + ASTRO_BROADPHASE_STEP);
+        seg.min = c2Minv(c2Impact(ray, t0), c2Impact(ray, t1));
+        seg.max = c2Maxv(c2Impact(ray, t0), c2Impact(ray, t1));
+        broadphase->VisitBox(seg, NARROWPHASE_PAD, visit);
+        if (t1 >= PHASER_RANGE || ((hitShip >= 0 || hitAsteroid >= 0) && closestDist <= t1)) break;
+        t0 = t1;
+    }
+    PhaserTrace trace;
+    trace.hitShip = hitShip;
+    trace.hitAsteroid = hitAsteroid;
+    trace.hitX = s.x + dirX * PHASER_RANGE;
+    trace.hitY = s.y + dirY * PHASER_RANGE;
+    if (hitShip >= 0 || hitAsteroid >= 0) {
+        c2v hp = c2Impact(ray, closestDist);
+        trace.hitX = hp.x; trace.hitY = hp.y;
+    }
+    return trace;
+}
+
+void AstroArena::ResolvePhaser(int self, PhaserTrace trace) {
+    auto& s = ships[self];
+    // simultaneous turns: whatever the beam was aimed at may have been destroyed by an
+    // earlier ship's action; the beam still ends where it was aimed
+    if (trace.hitShip >= 0 && !ships[trace.hitShip].alive) trace.hitShip = -1;
+    if (trace.hitAsteroid >= 0 && !asteroids.alive[trace.hitAsteroid]) trace.hitAsteroid = -1;
+    const int hitShip = trace.hitShip, hitAsteroid = trace.hitAsteroid;
+    const float hitX = trace.hitX, hitY = trace.hitY;
+    if (visualEffects) {
+        PhaserBeam beam;
+        beam.x1 = s.x; beam.y1 = s.y;
+        beam.x2 = hitX; beam.y2 = hitY;
+        beam.lifetime = 3;
+        beam.color = IM_COL32(255, 100, 100, 255);
+        beam.alive = true;
+        phaserBeams.Add(beam);
+    }
+    if (recorder) {
+        if (hitShip >= 0) recorder->Event(turn, ASTRO_EV_PHASER_HIT_SHIP, self, hitShip, PHASER_DAMAGE);
+        else if (hitAsteroid >= 0) recorder->Event(turn, ASTRO_EV_PHASER_HIT_ASTEROID, self, hitAsteroid);
+        else recorder->Event(turn, ASTRO_EV_PHASER_MISS, self);
     }
-    PhaserBeam beam;
-    beam.x1 = s.x; beam.y1 = s.y;
-    beam.x2 = hitX; beam.y2 = hitY;
-    beam.lifetime = 3;
-    beam.color = IM_COL32(255, 100, 100, 255);
-    beam.alive = true;
-    phaserBeams.push_back(beam);
     if (hitShip >= 0) {
         ships[hitShip].hp -= PHASER_DAMAGE;
+        s.damageDealt += PHASER_DAMAGE;
         SpawnParticleBurst(hitX, hitY, 28, IM_COL32(255, 160, 120, 255), 0.8f, 0.7f);
-        if (log) {
-            std::string attacker = s.ship ? s.ship->name : "Ship";
-            std::string target = ships[hitShip].ship ? ships[hitShip].ship->name : "Ship";
-            log(attacker + " hits " + target + " with phaser for " + std::to_string(PHASER_DAMAGE) + " damage!");
-        }
-        if (ships[hitShip].hp <= 0) {
-            std::string target = ships[hitShip].ship ? ships[hitShip].ship->name : "Ship";
-            KillShip(ships[hitShip], target + " is destroyed!");
-        }
+        Log(ASTRO_LOG_PHASER_HIT, self, hitShip, PHASER_DAMAGE);
+        if (ships[hitShip].hp <= 0) KillShip(ships[hitShip], self);
     } else if (hitAsteroid >= 0) {
         SpawnParticleBurst(hitX, hitY, 36, IM_COL32(255, 120, 120, 255), 0.9f, 0.8f);
         BreakAsteroid(hitAsteroid, s.x, s.y);
         s.fuel += FUEL_HIT_REWARD;
         if (s.fuel > ASTRO_START_FUEL) s.fuel = ASTRO_START_FUEL;
-    } else if (log) {
-        std::string attacker = s.ship ? s.ship->name : "Ship";
-        log(attacker + " fires phaser and misses.");
+    } else {
+        Log(ASTRO_LOG_PHASER_MISS, self);
     }
 }
 
@@ -351,67 +593,214 @@ void AstroArena::FirePhoton(int self) {
     auto& s = ships[self];
     if (!s.alive || s.photon_cooldown > 0) return;
     s.photon_cooldown = PHOTON_COOLDOWN;
+    // the other programs could scan the torpedo, so it waits for the resolve pass in a simultaneous turn
+    if (deferActions) intents[self].push_back({ ShipIntent::PHOTON, {} });
+    else LaunchPhoton(self);
+}
+
+void AstroArena::LaunchPhoton(int self) {
+    const auto& s = ships[self];
     PhotonTorpedo t;
     t.x = s.x;
     t.y = s.y;
     t.prevX = t.x;
     t.prevY = t.y;
-    float angleRad = s.angle * M_PI / 180.0f;
-    t.vx = s.vx + std::cos(angleRad) * PHOTON_SPEED;
-    t.vy = s.vy + std::sin(angleRad) * PHOTON_SPEED;
+    if (config.fixedPoint) {
+        constexpr AstroFixed speed = AstroFixedConst(PHOTON_SPEED);
+        const AstroFixed angle = AstroToFixed(s.angle);
+        t.vx = AstroFromFixed(AstroToFixed(s.vx) + AstroFixedMul(AstroFixedCosDeg(angle), speed));
+        t.vy = AstroFromFixed(AstroToFixed(s.vy) + AstroFixedMul(AstroFixedSinDeg(angle), speed));
+    } else {
+        float angleRad = s.angle * M_PI / 180.0f;
+        t.vx = s.vx + AstroCos(angleRad) * PHOTON_SPEED;
+        t.vy = s.vy + AstroSin(angleRad) * PHOTON_SPEED;
+    }
     t.lifetime = PHOTON_LIFETIME;
     t.damage = PHOTON_DAMAGE;
     t.owner = self;
     t.alive = true;
-    std::uniform_real_distribution<float> phaseDist(0.0f, 2.0f * (float)M_PI);
-    t.anim = phaseDist(rng);
-    torpedoes.push_back(t);
-    if (log) {
-        std::string attacker = s.ship ? s.ship->name : "Ship";
-        log(attacker + " fires photon torpedo!");
+    if (visualEffects) {
+        std::uniform_real_distribution<float> phaseDist(0.0f, 2.0f * (float)M_PI);
+        t.anim = phaseDist(effectsRng);
     }
+    torpedoes.Add(t);
+    if (recorder) recorder->Event(turn, ASTRO_EV_PHOTON_FIRE, self);
+    Log(ASTRO_LOG_PHOTON_FIRE, self);
 }
 
-void AstroArena::Scan(int self) {
+bool AstroArena::Scan(int self, AstroScanFilter filter) {
     auto& s = ships[self];
-    if (!s.alive) return;
-    float closestDist = ASTRO_SCAN_RANGE;
-    float closestAngle = 0;
-    bool found = false;
-    for (size_t i = 0; i < ships.size(); ++i) {
-        if (i == (size_t)self || !ships[i].alive) continue;
-        float dist = Distance(s.x, s.y, ships[i].x, ships[i].y);
-        if (dist < closestDist) {
-            closestDist = dist;
-            closestAngle = AngleTo(s.x, s.y, ships[i].x, ships[i].y);
-            found = true;
-        }
+    if (!s.alive) return false;
+    ScanCache& cache = scanCache[self];
+    if (cache.epoch != worldEpoch) {
+        cache.epoch = worldEpoch;
+        cache.valid = 0;
+        cache.walked = 0.0f;
+        cache.nearest[0] = cache.nearest[1] = ScanResult{};
     }
-    for (auto& a : asteroids) {
-        if (!a.alive) continue;
-        float dist = Distance(s.x, s.y, a.x, a.y);
-        if (dist < closestDist) {
-            closestDist = dist;
-            closestAngle = AngleTo(s.x, s.y, a.x, a.y);
-            found = true;
-        }
+    // torpedoes aren't in worldEpoch: launches in a sequential turn only append them
+    if (filter == ASTRO_SCAN_TORPEDOES && cache.torpedoCount != torpedoes.size()) {
+        cache.valid &= (uint8_t)~(1u << ASTRO_SCAN_TORPEDOES);
+    }
+    const bool query = !(cache.valid & (1u << filter));
+    if (query) {
+        if (filter == ASTRO_SCAN_TORPEDOES) ScanTorpedoes(self, cache);
+        else ScanBodies(self, filter, cache);
     }
+
+    // most programs only branch on whether and how near; the angle waits for ScanAngle()
+    const ScanResult& r = cache.found[filter];
+    bool found = r.index >= 0;
     s.scan_hit = found;
-    s.scan_dist = closestDist;
-    s.scan_angle = NormalizeAngle(closestAngle);
+    s.scan_distSq = found ? r.distSq : ASTRO_SCAN_RANGE * ASTRO_SCAN_RANGE;
+    s.scan_dx = found ? r.dx : 0.0f;
+    s.scan_dy = found ? r.dy : 0.0f;
+    s.scanEpoch = worldEpoch;
+    return query;
+}
+
+// Nearest ship and nearest asteroid by squared torus distance, ties to the lower index, so
+// the result doesn't depend on the order the broadphase visits them in; the nearest of
+// either kind is whichever of the two is nearer, ties to the ship. Resumes the walk the
+// cache left off, stops once filter's answer is settled, and caches every answer that is
+// settled by then.
+void AstroArena::ScanBodies(int self, AstroScanFilter filter, ScanCache& cache) {
+    const auto& s = ships[self];
+    // usually the broadphase HandleCollisions built last turn; rebuilt only if something changed since
+    EnsureBroadphase();
+
+    const float rangeSq = ASTRO_SCAN_RANGE * ASTRO_SCAN_RANGE;
+    ScanResult* best = cache.nearest; // ships, asteroids
+    auto consider = [&](ScanResult& b, float ox, float oy, int idx) {
+        float dx = WrapDelta(ox - s.x, config.width);
+        float dy = WrapDelta(oy - s.y, config.height);
+        float d2 = dx * dx + dy * dy;
+        if (d2 >= rangeSq) return;
+        if (b.index >= 0 && (d2 > b.distSq || (d2 == b.distSq && idx > b.index))) return;
+        b = { dx, dy, d2, idx };
+    };
+    auto visit = [&](AstroBodyKind kind, int i) {
+        if (kind == ASTRO_BODY_SHIP) {
+            if (i != self && ships[i].alive) consider(best[0], ships[i].x, ships[i].y, i);
+        } else if (asteroids.alive[i]) {
+            consider(best[1], asteroids.x[i], asteroids.y[i], i);
+        }
+    };
+    auto nearest = [&](AstroScanFilter f) -> const ScanResult& {
+        if (f == ASTRO_SCAN_SHIPS) return best[0];
+        if (f == ASTRO_SCAN_ASTEROIDS) return best[1];
+        return (best[0].index >= 0 && (best[1].index < 0 || best[0].distSq <= best[1].distSq)) ? best[0] : best[1];
+    };
+
+    // boxes doubling from ASTRO_BROADPHASE_STEP out to the range: once the best so far is
+    // no further than the box's half width, whatever lies outside the box is further still
+    float r = cache.walked;
+    auto settled = [&](AstroScanFilter f) {
+        const ScanResult& b = nearest(f);
+        return r >= ASTRO_SCAN_RANGE || (b.index >= 0 && b.distSq <= r * r);
+    };
+    while (r <= 0.0f || !settled(filter)) {
+        r = (r <= 0.0f) ? std::min(ASTRO_SCAN_RANGE, ASTRO_BROADPHASE_STEP) : std::min(ASTRO_SCAN_RANGE, 2.0f * r);
+        c2AABB box;
+        box.min = c2V(s.x - r, s.y - r);
+        box.max = c2V(s.x + r, s.y + r);
+        broadphase->VisitCentres(box, visit);
+    }
+    cache.walked = r;
+    for (AstroScanFilter f : { ASTRO_SCAN_ANY, ASTRO_SCAN_SHIPS, ASTRO_SCAN_ASTEROIDS }) {
+        if (!settled(f)) continue;
+        cache.found[f] = nearest(f);
+        cache.valid |= (uint8_t)(1u << f);
+    }
+}
+
+// Nearest torpedo fired by another ship and flying towards this one, ties to the lower index.
+// Heading is judged against the ship's position, not its velocity, so THRUST doesn't stale
+// the cached answer. Torpedoes aren't in the broadphase; one pass over them per ship and
+// world state.
+void AstroArena::ScanTorpedoes(int self, ScanCache& cache) {
+    const auto& s = ships[self];
+    const float rangeSq = ASTRO_SCAN_RANGE * ASTRO_SCAN_RANGE;
+    ScanResult best;
+    for (size_t i = 0; i < torpedoes.size(); ++i) {
+        const PhotonTorpedo& t = torpedoes[i];
+        if (!t.alive || t.owner == self) continue;
+        float dx = WrapDelta(t.x - s.x, config.width);
+        float dy = WrapDelta(t.y - s.y, config.height);
+        float d2 = dx * dx + dy * dy;
+        if (d2 >= rangeSq || (best.index >= 0 && d2 >= best.distSq)) continue;
+        if (dx * t.vx + dy * t.vy >= 0.0f) continue; // flying away
+        best = { dx, dy, d2, (int)i };
+    }
+    cache.found[ASTRO_SCAN_TORPEDOES] = best;
+    cache.torpedoCount = (uint32_t)torpedoes.size();
+    cache.valid |= (uint8_t)(1u << ASTRO_SCAN_TORPEDOES);
+}
+
+float AstroArena::ShipState::ScanAngle() const {
+    if (scan_dx == 0.0f && scan_dy == 0.0f) return 0.0f;
+    return NormalizeAngle(AstroAtan2(scan_dy, scan_dx) * 180.0f / (float)M_PI);
 }
 
 void AstroArena::Signal(int self, int value) {
     auto& s = ships[self];
     if (!s.alive) return;
     s.signal = value;
-    signals.emplace_back(s.x, s.y);
+    if (deferActions) intents[self].push_back({ ShipIntent::SIGNAL, {}, value });
+    else signals.push_back({ s.x, s.y, self, value });
+}
+
+// Boxes doubling from ASTRO_BROADPHASE_STEP out to the range, as ScanBodies() walks: once
+// the nearest so far is no further than the box's half width, nothing outside is nearer.
+const AstroArena::SignalRecord* AstroArena::Hear(int self) {
+    auto& s = ships[self];
+    if (s.heardTurn == turn) return s.heard >= 0 ? &heardSignals[s.heard] : nullptr;
+    s.heardTurn = turn;
+    s.heard = -1;
+    if (heardSignals.empty()) return nullptr;
+    const float rangeSq = ASTRO_SIGNAL_RANGE * ASTRO_SIGNAL_RANGE;
+    int best = -1;
+    float bestDx = 0, bestDy = 0, bestD2 = 0;
+    auto visit = [&](AstroBodyKind, int i) {
+        const SignalRecord& sig = heardSignals[i];
+        if (sig.ship == self || ships[sig.ship].team != s.team) return;
+        float dx = WrapDelta(sig.x - s.x, config.width);
+        float dy = WrapDelta(sig.y - s.y, config.height);
+        float d2 = dx * dx + dy * dy;
+        if (d2 > rangeSq) return;
+        // boxes overlap, so a signal can come up more than once
+        if (best >= 0 && (d2 > bestD2 || (d2 == bestD2 && i >= best))) return;
+        best = i;
+        bestDx = dx; bestDy = dy; bestD2 = d2;
+    };
+    float r = 0.0f;
+    while (r < ASTRO_SIGNAL_RANGE && !(best >= 0 && bestD2 <= r * r)) {
+        r = (r <= 0.0f) ? std::min(ASTRO_SIGNAL_RANGE, ASTRO_BROADPHASE_STEP) : std::min(ASTRO_SIGNAL_RANGE, 2.0f * r);
+        c2AABB box;
+        box.min = c2V(s.x - r, s.y - r);
+        box.max = c2V(s.x + r, s.y + r);
+        signalBins.VisitCentres(box, visit);
+    }
+    if (best < 0) return nullptr;
+    s.heard = best;
+    s.heard_dx = bestDx;
+    s.heard_dy = bestDy;
+    s.heard_distSq = bestD2;
+    return &heardSignals[best];
+}
+
+void AstroArena::TurnToSignal(int self) {
+    auto& s = ships[self];
+    if (!s.alive || !Hear(self)) return;
+    if (s.heard_dx == 0.0f && s.heard_dy == 0.0f) return;
+    s.targetAngle = NormalizeAngle(Atan2(s.heard_dy, s.heard_dx) * 180.0f / (float)M_PI);
 }
 
 void AstroArena::TurnToScan(int self) {
     auto& s = ships[self];
     if (!s.alive || !s.scan_hit) return;
-    s.targetAngle = s.scan_angle;
+    // ShipState::ScanAngle() with this arena's trig
+    s.targetAngle = s.scan_dx == 0.0f && s.scan_dy == 0.0f ? 0.0f : NormalizeAngle(Atan2(s.scan_dy, s.scan_dx) * 180.0f / (float)M_PI);
 }
 
 bool AstroArena::CircleCollision(float x1, float y1, float r1, float x2, float y2, float r2) {
@@ -419,55 +808,148 @@ bool AstroArena::CircleCollision(float x1, float y1, float r1, float x2, float y
     return dist < (r1 + r2);
 }
 
+// ship si's pair cache entry for asteroid h, else the slot skipped or tested longest ago
+// (emptied)
+AstroArena::PairCacheEntry& AstroArena::PairCacheSlot(size_t si, AstroHandle h) {
+    PairCacheEntry* slots = &pairCache[si * PAIR_CACHE_WAYS];
+    PairCacheEntry* oldest = slots;
+    for (int w = 0; w < PAIR_CACHE_WAYS; ++w) {
+        if (slots[w].asteroid == h) return slots[w];
+        if (slots[w].turn < oldest->turn) oldest = &slots[w];
+    }
+    *oldest = PairCacheEntry{};
+    return *oldest;
+}
+
 void AstroArena::HandleCollisions() {
-    RebuildBroadphase();
+    EnsureBroadphase();
+    const c2v world = c2V(config.width, config.height);
+    if (pairCache.size() != ships.size() * PAIR_CACHE_WAYS) {
+        pairCache.assign(ships.size() * PAIR_CACHE_WAYS, PairCacheEntry{});
+    }
     for (size_t si = 0; si < ships.size(); ++si) {
         auto& s = ships[si];
         if (!s.alive) continue;
-        int scx, scy; PosToCell(s.x, s.y, scx, scy);
-        std::vector<int> cellIdx;
-        CollectNearCells(scx, scy, cellIdx);
-        for (int cell : cellIdx) {
-            const auto& bucket = gridAsteroids[cell];
-            for (int ai : bucket) {
-                auto& a = asteroids[ai];
-            if (!a.alive) continue;
+        const c2Capsule& shipCap = shipCapsules[si];
+        const c2AABB& shipBox = shipBounds[si];
+        // hits break asteroids, which draws from the RNG: resolve them in index order
+        broadphase->Collect(shipBox, NARROWPHASE_PAD, broadphaseHits);
+        for (int ai : broadphaseHits.asteroids) {
+            if (!asteroids.alive[ai]) continue;
             // Ship vs asteroid using cute_c2 (capsule vs poly with wrap)
+            const AsteroidShape& shape = asteroids.Shape(ai);
             bool hit = false;
-            c2Capsule shipCap = MakeShipCapsule(s);
             std::array<c2x, 9> tr;
             int trCount = 0;
-            BuildWrapTransforms(a.x, a.y, tr, trCount);
-            for (int ti = 0; ti < trCount && !hit; ++ti) {
-                if (a.hasPoly && c2CapsuletoPoly(shipCap, &a.poly, &tr[ti])) {
-                    hit = true;
+            WrapOffsets offsets = FindWrapOffsets(asteroidBounds[ai], shipBox, world);
+            if (offsets.count == 0) continue;
+            uint16_t copies = 0;
+            for (int oi = 0; oi < offsets.count; ++oi) {
+                copies |= (uint16_t)(1u << ((offsets.at[oi].first + 1) * 3 + offsets.at[oi].second + 1));
+            }
+            const AstroHandle handle = asteroids.HandleAt(ai);
+            PairCacheEntry& cached = PairCacheSlot(si, handle);
+            if (cached.asteroid == handle && cached.copies == copies) {
+                const float shipMove = std::max(c2Len(c2Sub(shipCap.a, cached.shipA)), c2Len(c2Sub(shipCap.b, cached.shipB)));
+                const float asteroidMove = c2Len(c2V(asteroids.x[ai] - cached.x, asteroids.y[ai] - cached.y));
+                if (shipMove + asteroidMove < cached.gap - PAIR_CACHE_MARGIN) {
+                    cached.turn = turn;
+                    narrowphaseSkips++;
+                    continue;
                 }
             }
+            BuildWrapTransforms(asteroids.x[ai], asteroids.y[ai], offsets, world, tr, trCount);
+            // c2CapsuletoPoly() is this GJK's distance being zero; the distance is the gap
+            float gap = std::numeric_limits<float>::max();
+            for (int ti = 0; ti < trCount && !hit; ++ti) {
+                const float d = c2GJK(&shipCap, C2_TYPE_CAPSULE, 0, &shape.poly, C2_TYPE_POLY, &tr[ti], 0, 0, 1, 0, 0);
+                if (d == 0.0f) hit = true;
+                gap = std::min(gap, d);
+            }
+            narrowphaseTests++;
+            if (!hit) {
+                cached = { handle, turn, copies, gap, shipCap.a, shipCap.b, asteroids.x[ai], asteroids.y[ai] };
+            }
             if (hit) {
                 s.hp -= 1;
-                a.hp--;
+                asteroids.hp[ai]--;
                 SpawnParticleBurst(s.x, s.y, 24, IM_COL32(255, 150, 120, 255));
-                if (s.hp <= 0) {
-                    std::string name = s.ship ? s.ship->name : "Ship";
-                    KillShip(s, name + " destroyed by asteroid collision!");
-                }
-                if (a.hp <= 0) {
-                        BreakAsteroid((int)ai, s.x, s.y);
-                    }
+                if (s.hp <= 0) KillShip(s, -1);
+                if (asteroids.hp[ai] <= 0) {
+                    BreakAsteroid(ai, s.x, s.y);
                 }
             }
         }
     }
 }
 
+// ===== Torpedo sweeps =====
+// whether box, or one of its whole-world copies, comes within pad of q: FindWrapOffsets()
+// without building the list
+static bool TouchesOnTorus(const c2AABB& box, const c2AABB& q, c2v world, float pad = NARROWPHASE_PAD) {
+    auto axis = [](float lo, float hi, float qMin, float qMax, float extent) {
+        for (int k = -1; k <= 1; ++k) {
+            if (hi + k * extent >= qMin && lo + k * extent <= qMax) return true;
+        }
+        return false;
+    };
+    return axis(box.min.x - pad, box.max.x + pad, q.min.x, q.max.x, world.x) &&
+           axis(box.min.y - pad, box.max.y + pad, q.min.y, q.max.y, world.y);
+}
+
+void AstroArena::SweepTorpedoes() {
+    const c2v world = c2V(config.width, config.height);
+    torpedoCandidates.clear();
+    torpedoCandidateStart.resize(torpedoes.size() + 1);
+    for (size_t k = 0; k < torpedoes.size(); ++k) {
+        torpedoCandidateStart[k] = (int)torpedoCandidates.size();
+        const auto& t = torpedoes[k];
+        if (!t.alive) continue;
+        c2AABB sweptBox;
+        sweptBox.min = c2V(std::min(t.prevX, t.x) - TORPEDO_RADIUS, std::min(t.prevY, t.y) - TORPEDO_RADIUS);
+        sweptBox.max = c2V(std::max(t.prevX, t.x) + TORPEDO_RADIUS, std::max(t.prevY, t.y) + TORPEDO_RADIUS);
+        // The broadphase hands back everything in the cells around the path, several times
+        // the objects whose bounds the path's box actually touches: drop the rest before
+        // sorting, so only those get sorted, deduplicated and expanded into copies.
+        broadphaseHits.ships.clear();
+        broadphaseHits.asteroids.clear();
+        auto touch = [&](AstroBodyKind kind, int index) {
+            if (kind == ASTRO_BODY_SHIP) {
+                if (index == t.owner || !ships[index].alive) return;
+                if (TouchesOnTorus(shipBounds[index], sweptBox, world)) broadphaseHits.ships.push_back(index);
+            } else {
+                if (!asteroids.alive[index]) return;
+                if (TouchesOnTorus(asteroidBounds[index], sweptBox, world)) broadphaseHits.asteroids.push_back(index);
+            }
+        };
+        broadphase->VisitBox(sweptBox, NARROWPHASE_PAD, touch);
+        // in index order, each once: ties on time of impact go to the last one tested
+        for (std::vector<int>* list : { &broadphaseHits.ships, &broadphaseHits.asteroids }) {
+            std::sort(list->begin(), list->end());
+            list->erase(std::unique(list->begin(), list->end()), list->end());
+        }
+        auto addCopies = [&](AstroBodyKind kind, int index, const c2AABB& bounds) {
+            WrapOffsets offsets = FindWrapOffsets(bounds, sweptBox, world);
+            for (int oi = 0; oi < offsets.count; ++oi) {
+                torpedoCandidates.push_back({ index, kind, (int8_t)offsets.at[oi].first, (int8_t)offsets.at[oi].second });
+            }
+        };
+        for (int si : broadphaseHits.ships) addCopies(ASTRO_BODY_SHIP, si, shipBounds[si]);
+        for (int ai : broadphaseHits.asteroids) addCopies(ASTRO_BODY_ASTEROID, ai, asteroidBounds[ai]);
+    }
+    torpedoCandidateStart[torpedoes.size()] = (int)torpedoCandidates.size();
+}
+
 void AstroArena::HandleTorpedoes() {
-    RebuildBroadphase();
-    for (auto& t : torpedoes) {
+    // reuses the collision broadphase unless a collision broke an asteroid or killed a ship
+    EnsureBroadphase();
+    SweepTorpedoes();
+    for (size_t k = 0; k < torpedoes.size(); ++k) {
+        auto& t = torpedoes[k];
         if (!t.alive) continue;
-        // Prepare swept circle for torpedo using c2TOI
         c2Circle torpCircle;
         torpCircle.p = c2V(t.prevX, t.prevY);
-        torpCircle.r = 5.0f;
+        torpCircle.r = TORPEDO_RADIUS;
         c2v vA = c2V(t.x - t.prevX, t.y - t.prevY);
 
         // Track earliest impact
@@ -477,58 +959,31 @@ void AstroArena::HandleTorpedoes() {
         int hitIndex = -1;
         c2v hitPoint = c2V(t.x, t.y);
 
-        // Candidate cells around swept path
-        int c0x, c0y, c1x, c1y;
-        PosToCell(t.prevX, t.prevY, c0x, c0y);
-        PosToCell(t.x, t.y, c1x, c1y);
-        std::vector<int> cells;
-        CollectNearCells(c0x, c0y, cells);
-        std::vector<int> cells2;
-        CollectNearCells(c1x, c1y, cells2);
-        cells.insert(cells.end(), cells2.begin(), cells2.end());
-
-        // Against ships
-        for (int cell : cells) {
-            const auto& sbucket = gridShips[cell];
-            for (int si : sbucket) {
-                if (si == t.owner || !ships[si].alive) continue;
-                c2Capsule shipCap = MakeShipCapsule(ships[si]);
-                for (int oy = -1; oy <= 1; ++oy) {
-                    for (int ox = -1; ox <= 1; ++ox) {
-                        c2Capsule wcap = shipCap;
-                        wcap.a = c2Add(wcap.a, c2V(ox * ASTROBOTS_W, oy * ASTROBOTS_H));
-                        wcap.b = c2Add(wcap.b, c2V(ox * ASTROBOTS_W, oy * ASTROBOTS_H));
-                        c2TOIResult res = c2TOI(&torpCircle, C2_TYPE_CIRCLE, nullptr, vA, &wcap, C2_TYPE_CAPSULE, nullptr, c2V(0, 0), 1);
-                        if (res.hit && res.toi >= 0.0f && res.toi <= bestToi) {
-                            bestToi = res.toi;
-                            hitType = HIT_SHIP;
-                            hitIndex = si;
-                            hitPoint = res.p;
-                            anyHit = true;
-                        }
-                    }
-                }
+        // the copies SweepTorpedoes() couldn't rule out, ships then asteroids in index
+        // order: ties on time of impact go to the last one tested
+        for (int ci = torpedoCandidateStart[k]; ci < torpedoCandidateStart[k + 1]; ++ci) {
+            const TorpedoCandidate& c = torpedoCandidates[ci];
+            const c2v shift = c2V(c.ox * config.width, c.oy * config.height);
+            c2TOIResult res;
+            if (c.kind == ASTRO_BODY_SHIP) {
+                // an earlier torpedo this turn may have destroyed it
+                if (!ships[c.index].alive) continue;
+                c2Capsule wcap = shipCapsules[c.index];
+                wcap.a = c2Add(wcap.a, shift);
+                wcap.b = c2Add(wcap.b, shift);
+                res = c2TOI(&torpCircle, C2_TYPE_CIRCLE, nullptr, vA, &wcap, C2_TYPE_CAPSULE, nullptr, c2V(0, 0), 1);
+            } else {
+                if (!asteroids.alive[c.index]) continue;
+                c2x tr = c2xIdentity();
+                tr.p = c2V(asteroids.x[c.index] + shift.x, asteroids.y[c.index] + shift.y);
+                res = c2TOI(&torpCircle, C2_TYPE_CIRCLE, nullptr, vA, &asteroids.Shape(c.index).poly, C2_TYPE_POLY, &tr, c2V(0, 0), 1);
             }
-        }
-
-        // Against asteroids
-        for (int cell : cells) {
-            const auto& abucket = gridAsteroids[cell];
-            for (int ai : abucket) {
-                if (!asteroids[ai].alive || !asteroids[ai].hasPoly) continue;
-                std::array<c2x, 9> tr;
-                int trCount = 0;
-                BuildWrapTransforms(asteroids[ai].x, asteroids[ai].y, tr, trCount);
-                for (int ti = 0; ti < trCount; ++ti) {
-                    c2TOIResult res = c2TOI(&torpCircle, C2_TYPE_CIRCLE, nullptr, vA, &asteroids[ai].poly, C2_TYPE_POLY, &tr[ti], c2V(0, 0), 1);
-                    if (res.hit && res.toi >= 0.0f && res.toi <= bestToi) {
-                        bestToi = res.toi;
-                        hitType = HIT_AST;
-                        hitIndex = ai;
-                        hitPoint = res.p;
-                        anyHit = true;
-                    }
-                }
+            if (res.hit && res.toi >= 0.0f && res.toi <= bestToi) {
+                bestToi = res.toi;
+                hitType = c.kind == ASTRO_BODY_SHIP ? HIT_SHIP : HIT_AST;
+                hitIndex = c.index;
+                hitPoint = res.p;
+                anyHit = true;
             }
         }
 
@@ -536,19 +991,15 @@ void AstroArena::HandleTorpedoes() {
         if (anyHit) {
             t.alive = false;
             if (hitType == HIT_SHIP && hitIndex >= 0) {
+                if (recorder) recorder->Event(turn, ASTRO_EV_TORPEDO_HIT_SHIP, t.owner, hitIndex, t.damage);
                 ships[hitIndex].hp -= t.damage;
+                if (t.owner >= 0 && t.owner < (int)ships.size()) ships[t.owner].damageDealt += t.damage;
                 SpawnParticleBurst(ships[hitIndex].x, ships[hitIndex].y, 42, IM_COL32(255, 200, 140, 255), 1.0f, 1.0f);
                 SpawnParticleBurst(ships[hitIndex].x, ships[hitIndex].y, 20, IM_COL32(255, 255, 200, 255), 1.7f, 0.5f);
-                if (log) {
-                    std::string attacker = (t.owner >= 0 && ships[t.owner].ship) ? ships[t.owner].ship->name : "Ship";
-                    std::string target = ships[hitIndex].ship ? ships[hitIndex].ship->name : "Ship";
-                    log(attacker + "'s torpedo hits " + target + " for " + std::to_string(t.damage) + " damage!");
-                }
-                if (ships[hitIndex].hp <= 0) {
-                    std::string target = ships[hitIndex].ship ? ships[hitIndex].ship->name : "Ship";
-                    KillShip(ships[hitIndex], target + " is destroyed!");
-                }
+                Log(ASTRO_LOG_TORPEDO_HIT, t.owner, hitIndex, t.damage);
+                if (ships[hitIndex].hp <= 0) KillShip(ships[hitIndex], t.owner);
             } else if (hitType == HIT_AST && hitIndex >= 0) {
+                if (recorder) recorder->Event(turn, ASTRO_EV_TORPEDO_HIT_ASTEROID, t.owner, hitIndex);
                 SpawnParticleBurst(hitPoint.x, hitPoint.y, 48, IM_COL32(255, 180, 140, 255), 1.0f, 1.0f);
                 SpawnParticleBurst(hitPoint.x, hitPoint.y, 25, IM_COL32(255, 255, 200, 255), 1.8f, 0.6f);
                 BreakAsteroid(hitIndex, t.x, t.y);
@@ -561,13 +1012,22 @@ void AstroArena::HandleTorpedoes() {
     }
 }
 
-void AstroArena::KillShip(ShipState& s, const std::string& message) {
+void AstroArena::KillShip(ShipState& s, int killer) {
     if (!s.alive) return;
+    int index = (int)(&s - ships.data());
     s.alive = false;
-    if (log) log(message);
+    s.deathTurn = turn;
+    s.killedBy = killer;
+    worldEpoch++;
+    if (recorder) recorder->Event(turn, ASTRO_EV_SHIP_KILLED, index);
+    Log(ASTRO_LOG_SHIP_DESTROYED, index, killer);
     SpawnParticleBurst(s.x, s.y, 150, s.color, 1.2f, 1.5f);
     SpawnParticleBurst(s.x, s.y, 80, IM_COL32(255, 255, 220, 255), 2.2f, 0.8f);
+    SpawnShipDebris(s);
+}
 
+void AstroArena::SpawnShipDebris(const ShipState& s) {
+    if (!visualEffects) return;
     // Spawn Asteroids-style breakup debris from the triangle outline
     // Reconstruct ship triangle in world space
     float angleRad = s.angle * (float)M_PI / 180.0f;
@@ -576,12 +1036,12 @@ void AstroArena::KillShip(ShipState& s, const std::string& message) {
     if (renderScale > 0.00001f) {
         size = SHIP_DRAW_SIZE / renderScale;
     }
-    ImVec2 nose(s.x + std::cos(angleRad) * size,
-                s.y + std::sin(angleRad) * size);
-    ImVec2 leftWing(s.x + std::cos(angleRad + 2.4f) * size * 0.6f,
-                    s.y + std::sin(angleRad + 2.4f) * size * 0.6f);
-    ImVec2 rightWing(s.x + std::cos(angleRad - 2.4f) * size * 0.6f,
-                     s.y + std::sin(angleRad - 2.4f) * size * 0.6f);
+    ImVec2 nose(s.x + AstroCos(angleRad) * size,
+                s.y + AstroSin(angleRad) * size);
+    ImVec2 leftWing(s.x + AstroCos(angleRad + 2.4f) * size * 0.6f,
+                    s.y + AstroSin(angleRad + 2.4f) * size * 0.6f);
+    ImVec2 rightWing(s.x + AstroCos(angleRad - 2.4f) * size * 0.6f,
+                     s.y + AstroSin(angleRad - 2.4f) * size * 0.6f);
 
     // Triangle centroid
     ImVec2 center((nose.x + leftWing.x + rightWing.x) / 3.0f,
@@ -604,8 +1064,8 @@ void AstroArena::KillShip(ShipState& s, const std::string& message) {
         for (int i = 0; i < SHIP_DEBRIS_COUNT_PER_EDGE; ++i) {
             float t0 = (float)i / (float)SHIP_DEBRIS_COUNT_PER_EDGE;
             float t1 = (float)(i + 1) / (float)SHIP_DEBRIS_COUNT_PER_EDGE;
-            t0 = std::max(0.0f, std::min(1.0f, t0 + jitter(rng)));
-            t1 = std::max(0.0f, std::min(1.0f, t1 + jitter(rng)));
+            t0 = std::max(0.0f, std::min(1.0f, t0 + jitter(effectsRng)));
+            t1 = std::max(0.0f, std::min(1.0f, t1 + jitter(effectsRng)));
             if (t1 < t0) std::swap(t0, t1);
             ImVec2 p0(a.x + (b.x - a.x) * t0, a.y + (b.y - a.y) * t0);
             ImVec2 p1(a.x + (b.x - a.x) * t1, a.y + (b.y - a.y) * t1);
@@ -618,7 +1078,7 @@ void AstroArena::KillShip(ShipState& s, const std::string& message) {
             if (len < 1e-5f) { dx = 1.0f; dy = 0.0f; len = 1.0f; }
             dx /= len; dy /= len;
 
-            float spd = speedDist(rng);
+            float spd = speedDist(effectsRng);
 
             ShipDebrisSegment seg;
             seg.x1 = p0.x; seg.y1 = p0.y;
@@ -626,79 +1086,58 @@ void AstroArena::KillShip(ShipState& s, const std::string& message) {
             // Inherit some ship velocity, add outward impulse and slight downward bias
             seg.vx = s.vx + dx * spd;
             seg.vy = s.vy + dy * spd + 0.15f;
-            seg.angVel = angVelDist(rng);
-            seg.startLifetime = SHIP_DEBRIS_LIFETIME + lifeJitter(rng);
+            seg.angVel = angVelDist(effectsRng);
+            seg.startLifetime = SHIP_DEBRIS_LIFETIME + lifeJitter(effectsRng);
             if (seg.startLifetime < 20) seg.startLifetime = 20;
             seg.lifetime = seg.startLifetime;
             seg.color = s.color;
             seg.alive = true;
-            shipDebris.push_back(seg);
+            // capacity is reserved up front; past the cap a death just sheds fewer pieces
+            if (shipDebris.size() < (size_t)config.maxShipDebris) shipDebris.push_back(seg);
         }
     }
 }
 
 void AstroArena::BreakAsteroid(int asteroidIdx, float pushFromX, float pushFromY) {
     if (asteroidIdx < 0 || asteroidIdx >= (int)asteroids.size()) return;
-    auto& a = asteroids[asteroidIdx];
-    if (!a.alive) return;
-    a.alive = false;
-    std::uniform_real_distribution<float> angleDist(0, 2.0f * M_PI);
-    std::uniform_real_distribution<float> speedDist(0.5f, ASTEROID_MAX_SPEED);
-    std::uniform_int_distribution<int> countDist(2, 3);
+    if (!asteroids.alive[asteroidIdx]) return;
+    asteroids.alive[asteroidIdx] = 0;
+    worldEpoch++;
+    // copies: spawning fragments below grows the columns
+    const float ax = asteroids.x[asteroidIdx], ay = asteroids.y[asteroidIdx];
+    const float avx = asteroids.vx[asteroidIdx], avy = asteroids.vy[asteroidIdx];
+    const float asize = asteroids.radius[asteroidIdx];
     float pushAngle = 0;
     float pushSpeed = 1.5f;
     bool hasPush = (pushFromX >= 0 && pushFromY >= 0);
-    if (hasPush) pushAngle = AngleTo(pushFromX, pushFromY, a.x, a.y) * M_PI / 180.0f;
-    if (a.size > MEDIUM_ASTEROID_SIZE) {
-        int count = countDist(rng);
-        for (int i = 0; i < count; ++i) {
-            Asteroid newAst;
-            newAst.x = a.x; newAst.y = a.y;
-            float angle = angleDist(rng);
-            float speed = speedDist(rng);
-            if (hasPush) {
-                float angleOffset = (float)(i - count / 2) * 0.8f;
-                angle = pushAngle + angleOffset;
-                speed += pushSpeed;
-            }
-            newAst.vx = a.vx + std::cos(angle) * speed;
-            newAst.vy = a.vy + std::sin(angle) * speed;
-            newAst.size = MEDIUM_ASTEROID_SIZE;
-            newAst.hp = MEDIUM_ASTEROID_HP;
-            newAst.alive = true;
-            newAst.GenerateShape(7, MEDIUM_ASTEROID_SIZE);
-            asteroids.push_back(newAst);
-        }
-    } else if (a.size > SMALL_ASTEROID_SIZE) {
-        int count = countDist(rng);
+    if (hasPush) pushAngle = AngleTo(pushFromX, pushFromY, ax, ay) * M_PI / 180.0f;
+    if (asize > SMALL_ASTEROID_SIZE) {
+        // large splits into medium, medium into small
+        bool large = asize > MEDIUM_ASTEROID_SIZE;
+        float fragSize = large ? MEDIUM_ASTEROID_SIZE : SMALL_ASTEROID_SIZE;
+        int fragHp = large ? MEDIUM_ASTEROID_HP : SMALL_ASTEROID_HP;
+        int count = RandomInt(2, 3);
+        if (recorder) recorder->Event(turn, ASTRO_EV_ASTEROID_BROKEN, asteroidIdx, count);
         for (int i = 0; i < count; ++i) {
-            Asteroid newAst;
-            newAst.x = a.x; newAst.y = a.y;
-            float angle = angleDist(rng);
-            float speed = speedDist(rng);
+            float angle = RandomFloat(0, 2.0f * M_PI);
+            float speed = RandomFloat(0.5f, ASTEROID_MAX_SPEED);
             if (hasPush) {
                 float angleOffset = (float)(i - count / 2) * 0.8f;
                 angle = pushAngle + angleOffset;
                 speed += pushSpeed;
             }
-            newAst.vx = a.vx + std::cos(angle) * speed;
-            newAst.vy = a.vy + std::sin(angle) * speed;
-            newAst.size = SMALL_ASTEROID_SIZE;
-            newAst.hp = SMALL_ASTEROID_HP;
-            newAst.alive = true;
-            newAst.GenerateShape(6, SMALL_ASTEROID_SIZE);
-            asteroids.push_back(newAst);
+            float sn, cs;
+            SinCos(angle, sn, cs);
+            asteroids.Add(ax, ay, avx + cs * speed, avy + sn * speed, fragSize, fragHp, PickShape(fragSize));
         }
     } else {
+        if (recorder) recorder->Event(turn, ASTRO_EV_ASTEROID_BROKEN, asteroidIdx, 0);
         for (auto& s : ships) {
             if (!s.alive) continue;
-            if (Distance(s.x, s.y, a.x, a.y) < 50.0f) {
+            if (Distance(s.x, s.y, ax, ay) < 50.0f) {
                 s.fuel += FUEL_PICKUP_AMOUNT;
                 if (s.fuel > ASTRO_START_FUEL) s.fuel = ASTRO_START_FUEL;
-                if (log) {
-                    std::string name = s.ship ? s.ship->name : "Ship";
-                    log(name + " collects fuel!");
-                }
+                Log(ASTRO_LOG_FUEL_PICKUP, (int)(&s - ships.data()));
                 break;
             }
         }
@@ -706,83 +1145,66 @@ void AstroArena::BreakAsteroid(int asteroidIdx, float pushFromX, float pushFromY
 }
 
 void AstroArena::SpawnAsteroids(int count) {
-    std::uniform_real_distribution<float> xDist(100.0f, ASTROBOTS_W - 100.0f);
-    std::uniform_real_distribution<float> yDist(100.0f, ASTROBOTS_H - 100.0f);
-    std::uniform_real_distribution<float> angleDist(0, 2.0f * M_PI);
-    std::uniform_real_distribution<float> speedDist(0.3f, ASTEROID_MAX_SPEED);
+    worldEpoch++;
+    if (recorder) recorder->Event(turn, ASTRO_EV_ASTEROID_SPAWNED, count);
     for (int i = 0; i < count; ++i) {
-        Asteroid a;
-        a.x = xDist(rng);
-        a.y = yDist(rng);
-        float angle = angleDist(rng);
-        float speed = speedDist(rng);
-        a.vx = std::cos(angle) * speed;
-        a.vy = std::sin(angle) * speed;
-        a.size = LARGE_ASTEROID_SIZE;
-        a.hp = LARGE_ASTEROID_HP;
-        a.alive = true;
-        a.GenerateShape(8, LARGE_ASTEROID_SIZE);
-        asteroids.push_back(a);
+        float x = RandomFloat(100.0f, config.width - 100.0f);
+        float y = RandomFloat(100.0f, config.height - 100.0f);
+        float angle = RandomFloat(0, 2.0f * M_PI);
+        float speed = RandomFloat(0.3f, ASTEROID_MAX_SPEED);
+        float sn, cs;
+        SinCos(angle, sn, cs);
+        asteroids.Add(x, y, cs * speed, sn * speed, LARGE_ASTEROID_SIZE, LARGE_ASTEROID_HP, PickShape(LARGE_ASTEROID_SIZE));
     }
 }
 
 void AstroArena::SpawnAsteroidFromEdge() {
-    std::uniform_int_distribution<int> edgeDist(0, 3);
-    std::uniform_real_distribution<float> alongX(0.0f, ASTROBOTS_W);
-    std::uniform_real_distribution<float> alongY(0.0f, ASTROBOTS_H);
-    std::uniform_real_distribution<float> angleJitter(-M_PI/12.0f, M_PI/12.0f);
-    std::uniform_real_distribution<float> speedDist(0.4f, ASTEROID_MAX_SPEED);
-    Asteroid a;
-    int edge = edgeDist(rng);
+    worldEpoch++;
+    if (recorder) recorder->Event(turn, ASTRO_EV_ASTEROID_SPAWNED, 1);
+    float x, y;
+    int edge = RandomInt(0, 3);
     float inset = 8.0f;
-    float cx = ASTROBOTS_W * 0.5f;
-    float cy = ASTROBOTS_H * 0.5f;
-    if (edge == 0) { a.x = alongX(rng); a.y = inset; }
-    else if (edge == 1) { a.x = ASTROBOTS_W - inset; a.y = alongY(rng); }
-    else if (edge == 2) { a.x = alongX(rng); a.y = ASTROBOTS_H - inset; }
-    else { a.x = inset; a.y = alongY(rng); }
-    float baseAngle = AngleTo(a.x, a.y, cx, cy) * (float)(M_PI / 180.0f);
-    float angle = baseAngle + angleJitter(rng);
-    float speed = speedDist(rng);
-    a.vx = std::cos(angle) * speed;
-    a.vy = std::sin(angle) * speed;
-    a.size = LARGE_ASTEROID_SIZE;
-    a.hp = LARGE_ASTEROID_HP;
-    a.alive = true;
-    a.GenerateShape(8, LARGE_ASTEROID_SIZE);
-    asteroids.push_back(a);
+    float cx = config.width * 0.5f;
+    float cy = config.height * 0.5f;
+    if (edge == 0) { x = RandomFloat(0.0f, config.width); y = inset; }
+    else if (edge == 1) { x = config.width - inset; y = RandomFloat(0.0f, config.height); }
+    else if (edge == 2) { x = RandomFloat(0.0f, config.width); y = config.height - inset; }
+    else { x = inset; y = RandomFloat(0.0f, config.height); }
+    float baseAngle = AngleTo(x, y, cx, cy) * (float)(M_PI / 180.0f);
+    float angle = baseAngle + RandomFloat(-M_PI/12.0f, M_PI/12.0f);
+    float speed = RandomFloat(0.4f, ASTEROID_MAX_SPEED);
+    float sn, cs;
+    SinCos(angle, sn, cs);
+    asteroids.Add(x, y, cs * speed, sn * speed, LARGE_ASTEROID_SIZE, LARGE_ASTEROID_HP, PickShape(LARGE_ASTEROID_SIZE));
 }
 
 void AstroArena::SpawnParticleBurst(float x, float y, int count, ImU32 baseColor, float speedScale, float lifeScale, float particleLength) {
+    if (!visualEffects) return;
     std::uniform_real_distribution<float> ang(0.0f, 2.0f * (float)M_PI);
     std::uniform_real_distribution<float> spd(PARTICLE_MIN_SPEED, PARTICLE_MAX_SPEED);
     std::uniform_int_distribution<int> life(PARTICLE_DEFAULT_LIFETIME - 15, PARTICLE_DEFAULT_LIFETIME + 15);
     std::uniform_real_distribution<float> lenDist(0.7f, 1.3f);
     std::uniform_int_distribution<int> colorJitter(-40, 40);
     for (int i = 0; i < count; ++i) {
-        float a = ang(rng);
-        float s = spd(rng) * speedScale;
-        Particle p;
-        p.x = x; p.y = y;
-        p.vx = std::cos(a) * s;
-        p.vy = std::sin(a) * s;
-        p.lifetime = std::max(10, (int)(life(rng) * lifeScale));
-        p.startLifetime = p.lifetime;
-        p.length = particleLength * lenDist(rng);
+        float a = ang(effectsRng);
+        float s = spd(effectsRng) * speedScale;
+        int lifetime = std::max(10, (int)(life(effectsRng) * lifeScale));
+        float length = particleLength * lenDist(effectsRng);
         int r = (int)((baseColor >> IM_COL32_R_SHIFT) & 0xFF);
         int g = (int)((baseColor >> IM_COL32_G_SHIFT) & 0xFF);
         int b = (int)((baseColor >> IM_COL32_B_SHIFT) & 0xFF);
-        r = std::min(255, std::max(0, r + colorJitter(rng)));
-        g = std::min(255, std::max(0, g + colorJitter(rng)));
-        b = std::min(255, std::max(0, b + colorJitter(rng)));
-        p.color = IM_COL32(r, g, b, 255);
-        p.alive = true;
-        particles.push_back(p);
+        r = std::min(255, std::max(0, r + colorJitter(effectsRng)));
+        g = std::min(255, std::max(0, g + colorJitter(effectsRng)));
+        b = std::min(255, std::max(0, b + colorJitter(effectsRng)));
+        particles.Add(x, y, AstroCos(a) * s, AstroSin(a) * s, lifetime, length, IM_COL32(r, g, b, 255));
     }
 }
 
 void AstroArena::StartTurn() {
+    // last turn's signals are this turn's to hear
+    heardSignals.swap(signals);
     signals.clear();
+    signalBins.Build(*this);
     for (auto& s : ships) {
         if (!s.alive) continue;
         if (s.phaser_cooldown > 0) --s.phaser_cooldown;
@@ -792,4 +1214,321 @@ void AstroArena::StartTurn() {
     }
 }
 
+// ===== Match lifecycle =====
+AstroArena::AstroArena() = default;
+AstroArena::~AstroArena() = default;
+
+void AstroArena::Reset() {
+    ships.clear();
+    programs.clear();
+    torpedoes.clear();
+    phaserBeams.clear();
+    particles.clear();
+    asteroids.clear();
+    shipDebris.clear();
+    signals.clear();
+    heardSignals.clear();
+    edgeSpawnCooldown = 0;
+    turn = 0;
+    quietTurns = 0;
+    worldEpoch++;
+}
+
+void AstroArena::Setup(std::vector<std::unique_ptr<ShipBase>> roster, uint32_t matchSeed) {
+    Reset();
+    if (!config.FitsFixedPoint()) {
+        // past the grid AstroToFixed() would overflow
+        config.width = std::min(ASTRO_FIXED_MAX_EXTENT, config.width);
+        config.height = std::min(ASTRO_FIXED_MAX_EXTENT, config.height);
+    }
+    seed = matchSeed;
+    rng.seed(seed);
+    effectsRng.seed(seed ^ 0x45464658u);
+    programs = std::move(roster);
+    ships.resize(programs.size());
+    vmCounters.assign(programs.size(), AstroVmCounters{});
+    Reserve();
+
+    // Compile scripts & inject arena refs
+    for (size_t i = 0; i < programs.size(); ++i) {
+        int cost = programs[i]->SetupShip();
+        // AstroFormatLog highlights a cost over the limit and a rejected program
+        Log(ASTRO_LOG_SCRIPT_COST, (int)i, 0, cost);
+        ships[i].ship = programs[i].get();
+        programs[i]->A = this;
+        programs[i]->id = (int)i;
+    }
+    // ships running the same program are a team: each hears the others' signals
+    std::unordered_map<std::string, int> teams;
+    for (size_t i = 0; i < programs.size(); ++i) {
+        ships[i].team = teams.emplace(programs[i]->name, (int)i).first->second;
+    }
+
+    // Spawn ships in a circle around the center, wide enough that big rosters don't start
+    // on top of each other (within the world)
+    float centerX = config.width / 2.0f;
+    float centerY = config.height / 2.0f;
+    float spawnRadius = std::max(300.0f, (float)ships.size() * SHIP_DRAW_SIZE * 1.5f / (2.0f * (float)M_PI));
+    spawnRadius = std::min(spawnRadius, 0.45f * std::min(config.width, config.height));
+    for (size_t i = 0; i < ships.size(); ++i) {
+        float angle = (float)i / ships.size() * 2.0f * M_PI;
+        float sn, cs;
+        SinCos(angle, sn, cs);
+        ships[i].x = centerX + cs * spawnRadius;
+        ships[i].y = centerY + sn * spawnRadius;
+        ships[i].angle = angle * 180.0f / M_PI;
+        ships[i].targetAngle = ships[i].angle;
+        ships[i].vx = 0;
+        ships[i].vy = 0;
+    }
+
+    SpawnAsteroids(config.asteroids);
+}
+
+void AstroArena::Reserve() {
+    broadphase = AstroMakeBroadphase(config, ships.size());
+    if (particles.Capacity() != (size_t)config.maxParticles) particles.SetCapacity(config.maxParticles);
+    const size_t n = ships.size();
+    // a ship has at most PHOTON_LIFETIME / PHOTON_COOLDOWN + 1 torpedoes in flight; a large
+    // asteroid breaks into at most four small ones, and edge spawns only refill the count
+    torpedoes.reserve(n * (PHOTON_LIFETIME / PHOTON_COOLDOWN + 1));
+    phaserBeams.reserve(n);
+    scanCache.assign(n, ScanCache{});
+    pairCache.assign(n * PAIR_CACHE_WAYS, PairCacheEntry{});
+    signals.reserve(n);
+    heardSignals.reserve(n);
+    signalBins.SetCellSize(config.CellSizeFor(n));
+    shipDebris.reserve(config.maxShipDebris);
+    asteroids.reserve(4 * (size_t)config.asteroids);
+    asteroidBounds.reserve(4 * (size_t)config.asteroids);
+    shipCapsules.reserve(n);
+    shipBounds.reserve(n);
+}
+
+bool AstroArenaConfig::FitsFixedPoint() const {
+    return !fixedPoint || (width <= ASTRO_FIXED_MAX_EXTENT && height <= ASTRO_FIXED_MAX_EXTENT);
+}
+
+int AstroArenaConfig::CellSizeFor(size_t shipCount) const {
+    if (cellSize > 0) return cellSize;
+    int cell = 1;
+    while ((float)cell < LARGE_ASTEROID_SIZE * ASTEROID_MAX_RADIUS_SCALE) cell *= 2;
+    const double entities = std::max(1.0, (double)shipCount + (double)asteroids);
+    auto cellsAt = [&](int size) {
+        return std::ceil(width / (float)size) * (double)std::ceil(height / (float)size);
+    };
+    // stop while the grid is still at least 3 cells wide, so 3x3 blocks don't overlap themselves
+    while (cellsAt(cell) > ASTRO_GRID_CELLS_PER_ENTITY * entities &&
+           std::min(width, height) >= 3.0f * (float)(2 * cell)) {
+        cell *= 2;
+    }
+    return cell;
+}
+
+int AstroArena::AliveCount() const {
+    int alive = 0;
+    for (const auto& s : ships) {
+        if (s.alive) alive++;
+    }
+    return alive;
+}
+
+void AstroArena::RunProgramsSimultaneous() {
+    // Programs only touch their own ShipState and their own intent queue; everything else
+    // they look at (positions, the broadphase, shapes) holds still until the resolve pass.
+    EnsureBroadphase();
+    intents.resize(ships.size());
+    for (auto& queue : intents) queue.clear();
+    deferActions = true;
+    auto runShips = [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (ships[i].alive) programs[i]->Run(turn);
+        }
+    };
+    int workers = vmPool ? std::min(vmPool->ThreadCount(), (int)ships.size()) : 1;
+    if (workers > 1) {
+        size_t chunk = (ships.size() + workers - 1) / workers;
+        for (size_t begin = 0; begin < ships.size(); begin += chunk) {
+            size_t end = std::min(ships.size(), begin + chunk);
+            vmPool->Submit([&runShips, begin, end] { runShips(begin, end); });
+        }
+        vmPool->Wait();
+    } else {
+        runShips(0, ships.size());
+    }
+    deferActions = false;
+
+    for (size_t i = 0; i < ships.size(); ++i) {
+        for (const ShipIntent& intent : intents[i]) {
+            switch (intent.kind) {
+                case ShipIntent::PHASER: ResolvePhaser((int)i, intent.phaser); break;
+                case ShipIntent::PHOTON: LaunchPhoton((int)i); break;
+                case ShipIntent::SIGNAL: signals.push_back({ ships[i].x, ships[i].y, (int)i, intent.value }); break;
+            }
+        }
+    }
+}
+
+bool AstroArena::Step() {
+    if (IsOver()) return false;
+    ASTRO_PROFILE_SCOPE(profiler, ASTRO_PHASE_TURN);
+    BeginStep();
+    MoveShips();
+    FinishStep();
+    return true;
+}
+
+bool AstroArena::BeginStep() {
+    if (IsOver()) return false;
+    turn++;
+    if (config.stalemateTurns > 0) turnStartHp = LiveShipHp();
+
+    // Start turn (reset cooldowns, etc.)
+    {
+        ASTRO_PROFILE_SCOPE(profiler, ASTRO_PHASE_START_TURN);
+        StartTurn();
+    }
+
+    // Each alive ship takes a turn
+    ASTRO_PROFILE_SCOPE(profiler, ASTRO_PHASE_PROGRAMS);
+    if (simultaneous) {
+        RunProgramsSimultaneous();
+    } else {
+        for (size_t i = 0; i < ships.size(); ++i) {
+            if (!ships[i].alive) continue;
+            programs[i]->Run(turn);
+        }
+    }
+    return true;
+}
+
+void AstroArena::FinishStep() {
+    MoveWorld();
+    {
+        ASTRO_PROFILE_SCOPE(profiler, ASTRO_PHASE_COLLISIONS);
+        HandleCollisions();
+    }
+    {
+        ASTRO_PROFILE_SCOPE(profiler, ASTRO_PHASE_TORPEDOES);
+        HandleTorpedoes();
+    }
 
+    {
+        ASTRO_PROFILE_SCOPE(profiler, ASTRO_PHASE_COMPACT);
+        // After handling torpedo collisions based on unwrapped motion, wrap torpedoes
+        for (auto& t : torpedoes) {
+            if (t.alive) {
+                WrapPosition(t.x, t.y);
+            }
+        }
+
+        // Clean up dead torpedoes, asteroids, and phaser beams
+        torpedoes.RemoveDead();
+        size_t asteroidCount = asteroids.size();
+        asteroids.RemoveDead();
+        if (asteroids.size() != asteroidCount) worldEpoch++; // indices shifted, the broadphase is stale
+        phaserBeams.RemoveDead();
+    }
+
+    // Maintain asteroid population by spawning from edges with a cooldown
+    ASTRO_PROFILE_SCOPE(profiler, ASTRO_PHASE_SPAWN);
+    if (edgeSpawnCooldown > 0) {
+        edgeSpawnCooldown--;
+    }
+    if (asteroids.size() < (size_t)config.asteroids && edgeSpawnCooldown == 0) {
+        SpawnAsteroidFromEdge();
+        edgeSpawnCooldown = 60; // spawn at most every ~2 seconds (at 30Hz)
+    }
+    UpdateStalemate();
+    if (recorder) recorder->EndTurn(*this);
+}
+
+int AstroArena::LiveShipHp() const {
+    int hp = 0;
+    for (const auto& s : ships) {
+        if (s.alive) hp += s.hp;
+    }
+    return hp;
+}
+
+void AstroArena::UpdateStalemate() {
+    if (config.stalemateTurns <= 0) return;
+    if (LiveShipHp() != turnStartHp || ShipsInScanRange()) {
+        quietTurns = 0;
+    } else if (++quietTurns == config.stalemateTurns) {
+        Log(ASTRO_LOG_STALEMATE, AliveCount(), 0, quietTurns);
+    }
+}
+
+bool AstroArena::ShipsInScanRange() {
+    const float rangeSq = ASTRO_SCAN_RANGE * ASTRO_SCAN_RANGE;
+    auto inRange = [&](const ShipState& a, const ShipState& b) {
+        float dx = WrapDelta(b.x - a.x, config.width);
+        float dy = WrapDelta(b.y - a.y, config.height);
+        return dx * dx + dy * dy < rangeSq;
+    };
+    // a handful of ships: every pair is cheaper than a broadphase the programs may not need
+    if (ships.size() <= ASTRO_STALEMATE_PAIRWISE_SHIPS) {
+        for (size_t i = 0; i < ships.size(); ++i) {
+            if (!ships[i].alive) continue;
+            for (size_t j = i + 1; j < ships.size(); ++j) {
+                if (ships[j].alive && inRange(ships[i], ships[j])) return true;
+            }
+        }
+        return false;
+    }
+    // the broadphase built here is the one next turn's programs scan against: nothing
+    // moves between the end of this turn and them
+    EnsureBroadphase();
+    bool found = false;
+    size_t self = 0;
+    auto visit = [&](AstroBodyKind kind, int i) {
+        if (found || kind != ASTRO_BODY_SHIP || (size_t)i == self || !ships[i].alive) return;
+        found = inRange(ships[self], ships[i]);
+    };
+    for (self = 0; self < ships.size() && !found; ++self) {
+        const ShipState& s = ships[self];
+        if (!s.alive) continue;
+        c2AABB box;
+        box.min = c2V(s.x - ASTRO_SCAN_RANGE, s.y - ASTRO_SCAN_RANGE);
+        box.max = c2V(s.x + ASTRO_SCAN_RANGE, s.y + ASTRO_SCAN_RANGE);
+        broadphase->VisitCentres(box, visit);
+    }
+    return found;
+}
+
+namespace {
+struct Fnv1a {
+    uint64_t h = 1469598103934665603ull;
+    template <typename T> void Add(const T& v) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&v);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    }
+};
+}
+
+uint64_t AstroArena::Checksum() const {
+    // gameplay state only: visual effects (particles, debris, beams) are left out
+    Fnv1a f;
+    f.Add(turn);
+    f.Add(edgeSpawnCooldown);
+    for (const auto& s : ships) {
+        f.Add(s.x); f.Add(s.y); f.Add(s.vx); f.Add(s.vy);
+        f.Add(s.angle); f.Add(s.targetAngle); f.Add(s.hp); f.Add(s.fuel); f.Add(s.alive);
+        f.Add(s.phaser_cooldown); f.Add(s.photon_cooldown);
+    }
+    for (size_t i = 0; i < asteroids.size(); ++i) {
+        f.Add(asteroids.x[i]); f.Add(asteroids.y[i]); f.Add(asteroids.vx[i]); f.Add(asteroids.vy[i]);
+        f.Add(asteroids.hp[i]); f.Add((bool)asteroids.alive[i]);
+    }
+    for (const auto& t : torpedoes) {
+        f.Add(t.x); f.Add(t.y); f.Add(t.vx); f.Add(t.vy); f.Add(t.lifetime); f.Add(t.owner); f.Add(t.alive);
+    }
+    // the generator state captures every draw made so far
+    std::mt19937 copy = rng;
+    f.Add(copy());
+    return f.h;
+}
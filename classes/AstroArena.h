@@ -1,14 +1,27 @@
 #pragma once
 
 struct ShipBase;
+class AstroReplayRecorder;
+class AstroThreadPool;
+class AstroProfiler;
 
 #include <vector>
 #include <string>
 #include <functional>
+#include <memory>
+#include <array>
+#include <cmath>
 
 #include "AstroTypes.h"
+#include "AstroLog.h"
+#include "AstroBytecode.h"
+#include "AstroBroadphase.h"
+#include "AstroFixed.h"
 
 struct AstroArena {
+    AstroArena();
+    ~AstroArena();
+
     struct ShipState {
         float x = 0, y = 0;
         float vx = 0, vy = 0;
@@ -19,10 +32,15 @@ struct AstroArena {
         bool alive = true;
         ShipBase* ship = nullptr;
 
-        // scan results
-        float scan_dist = 0;      // 0 means nothing seen
-        float scan_angle = 0;     // angle to scanned object
+        // scan results: the torus offset to the object found (0, 0 if none) and its
+        // square; the distance and direction are only worked out when something reads them
+        float scan_dx = 0, scan_dy = 0;
+        float scan_distSq = 0;    // 0 before the first scan, ASTRO_SCAN_RANGE^2 when nothing was seen
         bool scan_hit = false;
+        uint32_t scanEpoch = 0;   // worldEpoch when the scan above ran
+
+        float ScanDist() const { return std::sqrt(scan_distSq); }
+        float ScanAngle() const;  // degrees 0-360 towards the scanned object, 0 if none
 
         // weapon cooldowns
         int phaser_cooldown = 0;
@@ -30,63 +48,272 @@ struct AstroArena {
 
         // signal
         int signal = -1;
+        int team = 0;           // first ship running the same program (by name); a team are allies
+        // The nearest ally signal heard this turn (Hear()), looked up the first time the
+        // program asks and kept for the rest of the turn
+        int heardTurn = -1;     // turn the fields below hold for
+        int heard = -1;         // heardSignals row, -1 if no ally signaled within ASTRO_SIGNAL_RANGE
+        float heard_dx = 0, heard_dy = 0; // torus offset to where it was sent from
+        float heard_distSq = 0;
+
+        // match statistics
+        int damageDealt = 0;    // hp removed from other ships by this ship's weapons
+        int deathTurn = 0;      // turn the ship was destroyed on, 0 while alive
+        int killedBy = -1;      // ship whose weapon destroyed this one, -1 if alive or it hit an asteroid
 
         ImU32 color; // ship color
     };
 
     std::vector<ShipState> ships;
-    std::vector<PhotonTorpedo> torpedoes;
-    std::vector<PhaserBeam> phaserBeams;
-    std::vector<Particle> particles;
-    std::vector<Asteroid> asteroids;
-    std::vector<ShipDebrisSegment> shipDebris;
-    std::vector<std::pair<float,float>> signals; // positions
-    std::function<void(const std::string&)> log;
-
-    // Rendering scale (screen pixels per world unit), set by renderer each frame
+    std::vector<std::unique_ptr<ShipBase>> programs; // ship programs, programs[i] drives ships[i]
+    // rows of these three shift down at the end of every turn; hold an AstroHandle
+    // (AstroTypes.h) rather than an index to keep track of one across turns
+    AstroEntityPool<PhotonTorpedo, ASTRO_MEM_TORPEDOES> torpedoes;
+    AstroEntityPool<PhaserBeam, ASTRO_MEM_BEAMS> phaserBeams;
+    AsteroidPool asteroids;
+    ParticlePool particles;
+    AstroVector<ShipDebrisSegment, ASTRO_MEM_DEBRIS> shipDebris;
+    // ===== Signals =====
+    // SIGNAL(v) records where the ship was and v. Programs hear the signals of the turn
+    // before: StartTurn() moves signals into heardSignals and bins them (signalBins), so
+    // what a ship hears doesn't depend on the order ships run in, and a ship listening
+    // reads the cells around it rather than every signal sent.
+    struct SignalRecord {
+        float x = 0, y = 0;
+        int ship = -1;
+        int value = 0;
+    };
+    AstroVector<SignalRecord, ASTRO_MEM_SIGNALS> signals;      // sent this turn
+    AstroVector<SignalRecord, ASTRO_MEM_SIGNALS> heardSignals; // sent last turn
+    AstroSignalBins signalBins;                                // heardSignals by position
+    AstroLogRing* eventLog = nullptr; // optional: typed log entries, formatted by whoever reads them
+    AstroReplayRecorder* recorder = nullptr; // optional: gets fires, hits, kills and spawns (AstroReplay.h)
+    AstroProfiler* profiler = nullptr; // optional: per-phase turn timings (AstroProfile.h)
+    // opt-in runtime cost of each program: with countVm set, vmCounters[i] (reset by
+    // Setup()) sums what programs[i] executed over the match
+    bool countVm = false;
+    std::vector<AstroVmCounters> vmCounters;
+    // run programs compiled into the build (ShipBase::native) rather than interpreting
+    // them; same results either way
+    bool nativePrograms = true;
+    // Spawn the visual effects: particle bursts, ship debris, phaser beams and the torpedo
+    // pulse phase. They exist only for someone watching, so headless runs leave this off
+    // and skip the work; the viewer turns it on. Effects draw from effectsRng, never rng,
+    // so a match plays out the same either way.
+    bool visualEffects = false;
+
+    // World size, entity caps and broadphase, set before Setup() and left alone until the
+    // next one; like the rule below, except the broadphase, which only changes speed (AstroTypes.h)
+    AstroArenaConfig config;
+
+    // ===== Simultaneous turns =====
+    // A rule of the match, set before Setup() (snapshots and replays carry it). Off, ships
+    // act in index order and each sees what the ones before it did. On, every program runs
+    // against the world as it stood at the start of the turn: a program still moves its own
+    // ship and scans straight away, but phaser shots, torpedo launches and signals are
+    // queued per ship and resolved after all programs have run, in ship order. A ship
+    // destroyed while resolving still gets its own queued shots.
+    bool simultaneous = false;
+    // optional, simultaneous turns only: runs the programs on these workers. Results don't
+    // depend on it. Don't pass a pool whose workers are the ones calling Step().
+    AstroThreadPool* vmPool = nullptr;
+
+    // Rendering scale (screen pixels per world unit), set by renderer each frame; sizes
+    // the debris of a destroyed ship, so only matters with visualEffects
     float renderScale = 1.0f;
-    // Broad-phase uniform grid (Phase 2)
-    int gridCellSize = 128;
-    int gridCols = 0;
-    int gridRows = 0;
-    std::vector<std::vector<int>> gridAsteroids; // per-cell asteroid indices
-    std::vector<std::vector<int>> gridShips;     // per-cell ship indices
+    // Broadphase over ships and asteroids (AstroBroadphase.h), made by Reserve() from
+    // config.broadphase
+    std::unique_ptr<AstroBroadphase> broadphase;
+    // Shapes as of broadphaseEpoch, rebuilt with the broadphase: nothing moves or turns
+    // without bumping worldEpoch, so these are current whenever the broadphase is.
+    std::vector<c2Capsule> shipCapsules;         // per ship, unwrapped position
+    std::vector<c2AABB> shipBounds;              // per ship, around its capsule
+    std::vector<c2AABB> asteroidBounds;          // per asteroid, world space around its poly
+    std::vector<float> shipTrig;                 // scratch for RebuildBroadphase: headings, sines, cosines
+    uint32_t broadphaseEpoch = 0;                // worldEpoch the broadphase was built at
+    // Per ship, what its scans found at scanCache[i].epoch. One broadphase walk answers
+    // SCAN, SCAN_SHIPS and SCAN_ASTEROIDS together as far as it went, and a scan it didn't
+    // settle picks the walk up where it stopped, so a program that scans several ways
+    // walks once per world state.
+    struct ScanResult {
+        float dx = 0, dy = 0; // torus offset from the scanning ship
+        float distSq = 0;
+        int index = -1;       // ship, asteroid or torpedo row, -1 if nothing in range
+    };
+    struct ScanCache {
+        uint32_t epoch = 0;        // worldEpoch the entries below hold for
+        uint32_t torpedoCount = 0; // torpedoes.size() the torpedo entry was found at
+        uint8_t valid = 0;         // bit per AstroScanFilter
+        ScanResult found[ASTRO_SCAN_FILTER_COUNT];
+        float walked = 0;          // half width of the last box the walk visited, 0 = not started
+        ScanResult nearest[2];     // nearest ship and asteroid within that box
+    };
+    std::vector<ScanCache> scanCache;
+    void ScanBodies(int self, AstroScanFilter filter, ScanCache& cache);
+    void ScanTorpedoes(int self, ScanCache& cache);
+    AstroBroadphaseHits broadphaseHits;          // scratch for HandleCollisions / HandleTorpedoes
+    // Per ship, PAIR_CACHE_WAYS slots of what HandleCollisions' narrowphase last found
+    // against an asteroid: the gap between them and where both were. No point of either
+    // has moved further than its capsule ends or its centre since, so while those moves
+    // add up to less than the gap and the same torus copies are in reach, the pair is
+    // still apart and its GJK is skipped. A wrap or a turn is just a longer move, and an
+    // asteroid broken or restored from a snapshot has a new handle.
+    struct PairCacheEntry {
+        AstroHandle asteroid;     // none for an empty slot
+        int turn = 0;             // last tested or skipped, for picking a slot to reuse
+        uint16_t copies = 0;      // bit per torus copy tested
+        float gap = 0.0f;
+        c2v shipA{}, shipB{};     // capsule ends
+        float x = 0.0f, y = 0.0f; // asteroid
+    };
+    static constexpr int PAIR_CACHE_WAYS = 8;
+    std::vector<PairCacheEntry> pairCache; // PAIR_CACHE_WAYS per ship
+    PairCacheEntry& PairCacheSlot(size_t ship, AstroHandle asteroid);
+    // GJK calls HandleCollisions made and skipped, over the arena's life
+    uint64_t narrowphaseTests = 0, narrowphaseSkips = 0;
+    // Torpedo-ship and torpedo-asteroid pairs worth a c2TOI this turn, one per torus copy:
+    // torpedo k owns torpedoCandidates[torpedoCandidateStart[k] .. torpedoCandidateStart[k + 1])
+    struct TorpedoCandidate {
+        int index;
+        AstroBodyKind kind;
+        int8_t ox, oy; // whole-world offset of the copy
+    };
+    std::vector<TorpedoCandidate> torpedoCandidates;
+    std::vector<int> torpedoCandidateStart;
     void RebuildBroadphase();
-    inline int CellIndex(int cx, int cy) const {
-        if (gridCols <= 0 || gridRows <= 0) return -1;
-        int x = ((cx % gridCols) + gridCols) % gridCols;
-        int y = ((cy % gridRows) + gridRows) % gridRows;
-        return y * gridCols + x;
-    }
-    inline void PosToCell(float x, float y, int& cx, int& cy) const {
-        cx = (int)std::floor(x / (float)gridCellSize);
-        cy = (int)std::floor(y / (float)gridCellSize);
-    }
-    void CollectNearCells(int cx, int cy, std::vector<int>& outCellIdx) const;
+    // Rebuilds only if something the broadphase indexes changed since the last build.
+    void EnsureBroadphase() { if (broadphaseEpoch != worldEpoch) RebuildBroadphase(); }
+    // where a phaser shot from a ship lands, against the current world
+    struct PhaserTrace {
+        int hitShip = -1;
+        int hitAsteroid = -1;
+        float hitX = 0, hitY = 0;
+    };
+    struct ShipIntent {
+        enum Kind : uint8_t { PHASER, PHOTON, SIGNAL } kind;
+        PhaserTrace phaser; // PHASER: traced when the program fired
+        int value = 0;      // SIGNAL
+    };
+    std::vector<std::vector<ShipIntent>> intents; // per ship, queued this turn
+    bool deferActions = false;                    // set while programs run in a simultaneous turn
+    void RunProgramsSimultaneous();
+    PhaserTrace TracePhaser(int self) const;
+    void ResolvePhaser(int self, PhaserTrace trace);
+    void LaunchPhoton(int self);
+
     // world queries & actions
-    void UpdatePhysics();
+    void UpdatePhysics(); // MoveShips() then MoveWorld()
+    void MoveWorld();     // asteroids, torpedoes, beams and effects
     void WrapPosition(float& x, float& y);
+    // config.fixedPoint: a wrapped grid coordinate back in the float fields
+    static float FixedCoord(AstroFixed v, float extent);
+    void MoveShipsFixed();
+    void ThrustFixed(ShipState& s, float effectivePower);
+    // The trig play depends on: the build's (AstroMath.h), except that a config.fixedPoint
+    // arena always takes the polynomials, which give the same bits on every platform,
+    // whatever ASTRO_FAST_TRIG says. Drawing and effects keep the build's.
+    void SinCos(float rad, float& s, float& c) const;
+    float Atan2(float y, float x) const;
+    float AngleTo(float x1, float y1, float x2, float y2) const; // degrees from (x1, y1) towards (x2, y2)
     void Thrust(int self, float power);
     void TurnDeg(int self, int degrees);
     void FirePhaser(int self);
     void FirePhoton(int self);
-    void Scan(int self);
+    // Nearest object of the filter's kind within ASTRO_SCAN_RANGE, into the ship's scan_*
+    // fields. Returns false when scanCache already had the answer.
+    bool Scan(int self, AstroScanFilter filter = ASTRO_SCAN_ANY);
     void Signal(int self, int value);
     void TurnToScan(int self);
+    // The nearest signal from another ship of the same team in heardSignals, within
+    // ASTRO_SIGNAL_RANGE (ties to the earlier signal); nullptr if there is none. Only
+    // writes the ship's own heard* fields, so programs may call it from several threads.
+    const SignalRecord* Hear(int self);
+    bool HeardWithin(int self, float range) { return Hear(self) && ships[self].heard_distSq <= range * range; }
+    bool HeardValue(int self, int value) { const SignalRecord* h = Hear(self); return h && h->value == value; }
+    void TurnToSignal(int self);
 
     // collision detection
     bool CircleCollision(float x1, float y1, float r1, float x2, float y2, float r2);
     void HandleCollisions();
     void HandleTorpedoes();
-    void KillShip(ShipState& s, const std::string& message);
+    // First half of HandleTorpedoes(), before any torpedo hits: each live torpedo's swept
+    // box against the broadphase, keeping the torus copies of ships and asteroids whose
+    // bounds it touches in torpedoCandidates. The second half runs c2TOI on those alone.
+    void SweepTorpedoes();
+    // killer = ship whose weapon did it, -1 for an asteroid collision
+    void KillShip(ShipState& s, int killer);
+    void Log(AstroLogType type, int a, int b = 0, int value = 0) {
+        if (eventLog) eventLog->Push({ turn, type, a, b, value });
+    }
     void BreakAsteroid(int asteroidIdx, float pushFromX = -1, float pushFromY = -1);
 
     void StartTurn();
     void SpawnAsteroids(int count);
     void SpawnAsteroidFromEdge(); // spawn a large asteroid just inside an edge moving inward
+    // visual effects: both do nothing unless visualEffects is set
     void SpawnParticleBurst(float x, float y, int count, ImU32 baseColor, float speedScale = 1.0f, float lifeScale = 1.0f, float particleLength = PARTICLE_LENGTH);
+    void SpawnShipDebris(const ShipState& s); // the hull outline breaking up
 
     int edgeSpawnCooldown = 0; // turns until next edge spawn allowed
+    // bumped whenever anything Scan() looks at changes (positions, ships dying, asteroids breaking/spawning)
+    uint32_t worldEpoch = 1;
+
+    // Every random draw that affects play comes from this generator, so (seed, roster) fully
+    // determines the match and separate arenas can run on separate threads.
+    std::mt19937 rng;
+    // Uniform draws from rng. The std distributions are free to map the generator's output
+    // differently from one standard library to the next (MSVC's and libstdc++'s integer
+    // ones do), so a config.fixedPoint arena maps it itself; the others keep the std ones
+    // their seeds have always played with.
+    float RandomFloat(float lo, float hi);
+    int RandomInt(int lo, int hi);
+    uint16_t PickShape(float sz); // AsteroidShapeLibrary::Pick() of a random variant
+    // ...and every visual effect's from this one, seeded from the same seed by Setup()
+    // but not part of snapshots or Checksum()
+    std::mt19937 effectsRng;
+    uint32_t seed = 0;
+
+    // ===== Match lifecycle (pure simulation: no ImGui, Game or ClassGame dependency) =====
+    int turn = 0; // turns completed so far
+    // Takes ownership of the roster, seeds the RNG, compiles each program, places ships and spawns asteroids.
+    void Setup(std::vector<std::unique_ptr<ShipBase>> roster, uint32_t matchSeed);
+    // Drops all ships, programs and world state.
+    void Reset();
+    // Makes the broadphase and sizes the per-turn buffers for config and the roster, so a
+    // match at scale doesn't grow them turn by turn (called by Setup()).
+    void Reserve();
+    // Advances the match by one turn. Returns false (and does nothing) once the match is over.
+    bool Step();
+    // Step() in three parts, for callers that move the ships themselves (AstroBatch):
+    // BeginStep() runs the programs (false once the match is over), MoveShips() is the ship
+    // half of UpdatePhysics() and FinishStep() is everything after it.
+    bool BeginStep();
+    void MoveShips();
+    void FinishStep();
+    bool IsOver() const { return turn >= ASTRO_MAX_TURNS || AliveCount() <= 1 || Stalemated(); }
+    int AliveCount() const;
+    // FNV-1a hash of the gameplay state (ships, asteroids, torpedoes, RNG); equal for equal matches.
+    uint64_t Checksum() const;
+
+    // ===== Stalemates =====
+    // With config.stalemateTurns set, FinishStep() counts the turns in a row that nothing
+    // happened in: no ship lost hp and no live ship had another within ASTRO_SCAN_RANGE.
+    // Once quietTurns reaches stalemateTurns the match is over with ships still alive.
+    int quietTurns = 0;            // snapshots carry it
+    int turnStartHp = 0;           // hp of the live ships when the turn began
+    bool Stalemated() const { return config.stalemateTurns > 0 && quietTurns >= config.stalemateTurns; }
+    void UpdateStalemate();
+    bool ShipsInScanRange();       // any two live ships within ASTRO_SCAN_RANGE (torus distance)
+    int LiveShipHp() const;
+
+    // ===== Snapshots (AstroSnapshot.cpp) =====
+    // Appends a versioned binary snapshot of the match state to out: ships, asteroids with
+    // their shapes, torpedoes, beams, signals, RNG and spawn cooldown. Programs and visual
+    // effects (particles, debris) are not included.
+    void SaveSnapshot(std::vector<uint8_t>& out) const;
+    // Restores a snapshot into an arena set up with the same roster. On failure returns
+    // false, fills error and leaves the arena untouched.
+    bool LoadSnapshot(const uint8_t* data, size_t size, std::string* error = nullptr);
 };
 
 
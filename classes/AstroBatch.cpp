@@ -0,0 +1,72 @@
+#include "AstroBatch.h"
+#include "AstroArena.h"
+#include "AstroShips.h"
+#include "AstroSimd.h"
+
+AstroBatch::AstroBatch() = default;
+AstroBatch::~AstroBatch() = default;
+
+void AstroBatch::Setup(const RosterFactory& makeRoster, const std::vector<uint32_t>& seeds, bool simultaneous,
+                       const AstroArenaConfig& config) {
+    _arenas.clear();
+    _config = config;
+    for (uint32_t seed : seeds) {
+        auto arena = std::make_unique<AstroArena>();
+        arena->simultaneous = simultaneous;
+        arena->config = config;
+        arena->Setup(makeRoster(), seed);
+        _arenas.push_back(std::move(arena));
+    }
+}
+
+int AstroBatch::Step(int maxTurns) {
+    _stepping.clear();
+    for (auto& arena : _arenas) {
+        if (arena->turn < maxTurns && arena->BeginStep()) _stepping.push_back(arena.get());
+    }
+    if (_stepping.empty()) return 0;
+    if (_config.fixedPoint) {
+        // the kernel below is float; fixed-point arenas move their own ships on the grid
+        for (AstroArena* arena : _stepping) {
+            arena->MoveShips();
+            arena->FinishStep();
+        }
+        return (int)_stepping.size();
+    }
+
+    // gather
+    size_t n = 0;
+    for (AstroArena* arena : _stepping) n += arena->ships.size();
+    _angle.resize(n); _target.resize(n);
+    _x.resize(n); _y.resize(n); _vx.resize(n); _vy.resize(n);
+    _alive.resize(n);
+    size_t row = 0;
+    for (AstroArena* arena : _stepping) {
+        for (const auto& s : arena->ships) {
+            _angle[row] = s.angle; _target[row] = s.targetAngle;
+            _x[row] = s.x; _y[row] = s.y; _vx[row] = s.vx; _vy[row] = s.vy;
+            _alive[row] = s.alive ? 1 : 0;
+            ++row;
+        }
+    }
+
+    AstroMoveShips(_angle.data(), _target.data(), _x.data(), _y.data(), _vx.data(), _vy.data(),
+                   _alive.data(), n, ROTATION_SPEED, DRAG, MIN_VELOCITY, _config.width, _config.height);
+
+    // scatter, then the rest of each arena's turn
+    row = 0;
+    for (AstroArena* arena : _stepping) {
+        for (auto& s : arena->ships) {
+            s.angle = _angle[row];
+            s.x = _x[row]; s.y = _y[row]; s.vx = _vx[row]; s.vy = _vy[row];
+            ++row;
+        }
+        arena->FinishStep();
+    }
+    return (int)_stepping.size();
+}
+
+void AstroBatch::Run(int maxTurns) {
+    while (Step(maxTurns) > 0) {
+    }
+}
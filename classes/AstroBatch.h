@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "AstroTypes.h"
+
+struct AstroArena;
+struct ShipBase;
+
+// ===== Batched arenas =====
+// K independent matches stepped in lockstep, for sweeps that play one roster over many
+// seeds. Each turn every running arena runs its programs, then the ships of all of them
+// move in one AstroMoveShips() pass over columns laid side by side, then each arena
+// finishes its turn. Programs and collisions stay per arena: they branch on the arena's
+// own state, so lanes would diverge at once. Every arena ends in exactly the state a
+// plain Setup() + Step() loop with the same seed reaches.
+class AstroBatch {
+public:
+    using RosterFactory = std::function<std::vector<std::unique_ptr<ShipBase>>()>;
+
+    AstroBatch();
+    ~AstroBatch();
+
+    // one arena per seed, each with its own roster from makeRoster; all of them share one
+    // config, since the ship pass wraps every arena's ships on the same torus
+    void Setup(const RosterFactory& makeRoster, const std::vector<uint32_t>& seeds, bool simultaneous = false,
+               const AstroArenaConfig& config = {});
+    // Advances every arena that is still playing and under maxTurns by one turn.
+    // Returns how many arenas moved; 0 once all of them are done.
+    int Step(int maxTurns = ASTRO_MAX_TURNS);
+    // steps until every arena is done
+    void Run(int maxTurns = ASTRO_MAX_TURNS);
+
+    size_t Size() const { return _arenas.size(); }
+    AstroArena& Arena(size_t k) { return *_arenas[k]; }
+    const AstroArena& Arena(size_t k) const { return *_arenas[k]; }
+
+private:
+    std::vector<std::unique_ptr<AstroArena>> _arenas;
+    AstroArenaConfig _config;
+    std::vector<AstroArena*> _stepping; // arenas in this turn's ship pass
+    // ship columns of _stepping, arena after arena
+    std::vector<float> _angle, _target, _x, _y, _vx, _vy;
+    std::vector<uint8_t> _alive;
+};
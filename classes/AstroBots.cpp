@@ -1,225 +1,18 @@
 #include "AstroBots.h"
+#include "../Application.h"
 #include "../imgui/imgui.h"
+#include "AstroSimd.h"
 #include <sstream>
 #include <iomanip>
 #include <cmath>
 #include <random>
 #include <algorithm>
+#include <chrono>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// ===== VM implementation =====
-void ShipBase::Run(int turn) {
-    int pc = 0;
-    bool flag = false;
-    while (pc < (int)code.size()) {
-        int op = code[pc++];
-        switch(op) {
-            case ASTRO_OP_WAIT:
-                break;
-            case ASTRO_OP_THRUST: {
-                int powerInt = code[pc++];
-                float power = powerInt / 10.0f;
-                A->Thrust(id, power);
-                break;
-            }
-            case ASTRO_OP_TURN_DEG: {
-                int degrees = code[pc++];
-                A->TurnDeg(id, degrees);
-                break;
-            }
-            case ASTRO_OP_FIRE_PHASER:
-                A->FirePhaser(id);
-                break;
-            case ASTRO_OP_FIRE_PHOTON:
-                A->FirePhoton(id);
-                break;
-            case ASTRO_OP_SCAN:
-                A->Scan(id);
-                break;
-            case ASTRO_OP_SIGNAL: {
-                int value = code[pc++];
-                A->Signal(id, value);
-                break;
-            }
-            case ASTRO_OP_TURN_TO_SCAN:
-                A->TurnToScan(id);
-                break;
-            case ASTRO_OP_IF_SEEN:
-                pc++; // skip param
-                flag = A->ships[id].scan_hit;
-                break;
-            case ASTRO_OP_IF_SCAN_LE: {
-                int range = code[pc++];
-                flag = (A->ships[id].scan_hit && A->ships[id].scan_dist <= range);
-                break;
-            }
-            case ASTRO_OP_IF_DAMAGED:
-                pc++; // skip param
-                flag = (A->ships[id].hp < ASTRO_START_HP);
-                break;
-            case ASTRO_OP_IF_HP_LE: {
-                int hp = code[pc++];
-                flag = (A->ships[id].hp <= hp);
-                break;
-            }
-            case ASTRO_OP_IF_FUEL_LE: {
-                int fuel = code[pc++];
-                flag = (A->ships[id].fuel <= fuel);
-                break;
-            }
-            case ASTRO_OP_IF_CAN_FIRE_PHASER:
-                pc++; // skip param
-                flag = (A->ships[id].phaser_cooldown == 0);
-                break;
-            case ASTRO_OP_IF_CAN_FIRE_PHOTON:
-                pc++; // skip param
-                flag = (A->ships[id].photon_cooldown == 0);
-                break;
-            case ASTRO_OP_JUMP_IF_FALSE: {
-                int target = code[pc++];
-                if (!flag) pc = target;
-                break;
-            }
-            case ASTRO_OP_JUMP: { 
-                int tgt=code[pc++]; 
-                pc=tgt; break; 
-            }
-            case ASTRO_OP_END:
-                return;
-            default:
-                return;
-        }
-    }
-}
-
-// ===== Sample ship implementations =====
-int HunterShip::SetupShip() {
-    SCAN();
-    IF_SEEN() {
-        // Always turn toward and pursue what we see
-        TURN_TO_SCAN();
-        IF_SCAN_LE(500) {  // within phaser range: shoot
-            IF_SHIP_CAN_FIRE_PHASER() {
-                FIRE_PHASER();
-            }
-            IF_SHIP_CAN_FIRE_PHOTON() {
-                FIRE_PHOTON();
-            }
-        }
-        THRUST(2);  // close distance if not in range
-    } ELSE() {
-        THRUST(4);
-    }
-    IF_SHIP_FUEL_LE(40) {
-        SCAN();
-        IF_SCAN_LE(300) {  // Increased from 100 - look for fuel further away
-            TURN_TO_SCAN();
-            THRUST(2);
-        }
-    }
-    return Finalize();
-}
-
-int DroneShip::SetupShip() {
-    SCAN();
-    IF_SEEN() {
-        IF_SCAN_LE(450) {  // Increased from 400 - be more cautious
-            // Thrust away from threat
-            THRUST(3);
-            IF_SHIP_CAN_FIRE_PHOTON() {
-                FIRE_PHOTON();  // Fire while retreating
-            }
-        }
-    }
-    IF_SHIP_HP_LE(6) {  // Emergency threshold
-        THRUST(2);
-    }
-    IF_SHIP_FUEL_LE(35) {
-        SCAN();
-        IF_SCAN_LE(200) {  // Increased from 100
-            TURN_TO_SCAN();
-            THRUST(2);
-        }
-    }
-    return Finalize();
-}
-
-int MinerShip::SetupShip() {
-    // Move toward scanned objects and fire when close
-    SCAN();
-    IF_SEEN() {
-        TURN_TO_SCAN();
-        THRUST(2);
-        IF_SCAN_LE(150) {  // close range work
-            IF_SHIP_CAN_FIRE_PHASER() {
-                FIRE_PHASER();
-            }
-        }
-    }
-    IF_SHIP_DAMAGED() {
-        SCAN();
-        IF_SEEN() {
-            IF_SCAN_LE(350) {  // Increased from 200 - flee earlier
-                THRUST(3);
-            }
-        }
-    }
-    return Finalize();
-}
-
-int GraemeShip::SetupShip() {
-    SCAN();
-    IF_SEEN() {
-        IF_SCAN_LE(450) {  // Increased from 400 - be more cautious
-            // Thrust away from threat
-            THRUST(3);
-            IF_SHIP_CAN_FIRE_PHOTON() {
-                FIRE_PHOTON();  // Fire while retreating
-            }
-        }
-    }
-    IF_SHIP_HP_LE(6) {  // Emergency threshold
-        THRUST(2);
-    }
-    IF_SHIP_FUEL_LE(35) {
-        SCAN();
-        IF_SCAN_LE(200) {  // Increased from 100
-            TURN_TO_SCAN();
-            THRUST(2);
-        }
-    }
-    return Finalize();
-}
-
-int MandeezShip::SetupShip() {
-    SCAN();
-    IF_SEEN() {
-        // Always turn toward and pursue what we see
-        TURN_TO_SCAN();
-        IF_SCAN_LE(450) {  // within phaser range: shoot
-            IF_SHIP_CAN_FIRE_PHASER() {
-                FIRE_PHASER();
-            }
-            IF_SHIP_CAN_FIRE_PHOTON() {
-                FIRE_PHOTON();
-            }
-        }
-        THRUST(2);  // close distance if not in range
-    } ELSE() {
-        THRUST(4);
-    }
-    IF_SHIP_FUEL_LE(40) {
-        SCAN();
-        IF_SCAN_LE(200) {  // Increased from 100 - look for fuel further away
-            TURN_TO_SCAN();
-            THRUST(2);
-        }
-    }
-    return Finalize();
-}
 // ===== AstroBots game implementation =====
 AstroBots::AstroBots() {
     _currentTurn = 0;
@@ -227,29 +20,13 @@ AstroBots::AstroBots() {
 }
 
 AstroBots::~AstroBots() {
+    _sim.Stop();
 }
 
-std::vector<std::unique_ptr<ShipBase>> AstroBots::makeShips() {
-    std::vector<std::unique_ptr<ShipBase>> v;
-    v.emplace_back(std::make_unique<HunterShip>());
-    v.emplace_back(std::make_unique<DroneShip>());
-    v.emplace_back(std::make_unique<MinerShip>());
-    v.emplace_back(std::make_unique<GraemeShip>());
-    v.emplace_back(std::make_unique<MandeezShip>());
-    return v;
-}
-
-void AstroBots::setUpBoard() {
-    setNumberOfPlayers(1);
-    _gameOptions.rowX = (int)ASTROBOTS_W;
-    _gameOptions.rowY = (int)ASTROBOTS_H;
-
-    _ships = makeShips();
-    _arena.ships.resize(_ships.size());
-    _logLines.clear();
-
-    // Validate scripts & inject arena refs
-    ImU32 shipColors[] = {
+// the first eight ships get the named colors, the rest walk the hue circle by the golden
+// angle so neighbours in a big roster still differ
+static ImU32 ShipColor(size_t i) {
+    static const ImU32 shipColors[] = {
         IM_COL32(255, 80, 80, 255),   // Red
         IM_COL32(80, 255, 80, 255),   // Green
         IM_COL32(80, 180, 255, 255),  // Blue
@@ -259,79 +36,144 @@ void AstroBots::setUpBoard() {
         IM_COL32(255, 160, 0, 255),    // Orange
         IM_COL32(128, 0, 128, 255)     // Purple
     };
+    const size_t named = sizeof(shipColors) / sizeof(shipColors[0]);
+    if (i < named) return shipColors[i];
+    float r, g, b;
+    ImGui::ColorConvertHSVtoRGB(std::fmod((float)(i - named) * 0.618034f, 1.0f), 0.7f, 1.0f, r, g, b);
+    return ImGui::ColorConvertFloat4ToU32(ImVec4(r, g, b, 1.0f));
+}
 
-    // Hook up logger
-    _arena.log = [this](const std::string& line) {
-        _logLines.push_back(line);
-        if (_logLines.size() > 500) {
-            _logLines.erase(_logLines.begin(), _logLines.begin() + (_logLines.size() - 500));
-        }
-    };
-
-    for (size_t i = 0; i < _ships.size(); ++i) {
-        int cost = _ships[i]->SetupShip();
-        // log the ship setup cost and show the name, highlight if it exceeds the limit
-        std::string nm = _ships[i] ? _ships[i]->name : std::string("Ship");
-        std::string line = nm + " script cost " + std::to_string(cost) + "/" + std::to_string(ASTRO_MAX_SCRIPT_COST);
-        if (cost > ASTRO_MAX_SCRIPT_COST) line += " (EXCEEDS LIMIT)";
-        _logLines.push_back(line);
-        if (_logLines.size() > 500) {
-            _logLines.erase(_logLines.begin(), _logLines.begin() + (_logLines.size() - 500));
-        }
-        _arena.ships[i].ship = _ships[i].get();
-        _arena.ships[i].color = shipColors[i % 6];
-        _ships[i]->A = &_arena;
-        _ships[i]->id = (int)i;
-    }
-
-    // Spawn ships in a circle around the center
-    float centerX = ASTROBOTS_W / 2.0f;
-    float centerY = ASTROBOTS_H / 2.0f;
-    float spawnRadius = 300.0f;
+std::vector<std::unique_ptr<ShipBase>> AstroBots::makeShips() {
+    return _ships.Empty() ? MakeDefaultShips(_arena.config.ships) : _ships.MakeShips(_arena.config.ships);
+}
 
+void AstroBots::setUpBoard() {
+    _sim.Stop();
+    setNumberOfPlayers(1);
+    _gameOptions.rowX = (int)_arena.config.width;
+    _gameOptions.rowY = (int)_arena.config.height;
+
+    _eventLog.Clear();
+
+    // Hook up logger: lines are formatted when the log window shows them
+    _arena.eventLog = &_eventLog;
+    _arena.profiler = &_turnProfiler;
+    _arena.countVm = true;
+    _arena.visualEffects = true; // particles, debris, beams and torpedo pulses to draw
+    _turnProfiler.Reset();
+    _profiler.Reset();
+
+    // Arena compiles the scripts, places the ships and spawns asteroids
+    uint32_t seed = std::random_device{}();
+    _eventLog.Push({ 0, ASTRO_LOG_MATCH_SEED, -1, -1, (int32_t)seed });
+    _arena.Setup(makeShips(), seed);
     for (size_t i = 0; i < _arena.ships.size(); ++i) {
-        float angle = (float)i / _ships.size() * 2.0f * M_PI;
-        _arena.ships[i].x = centerX + std::cos(angle) * spawnRadius;
-        _arena.ships[i].y = centerY + std::sin(angle) * spawnRadius;
-        _arena.ships[i].angle = angle * 180.0f / M_PI;
-        _arena.ships[i].targetAngle = _arena.ships[i].angle;
-        _arena.ships[i].vx = 0;
-        _arena.ships[i].vy = 0;
+        _arena.ships[i].color = ShipColor(i);
     }
 
-    // Spawn asteroids
-    _arena.SpawnAsteroids(NUM_INITIAL_ASTEROIDS);
+    _history.Begin(_arena.ships.size());
+    _history.Record(_arena);
+    // the viewer re-simulates from the recording when rewinding
+    _recorder.Begin(_arena, ASTRO_REPLAY_KEYFRAME_EVERY);
+    _arena.recorder = &_recorder;
+    _stream.Restart();
+    _checkpoint.clear();
+    // the Memory panel counts from here
+    AstroMemoryStats::ResetPeaks();
+    _memoryAtStart = AstroMemoryStats::Read();
 
     _currentTurn = 0;
     _gameRunning = true;
 
+    // from here on the arena is the worker's; the decorate hook runs there too
+    _sim.Start(_arena, [this]() { endTurn(); }, [this](AstroRenderState& state) {
+        state.checkpointTurn = _checkpoint.empty() ? -1 : _checkpointTurn;
+        state.replayEvents = _recorder.Replay().eventCount;
+        state.replayBytes = _recorder.Replay().events.size();
+        state.stateString = _history.Size() > 0 ? _history.StateString(_history.Size() - 1) : std::string();
+        state.spectators = _broadcast.Listening() ? _broadcast.SpectatorCount() : -1;
+    });
+    _view = &_sim.Latest();
+
     startGame();
 }
 
-ImVec2 AstroBots::WorldToScreen(float x, float y) {
-    // Properly scaled viewport
-    ImVec2 contentMin = ImGui::GetWindowContentRegionMin();
-    ImVec2 contentMax = ImGui::GetWindowContentRegionMax();
-    ImVec2 size = ImVec2(contentMax.x - contentMin.x, contentMax.y - contentMin.y);
+// Moves (x, y) to the copy of the torus nearest the camera, and says whether something of
+// radius world units plus padPx pixels around it there is on screen this frame
+bool AstroBots::OnScreen(float& x, float& y, float radius, float padPx) const {
+    x = _cameraX + std::remainder(x - _cameraX, _arena.config.width);
+    y = _cameraY + std::remainder(y - _cameraY, _arena.config.height);
+    const float pad = radius + padPx / _screen.scale;
+    return std::fabs(x - _cameraX) <= _viewHalfW + pad && std::fabs(y - _cameraY) <= _viewHalfH + pad;
+}
 
-    // Calculate scale to fit world in window
-    float scaleX = size.x / ASTROBOTS_W;
-    float scaleY = size.y / ASTROBOTS_H;
-    float scale = (scaleX < scaleY) ? scaleX : scaleY;
+// Mouse wheel zooms about the cursor, right-drag pans. At zoom 1 the whole arena is framed.
+void AstroBots::UpdateCamera(ImVec2 origin, ImVec2 size, float fitScale) {
+    ImGuiIO& io = ImGui::GetIO();
+    const bool hovered = ImGui::IsWindowHovered() && io.MousePos.x >= origin.x && io.MousePos.y >= origin.y &&
+                         io.MousePos.x < origin.x + size.x && io.MousePos.y < origin.y + size.y;
+    if (hovered && io.MouseWheel != 0.0f) {
+        // keep the world point under the cursor where it is
+        float mx = io.MousePos.x - origin.x - size.x * 0.5f, my = io.MousePos.y - origin.y - size.y * 0.5f;
+        float wx = _cameraX + mx / (fitScale * _zoom), wy = _cameraY + my / (fitScale * _zoom);
+        _zoom = std::clamp(_zoom * std::pow(1.2f, io.MouseWheel), 1.0f, ASTRO_MAX_ZOOM);
+        _cameraX = wx - mx / (fitScale * _zoom);
+        _cameraY = wy - my / (fitScale * _zoom);
+    }
+    if (hovered && ImGui::IsMouseDragging(ImGuiMouseButton_Right)) {
+        _cameraX -= io.MouseDelta.x / (fitScale * _zoom);
+        _cameraY -= io.MouseDelta.y / (fitScale * _zoom);
+    }
+    const float worldW = _arena.config.width, worldH = _arena.config.height;
+    if (_zoom <= 1.0f) {
+        _cameraX = worldW / 2.0f;
+        _cameraY = worldH / 2.0f;
+    }
+    _cameraX -= std::floor(_cameraX / worldW) * worldW;
+    _cameraY -= std::floor(_cameraY / worldH) * worldH;
+
+    // the camera sits at the center of the window
+    _screen.scale = fitScale * _zoom;
+    _screen.offsetX = origin.x + size.x * 0.5f - _cameraX * _screen.scale;
+    _screen.offsetY = origin.y + size.y * 0.5f - _cameraY * _screen.scale;
+    // never more than one period of the torus: everything is drawn once, at its copy nearest the camera
+    _viewHalfW = std::min(size.x * 0.5f / _screen.scale, worldW * 0.5f);
+    _viewHalfH = std::min(size.y * 0.5f / _screen.scale, worldH * 0.5f);
+}
 
-    // Center the world in the window
-    float screenX = x * scale;
-    float screenY = y * scale;
+// Grid lines every 200 units and the arena's edges, over the visible part of the torus
+void AstroBots::DrawBackground(ImDrawList* drawList, ImVec2 origin, ImVec2 size) {
+    // Draw space background in content region
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y),
+                           IM_COL32(5, 5, 15, 255));
 
-    return ImVec2(screenX, screenY);
+    const float worldW = _arena.config.width, worldH = _arena.config.height;
+    const float minX = _cameraX - _viewHalfW, maxX = _cameraX + _viewHalfW;
+    const float minY = _cameraY - _viewHalfH, maxY = _cameraY + _viewHalfH;
+    ImU32 gridColor = IM_COL32(20, 20, 30, 100);
+    ImU32 borderColor = IM_COL32(100, 100, 150, 255);
+    auto line = [&](float x1, float y1, float x2, float y2, ImU32 color, float thickness) {
+        ImVec2 p1 = WorldToScreen(x1, y1);
+        ImVec2 p2 = WorldToScreen(x2, y2);
+        drawList->AddLine(p1, p2, color, thickness);
+    };
+    // each copy of the world in view has its own grid, starting at its edge
+    for (float copy = std::floor(minX / worldW) * worldW; copy <= maxX; copy += worldW) {
+        for (float x = copy; x < copy + worldW; x += 200) {
+            if (x >= minX && x <= maxX) line(x, minY, x, maxY, x == copy ? borderColor : gridColor, x == copy ? 3.0f : 1.0f);
+        }
+    }
+    for (float copy = std::floor(minY / worldH) * worldH; copy <= maxY; copy += worldH) {
+        for (float y = copy; y < copy + worldH; y += 200) {
+            if (y >= minY && y <= maxY) line(minX, y, maxX, y, y == copy ? borderColor : gridColor, y == copy ? 3.0f : 1.0f);
+        }
+    }
 }
 
-void AstroBots::DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship, ImVec2 offset) {
+void AstroBots::DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship) {
     if (!ship.alive) return;
 
     ImVec2 pos = WorldToScreen(ship.x, ship.y);
-    pos.x += offset.x;
-    pos.y += offset.y;
 
     // Draw ship as triangle pointing in facing direction
     float angleRad = ship.angle * M_PI / 180.0f;
@@ -383,43 +225,62 @@ void AstroBots::DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship
     drawList->AddText(textPos, IM_COL32(255, 255, 255, 255), label);
 }
 
-void AstroBots::DrawAsteroid(ImDrawList* drawList, const Asteroid& asteroid, ImVec2 offset) {
-    if (!asteroid.alive) return;
+// lag: how many turns behind the current position to draw it (asteroids drift at a
+// constant velocity, so that's exact)
+void AstroBots::DrawAsteroid(ImDrawList* drawList, const AsteroidPool& asteroids, size_t index, float lag) {
+    if (!asteroids.alive[index]) return;
+    float ax = asteroids.x[index] - asteroids.vx[index] * lag, ay = asteroids.y[index] - asteroids.vy[index] * lag;
+    const AsteroidShape& shape = asteroids.Shape(index);
+    const auto& outline = shape.outline;
+    const float extent = std::max({ asteroids.radius[index], -shape.bounds.min.x, shape.bounds.max.x, -shape.bounds.min.y, shape.bounds.max.y });
+    if (!OnScreen(ax, ay, extent)) return;
 
-    ImVec2 pos = WorldToScreen(asteroid.x, asteroid.y);
-    pos.x += offset.x;
-    pos.y += offset.y;
+    ImVec2 pos = WorldToScreen(ax, ay);
 
     // Draw asteroid as polygon
-    if (asteroid.shape.size() < 3) return;
-
-    std::vector<ImVec2> points;
-    for (const auto& v : asteroid.shape) {
-        ImVec2 p = WorldToScreen(asteroid.x + v.x, asteroid.y + v.y);
-        p.x += offset.x; p.y += offset.y;
-        points.push_back(p);
-    }
-
-    // Draw filled polygon (using triangles)
-    ImVec2 center = pos;
-    for (size_t i = 0; i < points.size(); ++i) {
-        size_t next = (i + 1) % points.size();
-        drawList->AddTriangleFilled(center, points[i], points[next], IM_COL32(100, 80, 70, 180));
+    if (outline.size() < 3) return;
+
+    // the local outline, scaled and moved onto the screen in one pass
+    std::vector<ImVec2>& points = _points;
+    points.resize(outline.size());
+    AstroTransformPoints(&outline[0].x, &points[0].x, outline.size(), _screen.scale, pos.x, pos.y);
+
+    // Draw filled polygon: the outline is star-shaped about the center, so a fan round it
+    // covers it, written straight into the draw list (n + 1 vertices, 3n indices). Too
+    // small to see the fill, just the outline.
+    const int n = (int)points.size();
+    if (asteroids.radius[index] * _screen.scale >= ASTRO_LOD_ASTEROID_PX) {
+        const ImU32 fill = IM_COL32(100, 80, 70, 180);
+        const ImVec2 uv = ImGui::GetFontTexUvWhitePixel();
+        drawList->PrimReserve(3 * n, n + 1);
+        const ImDrawIdx center = (ImDrawIdx)drawList->_VtxCurrentIdx;
+        drawList->PrimWriteVtx(pos, uv, fill);
+        for (int i = 0; i < n; ++i) drawList->PrimWriteVtx(points[i], uv, fill);
+        for (int i = 0; i < n; ++i) {
+            drawList->PrimWriteIdx(center);
+            drawList->PrimWriteIdx((ImDrawIdx)(center + 1 + i));
+            drawList->PrimWriteIdx((ImDrawIdx)(center + 1 + (i + 1) % n));
+        }
     }
 
     // Draw outline
-    for (size_t i = 0; i < points.size(); ++i) {
-        size_t next = (i + 1) % points.size();
-        drawList->AddLine(points[i], points[next], IM_COL32(150, 130, 120, 255), 2.0f);
-    }
+    drawList->AddPolyline(points.data(), n, IM_COL32(150, 130, 120, 255), ImDrawFlags_Closed, 2.0f);
 }
 
-void AstroBots::DrawTorpedo(ImDrawList* drawList, const PhotonTorpedo& torpedo, ImVec2 offset) {
+void AstroBots::DrawTorpedo(ImDrawList* drawList, const PhotonTorpedo& torpedo) {
     if (!torpedo.alive) return;
 
     ImVec2 pos = WorldToScreen(torpedo.x, torpedo.y);
-    pos.x += offset.x;
-    pos.y += offset.y;
+
+    // zoomed far out the asterisk would be a blur of 24 lines: a dot
+    if (_screen.scale < ASTRO_LOD_DETAIL_SCALE) {
+        drawList->AddRectFilled(ImVec2(pos.x - 1.0f, pos.y - 1.0f), ImVec2(pos.x + 1.0f, pos.y + 1.0f), IM_COL32(255, 80, 80, 255));
+        return;
+    }
+    if (_effectsThisFrame) {
+        _effects.Add(ASTRO_EFFECT_TORPEDO, { pos.x, pos.y, 0.0f, 0.0f, (float)torpedo.anim, 0 });
+        return;
+    }
 
     // Animated rotating/pulsing asterisk photon
     const int spokes = PHOTON_SPOKES;
@@ -454,13 +315,15 @@ void AstroBots::DrawTorpedo(ImDrawList* drawList, const PhotonTorpedo& torpedo,
     drawList->AddCircle(pos, (base + amp) * 0.35f, coreColor, 0, 2.0f);
 }
 
-void AstroBots::DrawPhaserBeam(ImDrawList* drawList, const PhaserBeam& beam, ImVec2 offset) {
+void AstroBots::DrawPhaserBeam(ImDrawList* drawList, const PhaserBeam& beam) {
     if (!beam.alive) return;
 
-    ImVec2 p1 = WorldToScreen(beam.x1, beam.y1);
-    ImVec2 p2 = WorldToScreen(beam.x2, beam.y2);
-    p1.x += offset.x; p1.y += offset.y;
-    p2.x += offset.x; p2.y += offset.y;
+    // culled and wrapped as a whole, by its midpoint
+    const float cx = (beam.x1 + beam.x2) * 0.5f, cy = (beam.y1 + beam.y2) * 0.5f;
+    float mx = cx, my = cy;
+    if (!OnScreen(mx, my, 0.5f * std::hypot(beam.x2 - beam.x1, beam.y2 - beam.y1), 6.0f)) return;
+    ImVec2 p1 = WorldToScreen(beam.x1 + mx - cx, beam.y1 + my - cy);
+    ImVec2 p2 = WorldToScreen(beam.x2 + mx - cx, beam.y2 + my - cy);
 
     // Draw bright beam with glow effect
     drawList->AddLine(p1, p2, beam.color, 3.0f);
@@ -469,32 +332,43 @@ void AstroBots::DrawPhaserBeam(ImDrawList* drawList, const PhaserBeam& beam, ImV
     drawList->AddLine(p1, p2, glowColor, 6.0f);
 }
 
-void AstroBots::DrawParticles(ImDrawList* drawList, const std::vector<Particle>& particles, ImVec2 offset) {
-    for (const auto& p : particles) {
-        if (!p.alive) continue;
-        ImVec2 pos = WorldToScreen(p.x, p.y);
-        pos.x += offset.x; pos.y += offset.y;
+void AstroBots::DrawParticles(ImDrawList* drawList, const ParticlePool& particles) {
+    const ParticlePool& p = particles;
+    const bool detailed = _screen.scale >= ASTRO_LOD_DETAIL_SCALE;
+    for (size_t i = 0; i < p.size(); ++i) {
+        if (!p.alive[i]) continue;
+        float x = p.x[i], y = p.y[i];
+        // the streak trails up to length pixels behind
+        if (!OnScreen(x, y, 0.0f, p.length[i] + 8.0f)) continue;
+        ImVec2 pos = WorldToScreen(x, y);
 
         // Calculate normalized lifetime (1.0 at spawn, 0.0 at death)
         float lifeT = 0.0f;
-        if (p.startLifetime > 0) {
-            lifeT = std::max(0.0f, (float)p.lifetime / (float)p.startLifetime);
+        if (p.startLifetime[i] > 0) {
+            lifeT = std::max(0.0f, (float)p.lifetime[i] / (float)p.startLifetime[i]);
         }
 
         // Fade length to zero
-        float len = p.length * lifeT;
+        float len = p.length[i] * lifeT;
 
         // Get velocity direction
-        float vx = p.vx, vy = p.vy;
+        float vx = p.vx[i], vy = p.vy[i];
         float vlen = std::sqrt(vx*vx + vy*vy);
         if (vlen < 1e-4f) vlen = 1.0f;
         vx /= vlen; vy /= vlen;
 
+        // the shader does the cooling, fading and layering below (the core-only
+        // line of the far-out level of detail stays an ImDrawList line)
+        if (_effectsThisFrame && detailed) {
+            _effects.Add(ASTRO_EFFECT_PARTICLE, { pos.x, pos.y, -vx * len, -vy * len, lifeT, p.color[i] });
+            continue;
+        }
+
         // *** "Hot" Particles ***
         // Interpolate color from white-hot to its base color as it "cools"
-        int r_base = (p.color >> IM_COL32_R_SHIFT) & 0xFF;
-        int g_base = (p.color >> IM_COL32_G_SHIFT) & 0xFF;
-        int b_base = (p.color >> IM_COL32_B_SHIFT) & 0xFF;
+        int r_base = (p.color[i] >> IM_COL32_R_SHIFT) & 0xFF;
+        int g_base = (p.color[i] >> IM_COL32_G_SHIFT) & 0xFF;
+        int b_base = (p.color[i] >> IM_COL32_B_SHIFT) & 0xFF;
 
         // As lifeT goes from 1.0 -> 0.0, we fade from 255 -> base_color
         int r = (int)(r_base + (255 - r_base) * lifeT);
@@ -511,24 +385,29 @@ void AstroBots::DrawParticles(ImDrawList* drawList, const std::vector<Particle>&
         ImVec2 tail(pos.x - vx * len, pos.y - vy * len);
         
         // Layered lines: a thick, dim glow and a thin, bright core
-        // Both shrink and fade with lifeT
-        drawList->AddLine(tail, pos, glow, 7.0f * lifeT + 2.0f); 
+        // Both shrink and fade with lifeT; zoomed far out just the core
+        if (detailed) drawList->AddLine(tail, pos, glow, 7.0f * lifeT + 2.0f);
         drawList->AddLine(tail, pos, colorMain, 3.0f * lifeT + 1.0f);
     }
 }
 
-void AstroBots::DrawShipDebris(ImDrawList* drawList, const std::vector<ShipDebrisSegment>& debris, ImVec2 offset) {
+void AstroBots::DrawShipDebris(ImDrawList* drawList, const decltype(AstroArena::shipDebris)& debris) {
     for (const auto& d : debris) {
         if (!d.alive) continue;
-        ImVec2 p1 = WorldToScreen(d.x1, d.y1);
-        ImVec2 p2 = WorldToScreen(d.x2, d.y2);
-        p1.x += offset.x; p1.y += offset.y;
-        p2.x += offset.x; p2.y += offset.y;
+        const float cx = (d.x1 + d.x2) * 0.5f, cy = (d.y1 + d.y2) * 0.5f;
+        float mx = cx, my = cy;
+        if (!OnScreen(mx, my, 0.5f * std::hypot(d.x2 - d.x1, d.y2 - d.y1), 4.0f)) continue;
+        ImVec2 p1 = WorldToScreen(d.x1 + mx - cx, d.y1 + my - cy);
+        ImVec2 p2 = WorldToScreen(d.x2 + mx - cx, d.y2 + my - cy);
 
         float lifeT = 0.0f;
         if (d.startLifetime > 0) {
             lifeT = std::max(0.0f, (float)d.lifetime / (float)d.startLifetime);
         }
+        if (_effectsThisFrame) {
+            _effects.Add(ASTRO_EFFECT_DEBRIS, { p1.x, p1.y, p2.x - p1.x, p2.y - p1.y, lifeT, d.color });
+            continue;
+        }
 
         // Glow color derived from ship color, core is white
         int r = (int)((d.color >> IM_COL32_R_SHIFT) & 0xFF);
@@ -548,6 +427,7 @@ void AstroBots::DrawShipDebris(ImDrawList* drawList, const std::vector<ShipDebri
 }
 
 void AstroBots::drawFrame() {
+    ASTRO_PROFILE_SCOPE(&_profiler, ASTRO_PHASE_DRAW_FRAME);
     Game::drawFrame();
 
     //ImGui::Begin("AstroBotsView");
@@ -559,89 +439,151 @@ void AstroBots::drawFrame() {
     ImVec2 origin = ImVec2(windowPos.x + contentMin.x, windowPos.y + contentMin.y);
     ImVec2 size = ImVec2(contentMax.x - contentMin.x, contentMax.y - contentMin.y);
     // Update arena render scale for effects that need screen-size awareness
-    float scaleX = size.x / ASTROBOTS_W;
-    float scaleY = size.y / ASTROBOTS_H;
-    _arena.renderScale = (scaleX < scaleY) ? scaleX : scaleY;
+    float scaleX = size.x / _arena.config.width;
+    float scaleY = size.y / _arena.config.height;
+    UpdateCamera(origin, size, (scaleX < scaleY) ? scaleX : scaleY);
+    _sim.SetRenderScale(_screen.scale);
+    const AstroRenderState& world = view();
 
-    // Draw space background in content region
-    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y),
-                           IM_COL32(5, 5, 15, 255));
+    DrawBackground(drawList, origin, size);
 
-    // Draw grid (optional, for reference)
-    ImU32 gridColor = IM_COL32(20, 20, 30, 100);
-    for (float x = 0; x < ASTROBOTS_W; x += 200) {
-        ImVec2 p1 = WorldToScreen(x, 0);
-        ImVec2 p2 = WorldToScreen(x, ASTROBOTS_H);
-        p1.x += origin.x; p1.y += origin.y;
-        p2.x += origin.x; p2.y += origin.y;
-        drawList->AddLine(p1, p2, gridColor);
-    }
-    for (float y = 0; y < ASTROBOTS_H; y += 200) {
-        ImVec2 p1 = WorldToScreen(0, y);
-        ImVec2 p2 = WorldToScreen(ASTROBOTS_W, y);
-        p1.x += origin.x; p1.y += origin.y;
-        p2.x += origin.x; p2.y += origin.y;
-        drawList->AddLine(p1, p2, gridColor);
-    }
-
-    // Draw border around play area
-    ImVec2 borderTL = WorldToScreen(0, 0);
-    ImVec2 borderBR = WorldToScreen(ASTROBOTS_W, ASTROBOTS_H);
-    borderTL.x += origin.x; borderTL.y += origin.y;
-    borderBR.x += origin.x; borderBR.y += origin.y;
-    drawList->AddRect(borderTL, borderBR, IM_COL32(100, 100, 150, 255), 0.0f, 0, 3.0f);
+    // Instanced effects draw into the main viewport's framebuffer only: a window dragged
+    // out to a platform window of its own falls back to ImDrawList lines
+    ImGuiViewport* viewport = ImGui::GetWindowViewport();
+    _effectsThisFrame = _gpuEffects && AstroEffectsAvailable() && viewport == ImGui::GetMainViewport();
+    _effects.Clear();
+    if (_effectsThisFrame) {
+        _effects.displayPos = viewport->Pos;
+        _effects.displaySize = viewport->Size;
+        _effects.framebufferScale = ImGui::GetIO().DisplayFramebufferScale;
+        AstroEffectsSetParams({ PHOTON_BASE_SIZE, PHOTON_PULSE_AMPLITUDE, PHOTON_SPIN_SPEED, PHOTON_PULSE_SPEED });
+    }
+
+    // Between turns, moving things are drawn where they were a fraction of a turn ago
+    float lag = 0.0f;
+    if (world.turnMs > 0.0 && !world.over) {
+        double since = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - world.publishedAt).count();
+        lag = 1.0f - (float)std::min(1.0, since / world.turnMs);
+    }
 
     // Draw asteroids
-    for (const auto& a : _arena.asteroids) {
-        DrawAsteroid(drawList, a, origin);
+    {
+        ASTRO_PROFILE_SCOPE(&_profiler, ASTRO_PHASE_DRAW_ASTEROIDS);
+        for (size_t i = 0; i < world.asteroids.size(); ++i) {
+            DrawAsteroid(drawList, world.asteroids, i, lag);
+        }
     }
 
     // Draw phaser beams (drawn first so they appear behind torpedoes and ships)
-    for (const auto& beam : _arena.phaserBeams) {
-        DrawPhaserBeam(drawList, beam, origin);
+    {
+        ASTRO_PROFILE_SCOPE(&_profiler, ASTRO_PHASE_DRAW_BEAMS);
+        for (const auto& beam : world.phaserBeams) {
+            DrawPhaserBeam(drawList, beam);
+        }
     }
 
     // Draw particles (hits, sparks)
-    DrawParticles(drawList, _arena.particles, origin);
+    {
+        ASTRO_PROFILE_SCOPE(&_profiler, ASTRO_PHASE_DRAW_PARTICLES);
+        DrawParticles(drawList, world.particles);
+    }
 
     // Draw ship debris segments
-    DrawShipDebris(drawList, _arena.shipDebris, origin);
+    {
+        ASTRO_PROFILE_SCOPE(&_profiler, ASTRO_PHASE_DRAW_DEBRIS);
+        DrawShipDebris(drawList, world.shipDebris);
+    }
 
     // Draw torpedoes
-    for (const auto& t : _arena.torpedoes) {
-        DrawTorpedo(drawList, t, origin);
+    {
+        ASTRO_PROFILE_SCOPE(&_profiler, ASTRO_PHASE_DRAW_TORPEDOES);
+        for (const auto& t : world.torpedoes) {
+            PhotonTorpedo shown = t;
+            shown.x -= t.vx * lag;
+            shown.y -= t.vy * lag;
+            if (!OnScreen(shown.x, shown.y, 0.0f, PHOTON_BASE_SIZE + PHOTON_PULSE_AMPLITUDE + 4.0f)) continue;
+            DrawTorpedo(drawList, shown);
+        }
+        // everything batched above goes here in the draw order, in one go
+        if (_effects.Size() > 0) {
+            drawList->AddCallback(AstroEffectsRender, &_effects);
+            drawList->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+        }
     }
 
     // Draw ships
-    for (const auto& s : _arena.ships) {
-        DrawShip(drawList, s, origin);
+    {
+        ASTRO_PROFILE_SCOPE(&_profiler, ASTRO_PHASE_DRAW_SHIPS);
+        for (size_t i = 0; i < world.ships.size(); ++i) {
+            AstroArena::ShipState shown = world.ships[i];
+            if (lag > 0.0f && i < world.prevShips.size()) {
+                // from the previous pose, the short way round the torus and the circle
+                const AstroRenderState::Pose& p = world.prevShips[i];
+                float dx = shown.x - p.x, dy = shown.y - p.y;
+                dx = std::remainder(dx, _arena.config.width);
+                dy = std::remainder(dy, _arena.config.height);
+                float da = std::remainder(shown.angle - p.angle, 360.0f);
+                shown.x -= dx * lag;
+                shown.y -= dy * lag;
+                shown.angle -= da * lag;
+            }
+            // the health bars and name label reach about 40 pixels out
+            if (!OnScreen(shown.x, shown.y, 0.0f, 40.0f)) continue;
+            DrawShip(drawList, shown);
+        }
     }
 
     // Debug: collision boundaries
     if (_showColliders) {
-        DrawDebugColliders(drawList, origin);
+        DrawDebugColliders(drawList);
     }
 
     // Draw HUD
     DrawHUD();
+    DrawProfiler();
+    DrawMemory();
 
     ImGui::End();
 
     // Logging window
+    ASTRO_PROFILE_SCOPE(&_profiler, ASTRO_PHASE_DRAW_LOG);
     ImGui::Begin("AstroBots Log");
     if (ImGui::Button("Clear")) {
-        _logLines.clear();
+        _eventLog.Clear();
     }
     ImGui::SameLine();
     ImGui::Checkbox("Auto-scroll", &_logAutoScroll);
     ImGui::Separator();
     ImGui::Text("Turn: %d / %d", _currentTurn, ASTRO_MAX_TURNS);
+    if (view().stalemate) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "stalemate");
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("(%llu lines, last %zu kept)", (unsigned long long)(_eventLog.End() - _eventLog.Begin()),
+                        _eventLog.Capacity());
     ImGui::Separator();
     ImGui::BeginChild("scroll_region", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
-    for (const auto& line : _logLines) {
-        ImGui::TextUnformatted(line.c_str());
+    // only the rows in view get formatted; the programs they name don't change during a
+    // match, so reading them while the worker plays is fine
+    uint64_t first = _eventLog.Begin();
+    ImGuiListClipper clipper;
+    clipper.Begin((int)(_eventLog.End() - first));
+    char line[160];
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            AstroLogEntry e;
+            if (!_eventLog.Read(first + row, e)) {
+                ImGui::TextUnformatted("");
+                continue;
+            }
+            AstroFormatLog(e, _arena, line, sizeof(line));
+            ImGui::TextUnformatted(line);
+        }
     }
-    if (_logAutoScroll) {
+    // follow new lines only while already at the bottom, so scrolling back up to read
+    // an old entry isn't undone by the next turn's log
+    if (_logAutoScroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
         ImGui::SetScrollHereY(1.0f);
     }
     ImGui::EndChild();
@@ -654,9 +596,95 @@ void AstroBots::DrawHUD() {
     ImGui::Text("Ship Status:");
     ImGui::Separator();
     ImGui::Checkbox("Show Colliders", &_showColliders);
+    if (AstroEffectsAvailable()) {
+        ImGui::SameLine();
+        ImGui::Checkbox("GPU Effects", &_gpuEffects);
+    }
+    // camera: wheel to zoom, right-drag to pan
+    ImGui::Checkbox("Follow Ships", &_followShips);
+    ImGui::SameLine();
+    if (ImGui::Button("Reset View")) _zoom = 1.0f;
+    ImGui::SameLine();
+    ImGui::Text("%.1fx", _zoom);
+    // game speed: 1x is 30 turns a second, max plays as many as fit in the frame budget
+    static const int speeds[] = { 1, 4, 16, 0 };
+    static const char* speedNames[] = { "1x", "4x", "16x", "max" };
+    ImGui::Text("Speed:");
+    for (int k = 0; k < 4; ++k) {
+        ImGui::SameLine();
+        if (ImGui::RadioButton(speedNames[k], _sim.Speed() == speeds[k])) {
+            _sim.SetSpeed(speeds[k]);
+        }
+    }
+    // the arena is the sim worker's: checkpoint, rewind and seek run there, between turns
+    const AstroRenderState& world = view();
+    if (ImGui::Button("Checkpoint")) {
+        _sim.Post([this]() {
+            _checkpoint.clear();
+            _arena.SaveSnapshot(_checkpoint);
+            _checkpointTurn = _arena.turn;
+        });
+    }
+    if (world.checkpointTurn >= 0) {
+        ImGui::SameLine();
+        if (ImGui::Button("Rewind")) {
+            _sim.Post([this]() { restoreSnapshot(std::string(_checkpoint.begin(), _checkpoint.end())); });
+        }
+        ImGui::SameLine();
+        ImGui::Text("(turn %d)", world.checkpointTurn);
+    }
+    // replay seek: restores the nearest keyframe before the turn and re-simulates from it
+    if (!_seekDragging) _seekTurn = _currentTurn;
+    ImGui::SliderInt("Rewind to", &_seekTurn, 0, std::max(1, world.turn));
+    _seekDragging = ImGui::IsItemActive();
+    if (ImGui::IsItemDeactivatedAfterEdit() && _seekTurn < world.turn) {
+        int turn = _seekTurn;
+        _sim.Post([this, turn]() {
+            if (_recorder.Seek(_arena, turn)) syncRestoredTurn();
+        });
+    }
+    ImGui::Text("Replay: %u events, %zu bytes", world.replayEvents, world.replayBytes);
+    // remote spectators (astro_sim --spectate HOST:PORT); the server lives on the sim worker
+    if (ImGui::Checkbox("Broadcast", &_broadcasting)) {
+        bool on = _broadcasting;
+        uint16_t port = (uint16_t)_broadcastPort;
+        _sim.Post([this, on, port]() {
+            if (!on) {
+                _broadcast.Close();
+                return;
+            }
+            if (_broadcast.Listen(port)) _stream.Restart();
+        });
+    }
+    ImGui::SameLine();
+    if (_broadcasting) {
+        if (world.spectators >= 0) ImGui::Text("port %d, %d watching", _broadcastPort, world.spectators);
+        else ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "can't listen on port %d", _broadcastPort);
+    } else {
+        ImGui::SetNextItemWidth(100.0f);
+        if (ImGui::InputInt("Port", &_broadcastPort)) _broadcastPort = std::clamp(_broadcastPort, 1, 65535);
+    }
+    // ship bundles (astro_sim --export-ships): loaded ships replace the sample roster
+    ImGui::SetNextItemWidth(200.0f);
+    ImGui::InputText("##bundle", _bundlePath, sizeof(_bundlePath));
+    ImGui::SameLine();
+    if (ImGui::Button("Load Ships")) {
+        std::string error;
+        if (_ships.Load(_bundlePath, &error)) {
+            _bundleStatus.clear();
+            _restartPending = true;
+        } else {
+            _bundleStatus = error;
+        }
+    }
+    if (!_ships.Empty()) {
+        ImGui::SameLine();
+        ImGui::Text("%zu ships, %zu files", _ships.ShipCount(), _ships.Files().size());
+    }
+    if (!_bundleStatus.empty()) ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", _bundleStatus.c_str());
     ImGui::Separator();
-    for (size_t i = 0; i < _arena.ships.size(); ++i) {
-        const auto& s = _arena.ships[i];
+    for (size_t i = 0; i < world.ships.size(); ++i) {
+        const auto& s = world.ships[i];
         const char* name = s.ship ? s.ship->name.c_str() : "Ship";
         if (s.alive) {
             ImGui::TextColored(ImVec4(0.5f, 1.0f, 0.5f, 1.0f),
@@ -665,14 +693,93 @@ void AstroBots::DrawHUD() {
             ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
                              "%s: DESTROYED", name);
         }
+        if (i < world.vmCounters.size()) {
+            // runtime cost next to the static budget
+            const AstroVmCounters& c = world.vmCounters[i];
+            ImGui::SameLine();
+            ImGui::TextDisabled("cost %d, %.1f instr/turn, %llu scans, %llu raycasts", s.ship ? s.ship->script_cost : 0,
+                                c.InstructionsPerTurn(), (unsigned long long)c.scans, (unsigned long long)c.raycasts);
+        }
     }
     ImGui::Separator();
-    ImGui::Text("Asteroids: %d", (int)_arena.asteroids.size());
-    ImGui::Text("Torpedoes: %d", (int)_arena.torpedoes.size());
+    ImGui::Text("Asteroids: %d", (int)world.asteroids.size());
+    ImGui::Text("Torpedoes: %d", (int)world.torpedoes.size());
     ImGui::EndGroup();
 }
 
-void AstroBots::DrawDebugColliders(ImDrawList* drawList, ImVec2 offset) {
+// rolling p50/p99 of the last ASTRO_PROFILE_WINDOW turns and frames, under the HUD
+void AstroBots::DrawProfiler() {
+    ImGui::SetCursorPosX(10);
+    ImGui::BeginGroup();
+    if (ImGui::CollapsingHeader("Profiler")) {
+        if (!ASTRO_PROFILE_ENABLED) {
+            ImGui::TextDisabled("built without ASTRO_PROFILE");
+        } else if (ImGui::BeginTable("profiler_phases", 4, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("phase");
+            ImGui::TableSetupColumn("p50 us");
+            ImGui::TableSetupColumn("p99 us");
+            ImGui::TableSetupColumn("max us");
+            ImGui::TableHeadersRow();
+            // turn phases as of the published turn (the worker's profiler), frame sections from ours
+            const AstroProfiler& turns = view().turnProfile;
+            for (int i = 0; i < ASTRO_PHASE_COUNT; ++i) {
+                const AstroProfiler& from = i < ASTRO_PHASE_DRAW_ASTEROIDS ? turns : _profiler;
+                AstroProfiler::Summary s = from.Recent((AstroPhase)i);
+                if (s.samples == 0) continue;
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(AstroPhaseName((AstroPhase)i));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", s.p50Us);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", s.p99Us);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", s.maxUs);
+            }
+            ImGui::EndTable();
+        }
+    }
+    ImGui::EndGroup();
+}
+
+// what each tagged subsystem allocated since the match started (AstroMemory.h), under the profiler
+void AstroBots::DrawMemory() {
+    ImGui::SetCursorPosX(10);
+    ImGui::BeginGroup();
+    if (ImGui::CollapsingHeader("Memory")) {
+        if (!ASTRO_MEMORY_ENABLED) {
+            ImGui::TextDisabled("built without ASTRO_MEMORY");
+        } else if (ImGui::BeginTable("memory_tags", 5, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("subsystem");
+            ImGui::TableSetupColumn("allocs");
+            ImGui::TableSetupColumn("allocs/turn");
+            ImGui::TableSetupColumn("live KB");
+            ImGui::TableSetupColumn("peak KB");
+            ImGui::TableHeadersRow();
+            AstroMemoryStats since = AstroMemoryStats::Read().Since(_memoryAtStart);
+            const int turns = std::max(1, view().turn);
+            for (int t = 0; t < ASTRO_MEM_COUNT; ++t) {
+                const AstroMemoryStats::Tag& tag = since.tags[t];
+                if (tag.allocations == 0 && tag.liveBytes == 0) continue;
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(AstroMemTagName((AstroMemTag)t));
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)tag.allocations);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", (double)tag.allocations / turns);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", tag.liveBytes / 1024.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", tag.peakBytes / 1024.0);
+            }
+            ImGui::EndTable();
+        }
+    }
+    ImGui::EndGroup();
+}
+
+void AstroBots::DrawDebugColliders(ImDrawList* drawList) {
     // Colors
     ImU32 shipColor = IM_COL32(80, 255, 120, 180);
     ImU32 shipOutline = IM_COL32(30, 200, 90, 220);
@@ -681,20 +788,21 @@ void AstroBots::DrawDebugColliders(ImDrawList* drawList, ImVec2 offset) {
     ImU32 torpColor = IM_COL32(80, 180, 255, 200);
     ImU32 sweepColor = IM_COL32(80, 80, 255, 140);
 
-    const float scale = _arena.renderScale;
+    const AstroRenderState& world = view();
+    const float scale = _screen.scale;
 
     // Ships as capsules
-    for (const auto& s : _arena.ships) {
+    for (const auto& s : world.ships) {
         if (!s.alive) continue;
         // Match capsule used in collisions
         const float halfLen = 15.0f;
         const float radius = 7.5f;
+        float sx = s.x, sy = s.y;
+        if (!OnScreen(sx, sy, halfLen + radius)) continue;
         float ang = s.angle * (float)M_PI / 180.0f;
         float dx = std::cos(ang), dy = std::sin(ang);
-        ImVec2 a = WorldToScreen(s.x - dx * halfLen, s.y - dy * halfLen);
-        ImVec2 b = WorldToScreen(s.x + dx * halfLen, s.y + dy * halfLen);
-        a.x += offset.x; a.y += offset.y;
-        b.x += offset.x; b.y += offset.y;
+        ImVec2 a = WorldToScreen(sx - dx * halfLen, sy - dy * halfLen);
+        ImVec2 b = WorldToScreen(sx + dx * halfLen, sy + dy * halfLen);
         float rpx = radius * scale;
         // Thick line body approximating capsule hull
         drawList->AddLine(a, b, shipColor, rpx * 2.0f);
@@ -706,19 +814,18 @@ void AstroBots::DrawDebugColliders(ImDrawList* drawList, ImVec2 offset) {
     }
 
     // Asteroids as collision polys (local verts translated to world)
-    for (const auto& a : _arena.asteroids) {
-        if (!a.alive || a.shape.size() < 3) continue;
+    const AsteroidPool& asteroids = world.asteroids;
+    for (size_t ai = 0; ai < asteroids.size(); ++ai) {
+        const auto& outline = asteroids.Shape(ai).outline;
+        if (!asteroids.alive[ai] || outline.size() < 3) continue;
+        float ax = asteroids.x[ai], ay = asteroids.y[ai];
+        if (!OnScreen(ax, ay, 2.0f * asteroids.radius[ai])) continue;
         // Build points
-        std::vector<ImVec2> pts;
-        pts.reserve(a.shape.size());
-        for (const auto& v : a.shape) {
-            ImVec2 p = WorldToScreen(a.x + v.x, a.y + v.y);
-            p.x += offset.x; p.y += offset.y;
-            pts.push_back(p);
-        }
+        ImVec2 center = WorldToScreen(ax, ay);
+        std::vector<ImVec2>& pts = _points;
+        pts.resize(outline.size());
+        AstroTransformPoints(&outline[0].x, &pts[0].x, outline.size(), scale, center.x, center.y);
         // Triangulated fill to show region lightly
-        ImVec2 center = WorldToScreen(a.x, a.y);
-        center.x += offset.x; center.y += offset.y;
         for (size_t i = 0; i < pts.size(); ++i) {
             size_t j = (i + 1) % pts.size();
             drawList->AddTriangleFilled(center, pts[i], pts[j], IM_COL32(255, 180, 60, 40));
@@ -731,103 +838,80 @@ void AstroBots::DrawDebugColliders(ImDrawList* drawList, ImVec2 offset) {
     }
 
     // Torpedoes as circles + sweep segment (prev->curr)
-    for (const auto& t : _arena.torpedoes) {
+    for (const auto& t : world.torpedoes) {
         if (!t.alive) continue;
         float rad = 5.0f * scale;
-        ImVec2 p = WorldToScreen(t.x, t.y);
-        p.x += offset.x; p.y += offset.y;
+        float tx = t.x, ty = t.y;
+        if (!OnScreen(tx, ty, PHOTON_SPEED)) continue;
+        ImVec2 p = WorldToScreen(tx, ty);
         drawList->AddCircle(p, rad, torpColor, 24, 2.0f);
         // Sweep (for debugging TOI)
-        ImVec2 p0 = WorldToScreen(t.prevX, t.prevY);
-        p0.x += offset.x; p0.y += offset.y;
+        ImVec2 p0 = WorldToScreen(t.prevX + tx - t.x, t.prevY + ty - t.y);
         drawList->AddLine(p0, p, sweepColor, 1.5f);
     }
 }
 
-void AstroBots::endTurn() {
-    if (!_gameRunning) return;
-
-    _currentTurn++;
-
-    if (_currentTurn > ASTRO_MAX_TURNS) {
-        _gameRunning = false;
-        return;
-    }
-
-    // Start turn (reset cooldowns, etc.)
-    _arena.StartTurn();
-
-    // Each alive ship takes a turn
-    for (size_t i = 0; i < _arena.ships.size(); ++i) {
-        if (!_arena.ships[i].alive) continue;
-        _ships[i]->Run(_currentTurn);
-    }
-
-    // Update physics
-    _arena.UpdatePhysics();
-
-    // Handle collisions
-    _arena.HandleCollisions();
-    _arena.HandleTorpedoes();
-
-    // After handling torpedo collisions based on unwrapped motion, wrap torpedoes
-    for (auto& t : _arena.torpedoes) {
-        if (t.alive) {
-            _arena.WrapPosition(t.x, t.y);
-        }
-    }
-
-    // Clean up dead torpedoes, asteroids, and phaser beams
-    _arena.torpedoes.erase(
-        std::remove_if(_arena.torpedoes.begin(), _arena.torpedoes.end(),
-                      [](const PhotonTorpedo& t) { return !t.alive; }),
-        _arena.torpedoes.end()
-    );
-    _arena.asteroids.erase(
-        std::remove_if(_arena.asteroids.begin(), _arena.asteroids.end(),
-                      [](const Asteroid& a) { return !a.alive; }),
-        _arena.asteroids.end()
-    );
-    _arena.phaserBeams.erase(
-        std::remove_if(_arena.phaserBeams.begin(), _arena.phaserBeams.end(),
-                      [](const PhaserBeam& b) { return !b.alive; }),
-        _arena.phaserBeams.end()
-    );
-
-    // Maintain asteroid population by spawning from edges with a cooldown
-    if (_arena.edgeSpawnCooldown > 0) {
-        _arena.edgeSpawnCooldown--;
-    }
-    if (_arena.asteroids.size() < NUM_INITIAL_ASTEROIDS && _arena.edgeSpawnCooldown == 0) {
-        _arena.SpawnAsteroidFromEdge();
-        _arena.edgeSpawnCooldown = 60; // spawn at most every ~2 seconds (at 30Hz)
-    }
+void AstroBots::advance() {
+    if (!_view) return; // no match set up
+    // hot reload: a bundle rewritten on disk restarts the match with its new programs
+    auto now = std::chrono::steady_clock::now();
+    if (!_ships.Empty() && now >= _nextShipPoll) {
+        _nextShipPoll = now + std::chrono::seconds(1);
+        std::string error;
+        if (_ships.Poll(&error) > 0) _restartPending = true;
+        if (!error.empty()) _bundleStatus = error;
+    }
+    if (_restartPending) {
+        _restartPending = false;
+        setUpBoard();
+    }
+    _view = &_sim.Latest();
+    const AstroRenderState& world = *_view;
+    if (world.turn == _currentTurn && world.over == !_gameRunning) return;
+    _currentTurn = world.turn;
+    _gameOptions.currentTurnNo = world.turn;
+    _gameRunning = !world.over;
 
     // Update camera to follow action (center on average ship position)
     float avgX = 0, avgY = 0;
     int aliveCount = 0;
-    for (const auto& s : _arena.ships) {
+    for (const auto& s : world.ships) {
         if (s.alive) {
             avgX += s.x;
             avgY += s.y;
             aliveCount++;
         }
     }
-    if (aliveCount > 0) {
+    if (_followShips && aliveCount > 0) {
         _cameraX = avgX / aliveCount;
         _cameraY = avgY / aliveCount;
     }
 
-    // Check if game over
-    int alive = 0;
-    for (const auto& s : _arena.ships) {
-        if (s.alive) alive++;
+    // Game::endTurn() would allocate a Turn holding a stateString() every turn;
+    // _history keeps the turns instead
+    ClassGame::EndOfTurn();
+}
+
+// the frame's turn; before the first match there is nothing published, and an empty state
+const AstroRenderState& AstroBots::view() {
+    static const AstroRenderState empty;
+    if (!_view) return empty;
+    return *_view;
+}
+
+void AstroBots::endTurn() {
+    if (!_arena.Step()) {
+        _broadcast.Poll(); // late spectators still get the final turn
+        return;
     }
-    if (alive <= 1) {
-        _gameRunning = false;
+    _history.Record(_arena);
+    if (_arena.IsOver()) {
+        _recorder.Finish(_arena);
+    }
+    if (_broadcast.Listening()) {
+        bool key = _stream.Encode(_arena, _streamFrame);
+        _broadcast.Publish(_streamFrame, key);
     }
-
-    Game::endTurn();
 }
 
 bool AstroBots::actionForEmptyHolder(BitHolder &holder) {
@@ -843,26 +927,24 @@ bool AstroBots::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
 }
 
 void AstroBots::stopGame() {
+    _sim.Stop();
+    _view = nullptr;
     _gameRunning = false;
 
-    // Clear all arena state
-    _arena.torpedoes.clear();
-    _arena.phaserBeams.clear();
-    _arena.asteroids.clear();
-    _arena.signals.clear();
-    _arena.ships.clear();
-    _arena.particles.clear();
-
-    // Clear ship scripts
-    _ships.clear();
-    _logLines.clear();
+    // Clear all arena state and ship scripts
+    _arena.recorder = nullptr;
+    _arena.Reset();
+    _history.Clear();
+    _checkpoint.clear();
+    _eventLog.Clear();
 }
 
 Player* AstroBots::checkForWinner() {
     if (!_gameRunning) {
         int alive = 0;
-        for (size_t i = 0; i < _arena.ships.size(); ++i) {
-            if (_arena.ships[i].alive) {
+        const AstroRenderState& world = view();
+        for (size_t i = 0; i < world.ships.size(); ++i) {
+            if (world.ships[i].alive) {
                 alive++;
             }
         }
@@ -874,9 +956,10 @@ Player* AstroBots::checkForWinner() {
 }
 
 bool AstroBots::checkForDraw() {
-    if (!_gameRunning && _currentTurn >= ASTRO_MAX_TURNS) {
+    // the turn limit, or a stalemate called early (AstroArena::Stalemated())
+    if (!_gameRunning && (_currentTurn >= ASTRO_MAX_TURNS || view().stalemate)) {
         int alive = 0;
-        for (const auto& s : _arena.ships) {
+        for (const auto& s : view().ships) {
             if (s.alive) alive++;
         }
         return alive > 1;
@@ -889,15 +972,43 @@ std::string AstroBots::initialStateString() {
 }
 
 std::string AstroBots::stateString() {
+    // the GUI asks every frame: the sim worker builds the string once per published turn
+    // from the history record
+    const AstroRenderState& world = view();
+    if (!world.stateString.empty()) return world.stateString;
     std::stringstream ss;
-    ss << _currentTurn << ";";
-    for (const auto& s : _arena.ships) {
+    ss << world.turn << ";";
+    for (const auto& s : world.ships) {
         ss << s.x << "," << s.y << "," << s.vx << "," << s.vy << ","
            << s.angle << "," << s.hp << "," << s.fuel << "," << s.alive << ";";
     }
     return ss.str();
 }
 
+// s is a binary arena snapshot (AstroArena::SaveSnapshot), not the text form stateString() returns
 void AstroBots::setStateString(const std::string &s) {
-    // Not fully implemented - would need to restore full state
+    _sim.Post([this, s]() { restoreSnapshot(s); });
+}
+
+// on the sim worker (or with it stopped)
+void AstroBots::restoreSnapshot(const std::string& s) {
+    std::string error;
+    if (!_arena.LoadSnapshot((const uint8_t*)s.data(), s.size(), &error)) {
+        _arena.Log(ASTRO_LOG_RESTORE_FAILED, -1);
+        return;
+    }
+    // a snapshot from this match: what was recorded after it gets recorded again
+    _recorder.Truncate(_arena.turn);
+    syncRestoredTurn();
+    _arena.Log(ASTRO_LOG_RESTORED, -1, -1, _arena.turn);
+}
+
+// after the arena jumped to another turn (snapshot restore or replay seek), on the sim
+// worker; the frame side catches up from the state published after the command
+void AstroBots::syncRestoredTurn() {
+    // turns recorded after the snapshot no longer happened
+    _history.Clear();
+    _history.Record(_arena);
+    // spectators start over from a keyframe of the restored turn
+    _stream.Restart();
 }
@@ -7,115 +7,36 @@
 #include <functional>
 #include <vector>
 #include <cmath>
+#include <chrono>
 
 #include "AstroTypes.h"
 #include "AstroArena.h"
-
-// ===== ShipBase: tiny VM with space combat Domain-Specific Language =====
-struct ShipBase {
-    std::vector<int> code;
-    std::vector<float> floatParams; // for storing float parameters like thrust power
-    int script_cost = 0;
-    std::string name = "Ship";
-    struct IfContext { int jumpIfFalseIndex=-1; int jumpToEndIndex=-1; };
-    std::vector<IfContext> _ifCtx;
-
-   struct IfBlock {
-        ShipBase* self; IfBlock(ShipBase* s, AstroOpCode cond, int param): self(s){
-            self->code.push_back(cond); self->code.push_back(param);
-            self->code.push_back(ASTRO_OP_JUMP_IF_FALSE); self->code.push_back(0); // placeholder
-            ShipBase::IfContext ctx; ctx.jumpIfFalseIndex = (int)self->code.size()-1; ctx.jumpToEndIndex = -1;
-            self->_ifCtx.push_back(ctx);
-        }
-        ~IfBlock(){
-            if (!self->_ifCtx.empty()){
-                ShipBase::IfContext &ctx = self->_ifCtx.back();
-                // If no ELSE() was emitted, patch false-jump to end of IF block
-                if (ctx.jumpToEndIndex == -1){
-                    self->code[ctx.jumpIfFalseIndex] = (int)self->code.size();
-                }
-                self->_ifCtx.pop_back();
-            }
-        }
-        explicit operator bool() const { return true; }
-    };
-    struct ElseBlock {
-        ShipBase* self;
-        ElseBlock(ShipBase* s): self(s){
-            // Begin ELSE: jump over else body, patch IF's false to here
-            self->code.push_back(ASTRO_OP_JUMP); self->code.push_back(0); // placeholder to end of else
-            int jumpToEndIdx = (int)self->code.size()-1;
-            if (!self->_ifCtx.empty()){
-                ShipBase::IfContext &ctx = self->_ifCtx.back();
-                self->code[ctx.jumpIfFalseIndex] = (int)self->code.size(); // start of ELSE
-                ctx.jumpToEndIndex = jumpToEndIdx;
-            }
-        }
-        ~ElseBlock(){
-            if (!self->_ifCtx.empty()){
-                ShipBase::IfContext &ctx = self->_ifCtx.back();
-                if (ctx.jumpToEndIndex != -1){
-                    self->code[ctx.jumpToEndIndex] = (int)self->code.size(); // end of ELSE
-                }
-            }
-        }
-        explicit operator bool() const { return true; }
-    };
-
-    // DSL: bot coders will use these in SetupShip()
-    #define THRUST(P)    do{ code.push_back(ASTRO_OP_THRUST); code.push_back((int)((P)*10)); script_cost += ASTRO_COST_THRUST; }while(0)
-    #define TURN_DEG(D)  do{ code.push_back(ASTRO_OP_TURN_DEG); code.push_back((D)); script_cost += ASTRO_COST_TURN; }while(0)
-    #define FIRE_PHASER() do{ code.push_back(ASTRO_OP_FIRE_PHASER); script_cost += ASTRO_COST_PHASER; }while(0)
-    #define FIRE_PHOTON() do{ code.push_back(ASTRO_OP_FIRE_PHOTON); script_cost += ASTRO_COST_PHOTON; }while(0)
-    #define SCAN()       do{ code.push_back(ASTRO_OP_SCAN); script_cost += ASTRO_COST_SCAN; }while(0)
-    #define SIGNAL(V)    do{ code.push_back(ASTRO_OP_SIGNAL); code.push_back((V)); script_cost += ASTRO_COST_SIGNAL; }while(0)
-    #define WAIT_()      do{ code.push_back(ASTRO_OP_WAIT); script_cost += ASTRO_COST_WAIT; }while(0)
-    #define TURN_TO_SCAN() do{ code.push_back(ASTRO_OP_TURN_TO_SCAN); script_cost += ASTRO_COST_TURN; }while(0)
-
-    #define IF_SEEN()      if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SEEN, 0})
-    #define IF_SCAN_LE(R)  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SCAN_LE, (R)})
-    #define IF_SHIP_DAMAGED()   if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_DAMAGED, 0})
-    #define IF_SHIP_HP_LE(N)    if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_HP_LE, (N)})
-    #define IF_SHIP_FUEL_LE(N)  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_FUEL_LE, (N)})
-    #define IF_SHIP_CAN_FIRE_PHASER()  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_CAN_FIRE_PHASER, 0})
-    #define IF_SHIP_CAN_FIRE_PHOTON()  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_CAN_FIRE_PHOTON, 0})
-    #define ELSE() else if (ElseBlock _cb##__LINE__{this})
-
-    int Finalize() { code.push_back(ASTRO_OP_END); return script_cost; }
-
-    // hooks provided by Arena at runtime
-    AstroArena* A = nullptr;
-    int id = -1;
-    virtual int SetupShip() = 0; // bot coders will implement this
-    virtual ~ShipBase() = default;
-
-    // interpreter
-    void Run(int turn);
-};
-
-// ===== Sample ships =====
-struct HunterShip : ShipBase {
-    HunterShip() { name = "Hunter"; }
-    int SetupShip() override;
-};
-
-struct DroneShip : ShipBase {
-    DroneShip() { name = "Drone"; }
-    int SetupShip() override;
-};
-
-struct MinerShip : ShipBase {
-    MinerShip() { name = "Miner"; }
-    int SetupShip() override;
-};
-
-struct GraemeShip : ShipBase {
-    GraemeShip() { name = "Graeme"; }
-    int SetupShip() override;
-};
-struct MandeezShip : ShipBase {
-    MandeezShip() { name = "Mandeez"; }
-    int SetupShip() override;
+#include "AstroShips.h"
+#include "AstroHistory.h"
+#include "AstroReplay.h"
+#include "AstroShipBundle.h"
+#include "AstroProfile.h"
+#include "AstroSimThread.h"
+#include "AstroStream.h"
+#include "AstroEffects.h"
+
+// ===== Viewer camera and level of detail =====
+static constexpr float ASTRO_MAX_ZOOM = 16.0f;          // 1 = the whole arena fits the window
+static constexpr float ASTRO_LOD_DETAIL_SCALE = 0.2f;   // pixels per world unit below which torpedoes are dots and particles one line
+static constexpr float ASTRO_LOD_ASTEROID_PX = 4.0f;    // asteroids smaller than this on screen are outline only
+
+// The log window keeps a whole match for post-mortems: entries are 32 bytes each in the
+// ring and only the rows in view are ever formatted, so the size costs nothing per frame
+static constexpr size_t ASTRO_VIEWER_LOG_CAPACITY = 1 << 17;
+
+// screen = world * scale + offset, with the camera, zoom and window origin folded in;
+// set once per frame by AstroBots::UpdateCamera
+struct AstroViewTransform {
+    float scale = 1.0f;   // screen pixels per world unit
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+
+    ImVec2 Apply(float x, float y) const { return ImVec2(x * scale + offsetX, y * scale + offsetY); }
 };
 
 // ===== Main game class =====
@@ -127,7 +48,10 @@ public:
 
     void setUpBoard() override;
     void drawFrame() override;
+    // one turn; the sim worker calls this (AstroSimThread), not the frame loop
     void endTurn() override;
+    // once per frame, before drawFrame(): picks up the newest turn the sim worker published
+    void advance();
 
     bool canBitMoveFrom(Bit &bit, BitHolder &src) override;
     bool canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
@@ -145,28 +69,69 @@ public:
     Grid* getGrid() override { return nullptr; } // No grid in AstroBots
 
 private:
-    void DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship, ImVec2 offset);
-    void DrawAsteroid(ImDrawList* drawList, const Asteroid& asteroid, ImVec2 offset);
-    void DrawTorpedo(ImDrawList* drawList, const PhotonTorpedo& torpedo, ImVec2 offset);
-    void DrawPhaserBeam(ImDrawList* drawList, const PhaserBeam& beam, ImVec2 offset);
-    void DrawParticles(ImDrawList* drawList, const std::vector<Particle>& particles, ImVec2 offset);
-    void DrawShipDebris(ImDrawList* drawList, const std::vector<ShipDebrisSegment>& debris, ImVec2 offset);
+    void DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship);
+    void DrawAsteroid(ImDrawList* drawList, const AsteroidPool& asteroids, size_t index, float lag = 0.0f);
+    void DrawTorpedo(ImDrawList* drawList, const PhotonTorpedo& torpedo);
+    void DrawPhaserBeam(ImDrawList* drawList, const PhaserBeam& beam);
+    void DrawParticles(ImDrawList* drawList, const ParticlePool& particles);
+    void DrawShipDebris(ImDrawList* drawList, const decltype(AstroArena::shipDebris)& debris);
     void DrawHUD();
-    void DrawDebugColliders(ImDrawList* drawList, ImVec2 offset);
-    ImVec2 WorldToScreen(float x, float y);
+    void DrawProfiler();
+    void DrawMemory();
+    void DrawDebugColliders(ImDrawList* drawList);
+    void DrawBackground(ImDrawList* drawList, ImVec2 origin, ImVec2 size);
+    void UpdateCamera(ImVec2 origin, ImVec2 size, float fitScale);
+    ImVec2 WorldToScreen(float x, float y) const { return _screen.Apply(x, y); }
+    bool OnScreen(float& x, float& y, float radius, float padPx = 0.0f) const;
+    void syncRestoredTurn();
+    void restoreSnapshot(const std::string& snapshot);
+    const AstroRenderState& view();
 
     std::vector<std::unique_ptr<ShipBase>> makeShips();
 
+    // owned by the sim worker while a match runs: touched only from endTurn() and
+    // commands posted to _sim
     AstroArena _arena;
-    std::vector<std::unique_ptr<ShipBase>> _ships;
-    std::vector<std::string> _logLines;
+    AstroHistory _history;          // recent turns, recorded by endTurn
+    AstroReplayRecorder _recorder;  // events of the current match, with seek keyframes
+    std::vector<uint8_t> _checkpoint; // arena snapshot for Rewind
+    int _checkpointTurn = 0;
+    AstroProfiler _turnProfiler;    // turn phases, via _arena.profiler
+    AstroStreamEncoder _stream;     // Broadcast: every turn for spectators...
+    AstroStreamServer _broadcast;   // ...published to whoever is connected
+    std::vector<uint8_t> _streamFrame;
+
+    // frame side
+    const AstroRenderState* _view = nullptr; // this frame's turn, from _sim
+    int _seekTurn = 0;              // "Rewind to" slider value while dragging
+    bool _seekDragging = false;
+    AstroLogRing _eventLog{ ASTRO_VIEWER_LOG_CAPACITY }; // arena log, formatted only for visible rows
     bool _logAutoScroll = true;
     bool _showColliders = false;
+    bool _broadcasting = false;     // Broadcast checkbox
+    int _broadcastPort = ASTRO_STREAM_DEFAULT_PORT;
+    AstroProfiler _profiler;        // frame sections
+    AstroMemoryStats _memoryAtStart; // counters when the match started, for the Memory panel
+    AstroViewTransform _screen;     // world to screen, this frame
+    std::vector<ImVec2> _points;    // scratch: one asteroid's outline on screen
+    AstroEffectBatch _effects;      // this frame's particles, debris and torpedoes for the GPU
+    bool _gpuEffects = true;        // draw them instanced when the backend can
+    bool _effectsThisFrame = false; // ...and it can this frame
+    AstroShipRegistry _ships;       // bundles loaded from the HUD; the roster when not empty
+    char _bundlePath[256] = "ships.bundle";
+    std::string _bundleStatus;      // why the last load or reload failed
+    bool _restartPending = false;   // set up the board again on the next advance()
+    std::chrono::steady_clock::time_point _nextShipPoll{};
     int _currentTurn;
     bool _gameRunning;
 
-    // Camera/viewport
+    // Camera/viewport: the world point at the window's center, on the torus
     float _cameraX = ASTROBOTS_W / 2.0f;
     float _cameraY = ASTROBOTS_H / 2.0f;
     float _zoom = 1.0f;
+    bool _followShips = false;      // keep the camera on the ships' average position
+    float _viewHalfW = ASTROBOTS_W / 2.0f; // world units visible either side of the camera this frame
+    float _viewHalfH = ASTROBOTS_H / 2.0f;
+
+    AstroSimThread _sim;            // last, so it stops before the state it plays goes away
 };
@@ -0,0 +1,332 @@
+#include "AstroBroadphase.h"
+#include "AstroArena.h"
+
+#include <algorithm>
+#include <cmath>
+
+// ===== Shared helpers =====
+static float Reach(const c2AABB& b, float x, float y) {
+    return std::max(std::max(x - b.min.x, b.max.x - x), std::max(y - b.min.y, b.max.y - y));
+}
+
+static bool Overlaps(const c2AABB& a, const c2AABB& b) {
+    return a.max.x >= b.min.x && a.min.x <= b.max.x && a.max.y >= b.min.y && a.min.y <= b.max.y;
+}
+
+void AstroBroadphase::Collect(const c2AABB& box, float pad, AstroBroadphaseHits& out) const {
+    out.ships.clear();
+    out.asteroids.clear();
+    auto add = [&](AstroBodyKind kind, int index) {
+        (kind == ASTRO_BODY_SHIP ? out.ships : out.asteroids).push_back(index);
+    };
+    VisitBox(box, pad, add);
+    for (std::vector<int>* list : { &out.ships, &out.asteroids }) {
+        std::sort(list->begin(), list->end());
+        list->erase(std::unique(list->begin(), list->end()), list->end());
+    }
+}
+
+// ===== Uniform grid =====
+// cellOf(i) returns the cell object i goes in, -1 to leave it out
+template <typename CellOf>
+static void BinObjects(int cells, size_t count, CellOf cellOf, AstroGridBroadphase::CellBins& bins) {
+    bins.start.assign(cells + 1, 0);
+    bins.cellOf.resize(count);
+    // count per cell, shifted by one so the prefix sum below leaves each cell's start in place
+    for (size_t i = 0; i < count; ++i) {
+        int idx = cellOf(i);
+        bins.cellOf[i] = idx;
+        if (idx >= 0) bins.start[idx + 1]++;
+    }
+    for (int c = 0; c < cells; ++c) {
+        bins.start[c + 1] += bins.start[c];
+    }
+    bins.items.resize(bins.start[cells]);
+    // scatter in index order; start[c] walks up to the old start[c + 1], then shift back
+    for (size_t i = 0; i < count; ++i) {
+        int idx = bins.cellOf[i];
+        if (idx >= 0) bins.items[bins.start[idx]++] = (int)i;
+    }
+    for (int c = cells; c > 0; --c) {
+        bins.start[c] = bins.start[c - 1];
+    }
+    bins.start[0] = 0;
+}
+
+// Cells along one axis whose centres can lie in [lo, hi] on a torus of the given extent:
+// one range, or two when the interval runs past an edge. Returns the number of ranges.
+static int CellRanges(float lo, float hi, float cell, int count, float extent, int (&first)[2], int (&last)[2]) {
+    if (hi - lo >= extent) {
+        first[0] = 0; last[0] = count - 1;
+        return 1;
+    }
+    float shift = std::floor(lo / extent) * extent;
+    lo -= shift;
+    hi -= shift;
+    auto cellOf = [&](float v) { return std::clamp((int)std::floor(v / cell), 0, count - 1); };
+    first[0] = cellOf(lo);
+    if (hi < extent) {
+        last[0] = cellOf(hi);
+        return 1;
+    }
+    last[0] = count - 1;
+    first[1] = 0; last[1] = cellOf(hi - extent);
+    return 2;
+}
+
+void AstroGridBroadphase::Build(const AstroArena& arena) {
+    _worldW = arena.config.width;
+    _worldH = arena.config.height;
+    _cols = (int)std::ceil(_worldW / (float)_cellSize);
+    _rows = (int)std::ceil(_worldH / (float)_cellSize);
+    auto cellAt = [this](float x, float y) {
+        int cx = (int)std::floor(x / (float)_cellSize);
+        int cy = (int)std::floor(y / (float)_cellSize);
+        cx = ((cx % _cols) + _cols) % _cols;
+        cy = ((cy % _rows) + _rows) % _rows;
+        return cy * _cols + cx;
+    };
+    const auto& ships = arena.ships;
+    const auto& asteroids = arena.asteroids;
+    _reach = 0;
+    int cells = _cols * _rows;
+    BinObjects(cells, asteroids.size(), [&](size_t i) {
+        if (!asteroids.alive[i]) return -1;
+        _reach = std::max(_reach, Reach(arena.asteroidBounds[i], asteroids.x[i], asteroids.y[i]));
+        return cellAt(asteroids.x[i], asteroids.y[i]);
+    }, _asteroids);
+    BinObjects(cells, ships.size(), [&](size_t i) {
+        if (!ships[i].alive) return -1;
+        _reach = std::max(_reach, Reach(arena.shipBounds[i], ships[i].x, ships[i].y));
+        return cellAt(ships[i].x, ships[i].y);
+    }, _ships);
+}
+
+void AstroGridBroadphase::VisitCells(float x0, float y0, float x1, float y1, Visitor visit) const {
+    if (_cols <= 0 || _rows <= 0) return;
+    int cx0[2], cx1[2], cy0[2], cy1[2];
+    int nx = CellRanges(x0, x1, (float)_cellSize, _cols, _worldW, cx0, cx1);
+    int ny = CellRanges(y0, y1, (float)_cellSize, _rows, _worldH, cy0, cy1);
+    for (int j = 0; j < ny; ++j) {
+        for (int cy = cy0[j]; cy <= cy1[j]; ++cy) {
+            for (int i = 0; i < nx; ++i) {
+                for (int cx = cx0[i]; cx <= cx1[i]; ++cx) {
+                    int cell = cy * _cols + cx;
+                    for (int si : _ships.Cell(cell)) visit(ASTRO_BODY_SHIP, si);
+                    for (int ai : _asteroids.Cell(cell)) visit(ASTRO_BODY_ASTEROID, ai);
+                }
+            }
+        }
+    }
+}
+
+void AstroGridBroadphase::VisitBox(const c2AABB& box, float pad, Visitor visit) const {
+    // objects are binned by centre: anything within pad of the box has its centre within
+    // reach + pad of it
+    const float grow = _reach + pad;
+    VisitCells(box.min.x - grow, box.min.y - grow, box.max.x + grow, box.max.y + grow, visit);
+}
+
+void AstroGridBroadphase::VisitCentres(const c2AABB& box, Visitor visit) const {
+    VisitCells(box.min.x, box.min.y, box.max.x, box.max.y, visit);
+}
+
+// ===== Signal bins =====
+void AstroSignalBins::Build(const AstroArena& arena) {
+    _worldW = arena.config.width;
+    _worldH = arena.config.height;
+    _cols = (int)std::ceil(_worldW / (float)_cellSize);
+    _rows = (int)std::ceil(_worldH / (float)_cellSize);
+    const auto& signals = arena.heardSignals;
+    BinObjects(_cols * _rows, signals.size(), [&](size_t i) {
+        int cx = (int)std::floor(signals[i].x / (float)_cellSize);
+        int cy = (int)std::floor(signals[i].y / (float)_cellSize);
+        cx = ((cx % _cols) + _cols) % _cols;
+        cy = ((cy % _rows) + _rows) % _rows;
+        return cy * _cols + cx;
+    }, _bins);
+}
+
+void AstroSignalBins::VisitCentres(const c2AABB& box, AstroBroadphase::Visitor visit) const {
+    if (_cols <= 0 || _rows <= 0 || _bins.items.empty()) return;
+    int cx0[2], cx1[2], cy0[2], cy1[2];
+    int nx = CellRanges(box.min.x, box.max.x, (float)_cellSize, _cols, _worldW, cx0, cx1);
+    int ny = CellRanges(box.min.y, box.max.y, (float)_cellSize, _rows, _worldH, cy0, cy1);
+    for (int j = 0; j < ny; ++j) {
+        for (int cy = cy0[j]; cy <= cy1[j]; ++cy) {
+            for (int i = 0; i < nx; ++i) {
+                for (int cx = cx0[i]; cx <= cx1[i]; ++cx) {
+                    for (int si : _bins.Cell(cy * _cols + cx)) visit(ASTRO_BODY_SIGNAL, si);
+                }
+            }
+        }
+    }
+}
+
+// ===== Loose quadtree =====
+// 16 bits of x and y interleaved, y above x at every level, so the top two bits of the
+// code are the root quadrant in child order, the next two the quadrant below that, and so on
+static uint32_t MortonCode(float x, float y, float scale) {
+    auto spread = [](uint32_t v) {
+        v = (v | (v << 8)) & 0x00ff00ffu;
+        v = (v | (v << 4)) & 0x0f0f0f0fu;
+        v = (v | (v << 2)) & 0x33333333u;
+        v = (v | (v << 1)) & 0x55555555u;
+        return v;
+    };
+    uint32_t qx = (uint32_t)std::clamp((int)(x * scale), 0, 0xffff);
+    uint32_t qy = (uint32_t)std::clamp((int)(y * scale), 0, 0xffff);
+    return spread(qx) | (spread(qy) << 1);
+}
+
+void AstroQuadtreeBroadphase::Build(const AstroArena& arena) {
+    _worldW = arena.config.width;
+    _worldH = arena.config.height;
+    const float scale = 65536.0f / std::max(_worldW, _worldH);
+    const auto& ships = arena.ships;
+    const auto& asteroids = arena.asteroids;
+    _scratch.clear();
+    _keys.clear();
+    auto add = [&](const c2AABB& b, float x, float y, AstroBodyKind kind, size_t i) {
+        _keys.push_back(((uint64_t)MortonCode(x, y, scale) << 32) | (uint32_t)_scratch.size());
+        _scratch.push_back({ b, x, y, kind, (int)i });
+    };
+    for (size_t i = 0; i < ships.size(); ++i) {
+        if (ships[i].alive) add(arena.shipBounds[i], ships[i].x, ships[i].y, ASTRO_BODY_SHIP, i);
+    }
+    for (size_t i = 0; i < asteroids.size(); ++i) {
+        if (asteroids.alive[i]) add(arena.asteroidBounds[i], asteroids.x[i], asteroids.y[i], ASTRO_BODY_ASTEROID, i);
+    }
+    // Morton order puts every node's items in one contiguous run: LSD radix sort on the
+    // code, a byte per pass
+    _sortBuffer.resize(_keys.size());
+    for (int shift = 32; shift < 64; shift += 8) {
+        size_t count[257] = {};
+        for (uint64_t k : _keys) count[((k >> shift) & 0xff) + 1]++;
+        for (int d = 0; d < 256; ++d) count[d + 1] += count[d];
+        for (uint64_t k : _keys) _sortBuffer[count[(k >> shift) & 0xff]++] = k;
+        _keys.swap(_sortBuffer);
+    }
+    _items.resize(_scratch.size());
+    for (size_t i = 0; i < _keys.size(); ++i) _items[i] = _scratch[(uint32_t)_keys[i]];
+
+    _nodes.clear();
+    if (_items.empty()) return;
+    Node root;
+    root.end = (int)_items.size();
+    _nodes.push_back(root);
+    Split(0, 0);
+}
+
+void AstroQuadtreeBroadphase::Split(int node, int depth) {
+    const int begin = _nodes[node].begin, end = _nodes[node].end;
+    if (end - begin > ASTRO_QUADTREE_LEAF_ITEMS && depth < ASTRO_QUADTREE_MAX_DEPTH) {
+        // the quadrant at this depth is two bits of the code, which only grows along the run
+        const int shift = 62 - 2 * depth;
+        auto quadrant = [&](int i) { return (int)((_keys[i] >> shift) & 3); };
+        int runs[5] = { begin, 0, 0, 0, end };
+        for (int k = 1; k < 4; ++k) {
+            int lo = runs[k - 1], hi = end;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (quadrant(mid) < k) lo = mid + 1;
+                else hi = mid;
+            }
+            runs[k] = lo;
+        }
+        // only quadrants something landed in get a node
+        const int child = (int)_nodes.size();
+        int count = 0;
+        for (int k = 0; k < 4; ++k) {
+            if (runs[k] == runs[k + 1]) continue;
+            Node c;
+            c.begin = runs[k];
+            c.end = runs[k + 1];
+            _nodes.push_back(c);
+            ++count;
+        }
+        // everything fell in one quadrant: keep going down without a node for this level
+        if (count > 1) {
+            _nodes[node].firstChild = child;
+            _nodes[node].childCount = count;
+            for (int c = child; c < child + count; ++c) Split(c, depth + 1);
+            Node& n = _nodes[node];
+            n.bounds = _nodes[child].bounds;
+            n.centres = _nodes[child].centres;
+            for (int c = child + 1; c < child + count; ++c) {
+                n.bounds.min = c2Minv(n.bounds.min, _nodes[c].bounds.min);
+                n.bounds.max = c2Maxv(n.bounds.max, _nodes[c].bounds.max);
+                n.centres.min = c2Minv(n.centres.min, _nodes[c].centres.min);
+                n.centres.max = c2Maxv(n.centres.max, _nodes[c].centres.max);
+            }
+            return;
+        }
+        _nodes.pop_back();
+        Split(node, depth + 1);
+        return;
+    }
+    Node& n = _nodes[node];
+    n.bounds = _items[begin].bounds;
+    n.centres.min = n.centres.max = c2V(_items[begin].cx, _items[begin].cy);
+    for (int i = begin + 1; i < end; ++i) {
+        const Item& it = _items[i];
+        n.bounds.min = c2Minv(n.bounds.min, it.bounds.min);
+        n.bounds.max = c2Maxv(n.bounds.max, it.bounds.max);
+        n.centres.min = c2Minv(n.centres.min, c2V(it.cx, it.cy));
+        n.centres.max = c2Maxv(n.centres.max, c2V(it.cx, it.cy));
+    }
+}
+
+// hit(item, q) for every item in a leaf whose box (by centres or by bounds) meets q, for
+// each whole-world copy of box that meets the root: items sit at their wrapped
+// positions, so the query moves to meet each copy instead
+template <bool ByCentre, typename Hit>
+void AstroQuadtreeBroadphase::Walk(const c2AABB& box, Hit hit) const {
+    if (_nodes.empty()) return;
+    auto nodeBox = [](const Node& n) -> const c2AABB& { return ByCentre ? n.centres : n.bounds; };
+    for (int oy = -1; oy <= 1; ++oy) {
+        for (int ox = -1; ox <= 1; ++ox) {
+            c2AABB q;
+            q.min = c2V(box.min.x - ox * _worldW, box.min.y - oy * _worldH);
+            q.max = c2V(box.max.x - ox * _worldW, box.max.y - oy * _worldH);
+            if (!Overlaps(q, nodeBox(_nodes[0]))) continue;
+            // each pop pushes at most four and the tree is at most MAX_DEPTH + 1 levels deep
+            int stack[3 * (ASTRO_QUADTREE_MAX_DEPTH + 1) + 1];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0) {
+                const Node& n = _nodes[stack[--top]];
+                if (n.firstChild < 0) {
+                    for (int i = n.begin; i < n.end; ++i) hit(_items[i], q);
+                    continue;
+                }
+                for (int c = n.firstChild; c < n.firstChild + n.childCount; ++c) {
+                    if (Overlaps(q, nodeBox(_nodes[c]))) stack[top++] = c;
+                }
+            }
+        }
+    }
+}
+
+void AstroQuadtreeBroadphase::VisitBox(const c2AABB& box, float pad, Visitor visit) const {
+    c2AABB grown;
+    grown.min = c2V(box.min.x - pad, box.min.y - pad);
+    grown.max = c2V(box.max.x + pad, box.max.y + pad);
+    Walk<false>(grown, [&](const Item& it, const c2AABB& q) {
+        if (Overlaps(it.bounds, q)) visit(it.kind, it.index);
+    });
+}
+
+void AstroQuadtreeBroadphase::VisitCentres(const c2AABB& box, Visitor visit) const {
+    Walk<true>(box, [&](const Item& it, const c2AABB& q) {
+        if (it.cx >= q.min.x && it.cx <= q.max.x && it.cy >= q.min.y && it.cy <= q.max.y) visit(it.kind, it.index);
+    });
+}
+
+std::unique_ptr<AstroBroadphase> AstroMakeBroadphase(const AstroArenaConfig& config, size_t shipCount) {
+    switch (config.broadphase) {
+        case ASTRO_BROADPHASE_QUADTREE: return std::make_unique<AstroQuadtreeBroadphase>();
+        case ASTRO_BROADPHASE_GRID:
+        default: return std::make_unique<AstroGridBroadphase>(config.CellSizeFor(shipCount));
+    }
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "AstroTypes.h"
+
+struct AstroArena;
+
+// ===== Broadphase =====
+// Finds the ships and asteroids near a box on the torus, so collisions, torpedoes, scans
+// and phasers only run narrowphase against those. AstroArena builds one per match from
+// AstroArenaConfig::broadphase and rebuilds it whenever worldEpoch moves. Queries are
+// conservative: they may return objects that turn out to be out of reach, never miss one
+// that isn't, so which broadphase an arena uses changes how long a turn takes, not what
+// happens in it. Queries are const and safe to run from several threads between builds.
+enum AstroBodyKind : uint8_t {
+    ASTRO_BODY_SHIP = 0,
+    ASTRO_BODY_ASTEROID,
+    ASTRO_BODY_SIGNAL,  // AstroSignalBins only; broadphases never visit one
+};
+
+// longest stretch a long query (a phaser ray, a scan out to its range) asks for at once,
+// so it can stop at the first piece that settles it
+static constexpr float ASTRO_BROADPHASE_STEP = 128.0f;
+
+// candidates sorted by index, each once: the order hits are resolved in
+struct AstroBroadphaseHits {
+    std::vector<int> ships;
+    std::vector<int> asteroids;
+};
+
+class AstroBroadphase {
+public:
+    // non-owning callable, so queries don't allocate
+    class Visitor {
+    public:
+        template <typename F>
+        Visitor(F& f) : _ctx(&f), _call([](void* ctx, AstroBodyKind kind, int index) { (*(F*)ctx)(kind, index); }) {}
+        void operator()(AstroBodyKind kind, int index) const { _call(_ctx, kind, index); }
+    private:
+        void* _ctx;
+        void (*_call)(void*, AstroBodyKind, int);
+    };
+
+    virtual ~AstroBroadphase() = default;
+    virtual const char* Name() const = 0;
+    // Indexes the live ships and asteroids at their current positions, using the bounds
+    // the arena keeps next to them (shipBounds, asteroidBounds), which have to be current.
+    virtual void Build(const AstroArena& arena) = 0;
+    // Visits every live object whose bounds, or one of their whole-world copies, come
+    // within pad of box. box is in unwrapped world coordinates and may reach past the
+    // edges. An object can be visited more than once, in no particular order.
+    virtual void VisitBox(const c2AABB& box, float pad, Visitor visit) const = 0;
+    // Visits every live object whose centre, or the centre of one of its copies, lies in
+    // box (same rules otherwise); for queries about positions rather than shapes.
+    virtual void VisitCentres(const c2AABB& box, Visitor visit) const = 0;
+
+    // VisitBox() sorted by index with duplicates dropped, for callers whose results depend
+    // on the order they see candidates in
+    void Collect(const c2AABB& box, float pad, AstroBroadphaseHits& out) const;
+};
+
+// ===== Uniform grid =====
+// One cell size for the whole world: objects are binned by centre, and a query reads the
+// cells its box covers once grown by the reach of the largest object.
+// Cheapest to build and query while objects are spread out; a cluster piles hundreds of
+// objects into the few cells every query around it reads.
+class AstroGridBroadphase : public AstroBroadphase {
+public:
+    explicit AstroGridBroadphase(int cellSize) : _cellSize(cellSize) {}
+    const char* Name() const override { return "grid"; }
+    void Build(const AstroArena& arena) override;
+    void VisitBox(const c2AABB& box, float pad, Visitor visit) const override;
+    void VisitCentres(const c2AABB& box, Visitor visit) const override;
+
+    // One object kind binned by counting sort into a single index array: cell c owns
+    // items[start[c] .. start[c + 1]), in ascending object index. Storage is reused
+    // between rebuilds, so a rebuild doesn't allocate once the arena has warmed up.
+    struct CellBins {
+        std::vector<int> start;  // cols * rows + 1 offsets into items
+        std::vector<int> items;  // object indices grouped by cell
+        std::vector<int> cellOf; // scratch: cell of each object, -1 if not binned
+        std::span<const int> Cell(int c) const {
+            return { items.data() + start[c], (size_t)(start[c + 1] - start[c]) };
+        }
+    };
+
+private:
+    void VisitCells(float x0, float y0, float x1, float y1, Visitor visit) const;
+
+    int _cellSize;
+    int _cols = 0, _rows = 0;
+    float _worldW = 0, _worldH = 0;
+    float _reach = 0; // largest distance from an object's centre to the edge of its bounds
+    CellBins _ships, _asteroids;
+};
+
+// ===== Loose quadtree =====
+// Splits only where objects are: a node holding more than ASTRO_QUADTREE_LEAF_ITEMS
+// centres hands them to its quadrants, so a dense cluster ends up in many small leaves
+// and empty space in none. Loose: each node's box is fitted to the bounds of everything
+// under it rather than to its quadrant, so objects never straddle siblings and a query
+// skips any node its box misses. Items are sorted along a Morton curve of their centres,
+// so a rebuild is a radix sort and every node owns one contiguous run of them.
+static constexpr int ASTRO_QUADTREE_LEAF_ITEMS = 8;
+static constexpr int ASTRO_QUADTREE_MAX_DEPTH = 12;
+
+class AstroQuadtreeBroadphase : public AstroBroadphase {
+public:
+    const char* Name() const override { return "quadtree"; }
+    void Build(const AstroArena& arena) override;
+    void VisitBox(const c2AABB& box, float pad, Visitor visit) const override;
+    void VisitCentres(const c2AABB& box, Visitor visit) const override;
+
+private:
+    struct Item {
+        c2AABB bounds;
+        float cx, cy;
+        AstroBodyKind kind;
+        int index;
+    };
+    struct Node {
+        c2AABB bounds{};         // union of the bounds of every item under the node
+        c2AABB centres{};        // box around their centres
+        int firstChild = -1;     // childCount consecutive nodes, -1 for a leaf
+        int childCount = 0;      // quadrants with anything in them, 2 to 4
+        int begin = 0, end = 0;  // items[begin .. end) under the node
+    };
+    void Split(int node, int depth);
+    template <bool ByCentre, typename Hit>
+    void Walk(const c2AABB& box, Hit hit) const;
+
+    float _worldW = 0, _worldH = 0;
+    std::vector<Item> _items;          // in Morton order once built
+    std::vector<Node> _nodes;          // _nodes[0] is the root
+    std::vector<uint64_t> _keys;       // Morton code << 32 | index into _scratch, sorted
+    std::vector<uint64_t> _sortBuffer; // radix sort scratch
+    std::vector<Item> _scratch;        // items in arena order, before sorting
+};
+
+std::unique_ptr<AstroBroadphase> AstroMakeBroadphase(const AstroArenaConfig& config, size_t shipCount);
+
+// ===== Signal bins =====
+// Last turn's signals (AstroArena::heardSignals) binned by position on the uniform grid's
+// cells, the way AstroGridBroadphase bins centres, whichever broadphase indexes the bodies:
+// signals are points that appear once a turn, so they get a grid of their own rather than
+// a place in the broadphase. A ship listening reads the cells around it, so a fleet
+// listening costs about the signals per cell per ship rather than every signal per ship.
+class AstroSignalBins {
+public:
+    void SetCellSize(int cellSize) { _cellSize = cellSize; }
+    void Build(const AstroArena& arena);
+    // Visits, as ASTRO_BODY_SIGNAL, every signal whose position or one of its whole-world
+    // copies lies in box (unwrapped world coordinates, may reach past the edges)
+    void VisitCentres(const c2AABB& box, AstroBroadphase::Visitor visit) const;
+
+private:
+    int _cellSize = 128;
+    int _cols = 0, _rows = 0;
+    float _worldW = 0, _worldH = 0;
+    AstroGridBroadphase::CellBins _bins;
+};
@@ -0,0 +1,168 @@
+#include "AstroBytecode.h"
+
+// ===== Verifier =====
+bool AstroVerifyBytecode(const std::vector<int>& code, std::string* error) {
+    auto fail = [error](const std::string& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+    const int n = (int)code.size();
+    if (n == 0) return fail("empty program");
+
+    std::vector<bool> isStart(n + 1, false);
+    std::vector<std::pair<int, int>> jumps; // (pc, target)
+    int last = -1;
+    for (int pc = 0; pc < n; ) {
+        int op = code[pc];
+        if (op < 0 || op >= ASTRO_OP_COUNT) {
+            return fail("unknown opcode " + std::to_string(op) + " at " + std::to_string(pc));
+        }
+        int operands = AstroOperandCount(op);
+        if (pc + operands >= n && operands) {
+            return fail("missing operand at " + std::to_string(pc));
+        }
+        isStart[pc] = true;
+        if (op == ASTRO_OP_JUMP || op == ASTRO_OP_JUMP_IF_FALSE) {
+            jumps.emplace_back(pc, code[pc + 1]);
+        }
+        last = pc;
+        pc += 1 + operands;
+    }
+    isStart[n] = true;
+    for (const auto& j : jumps) {
+        int pc = j.first, tgt = j.second;
+        if (tgt < 0 || tgt > n || !isStart[tgt]) {
+            return fail("jump at " + std::to_string(pc) + " to " + std::to_string(tgt) + " is not an instruction");
+        }
+        // forward-only control flow means the program counter strictly increases: it always ends
+        if (tgt <= pc) {
+            return fail("backward jump at " + std::to_string(pc) + " may never terminate");
+        }
+    }
+    if (code[last] != ASTRO_OP_END) return fail("program does not end with END");
+    return true;
+}
+
+int AstroScriptCost(const std::vector<int>& code) {
+    int cost = 0;
+    for (size_t pc = 0; pc < code.size(); pc += 1 + AstroOperandCount(code[pc])) cost += AstroOpCost(code[pc]);
+    return cost;
+}
+
+// ===== Optimizer =====
+namespace {
+
+// Scan() only looks at ship/asteroid positions and liveness. Within one ship's run
+// those only change when its phaser kills a ship or breaks an asteroid: thrust and
+// turns act on velocity/heading (positions move in UpdatePhysics) and photons are
+// only SCAN_TORPEDOES targets, never the unfiltered SCAN's.
+bool OpMayChangeScanResult(int op) {
+    return op == ASTRO_OP_FIRE_PHASER;
+}
+
+bool FallsThrough(int op) {
+    return op != ASTRO_OP_JUMP && op != ASTRO_OP_END;
+}
+
+// one round of rewrites + compaction; returns true if anything changed
+bool OptimizeOnce(std::vector<AstroInstr>& p) {
+    const int m = (int)p.size();
+    bool changed = false;
+
+    // thread jumps to unconditional jumps; a jump to END is just END
+    for (int i = 0; i < m; ++i) {
+        int t = p[i].target;
+        if (t < 0) continue;
+        while (p[t].op == ASTRO_OP_JUMP) t = p[t].target;
+        if (t != p[i].target) { p[i].target = t; changed = true; }
+        if (p[i].op == ASTRO_OP_JUMP && p[t].op == ASTRO_OP_END) {
+            p[i] = { ASTRO_OP_END, 0, 0.0f, -1 };
+            changed = true;
+        }
+    }
+
+    // the flag is only read by JUMP_IF_FALSE that couldn't be fused with its condition
+    bool flagRead = false;
+    for (const auto& in : p) {
+        if (in.op == ASTRO_OP_JUMP_IF_FALSE) flagRead = true;
+    }
+
+    // reachability (all jumps are forward, so one ascending sweep is enough)
+    std::vector<bool> reach(m, false);
+    reach[0] = true;
+    for (int i = 0; i < m; ++i) {
+        if (!reach[i]) continue;
+        if (FallsThrough(p[i].op) && i + 1 < m) reach[i + 1] = true;
+        if (p[i].target >= 0) reach[p[i].target] = true;
+    }
+
+    // scan dataflow: exact = a scan ran on every path and nothing since could change its
+    // result; prior = a scan ran on every path this turn
+    std::vector<signed char> inExact(m, -1), inPrior(m, -1);
+    inExact[0] = 0; inPrior[0] = 0;
+    auto meet = [](signed char& slot, bool v) { slot = (slot < 0) ? (signed char)v : (signed char)(slot && v); };
+    std::vector<bool> keep(m, true);
+    for (int i = 0; i < m; ++i) {
+        if (!reach[i]) {
+            if (i != m - 1) { keep[i] = false; changed = true; }
+            continue;
+        }
+        bool exact = inExact[i] > 0, prior = inPrior[i] > 0;
+        AstroInstr& in = p[i];
+        if (in.op == ASTRO_OP_SCAN) {
+            if (exact) { keep[i] = false; changed = true; }
+            else if (prior && in.param != ASTRO_SCAN_REUSE) { in.param = ASTRO_SCAN_REUSE; changed = true; }
+            exact = prior = true;
+        } else if (AstroScanFilterOf(in.op) != ASTRO_SCAN_ANY) {
+            exact = prior = false; // overwrites the scan result with a filtered one
+        } else if (OpMayChangeScanResult(in.op)) {
+            exact = false;
+        }
+        if (FallsThrough(in.op) && i + 1 < m) { meet(inExact[i + 1], exact); meet(inPrior[i + 1], prior); }
+        if (in.target >= 0) { meet(inExact[in.target], exact); meet(inPrior[in.target], prior); }
+
+        // no-op control flow: jumps/branches to the next instruction, empty IF bodies,
+        // conditions whose flag nobody reads, WAIT
+        if (in.target == i + 1 && in.op != ASTRO_OP_JUMP_IF_FALSE) {
+            if (in.op == ASTRO_OP_JUMP) { keep[i] = false; }
+            else { in.target = -1; }
+            changed = true;
+        }
+        if ((AstroIsCondition(in.op) && in.target < 0 && !flagRead) || in.op == ASTRO_OP_WAIT) {
+            keep[i] = false;
+            changed = true;
+        }
+    }
+    keep[m - 1] = true; // trailing END sentinel stays so every target has somewhere to land
+    if (!changed) return false;
+
+    // compact: a removed instruction's incoming jumps land on the next kept one
+    std::vector<int> remap(m, -1);
+    int next = 0;
+    for (int i = 0; i < m; ++i) {
+        if (keep[i]) remap[i] = next++;
+    }
+    for (int i = m - 1, after = remap[m - 1]; i >= 0; --i) {
+        if (remap[i] >= 0) after = remap[i];
+        else remap[i] = after;
+    }
+    std::vector<AstroInstr> out;
+    out.reserve(next);
+    for (int i = 0; i < m; ++i) {
+        if (!keep[i]) continue;
+        AstroInstr in = p[i];
+        if (in.target >= 0) in.target = remap[in.target];
+        out.push_back(in);
+    }
+    p.swap(out);
+    return true;
+}
+
+} // namespace
+
+void AstroOptimizeProgram(std::vector<AstroInstr>& program) {
+    if (program.empty()) return;
+    // every round strictly shrinks or settles the program; the cap is just a safety net
+    for (int round = 0; round < 16 && OptimizeOnce(program); ++round) {
+    }
+}
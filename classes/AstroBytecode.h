@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AstroTypes.h"
+
+// ===== Pre-decoded instruction (built from ShipBase::code by ShipBase::Compile()) =====
+// Conditions are fused with the JUMP_IF_FALSE the IF_* macros emit after them: they set
+// the flag and, when target >= 0, branch to target if it is false.
+struct AstroInstr {
+    int32_t op;      // AstroOpCode
+    int32_t param;   // integer operand (degrees, signal value, hp/fuel/range threshold)
+    float fparam;    // float operand (THRUST power, thresholds compared against floats)
+    int32_t target;  // absolute instruction index for jumps, -1 = fall through
+};
+
+// What one ship's program actually did at runtime, summed over a match (script_cost is
+// the static budget; this is the bill). Filled by ShipBase::Run() when the arena has
+// countVm set.
+struct AstroVmCounters {
+    uint64_t turns = 0;          // times the program ran
+    uint64_t instructions = 0;   // instructions retired, END included
+    uint64_t arenaCalls = 0;     // THRUST, TURN, FIRE_*, SCAN*, SIGNAL, TURN_TO_SCAN reaching the arena
+    uint64_t scans = 0;          // Scan() queries run (any filter)
+    uint64_t scansReused = 0;    // scans answered by the previous result or the arena's scan cache instead
+    uint64_t raycasts = 0;       // phaser shots traced (FIRE_PHASER off cooldown)
+    uint64_t branchesTaken = 0;  // jumps and failed conditions that left the straight line
+
+    double InstructionsPerTurn() const { return turns ? (double)instructions / (double)turns : 0.0; }
+};
+
+// SCAN param values in a decoded program
+enum AstroScanMode {
+    ASTRO_SCAN_ALWAYS = 0,      // run the query
+    ASTRO_SCAN_REUSE = 1,       // a scan already ran on every path this turn: skip if the world hasn't changed
+};
+
+// Checks raw bytecode before it is decoded: known opcodes, operands present, jump
+// targets on instruction boundaries, forward-only jumps (so every run terminates)
+// and a closing END. Returns false and fills error on the first problem found.
+bool AstroVerifyBytecode(const std::vector<int>& code, std::string* error);
+
+// script_cost of verified code: AstroOpCost() of every instruction in it, which is what
+// the DSL macros, the static builder and genomes add up as they emit them
+int AstroScriptCost(const std::vector<int>& code);
+
+// Peephole/dataflow pass over a decoded program: threads jumps to jumps, removes
+// unreachable code, no-op jumps and empty IF bodies, and drops a SCAN when nothing
+// that could change its result has run since the previous one. Script cost is untouched.
+void AstroOptimizeProgram(std::vector<AstroInstr>& program);
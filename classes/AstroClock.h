@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+
+// ===== Fixed-step sim clock =====
+// Turns are a fixed slice of game time (stepMs at 1x). Each tick (a wakeup of the sim
+// worker, AstroSimThread) feeds in the wall time since the last one; the clock says how
+// many turns are due, and how far the tick sits between the last two turns. Speed scales
+// game time, 0 plays as many turns as budgetMs of wall time allows. A stall (a debugger
+// stop, a window drag) counts as at most MAX_FRAME_MS, and turns that didn't fit in a
+// frame's budget are dropped rather than carried over.
+struct AstroClock {
+    static constexpr double MAX_FRAME_MS = 250.0; // longer gaps count as this long
+
+    double stepMs = 1000.0 / 30.0; // one turn at 1x (30 Hz)
+    int speed = 1;                 // turns per stepMs; 0 = as fast as the budget allows
+    double budgetMs = 12.0;        // wall time a frame may spend playing turns
+    int maxStepsPerFrame = 1024;
+
+    // adds frameMs of wall time and returns the number of turns due now
+    int Advance(double frameMs) {
+        if (speed <= 0) {
+            _accumulatorMs = 0.0;
+            return maxStepsPerFrame;
+        }
+        _accumulatorMs += std::min(frameMs, MAX_FRAME_MS) * speed;
+        int due = std::min((int)(_accumulatorMs / stepMs), maxStepsPerFrame);
+        _accumulatorMs = std::min(_accumulatorMs - due * stepMs, stepMs);
+        return due;
+    }
+    // the caller got through played of the due turns Advance() asked for: forget the rest
+    void Dropped(int played, int due) {
+        if (played < due) _accumulatorMs = 0.0;
+    }
+    // 0 = show the previous turn, 1 = the current one
+    float Alpha() const {
+        if (speed <= 0) return 1.0f;
+        return (float)std::min(1.0, _accumulatorMs / stepMs);
+    }
+    // wall time until Advance() will have another turn due (0 when speed is max)
+    double MsUntilNextStep() const {
+        if (speed <= 0) return 0.0;
+        return std::max(0.0, stepMs - _accumulatorMs) / speed;
+    }
+    void Reset() { _accumulatorMs = 0.0; }
+
+private:
+    double _accumulatorMs = 0.0; // game time not yet played
+};
@@ -0,0 +1,671 @@
+#include "AstroCluster.h"
+#include "AstroArena.h"
+#include "AstroMath.h"
+#include "AstroThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+#if defined(_WIN32)
+
+// the cluster speaks POSIX sockets; Windows builds play tournaments on local threads only
+struct AstroClusterCoordinator::Worker {};
+AstroClusterCoordinator::AstroClusterCoordinator() = default;
+AstroClusterCoordinator::~AstroClusterCoordinator() = default;
+bool AstroClusterCoordinator::Listen(uint16_t, std::string* error) {
+    if (error) *error = "distributed tournaments are not supported on Windows";
+    return false;
+}
+std::vector<TournamentOutcome> AstroClusterCoordinator::Play(const std::vector<ShipType>& entrants,
+                                                             const std::vector<TournamentMatch>& matches,
+                                                             const TournamentOptions& options) {
+    std::vector<TournamentOutcome> outcomes;
+    for (const auto& m : matches) outcomes.push_back(PlayTournamentMatch(entrants, m, options));
+    return outcomes;
+}
+void AstroClusterCoordinator::Shutdown() {}
+bool AstroRunClusterWorker(const std::string&, uint16_t, int, std::string* error) {
+    if (error) *error = "distributed tournaments are not supported on Windows";
+    return false;
+}
+
+#else
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t CLUSTER_MAGIC = 0x554C4341; // "ACLU"
+constexpr uint16_t CLUSTER_VERSION = 3; // 2: stalemate turns in SETUP, stalemate in RESULT, 3: fixed point in SETUP
+constexpr uint32_t MAX_FRAME = 1u << 24;
+
+enum ClusterFrame : uint8_t {
+    FRAME_HELLO = 1, FRAME_SETUP, FRAME_WANT, FRAME_LEASE, FRAME_RESULT, FRAME_BYE, FRAME_ERROR
+};
+
+#if defined(MSG_NOSIGNAL)
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0; // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+// little-endian frame payloads
+struct Out {
+    std::vector<uint8_t> b;
+    void U8(uint8_t v) { b.push_back(v); }
+    void U16(uint16_t v) { for (int i = 0; i < 2; ++i) b.push_back((uint8_t)(v >> (8 * i))); }
+    void U32(uint32_t v) { for (int i = 0; i < 4; ++i) b.push_back((uint8_t)(v >> (8 * i))); }
+    void U64(uint64_t v) { for (int i = 0; i < 8; ++i) b.push_back((uint8_t)(v >> (8 * i))); }
+    void I32(int32_t v) { U32((uint32_t)v); }
+    void F32(float v) { uint32_t u; std::memcpy(&u, &v, 4); U32(u); }
+    void Str(const std::string& s) {
+        U32((uint32_t)s.size());
+        for (char c : s) b.push_back((uint8_t)c);
+    }
+    // the whole frame: length (type byte included), type, payload
+    std::vector<uint8_t> Frame(uint8_t type) const {
+        Out f;
+        f.U32((uint32_t)(b.size() + 1));
+        f.U8(type);
+        f.b.insert(f.b.end(), b.begin(), b.end());
+        return f.b;
+    }
+};
+
+struct In {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+    uint64_t Bytes(int n) {
+        if (!ok || end - p < n) { ok = false; return 0; }
+        uint64_t v = 0;
+        for (int i = 0; i < n; ++i) v |= (uint64_t)p[i] << (8 * i);
+        p += n;
+        return v;
+    }
+    uint8_t U8() { return (uint8_t)Bytes(1); }
+    uint16_t U16() { return (uint16_t)Bytes(2); }
+    uint32_t U32() { return (uint32_t)Bytes(4); }
+    uint64_t U64() { return Bytes(8); }
+    int32_t I32() { return (int32_t)U32(); }
+    float F32() { uint32_t u = U32(); float v; std::memcpy(&v, &u, 4); return v; }
+    std::string Str() {
+        uint32_t n = U32();
+        if (!ok || (size_t)(end - p) < n) { ok = false; return {}; }
+        std::string s((const char*)p, n);
+        p += n;
+        return s;
+    }
+};
+
+void WriteOutcome(Out& o, const TournamentOutcome& r) {
+    o.I32(r.winner);
+    o.U8(r.stalemate ? 1 : 0);
+    for (int slot = 0; slot < 2; ++slot) { o.I32(r.turnsSurvived[slot]); o.I32(r.damageDealt[slot]); }
+    o.U64(r.checksum);
+}
+TournamentOutcome ReadOutcome(In& in) {
+    TournamentOutcome r;
+    r.winner = in.I32();
+    r.stalemate = in.U8() != 0;
+    for (int slot = 0; slot < 2; ++slot) { r.turnsSurvived[slot] = in.I32(); r.damageDealt[slot] = in.I32(); }
+    r.checksum = in.U64();
+    return r;
+}
+bool SameOutcome(const TournamentOutcome& x, const TournamentOutcome& y) {
+    return x.winner == y.winner && x.stalemate == y.stalemate && x.checksum == y.checksum &&
+           x.turnsSurvived[0] == y.turnsSurvived[0] && x.turnsSurvived[1] == y.turnsSurvived[1] &&
+           x.damageDealt[0] == y.damageDealt[0] && x.damageDealt[1] == y.damageDealt[1];
+}
+
+void PrepareSocket(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+// blocking send of a whole buffer (worker side)
+bool SendAll(int fd, const std::vector<uint8_t>& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, SEND_FLAGS);
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+// Splits complete frames off the front of buf; calls handle(type, payload, size) for each,
+// stopping early when it returns false. Returns false on a malformed frame.
+template <typename Handle>
+bool TakeFrames(std::vector<uint8_t>& buf, Handle&& handle) {
+    size_t pos = 0;
+    bool ok = true;
+    while (buf.size() - pos >= 4) {
+        In head{ buf.data() + pos, buf.data() + buf.size() };
+        uint32_t len = head.U32();
+        if (len == 0 || len > MAX_FRAME) { ok = false; break; }
+        if (buf.size() - pos - 4 < len) break;
+        const uint8_t* frame = buf.data() + pos + 4;
+        pos += 4 + len;
+        if (!handle(frame[0], frame + 1, (size_t)len - 1)) { ok = false; break; }
+    }
+    buf.erase(buf.begin(), buf.begin() + (std::ptrdiff_t)pos);
+    return ok;
+}
+
+// the same hash for a seed on every run and node: which matches get a second opinion
+bool PickedForVerify(uint32_t seed, double fraction) {
+    if (fraction <= 0.0) return false;
+    uint32_t h = seed * 0x9e3779b1u;
+    h ^= h >> 16;
+    return (double)(h % 10000u) < fraction * 10000.0;
+}
+
+} // namespace
+
+struct AstroClusterCoordinator::Worker {
+    int fd = -1;
+    int id = 0;
+    bool ready = false;           // sent an acceptable HELLO
+    bool closing = false;         // drop once the out buffer is flushed
+    uint32_t setupRound = 0;      // round its last SETUP was for
+    int wants = 0;                // matches asked for and not yet leased
+    std::string address;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;
+};
+
+AstroClusterCoordinator::AstroClusterCoordinator() = default;
+
+AstroClusterCoordinator::~AstroClusterCoordinator() {
+    Shutdown();
+    if (_listen >= 0) close(_listen);
+}
+
+bool AstroClusterCoordinator::Listen(uint16_t port, std::string* error) {
+    _listen = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listen < 0) {
+        if (error) *error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    int one = 1;
+    setsockopt(_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(_listen, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(_listen, 64) < 0) {
+        if (error) *error = "port " + std::to_string(port) + ": " + std::strerror(errno);
+        close(_listen);
+        _listen = -1;
+        return false;
+    }
+    fcntl(_listen, F_SETFL, fcntl(_listen, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void AstroClusterCoordinator::Accept() {
+    for (;;) {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        int fd = accept(_listen, (sockaddr*)&addr, &len);
+        if (fd < 0) return;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        PrepareSocket(fd);
+        auto w = std::make_unique<Worker>();
+        w->fd = fd;
+        w->id = _nextWorkerId++;
+        char host[INET_ADDRSTRLEN] = "?";
+        inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+        w->address = std::string(host) + ":" + std::to_string(ntohs(addr.sin_port));
+        _workers.push_back(std::move(w));
+    }
+}
+
+bool AstroClusterCoordinator::Receive(Worker& w) {
+    uint8_t chunk[16384];
+    for (;;) {
+        ssize_t n = recv(w.fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            w.in.insert(w.in.end(), chunk, chunk + n);
+            continue;
+        }
+        if (n == 0) return false;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        if (errno == EINTR) continue;
+        return false;
+    }
+    return TakeFrames(w.in, [&](uint8_t type, const uint8_t* payload, size_t size) {
+        return Handle(w, type, payload, size);
+    });
+}
+
+bool AstroClusterCoordinator::Flush(Worker& w) {
+    while (!w.out.empty()) {
+        ssize_t n = send(w.fd, w.out.data(), w.out.size(), SEND_FLAGS);
+        if (n > 0) {
+            w.out.erase(w.out.begin(), w.out.begin() + n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return true;
+        return false;
+    }
+    return !w.closing;
+}
+
+bool AstroClusterCoordinator::Handle(Worker& w, uint8_t type, const uint8_t* payload, size_t size) {
+    In in{ payload, payload + size };
+    auto reject = [&](const std::string& why) {
+        std::fprintf(stderr, "astro_cluster: rejecting worker %s: %s\n", w.address.c_str(), why.c_str());
+        Out o;
+        o.Str(why);
+        auto f = o.Frame(FRAME_ERROR);
+        w.out.insert(w.out.end(), f.begin(), f.end());
+        w.closing = true;
+        return true;
+    };
+    switch (type) {
+        case FRAME_HELLO: {
+            uint32_t magic = in.U32();
+            uint16_t version = in.U16();
+            in.U16(); // threads, informational
+            std::string trig = in.Str();
+            if (!in.ok || magic != CLUSTER_MAGIC) return false;
+            if (version != CLUSTER_VERSION) return reject("protocol version " + std::to_string(version) + ", expected " + std::to_string(CLUSTER_VERSION));
+            if (trig != AstroTrigPath()) return reject("worker trig is " + trig + ", coordinator's is " + AstroTrigPath());
+            w.ready = true;
+            stats.workersSeen++;
+            return true;
+        }
+        case FRAME_WANT: {
+            uint32_t n = in.U32();
+            if (!in.ok || !w.ready) return false;
+            w.wants += (int)std::min<uint32_t>(n, 1u << 16);
+            Lease(w);
+            return true;
+        }
+        case FRAME_RESULT: {
+            uint64_t jobId = in.U64();
+            TournamentOutcome o = ReadOutcome(in);
+            if (!in.ok || !w.ready) return false;
+            Result(w, jobId, o);
+            return true;
+        }
+        case FRAME_ERROR: {
+            std::string why = in.Str();
+            std::fprintf(stderr, "astro_cluster: worker %s gave up: %s\n", w.address.c_str(), why.c_str());
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+void AstroClusterCoordinator::Result(Worker& w, uint64_t jobId, const TournamentOutcome& o) {
+    // outcomes of copies still running when their round ended arrive late: nothing to do
+    if ((uint32_t)(jobId >> 32) != _round || (jobId & 0xffffffffu) >= _jobs.size()) return;
+    Job& job = _jobs[jobId & 0xffffffffu];
+    job.holders.erase(std::remove(job.holders.begin(), job.holders.end(), w.id), job.holders.end());
+    if (!job.done) {
+        job.done = true;
+        job.outcome = o;
+        job.resultsFrom = w.id;
+        job.outcomes = 1;
+        return;
+    }
+    job.outcomes++;
+    if (SameOutcome(job.outcome, o)) {
+        stats.verified++;
+        return;
+    }
+    stats.mismatches++;
+    std::fprintf(stderr, "astro_cluster: match %s vs %s seed %u: worker %s ended with hash=%016llx, an earlier run with hash=%016llx\n",
+                 _entrants[job.match.a].c_str(), _entrants[job.match.b].c_str(), job.match.seed, w.address.c_str(),
+                 (unsigned long long)o.checksum, (unsigned long long)job.outcome.checksum);
+}
+
+void AstroClusterCoordinator::Lease(Worker& w) {
+    if (!w.ready || w.closing || _jobs.empty()) return;
+    if (w.setupRound != _round) {
+        Out o;
+        o.U32(_round);
+        o.I32(_options.maxTurns);
+        o.U8(_options.simultaneous ? 1 : 0);
+        o.F32(_options.config.width);
+        o.F32(_options.config.height);
+        o.I32(_options.config.asteroids);
+        o.I32(_options.config.maxParticles);
+        o.I32(_options.config.maxShipDebris);
+        o.I32(_options.config.cellSize);
+        o.U8((uint8_t)_options.config.broadphase);
+        o.I32(_options.config.stalemateTurns);
+        o.U8(_options.config.fixedPoint ? 1 : 0);
+        o.U32((uint32_t)_entrants.size());
+        for (const auto& name : _entrants) o.Str(name);
+        auto f = o.Frame(FRAME_SETUP);
+        w.out.insert(w.out.end(), f.begin(), f.end());
+        w.setupRound = _round;
+    }
+
+    std::vector<int> batch;
+    const int limit = std::min(w.wants, leaseSize);
+    auto give = [&](int idx) {
+        _jobs[idx].holders.push_back(w.id);
+        batch.push_back(idx);
+    };
+    while ((int)batch.size() < limit && !_pending.empty()) {
+        give(_pending.front());
+        _pending.pop_front();
+    }
+    // second opinions: done matches picked for verification, from a node that didn't play them
+    for (size_t i = 0; i < _jobs.size() && (int)batch.size() < limit; ++i) {
+        const Job& job = _jobs[i];
+        if (job.done && job.verify && job.outcomes < 2 && job.holders.empty() && job.resultsFrom != w.id) give((int)i);
+    }
+    // work stealing: copies of matches held by exactly one other worker, oldest first
+    for (size_t i = 0; i < _jobs.size() && (int)batch.size() < limit; ++i) {
+        const Job& job = _jobs[i];
+        if (!job.done && job.holders.size() == 1 && job.holders[0] != w.id) {
+            give((int)i);
+            stats.stolen++;
+        }
+    }
+    if (batch.empty()) return;
+
+    Out o;
+    o.U32((uint32_t)batch.size());
+    for (int idx : batch) {
+        const TournamentMatch& m = _jobs[idx].match;
+        o.U64(((uint64_t)_round << 32) | (uint32_t)idx);
+        o.U16((uint16_t)m.a);
+        o.U16((uint16_t)m.b);
+        o.U32(m.seed);
+    }
+    auto f = o.Frame(FRAME_LEASE);
+    w.out.insert(w.out.end(), f.begin(), f.end());
+    w.wants -= (int)batch.size();
+    stats.leased += batch.size();
+}
+
+void AstroClusterCoordinator::Drop(Worker& w) {
+    bool held = false;
+    for (size_t i = 0; i < _jobs.size(); ++i) {
+        Job& job = _jobs[i];
+        auto it = std::find(job.holders.begin(), job.holders.end(), w.id);
+        if (it == job.holders.end()) continue;
+        held = true;
+        job.holders.erase(it);
+        if (!job.done && job.holders.empty()) {
+            _pending.push_front((int)i);
+            stats.reissued++;
+        }
+    }
+    if (held) {
+        stats.workersLost++;
+        std::fprintf(stderr, "astro_cluster: lost worker %s, its matches go back in the queue\n", w.address.c_str());
+    }
+    close(w.fd);
+    w.fd = -1;
+}
+
+bool AstroClusterCoordinator::JobSettled(const Job& job) const {
+    if (!job.done) return false;
+    if (!job.verify || job.outcomes >= 2) return true;
+    if (!job.holders.empty()) return false; // its second opinion is being played
+    // only the node that played it is left: no second opinion to be had
+    for (const auto& w : _workers) {
+        if (w->ready && !w->closing && w->id != job.resultsFrom) return false;
+    }
+    return true;
+}
+
+std::vector<TournamentOutcome> AstroClusterCoordinator::Play(const std::vector<ShipType>& entrants,
+                                                             const std::vector<TournamentMatch>& matches,
+                                                             const TournamentOptions& options) {
+    _round++;
+    _options = options;
+    _options.cluster = nullptr;
+    _entrants.clear();
+    for (const auto& e : entrants) _entrants.push_back(e.name);
+    _jobs.assign(matches.size(), Job{});
+    _pending.clear();
+    for (size_t i = 0; i < matches.size(); ++i) {
+        _jobs[i].match = matches[i];
+        _jobs[i].verify = PickedForVerify(matches[i].seed, verifyFraction);
+        _pending.push_back((int)i);
+    }
+
+    bool announced = false;
+    for (;;) {
+        bool settled = true;
+        for (const Job& job : _jobs) {
+            if (!JobSettled(job)) { settled = false; break; }
+        }
+        if (settled) break;
+
+        // new rounds, reissued and verifiable matches go to whoever is still asking
+        for (auto& w : _workers) {
+            if (w->wants > 0) Lease(*w);
+        }
+        int ready = 0;
+        for (const auto& w : _workers) ready += w->ready ? 1 : 0;
+        if (!ready && !announced) {
+            std::fprintf(stderr, "astro_cluster: waiting for workers\n");
+            announced = true;
+        }
+
+        std::vector<pollfd> fds;
+        fds.push_back({ _listen, POLLIN, 0 });
+        for (const auto& w : _workers) {
+            fds.push_back({ w->fd, (short)(POLLIN | (w->out.empty() ? 0 : POLLOUT)), 0 });
+        }
+        if (poll(fds.data(), (nfds_t)fds.size(), 1000) < 0 && errno != EINTR) break;
+        const size_t known = _workers.size();
+        if (fds[0].revents & POLLIN) Accept();
+        for (size_t i = 0; i < known; ++i) {
+            Worker& w = *_workers[i];
+            short ev = fds[i + 1].revents;
+            bool alive = true;
+            if (ev & (POLLIN | POLLHUP | POLLERR)) alive = Receive(w);
+            if (alive && !w.out.empty()) alive = Flush(w);
+            if (!alive) Drop(w);
+        }
+        _workers.erase(std::remove_if(_workers.begin(), _workers.end(), [](const std::unique_ptr<Worker>& w) {
+            return w->fd < 0;
+        }), _workers.end());
+    }
+
+    std::vector<TournamentOutcome> outcomes;
+    outcomes.reserve(_jobs.size());
+    for (const Job& job : _jobs) outcomes.push_back(job.outcome);
+    return outcomes;
+}
+
+void AstroClusterCoordinator::Shutdown() {
+    for (auto& w : _workers) {
+        if (w->fd < 0) continue;
+        auto f = Out{}.Frame(FRAME_BYE);
+        w->out.insert(w->out.end(), f.begin(), f.end());
+        // a last blocking flush: the tournament is over, nothing else to wait on
+        fcntl(w->fd, F_SETFL, fcntl(w->fd, F_GETFL) & ~O_NONBLOCK);
+        SendAll(w->fd, w->out);
+        close(w->fd);
+    }
+    _workers.clear();
+}
+
+bool AstroRunClusterWorker(const std::string& host, uint16_t port, int threads, std::string* error) {
+    auto fail = [error](const std::string& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found) != 0 || !found) {
+        return fail("cannot resolve " + host);
+    }
+    int fd = -1;
+    for (addrinfo* a = found; a && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (fd < 0) return fail("cannot connect to " + host + ":" + std::to_string(port));
+    PrepareSocket(fd);
+
+    AstroThreadPool pool(threads);
+    Out hello;
+    hello.U32(CLUSTER_MAGIC);
+    hello.U16(CLUSTER_VERSION);
+    hello.U16((uint16_t)pool.ThreadCount());
+    hello.Str(AstroTrigPath());
+    if (!SendAll(fd, hello.Frame(FRAME_HELLO))) {
+        close(fd);
+        return fail("connection lost");
+    }
+
+    struct Setup {
+        uint32_t round = 0;
+        TournamentOptions options;
+        std::vector<ShipType> entrants;
+    };
+    std::shared_ptr<const Setup> setup;
+    std::mutex doneLock;
+    std::vector<std::pair<uint64_t, TournamentOutcome>> done;
+    std::atomic<int> inflight{0};
+    // two matches per thread: one playing, one queued behind it while the next lease is on its way
+    const int capacity = 2 * pool.ThreadCount();
+    int asked = 0;
+    std::vector<uint8_t> in;
+    std::string problem;
+    bool bye = false;
+
+    auto handle = [&](uint8_t type, const uint8_t* payload, size_t size) {
+        In r{ payload, payload + size };
+        switch (type) {
+            case FRAME_SETUP: {
+                auto s = std::make_shared<Setup>();
+                s->round = r.U32();
+                s->options.maxTurns = r.I32();
+                s->options.simultaneous = r.U8() != 0;
+                s->options.config.width = r.F32();
+                s->options.config.height = r.F32();
+                s->options.config.asteroids = r.I32();
+                s->options.config.maxParticles = r.I32();
+                s->options.config.maxShipDebris = r.I32();
+                s->options.config.cellSize = r.I32();
+                s->options.config.broadphase = (AstroBroadphaseKind)r.U8();
+                s->options.config.stalemateTurns = r.I32();
+                s->options.config.fixedPoint = r.U8() != 0;
+                uint32_t n = r.U32();
+                for (uint32_t i = 0; i < n && r.ok; ++i) {
+                    std::string name = r.Str();
+                    auto& types = ShipTypes();
+                    auto it = std::find_if(types.begin(), types.end(), [&](const ShipType& t) { return t.name == name; });
+                    if (it == types.end()) {
+                        problem = "no ship type " + name + " in this build";
+                        return false;
+                    }
+                    s->entrants.push_back(*it);
+                }
+                if (!r.ok) { problem = "malformed SETUP"; return false; }
+                if (!s->options.config.FitsFixedPoint()) { problem = "SETUP world too large for fixed point"; return false; }
+                setup = std::move(s);
+                return true;
+            }
+            case FRAME_LEASE: {
+                uint32_t n = r.U32();
+                for (uint32_t i = 0; i < n && r.ok; ++i) {
+                    uint64_t jobId = r.U64();
+                    TournamentMatch m;
+                    m.a = r.U16();
+                    m.b = r.U16();
+                    m.seed = r.U32();
+                    if (!r.ok || !setup || m.a >= (int)setup->entrants.size() || m.b >= (int)setup->entrants.size()) {
+                        problem = "malformed LEASE";
+                        return false;
+                    }
+                    asked = std::max(0, asked - 1);
+                    inflight++;
+                    pool.Submit([s = setup, m, jobId, &doneLock, &done, &inflight]() {
+                        TournamentOutcome o = PlayTournamentMatch(s->entrants, m, s->options);
+                        std::lock_guard<std::mutex> hold(doneLock);
+                        done.emplace_back(jobId, o);
+                        inflight--;
+                    });
+                }
+                return true;
+            }
+            case FRAME_BYE:
+                bye = true;
+                return false;
+            case FRAME_ERROR:
+                problem = "coordinator: " + r.Str();
+                return false;
+            default:
+                problem = "unexpected frame " + std::to_string(type);
+                return false;
+        }
+    };
+
+    bool connected = true;
+    while (connected) {
+        // stream outcomes back as they finish, then ask for enough to keep every thread busy
+        std::vector<std::pair<uint64_t, TournamentOutcome>> ready;
+        {
+            std::lock_guard<std::mutex> hold(doneLock);
+            ready.swap(done);
+        }
+        int playing = inflight.load();
+        std::vector<uint8_t> send;
+        for (const auto& [jobId, o] : ready) {
+            Out r;
+            r.U64(jobId);
+            WriteOutcome(r, o);
+            auto f = r.Frame(FRAME_RESULT);
+            send.insert(send.end(), f.begin(), f.end());
+        }
+        int room = capacity - playing - asked;
+        if (room > 0) {
+            Out want;
+            want.U32((uint32_t)room);
+            auto f = want.Frame(FRAME_WANT);
+            send.insert(send.end(), f.begin(), f.end());
+            asked += room;
+        }
+        if (!send.empty() && !SendAll(fd, send)) break;
+
+        pollfd p{ fd, POLLIN, 0 };
+        if (poll(&p, 1, 2) <= 0) continue;
+        uint8_t chunk[16384];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        in.insert(in.end(), chunk, chunk + n);
+        if (!TakeFrames(in, handle)) connected = false;
+    }
+    pool.Wait();
+    close(fd);
+    if (bye) return true;
+    return fail(problem.empty() ? "coordinator closed the connection" : problem);
+}
+
+#endif
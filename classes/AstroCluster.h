@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AstroTournament.h"
+
+// ===== Distributed tournaments =====
+// A coordinator hands tournament matches to worker processes over TCP; each worker plays
+// them on its own thread pool and streams every outcome back as soon as it is known.
+//
+// Protocol: length-prefixed frames (u32 length, u8 type, payload; little-endian).
+//   worker -> coordinator  HELLO   protocol version, threads, trig path
+//   coordinator -> worker  SETUP   round, maxTurns, simultaneous, arena config, entrant names
+//   worker -> coordinator  WANT    how many more matches it can take
+//   coordinator -> worker  LEASE   a batch of (job id, entrant a, entrant b, seed)
+//   worker -> coordinator  RESULT  job id and its TournamentOutcome, checksum included
+//   coordinator -> worker  BYE     tournament over
+//   either way             ERROR   why the sender is closing the connection
+// Workers only ask for as much as keeps their threads busy, so leases stay small and a
+// fast node simply asks more often. Once nothing is left to hand out, an idle worker is
+// given copies of matches other workers still hold, oldest first (work stealing): the
+// first outcome in wins, and a later one from another node is checked against it. When a
+// worker disconnects, the matches only it held go back in the queue. Matches are
+// deterministic, so any two outcomes of one match must have the same checksum; with
+// verifyFraction > 0 that share of the matches (picked from the seed, so the same ones
+// every run) is also played on a second node. A mismatch is reported and counted, never
+// silently resolved. Workers must run a build with the same ship types and trig path
+// (AstroMath.h): anything else would play different matches, so HELLO is rejected.
+
+struct AstroClusterStats {
+    int workersSeen = 0;        // connections that passed HELLO
+    int workersLost = 0;        // connections that closed while holding matches
+    uint64_t leased = 0;        // matches handed out, copies included
+    uint64_t reissued = 0;      // matches put back in the queue after a worker was lost
+    uint64_t stolen = 0;        // copies of held matches given to idle workers
+    uint64_t verified = 0;      // matches whose outcome two nodes agreed on
+    uint64_t mismatches = 0;    // matches two nodes disagreed on
+};
+
+class AstroClusterCoordinator {
+public:
+    AstroClusterCoordinator();
+    ~AstroClusterCoordinator();
+    AstroClusterCoordinator(const AstroClusterCoordinator&) = delete;
+    AstroClusterCoordinator& operator=(const AstroClusterCoordinator&) = delete;
+
+    // listens on every interface; false and error if the port can't be bound
+    bool Listen(uint16_t port, std::string* error);
+    // Plays matches on the connected workers (waiting for the first to connect) and returns
+    // their outcomes in match order. Workers may come and go meanwhile.
+    std::vector<TournamentOutcome> Play(const std::vector<ShipType>& entrants, const std::vector<TournamentMatch>& matches,
+                                        const TournamentOptions& options);
+    // says BYE to every worker and closes the connections
+    void Shutdown();
+
+    int leaseSize = 16;           // most matches per LEASE
+    double verifyFraction = 0.0;  // share of matches also played on a second node, 0..1
+    AstroClusterStats stats;
+
+private:
+    struct Worker;
+    struct Job {
+        TournamentMatch match;
+        bool done = false;
+        bool verify = false;          // wants a second outcome from another node
+        int resultsFrom = -1;         // worker id the first outcome came from
+        int outcomes = 0;
+        std::vector<int> holders;     // worker ids it is leased to and not back from
+        TournamentOutcome outcome;
+    };
+
+    void Accept();
+    bool Receive(Worker& w);
+    bool Handle(Worker& w, uint8_t type, const uint8_t* payload, size_t size);
+    void Result(Worker& w, uint64_t jobId, const TournamentOutcome& o);
+    void Lease(Worker& w);
+    void Drop(Worker& w);
+    bool JobSettled(const Job& job) const;
+    bool Flush(Worker& w);
+
+    int _listen = -1;
+    int _nextWorkerId = 0;
+    uint32_t _round = 0;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    // the round being played
+    std::vector<Job> _jobs;
+    std::deque<int> _pending;         // jobs nobody holds
+    std::vector<std::string> _entrants;
+    TournamentOptions _options;
+};
+
+// Connects to a coordinator and plays what it hands out on threads workers (0 = all
+// cores) until it says BYE. Returns false and fills error if the connection fails or the
+// coordinator rejects this build.
+bool AstroRunClusterWorker(const std::string& host, uint16_t port, int threads, std::string* error);
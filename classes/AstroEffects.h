@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../imgui/imgui.h"
+
+// ===== GPU effects =====
+// Particles, ship debris and photon torpedoes drawn as instanced quads instead of
+// tessellated ImDrawList lines. AstroBots fills an AstroEffectBatch with one compact
+// record per effect while it builds the frame, then queues AstroEffectsRender as an
+// ImDrawList callback at the point the effects belong in the draw order; the backend
+// runs it while rendering the draw data, and the glow, fade and pulse math runs in the
+// shaders. One backend file is linked per platform, like the ImGui renderer it sits
+// next to: AstroEffectsOpenGL3.cpp with imgui_impl_opengl3, AstroEffectsDX11.cpp with
+// imgui_impl_dx11. When the backend couldn't set itself up, AstroEffectsAvailable() is
+// false and the viewer draws effects with ImDrawList as before.
+enum AstroEffectKind : uint8_t {
+    ASTRO_EFFECT_PARTICLE = 0,  // pos = head, vel = head to tail (pixels), life = 1 at spawn .. 0
+    ASTRO_EFFECT_DEBRIS,        // pos = one end, vel = to the other end, life = 1 .. 0
+    ASTRO_EFFECT_TORPEDO,       // pos = center, life = PhotonTorpedo::anim
+    ASTRO_EFFECT_COUNT
+};
+
+// one instance, in screen pixels (ImGui display coordinates); 24 bytes
+struct AstroEffectInstance {
+    float x, y;
+    float vx, vy;
+    float life;
+    uint32_t color;             // ImU32: the particle's base color, the debris's ship color
+};
+
+struct AstroEffectBatch {
+    std::vector<AstroEffectInstance> instances[ASTRO_EFFECT_COUNT];
+    // the viewport the batch is drawn into (ImDrawData's DisplayPos/Size, FramebufferScale)
+    ImVec2 displayPos{ 0.0f, 0.0f };
+    ImVec2 displaySize{ 0.0f, 0.0f };
+    ImVec2 framebufferScale{ 1.0f, 1.0f };
+
+    void Add(AstroEffectKind kind, const AstroEffectInstance& instance) { instances[kind].push_back(instance); }
+    size_t Size() const {
+        size_t n = 0;
+        for (const auto& v : instances) n += v.size();
+        return n;
+    }
+    void Clear() {
+        for (auto& v : instances) v.clear();
+    }
+};
+
+// Shape constants the shaders share with the ImDrawList path (PHOTON_* in AstroTypes.h)
+struct AstroEffectParams {
+    float photonBaseSize;
+    float photonPulseAmplitude;
+    float photonSpinSpeed;
+    float photonPulseSpeed;
+};
+
+// ===== Backend hooks =====
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+
+// after ImGui_ImplOpenGL3_Init (same GLSL version string; "#version 100" has no instancing)
+bool AstroEffectsInitOpenGL3(const char* glslVersion);
+// after ImGui_ImplDX11_Init
+bool AstroEffectsInitDX11(ID3D11Device* device, ID3D11DeviceContext* context);
+// before the ImGui backend shuts down
+void AstroEffectsShutdown();
+bool AstroEffectsAvailable();
+void AstroEffectsSetParams(const AstroEffectParams& params);
+
+// ImDrawCallback: cmd->UserCallbackData is the AstroEffectBatch, which has to stay alive
+// until the frame is rendered. Queue ImDrawCallback_ResetRenderState after it.
+void AstroEffectsRender(const ImDrawList* list, const ImDrawCmd* cmd);
@@ -0,0 +1,299 @@
+// Instanced effects renderer for the DirectX 11 backend (see AstroEffects.h).
+// Same quads and layers as AstroEffectsOpenGL3.cpp, in HLSL.
+
+#include "AstroEffects.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <d3d11.h>
+#include <d3dcompiler.h>
+
+#pragma comment(lib, "d3dcompiler")
+
+namespace {
+
+struct Constants {
+    float proj[4][4];
+    float photon[4]; // base size, pulse amplitude, spin speed, pulse speed
+    int kind;
+    int pad[3];
+};
+
+struct DxState {
+    ID3D11Device* device = nullptr;
+    ID3D11DeviceContext* context = nullptr;
+    ID3D11VertexShader* vs = nullptr;
+    ID3D11PixelShader* ps = nullptr;
+    ID3D11InputLayout* layout = nullptr;
+    ID3D11Buffer* constants = nullptr;
+    ID3D11Buffer* instances = nullptr;
+    size_t capacity = 0; // in instances
+    AstroEffectParams params{ 4.0f, 7.0f, 0.11f, 0.20f };
+};
+DxState g_effects;
+
+// v_local is the pixel's position relative to the segment start (along, across) or to
+// the torpedo center; see AstroEffectsOpenGL3.cpp
+const char* VERTEX_SHADER = R"(
+cbuffer Constants : register(b0) {
+    float4x4 u_proj;
+    float4 u_photon;
+    int u_kind;
+};
+struct VS_INPUT {
+    float2 pos : POSITION;
+    float2 vel : TEXCOORD0;
+    float life : TEXCOORD1;
+    float4 color : COLOR0;
+    uint id : SV_VertexID;
+};
+struct PS_INPUT {
+    float4 pos : SV_POSITION;
+    float2 local : TEXCOORD0;
+    float life : TEXCOORD1;
+    float4 color : COLOR0;
+};
+PS_INPUT main(VS_INPUT input) {
+    PS_INPUT output;
+    float2 corner = float2((float)(input.id & 1), (float)(input.id >> 1));
+    float2 p;
+    if (u_kind == 2) {
+        float r = u_photon.x + u_photon.y + 4.0;
+        output.local = (corner * 2.0 - 1.0) * r;
+        p = input.pos + output.local;
+    } else {
+        float len = length(input.vel);
+        float2 dir = len > 1e-4 ? input.vel / len : float2(1.0, 0.0);
+        float2 nrm = float2(-dir.y, dir.x);
+        float hw = (u_kind == 0 ? 7.0 * input.life + 2.0 : 6.0 * input.life + 1.5) * 0.5 + 1.0;
+        output.local = float2(corner.x * len, lerp(-hw, hw, corner.y));
+        p = input.pos + dir * output.local.x + nrm * output.local.y;
+    }
+    output.life = input.life;
+    output.color = input.color;
+    output.pos = mul(u_proj, float4(p, 0.0, 1.0));
+    return output;
+}
+)";
+
+const char* PIXEL_SHADER = R"(
+cbuffer Constants : register(b0) {
+    float4x4 u_proj;
+    float4 u_photon;
+    int u_kind;
+};
+struct PS_INPUT {
+    float4 pos : SV_POSITION;
+    float2 local : TEXCOORD0;
+    float life : TEXCOORD1;
+    float4 color : COLOR0;
+};
+float band(float d, float hw) { return saturate(hw - d + 0.5); }
+float4 over(float4 top, float4 under) {
+    float a = top.a + under.a * (1.0 - top.a);
+    float3 rgb = a > 0.0 ? (top.rgb * top.a + under.rgb * under.a * (1.0 - top.a)) / a : float3(0.0, 0.0, 0.0);
+    return float4(rgb, a);
+}
+float4 main(PS_INPUT input) : SV_Target {
+    float life = input.life;
+    float2 q = input.local;
+    float d = abs(q.y);
+    if (u_kind == 0) {
+        float3 rgb = input.color.rgb + (1.0 - input.color.rgb) * life;
+        float4 glow = float4(rgb, 120.0 / 255.0 * life * life * band(d, (7.0 * life + 2.0) * 0.5));
+        float4 core = float4(rgb, (220.0 * life * life + 35.0) / 255.0 * band(d, (3.0 * life + 1.0) * 0.5));
+        return over(core, glow);
+    }
+    if (u_kind == 1) {
+        float4 glow = float4(input.color.rgb, 120.0 / 255.0 * life * life * band(d, (6.0 * life + 1.5) * 0.5));
+        float4 core = float4(1.0, 1.0, 1.0, (230.0 * life * life + 20.0) / 255.0 * band(d, (2.0 * life + 1.0) * 0.5));
+        return over(core, glow);
+    }
+    float angle = life * u_photon.z;
+    float pulseT = life * u_photon.w;
+    float pulse = 0.65 + 0.35 * (0.5 * (sin(pulseT) + 1.0));
+    float base = u_photon.x * pulse;
+    float amp = u_photon.y * (0.6 + 0.4 * (0.5 * (sin(pulseT * 0.8 + 1.3) + 1.0)));
+    const float STEP = 6.2831853 / 12.0;
+    float k = floor((atan2(q.y, q.x) - angle) / STEP + 0.5);
+    float4 c = float4(0.0, 0.0, 0.0, 0.0);
+    for (int j = -1; j <= 1; ++j) {
+        float kk = k + (float)j;
+        float a = angle + kk * STEP;
+        float phase = (kk - 2.0 * floor(kk * 0.5)) < 0.5 ? 0.0 : 1.5707963;
+        float len = base + amp * (0.5 * (sin(pulseT + phase) + 1.0));
+        float2 dir = float2(cos(a), sin(a));
+        float t = clamp(dot(q, dir), -len * 0.25, len);
+        float ds = length(q - dir * t);
+        c = over(float4(1.0, 100.0 / 255.0, 100.0 / 255.0, 110.0 / 255.0 * band(ds, 3.0)), c);
+        c = over(float4(1.0, 80.0 / 255.0, 80.0 / 255.0, band(ds, 1.25)), c);
+    }
+    float r = length(q);
+    c = over(float4(1.0, 240.0 / 255.0, 180.0 / 255.0, 230.0 / 255.0 * band(r, 3.0)), c);
+    c = over(float4(1.0, 180.0 / 255.0, 120.0 / 255.0, band(abs(r - (base + amp) * 0.35), 1.0)), c);
+    return c;
+}
+)";
+
+template <typename T> void Release(T*& p) {
+    if (p) p->Release();
+    p = nullptr;
+}
+
+bool CompileBlob(const char* source, const char* target, ID3DBlob** blob) {
+    ID3DBlob* errors = nullptr;
+    HRESULT hr = D3DCompile(source, std::strlen(source), nullptr, nullptr, nullptr, "main", target, 0, 0, blob, &errors);
+    if (FAILED(hr)) {
+        std::fprintf(stderr, "AstroEffects: %s: %s\n", target, errors ? (const char*)errors->GetBufferPointer() : "compile failed");
+        Release(errors);
+        return false;
+    }
+    Release(errors);
+    return true;
+}
+
+// grows the dynamic instance buffer to at least n instances
+bool Reserve(DxState& s, size_t n) {
+    if (s.instances && n <= s.capacity) return true;
+    Release(s.instances);
+    size_t capacity = s.capacity ? s.capacity : 1024;
+    while (capacity < n) capacity *= 2;
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = (UINT)(capacity * sizeof(AstroEffectInstance));
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    if (FAILED(s.device->CreateBuffer(&desc, nullptr, &s.instances))) {
+        s.capacity = 0;
+        return false;
+    }
+    s.capacity = capacity;
+    return true;
+}
+
+} // namespace
+
+bool AstroEffectsInitDX11(ID3D11Device* device, ID3D11DeviceContext* context) {
+    AstroEffectsShutdown();
+    DxState& s = g_effects;
+    if (!device || !context) return false;
+    ID3DBlob* vsBlob = nullptr;
+    ID3DBlob* psBlob = nullptr;
+    bool ok = CompileBlob(VERTEX_SHADER, "vs_4_0", &vsBlob) && CompileBlob(PIXEL_SHADER, "ps_4_0", &psBlob);
+    ok = ok && SUCCEEDED(device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &s.vs));
+    ok = ok && SUCCEEDED(device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &s.ps));
+    if (ok) {
+        const D3D11_INPUT_ELEMENT_DESC layout[] = {
+            { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, (UINT)offsetof(AstroEffectInstance, x), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, (UINT)offsetof(AstroEffectInstance, vx), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "TEXCOORD", 1, DXGI_FORMAT_R32_FLOAT, 0, (UINT)offsetof(AstroEffectInstance, life), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, (UINT)offsetof(AstroEffectInstance, color), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        };
+        ok = SUCCEEDED(device->CreateInputLayout(layout, 4, vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), &s.layout));
+    }
+    if (ok) {
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth = sizeof(Constants);
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        ok = SUCCEEDED(device->CreateBuffer(&desc, nullptr, &s.constants));
+    }
+    Release(vsBlob);
+    Release(psBlob);
+    s.device = device;
+    s.context = context;
+    if (!ok) {
+        std::fprintf(stderr, "AstroEffects: GPU effects off, could not create the DX11 pipeline\n");
+        AstroEffectsShutdown();
+    }
+    return ok;
+}
+
+void AstroEffectsShutdown() {
+    DxState& s = g_effects;
+    Release(s.instances);
+    Release(s.constants);
+    Release(s.layout);
+    Release(s.ps);
+    Release(s.vs);
+    s.capacity = 0;
+    s.device = nullptr;
+    s.context = nullptr;
+}
+
+bool AstroEffectsAvailable() {
+    return g_effects.vs && g_effects.ps && g_effects.layout && g_effects.constants;
+}
+
+void AstroEffectsSetParams(const AstroEffectParams& params) {
+    g_effects.params = params;
+}
+
+// no OpenGL renderer in a DX11 build
+bool AstroEffectsInitOpenGL3(const char*) {
+    return false;
+}
+
+void AstroEffectsRender(const ImDrawList* list, const ImDrawCmd* cmd) {
+    DxState& s = g_effects;
+    const AstroEffectBatch* batch = (const AstroEffectBatch*)cmd->UserCallbackData;
+    if (!AstroEffectsAvailable() || !batch) return;
+    const size_t total = batch->Size();
+    if (total == 0 || !Reserve(s, total)) return;
+    ID3D11DeviceContext* ctx = s.context;
+
+    // every kind in one upload, drawn kind by kind from its offset
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (ctx->Map(s.instances, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped) != S_OK) return;
+    AstroEffectInstance* dst = (AstroEffectInstance*)mapped.pData;
+    for (const auto& kind : batch->instances) {
+        if (!kind.empty()) std::memcpy(dst, kind.data(), kind.size() * sizeof(AstroEffectInstance));
+        dst += kind.size();
+    }
+    ctx->Unmap(s.instances, 0);
+
+    // clip like the ImGui backend does, relative to the display origin
+    const ImVec2 pos = batch->displayPos, size = batch->displaySize;
+    const ImVec4 clip = cmd->ClipRect;
+    if (clip.z <= clip.x || clip.w <= clip.y) return;
+    const D3D11_RECT r = { (LONG)(clip.x - pos.x), (LONG)(clip.y - pos.y), (LONG)(clip.z - pos.x), (LONG)(clip.w - pos.y) };
+    ctx->RSSetScissorRects(1, &r);
+
+    // blend, rasterizer and viewport stay as the ImGui backend set them up
+    ctx->IASetInputLayout(s.layout);
+    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    ctx->VSSetShader(s.vs, nullptr, 0);
+    ctx->PSSetShader(s.ps, nullptr, 0);
+    ctx->VSSetConstantBuffers(0, 1, &s.constants);
+    ctx->PSSetConstantBuffers(0, 1, &s.constants);
+
+    const float L = pos.x, R = pos.x + size.x, T = pos.y, B = pos.y + size.y;
+    const float proj[4][4] = {
+        { 2.0f / (R - L), 0.0f, 0.0f, 0.0f },
+        { 0.0f, 2.0f / (T - B), 0.0f, 0.0f },
+        { 0.0f, 0.0f, 0.5f, 0.0f },
+        { (R + L) / (L - R), (T + B) / (B - T), 0.5f, 1.0f },
+    };
+    size_t first = 0;
+    for (int kind = 0; kind < ASTRO_EFFECT_COUNT; ++kind) {
+        const size_t n = batch->instances[kind].size();
+        if (n == 0) continue;
+        if (ctx->Map(s.constants, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped) != S_OK) return;
+        Constants* c = (Constants*)mapped.pData;
+        std::memcpy(c->proj, proj, sizeof(proj));
+        c->photon[0] = s.params.photonBaseSize;
+        c->photon[1] = s.params.photonPulseAmplitude;
+        c->photon[2] = s.params.photonSpinSpeed;
+        c->photon[3] = s.params.photonPulseSpeed;
+        c->kind = kind;
+        ctx->Unmap(s.constants, 0);
+        const UINT stride = sizeof(AstroEffectInstance);
+        const UINT offset = (UINT)(first * sizeof(AstroEffectInstance));
+        ctx->IASetVertexBuffers(0, 1, &s.instances, &stride, &offset);
+        ctx->DrawInstanced(4, (UINT)n, 0, 0);
+        first += n;
+    }
+    (void)list;
+}
@@ -0,0 +1,383 @@
+// Instanced effects renderer for the OpenGL 3 backend (see AstroEffects.h).
+// GL entry points are looked up through GLFW rather than ImGui's private loader, into a
+// table of our own so nothing clashes with the system GL headers.
+
+#include "AstroEffects.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include <GLFW/glfw3.h> // Will drag system OpenGL headers
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS 0x8B82
+#endif
+
+namespace {
+
+struct GlProcs {
+    void (APIENTRY* Enable)(unsigned int cap);
+    void (APIENTRY* Scissor)(int x, int y, int width, int height);
+    unsigned int (APIENTRY* CreateShader)(unsigned int type);
+    void (APIENTRY* ShaderSource)(unsigned int shader, int count, const char* const* source, const int* length);
+    void (APIENTRY* CompileShader)(unsigned int shader);
+    void (APIENTRY* GetShaderiv)(unsigned int shader, unsigned int pname, int* params);
+    void (APIENTRY* GetShaderInfoLog)(unsigned int shader, int size, int* length, char* log);
+    void (APIENTRY* DeleteShader)(unsigned int shader);
+    unsigned int (APIENTRY* CreateProgram)();
+    void (APIENTRY* AttachShader)(unsigned int program, unsigned int shader);
+    void (APIENTRY* BindAttribLocation)(unsigned int program, unsigned int index, const char* name);
+    void (APIENTRY* LinkProgram)(unsigned int program);
+    void (APIENTRY* GetProgramiv)(unsigned int program, unsigned int pname, int* params);
+    void (APIENTRY* GetProgramInfoLog)(unsigned int program, int size, int* length, char* log);
+    void (APIENTRY* DeleteProgram)(unsigned int program);
+    void (APIENTRY* UseProgram)(unsigned int program);
+    int (APIENTRY* GetUniformLocation)(unsigned int program, const char* name);
+    void (APIENTRY* UniformMatrix4fv)(int location, int count, unsigned char transpose, const float* value);
+    void (APIENTRY* Uniform1i)(int location, int v0);
+    void (APIENTRY* Uniform4f)(int location, float v0, float v1, float v2, float v3);
+    void (APIENTRY* GenBuffers)(int n, unsigned int* buffers);
+    void (APIENTRY* DeleteBuffers)(int n, const unsigned int* buffers);
+    void (APIENTRY* BindBuffer)(unsigned int target, unsigned int buffer);
+    void (APIENTRY* BufferData)(unsigned int target, std::ptrdiff_t size, const void* data, unsigned int usage);
+    void (APIENTRY* GenVertexArrays)(int n, unsigned int* arrays);
+    void (APIENTRY* DeleteVertexArrays)(int n, const unsigned int* arrays);
+    void (APIENTRY* BindVertexArray)(unsigned int array);
+    void (APIENTRY* EnableVertexAttribArray)(unsigned int index);
+    void (APIENTRY* VertexAttribPointer)(unsigned int index, int size, unsigned int type, unsigned char normalized,
+                                         int stride, const void* pointer);
+    void (APIENTRY* VertexAttribDivisor)(unsigned int index, unsigned int divisor);
+    void (APIENTRY* DrawArraysInstanced)(unsigned int mode, int first, int count, int instances);
+};
+
+struct GlState {
+    GlProcs gl{};
+    bool ready = false;
+    unsigned int program = 0;
+    unsigned int vao = 0;
+    unsigned int vbo = 0;
+    int projLoc = -1;
+    int kindLoc = -1;
+    int photonLoc = -1;
+    AstroEffectParams params{ 4.0f, 7.0f, 0.11f, 0.20f };
+    std::vector<AstroEffectInstance> upload; // every kind back to back, reused frame to frame
+};
+GlState g_effects;
+
+enum : unsigned int { ATTR_POS = 0, ATTR_VEL, ATTR_LIFE, ATTR_COLOR };
+
+// The quad each instance expands to, from gl_VertexID (a 4-vertex strip): along the
+// segment for particles and debris, round the center for torpedoes. v_local is the
+// fragment's position in pixels relative to the segment start (along, across) or to the
+// torpedo center.
+const char* VERTEX_SHADER = R"(
+uniform mat4 u_proj;
+uniform int u_kind;
+uniform vec4 u_photon;
+in vec2 a_pos;
+in vec2 a_vel;
+in float a_life;
+in vec4 a_color;
+out vec2 v_local;
+out float v_life;
+out vec4 v_color;
+void main() {
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec2 p;
+    if (u_kind == 2) {
+        float r = u_photon.x + u_photon.y + 4.0;
+        v_local = (corner * 2.0 - 1.0) * r;
+        p = a_pos + v_local;
+    } else {
+        float len = length(a_vel);
+        vec2 dir = len > 1e-4 ? a_vel / len : vec2(1.0, 0.0);
+        vec2 nrm = vec2(-dir.y, dir.x);
+        float hw = (u_kind == 0 ? 7.0 * a_life + 2.0 : 6.0 * a_life + 1.5) * 0.5 + 1.0;
+        v_local = vec2(corner.x * len, mix(-hw, hw, corner.y));
+        p = a_pos + dir * v_local.x + nrm * v_local.y;
+    }
+    v_life = a_life;
+    v_color = a_color;
+    gl_Position = u_proj * vec4(p, 0.0, 1.0);
+}
+)";
+
+// The same layers the ImDrawList path draws, composited in the same order: glow under
+// core for particles and debris; spoke glows, spokes, core dot and halo for torpedoes.
+const char* FRAGMENT_SHADER = R"(
+uniform int u_kind;
+uniform vec4 u_photon;
+in vec2 v_local;
+in float v_life;
+in vec4 v_color;
+out vec4 o_color;
+float band(float d, float hw) { return clamp(hw - d + 0.5, 0.0, 1.0); }
+vec4 over(vec4 top, vec4 under) {
+    float a = top.a + under.a * (1.0 - top.a);
+    vec3 rgb = a > 0.0 ? (top.rgb * top.a + under.rgb * under.a * (1.0 - top.a)) / a : vec3(0.0);
+    return vec4(rgb, a);
+}
+void main() {
+    float life = v_life;
+    float d = abs(v_local.y);
+    if (u_kind == 0) {
+        vec3 rgb = v_color.rgb + (1.0 - v_color.rgb) * life;
+        vec4 glow = vec4(rgb, 120.0 / 255.0 * life * life * band(d, (7.0 * life + 2.0) * 0.5));
+        vec4 core = vec4(rgb, (220.0 * life * life + 35.0) / 255.0 * band(d, (3.0 * life + 1.0) * 0.5));
+        o_color = over(core, glow);
+    } else if (u_kind == 1) {
+        vec4 glow = vec4(v_color.rgb, 120.0 / 255.0 * life * life * band(d, (6.0 * life + 1.5) * 0.5));
+        vec4 core = vec4(1.0, 1.0, 1.0, (230.0 * life * life + 20.0) / 255.0 * band(d, (2.0 * life + 1.0) * 0.5));
+        o_color = over(core, glow);
+    } else {
+        float angle = life * u_photon.z;
+        float pulseT = life * u_photon.w;
+        float pulse = 0.65 + 0.35 * (0.5 * (sin(pulseT) + 1.0));
+        float base = u_photon.x * pulse;
+        float amp = u_photon.y * (0.6 + 0.4 * (0.5 * (sin(pulseT * 0.8 + 1.3) + 1.0)));
+        const float STEP = 6.2831853 / 12.0;
+        float k = floor((atan(v_local.y, v_local.x) - angle) / STEP + 0.5);
+        vec4 c = vec4(0.0);
+        for (int j = -1; j <= 1; ++j) {
+            float kk = k + float(j);
+            float a = angle + kk * STEP;
+            float phase = mod(kk, 2.0) < 0.5 ? 0.0 : 1.5707963;
+            float len = base + amp * (0.5 * (sin(pulseT + phase) + 1.0));
+            vec2 dir = vec2(cos(a), sin(a));
+            float t = clamp(dot(v_local, dir), -len * 0.25, len);
+            float ds = length(v_local - dir * t);
+            c = over(vec4(1.0, 100.0 / 255.0, 100.0 / 255.0, 110.0 / 255.0 * band(ds, 3.0)), c);
+            c = over(vec4(1.0, 80.0 / 255.0, 80.0 / 255.0, band(ds, 1.25)), c);
+        }
+        float r = length(v_local);
+        c = over(vec4(1.0, 240.0 / 255.0, 180.0 / 255.0, 230.0 / 255.0 * band(r, 3.0)), c);
+        c = over(vec4(1.0, 180.0 / 255.0, 120.0 / 255.0, band(abs(r - (base + amp) * 0.35), 1.0)), c);
+        o_color = c;
+    }
+}
+)";
+
+template <typename Fn> bool Load(Fn& fn, const char* name) {
+    fn = reinterpret_cast<Fn>(glfwGetProcAddress(name));
+    return fn != nullptr;
+}
+
+bool LoadProcs(GlProcs& gl) {
+    bool ok = true;
+    ok &= Load(gl.Enable, "glEnable");
+    ok &= Load(gl.Scissor, "glScissor");
+    ok &= Load(gl.CreateShader, "glCreateShader");
+    ok &= Load(gl.ShaderSource, "glShaderSource");
+    ok &= Load(gl.CompileShader, "glCompileShader");
+    ok &= Load(gl.GetShaderiv, "glGetShaderiv");
+    ok &= Load(gl.GetShaderInfoLog, "glGetShaderInfoLog");
+    ok &= Load(gl.DeleteShader, "glDeleteShader");
+    ok &= Load(gl.CreateProgram, "glCreateProgram");
+    ok &= Load(gl.AttachShader, "glAttachShader");
+    ok &= Load(gl.BindAttribLocation, "glBindAttribLocation");
+    ok &= Load(gl.LinkProgram, "glLinkProgram");
+    ok &= Load(gl.GetProgramiv, "glGetProgramiv");
+    ok &= Load(gl.GetProgramInfoLog, "glGetProgramInfoLog");
+    ok &= Load(gl.DeleteProgram, "glDeleteProgram");
+    ok &= Load(gl.UseProgram, "glUseProgram");
+    ok &= Load(gl.GetUniformLocation, "glGetUniformLocation");
+    ok &= Load(gl.UniformMatrix4fv, "glUniformMatrix4fv");
+    ok &= Load(gl.Uniform1i, "glUniform1i");
+    ok &= Load(gl.Uniform4f, "glUniform4f");
+    ok &= Load(gl.GenBuffers, "glGenBuffers");
+    ok &= Load(gl.DeleteBuffers, "glDeleteBuffers");
+    ok &= Load(gl.BindBuffer, "glBindBuffer");
+    ok &= Load(gl.BufferData, "glBufferData");
+    ok &= Load(gl.GenVertexArrays, "glGenVertexArrays");
+    ok &= Load(gl.DeleteVertexArrays, "glDeleteVertexArrays");
+    ok &= Load(gl.BindVertexArray, "glBindVertexArray");
+    ok &= Load(gl.EnableVertexAttribArray, "glEnableVertexAttribArray");
+    ok &= Load(gl.VertexAttribPointer, "glVertexAttribPointer");
+    // GL 3.3 (or ARB_instanced_arrays) and 3.1
+    if (!Load(gl.VertexAttribDivisor, "glVertexAttribDivisor")) ok &= Load(gl.VertexAttribDivisor, "glVertexAttribDivisorARB");
+    ok &= Load(gl.DrawArraysInstanced, "glDrawArraysInstanced");
+    return ok;
+}
+
+bool Compile(const GlProcs& gl, unsigned int type, const std::string& source, unsigned int& shader, std::string* error) {
+    shader = gl.CreateShader(type);
+    const char* text = source.c_str();
+    gl.ShaderSource(shader, 1, &text, nullptr);
+    gl.CompileShader(shader);
+    int status = 0;
+    gl.GetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status) return true;
+    char log[1024] = {};
+    gl.GetShaderInfoLog(shader, (int)sizeof(log), nullptr, log);
+    if (error) *error = std::string(type == GL_VERTEX_SHADER ? "vertex" : "fragment") + " shader: " + log;
+    gl.DeleteShader(shader);
+    shader = 0;
+    return false;
+}
+
+bool BuildProgram(GlState& s, const char* glslVersion, std::string* error) {
+    const GlProcs& gl = s.gl;
+    const std::string header = std::string(glslVersion) + "\n";
+    unsigned int vs = 0, fs = 0;
+    if (!Compile(gl, GL_VERTEX_SHADER, header + VERTEX_SHADER, vs, error)) return false;
+    if (!Compile(gl, GL_FRAGMENT_SHADER, header + FRAGMENT_SHADER, fs, error)) {
+        gl.DeleteShader(vs);
+        return false;
+    }
+    s.program = gl.CreateProgram();
+    gl.AttachShader(s.program, vs);
+    gl.AttachShader(s.program, fs);
+    gl.BindAttribLocation(s.program, ATTR_POS, "a_pos");
+    gl.BindAttribLocation(s.program, ATTR_VEL, "a_vel");
+    gl.BindAttribLocation(s.program, ATTR_LIFE, "a_life");
+    gl.BindAttribLocation(s.program, ATTR_COLOR, "a_color");
+    gl.LinkProgram(s.program);
+    gl.DeleteShader(vs);
+    gl.DeleteShader(fs);
+    int status = 0;
+    gl.GetProgramiv(s.program, GL_LINK_STATUS, &status);
+    if (!status) {
+        char log[1024] = {};
+        gl.GetProgramInfoLog(s.program, (int)sizeof(log), nullptr, log);
+        if (error) *error = std::string("link: ") + log;
+        gl.DeleteProgram(s.program);
+        s.program = 0;
+        return false;
+    }
+    s.projLoc = gl.GetUniformLocation(s.program, "u_proj");
+    s.kindLoc = gl.GetUniformLocation(s.program, "u_kind");
+    s.photonLoc = gl.GetUniformLocation(s.program, "u_photon");
+    return true;
+}
+
+// instance attributes start at byte offset `first` instances into the buffer
+void PointAttributes(const GlProcs& gl, size_t first) {
+    const int stride = (int)sizeof(AstroEffectInstance);
+    const char* base = (const char*)(first * sizeof(AstroEffectInstance));
+    gl.VertexAttribPointer(ATTR_POS, 2, GL_FLOAT, GL_FALSE, stride, base + offsetof(AstroEffectInstance, x));
+    gl.VertexAttribPointer(ATTR_VEL, 2, GL_FLOAT, GL_FALSE, stride, base + offsetof(AstroEffectInstance, vx));
+    gl.VertexAttribPointer(ATTR_LIFE, 1, GL_FLOAT, GL_FALSE, stride, base + offsetof(AstroEffectInstance, life));
+    gl.VertexAttribPointer(ATTR_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, base + offsetof(AstroEffectInstance, color));
+}
+
+} // namespace
+
+bool AstroEffectsInitOpenGL3(const char* glslVersion) {
+    AstroEffectsShutdown();
+    GlState& s = g_effects;
+    std::string error;
+    // GLSL 100 is GL ES 2, which has neither instancing nor gl_VertexID
+    if (!glslVersion || std::string(glslVersion).find("100") != std::string::npos) {
+        error = "needs GLSL 1.30 or later";
+    } else if (!LoadProcs(s.gl)) {
+        error = "no instanced drawing (glVertexAttribDivisor, glDrawArraysInstanced)";
+    } else if (BuildProgram(s, glslVersion, &error)) {
+        const GlProcs& gl = s.gl;
+        gl.GenVertexArrays(1, &s.vao);
+        gl.GenBuffers(1, &s.vbo);
+        gl.BindVertexArray(s.vao);
+        gl.BindBuffer(GL_ARRAY_BUFFER, s.vbo);
+        for (unsigned int attr : { ATTR_POS, ATTR_VEL, ATTR_LIFE, ATTR_COLOR }) {
+            gl.EnableVertexAttribArray(attr);
+            gl.VertexAttribDivisor(attr, 1);
+        }
+        PointAttributes(gl, 0);
+        gl.BindVertexArray(0);
+        s.ready = true;
+        return true;
+    }
+    std::fprintf(stderr, "AstroEffects: GPU effects off, %s\n", error.c_str());
+    return false;
+}
+
+void AstroEffectsShutdown() {
+    GlState& s = g_effects;
+    if (s.ready) {
+        s.gl.DeleteBuffers(1, &s.vbo);
+        s.gl.DeleteVertexArrays(1, &s.vao);
+        s.gl.DeleteProgram(s.program);
+    }
+    s.ready = false;
+    s.program = s.vao = s.vbo = 0;
+}
+
+bool AstroEffectsAvailable() {
+    return g_effects.ready;
+}
+
+void AstroEffectsSetParams(const AstroEffectParams& params) {
+    g_effects.params = params;
+}
+
+// no instanced renderer for DX11 in this build
+bool AstroEffectsInitDX11(ID3D11Device*, ID3D11DeviceContext*) {
+    return false;
+}
+
+void AstroEffectsRender(const ImDrawList* list, const ImDrawCmd* cmd) {
+    GlState& s = g_effects;
+    const AstroEffectBatch* batch = (const AstroEffectBatch*)cmd->UserCallbackData;
+    if (!s.ready || !batch || batch->Size() == 0) return;
+    const GlProcs& gl = s.gl;
+
+    // clip like the ImGui backend does: ClipRect is in display coordinates, scissor in
+    // framebuffer pixels from the bottom
+    const ImVec2 pos = batch->displayPos, size = batch->displaySize, scale = batch->framebufferScale;
+    const float fbHeight = size.y * scale.y;
+    const ImVec4 clip = cmd->ClipRect;
+    if (clip.z <= clip.x || clip.w <= clip.y) return;
+    gl.Enable(GL_SCISSOR_TEST);
+    gl.Scissor((int)((clip.x - pos.x) * scale.x), (int)(fbHeight - (clip.w - pos.y) * scale.y),
+               (int)((clip.z - clip.x) * scale.x), (int)((clip.w - clip.y) * scale.y));
+    gl.Enable(GL_BLEND);
+
+    // same orthographic projection as ImGui_ImplOpenGL3_SetupRenderState
+    const float L = pos.x, R = pos.x + size.x, T = pos.y, B = pos.y + size.y;
+    const float proj[4][4] = {
+        { 2.0f / (R - L), 0.0f, 0.0f, 0.0f },
+        { 0.0f, 2.0f / (T - B), 0.0f, 0.0f },
+        { 0.0f, 0.0f, -1.0f, 0.0f },
+        { (R + L) / (L - R), (T + B) / (B - T), 0.0f, 1.0f },
+    };
+
+    // every kind in one upload, drawn kind by kind from its offset
+    s.upload.clear();
+    for (const auto& kind : batch->instances) s.upload.insert(s.upload.end(), kind.begin(), kind.end());
+    gl.UseProgram(s.program);
+    gl.UniformMatrix4fv(s.projLoc, 1, GL_FALSE, &proj[0][0]);
+    gl.Uniform4f(s.photonLoc, s.params.photonBaseSize, s.params.photonPulseAmplitude, s.params.photonSpinSpeed,
+                 s.params.photonPulseSpeed);
+    gl.BindVertexArray(s.vao);
+    gl.BindBuffer(GL_ARRAY_BUFFER, s.vbo);
+    gl.BufferData(GL_ARRAY_BUFFER, (std::ptrdiff_t)(s.upload.size() * sizeof(AstroEffectInstance)), s.upload.data(),
+                  GL_STREAM_DRAW);
+    size_t first = 0;
+    for (int kind = 0; kind < ASTRO_EFFECT_COUNT; ++kind) {
+        const size_t n = batch->instances[kind].size();
+        if (n == 0) continue;
+        PointAttributes(gl, first);
+        gl.Uniform1i(s.kindLoc, kind);
+        gl.DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (int)n);
+        first += n;
+    }
+    (void)list;
+}
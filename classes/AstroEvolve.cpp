@@ -0,0 +1,505 @@
+#include "AstroEvolve.h"
+#include "AstroArena.h"
+#include "AstroBatch.h"
+#include "AstroNative.h"
+#include "AstroThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+
+namespace {
+
+// what search draws from; matches are 1v1, so there is nobody to SIGNAL() to or listen for
+const int kActions[] = {
+    ASTRO_OP_THRUST, ASTRO_OP_TURN_DEG, ASTRO_OP_FIRE_PHASER, ASTRO_OP_FIRE_PHOTON, ASTRO_OP_SCAN,
+    ASTRO_OP_SCAN_SHIPS, ASTRO_OP_SCAN_ASTEROIDS, ASTRO_OP_SCAN_TORPEDOES, ASTRO_OP_TURN_TO_SCAN
+};
+const int kConditions[] = {
+    ASTRO_OP_IF_SEEN, ASTRO_OP_IF_SCAN_LE, ASTRO_OP_IF_DAMAGED, ASTRO_OP_IF_HP_LE,
+    ASTRO_OP_IF_FUEL_LE, ASTRO_OP_IF_CAN_FIRE_PHASER, ASTRO_OP_IF_CAN_FIRE_PHOTON
+};
+
+// the values search gives an operand: [lo, hi], nudged by up to step
+struct ParamRange { int lo, hi, step; };
+ParamRange RangeOf(int op) {
+    switch (op) {
+        case ASTRO_OP_THRUST: return { 1, 50, 5 };     // power 0.1 - 5.0
+        case ASTRO_OP_TURN_DEG: return { -180, 180, 30 };
+        case ASTRO_OP_SIGNAL: return { 0, 9, 2 };
+        case ASTRO_OP_IF_SCAN_LE: return { 25, (int)ASTRO_SCAN_RANGE, 60 };
+        case ASTRO_OP_IF_HP_LE: return { 1, ASTRO_START_HP - 1, 2 };
+        case ASTRO_OP_IF_FUEL_LE: return { 5, (int)ASTRO_START_FUEL - 5, 10 };
+        case ASTRO_OP_IF_SIGNAL_LE: return { 25, (int)ASTRO_SIGNAL_RANGE, 100 };
+        case ASTRO_OP_IF_SIGNAL_IS: return { 0, 9, 2 };
+        default: return { 0, 0, 0 };
+    }
+}
+
+void EmitBlock(const std::vector<AstroGene>& block, std::vector<int>& code) {
+    for (const AstroGene& g : block) {
+        if (!AstroIsCondition(g.op)) {
+            code.push_back(g.op);
+            if (AstroOperandCount(g.op)) code.push_back(g.param);
+            continue;
+        }
+        // the words IF_*() and ELSE() emit
+        code.push_back(g.op);
+        code.push_back(g.param);
+        code.push_back(ASTRO_OP_JUMP_IF_FALSE);
+        code.push_back(0);
+        size_t falseJump = code.size() - 1;
+        EmitBlock(g.then, code);
+        if (g.otherwise.empty()) {
+            code[falseJump] = (int)code.size();
+            continue;
+        }
+        code.push_back(ASTRO_OP_JUMP);
+        code.push_back(0);
+        size_t endJump = code.size() - 1;
+        code[falseJump] = (int)code.size();
+        EmitBlock(g.otherwise, code);
+        code[endJump] = (int)code.size();
+    }
+}
+
+int BlockCost(const std::vector<AstroGene>& block) {
+    int cost = 0;
+    for (const AstroGene& g : block) cost += AstroOpCost(g.op) + BlockCost(g.then) + BlockCost(g.otherwise);
+    return cost;
+}
+int BlockSize(const std::vector<AstroGene>& block) {
+    int n = 0;
+    for (const AstroGene& g : block) n += 1 + BlockSize(g.then) + BlockSize(g.otherwise);
+    return n;
+}
+int BlockDepth(const std::vector<AstroGene>& block) {
+    int depth = 0;
+    for (const AstroGene& g : block) {
+        if (AstroIsCondition(g.op)) depth = std::max(depth, 1 + std::max(BlockDepth(g.then), BlockDepth(g.otherwise)));
+    }
+    return depth;
+}
+
+// Parses statements in [pc, end). Inside a THEN body (elseTarget set), a JUMP that ends
+// the range is the ELSE() jump: its target is where the ELSE body ends.
+bool ParseBlock(const std::vector<int>& code, int& pc, int end, std::vector<AstroGene>& out, int* elseTarget) {
+    while (pc < end) {
+        int op = code[pc];
+        if (op == ASTRO_OP_JUMP && elseTarget && pc + 2 == end) {
+            *elseTarget = code[pc + 1];
+            pc = end;
+            return true;
+        }
+        if (AstroIsCondition(op)) {
+            if (pc + 4 > end || code[pc + 2] != ASTRO_OP_JUMP_IF_FALSE) return false;
+            AstroGene g;
+            g.op = op;
+            g.param = code[pc + 1];
+            int falseTarget = code[pc + 3];
+            if (falseTarget < pc + 4 || falseTarget > end) return false;
+            int p = pc + 4;
+            int bodyEnd = -1;
+            if (!ParseBlock(code, p, falseTarget, g.then, &bodyEnd)) return false;
+            pc = falseTarget;
+            if (bodyEnd >= 0) {
+                if (bodyEnd < falseTarget || bodyEnd > end) return false;
+                if (!ParseBlock(code, pc, bodyEnd, g.otherwise, nullptr)) return false;
+            }
+            out.push_back(std::move(g));
+            continue;
+        }
+        if (op < 0 || op >= ASTRO_OP_IF_SEEN) return false; // flow control outside the block shapes
+        int operands = AstroOperandCount(op);
+        if (pc + 1 + operands > end) return false;
+        AstroGene g;
+        g.op = op;
+        g.param = operands ? code[pc + 1] : 0;
+        out.push_back(std::move(g));
+        pc += 1 + operands;
+    }
+    return pc == end;
+}
+
+void SourceBlock(const std::vector<AstroGene>& block, int indent, std::string& out) {
+    char line[96];
+    std::string pad((size_t)indent * 4, ' ');
+    for (const AstroGene& g : block) {
+        switch (g.op) {
+            case ASTRO_OP_THRUST: std::snprintf(line, sizeof(line), "THRUST(%g);", g.param / 10.0); break;
+            case ASTRO_OP_TURN_DEG: std::snprintf(line, sizeof(line), "TURN_DEG(%d);", g.param); break;
+            case ASTRO_OP_FIRE_PHASER: std::snprintf(line, sizeof(line), "FIRE_PHASER();"); break;
+            case ASTRO_OP_FIRE_PHOTON: std::snprintf(line, sizeof(line), "FIRE_PHOTON();"); break;
+            case ASTRO_OP_SCAN: std::snprintf(line, sizeof(line), "SCAN();"); break;
+            case ASTRO_OP_SIGNAL: std::snprintf(line, sizeof(line), "SIGNAL(%d);", g.param); break;
+            case ASTRO_OP_TURN_TO_SCAN: std::snprintf(line, sizeof(line), "TURN_TO_SCAN();"); break;
+            case ASTRO_OP_SCAN_SHIPS: std::snprintf(line, sizeof(line), "SCAN_SHIPS();"); break;
+            case ASTRO_OP_SCAN_ASTEROIDS: std::snprintf(line, sizeof(line), "SCAN_ASTEROIDS();"); break;
+            case ASTRO_OP_SCAN_TORPEDOES: std::snprintf(line, sizeof(line), "SCAN_TORPEDOES();"); break;
+            case ASTRO_OP_IF_SEEN: std::snprintf(line, sizeof(line), "IF_SEEN() {"); break;
+            case ASTRO_OP_IF_SCAN_LE: std::snprintf(line, sizeof(line), "IF_SCAN_LE(%d) {", g.param); break;
+            case ASTRO_OP_IF_DAMAGED: std::snprintf(line, sizeof(line), "IF_SHIP_DAMAGED() {"); break;
+            case ASTRO_OP_IF_HP_LE: std::snprintf(line, sizeof(line), "IF_SHIP_HP_LE(%d) {", g.param); break;
+            case ASTRO_OP_IF_FUEL_LE: std::snprintf(line, sizeof(line), "IF_SHIP_FUEL_LE(%d) {", g.param); break;
+            case ASTRO_OP_IF_CAN_FIRE_PHASER: std::snprintf(line, sizeof(line), "IF_SHIP_CAN_FIRE_PHASER() {"); break;
+            case ASTRO_OP_IF_CAN_FIRE_PHOTON: std::snprintf(line, sizeof(line), "IF_SHIP_CAN_FIRE_PHOTON() {"); break;
+            case ASTRO_OP_TURN_TO_SIGNAL: std::snprintf(line, sizeof(line), "TURN_TO_SIGNAL();"); break;
+            case ASTRO_OP_IF_SIGNAL_LE: std::snprintf(line, sizeof(line), "IF_SIGNAL_LE(%d) {", g.param); break;
+            case ASTRO_OP_IF_SIGNAL_IS: std::snprintf(line, sizeof(line), "IF_SIGNAL_IS(%d) {", g.param); break;
+            default: std::snprintf(line, sizeof(line), "WAIT_();"); break;
+        }
+        out += pad + line + "\n";
+        if (!AstroIsCondition(g.op)) continue;
+        SourceBlock(g.then, indent + 1, out);
+        if (!g.otherwise.empty()) {
+            out += pad + "} ELSE() {\n";
+            SourceBlock(g.otherwise, indent + 1, out);
+        }
+        out += pad + "}\n";
+    }
+}
+
+// every statement list in block and below it, block first
+void CollectBlocks(std::vector<AstroGene>& block, std::vector<std::vector<AstroGene>*>& out) {
+    out.push_back(&block);
+    for (AstroGene& g : block) {
+        if (!AstroIsCondition(g.op)) continue;
+        CollectBlocks(g.then, out);
+        CollectBlocks(g.otherwise, out);
+    }
+}
+
+// drops conditions nested deeper than maxDepth; level is the nesting of block's statements
+void TrimDepth(std::vector<AstroGene>& block, int level, int maxDepth) {
+    for (size_t i = 0; i < block.size();) {
+        AstroGene& g = block[i];
+        if (AstroIsCondition(g.op)) {
+            if (level + 1 > maxDepth) {
+                block.erase(block.begin() + (std::ptrdiff_t)i);
+                continue;
+            }
+            TrimDepth(g.then, level + 1, maxDepth);
+            TrimDepth(g.otherwise, level + 1, maxDepth);
+        }
+        ++i;
+    }
+}
+
+} // namespace
+
+// ===== Genomes =====
+
+void AstroGenome::Emit(std::vector<int>& code) const {
+    code.clear();
+    EmitBlock(body, code);
+    code.push_back(ASTRO_OP_END);
+}
+
+int AstroGenome::Cost() const { return BlockCost(body); }
+int AstroGenome::Size() const { return BlockSize(body); }
+int AstroGenome::Depth() const { return BlockDepth(body); }
+
+std::string AstroGenome::Source() const {
+    std::string out;
+    SourceBlock(body, 0, out);
+    out += "return Finalize();\n";
+    return out;
+}
+
+bool AstroDecodeGenome(const std::vector<int>& code, AstroGenome& genome) {
+    genome.body.clear();
+    if (code.empty() || code.back() != ASTRO_OP_END) return false;
+    int pc = 0;
+    return ParseBlock(code, pc, (int)code.size() - 1, genome.body, nullptr);
+}
+
+int GenomeShip::SetupShip() {
+    genome.Emit(code);
+    script_cost = genome.Cost();
+    Compile();
+    return script_cost;
+}
+
+// ===== Search =====
+
+AstroEvolver::AstroEvolver(std::vector<ShipType> opponents, const AstroEvolveOptions& options)
+    : _opponents(std::move(opponents)), _options(options), _rng(options.seed) {
+    _options.population = std::max(2, _options.population);
+    _options.elite = std::clamp(_options.elite, 0, _options.population - 1);
+    _options.tournament = std::max(1, _options.tournament);
+    _options.gamesPerSide = std::max(1, _options.gamesPerSide);
+    _options.maxSize = std::max(1, _options.maxSize);
+}
+
+int AstroEvolver::RandomParam(int op) {
+    ParamRange r = RangeOf(op);
+    return std::uniform_int_distribution<int>(r.lo, r.hi)(_rng);
+}
+
+AstroGene AstroEvolver::RandomStatement(int depth) {
+    AstroGene g;
+    bool condition = depth < _options.maxDepth && std::uniform_int_distribution<int>(0, 99)(_rng) < 35;
+    if (!condition) {
+        g.op = kActions[std::uniform_int_distribution<size_t>(0, std::size(kActions) - 1)(_rng)];
+        g.param = RandomParam(g.op);
+        return g;
+    }
+    g.op = kConditions[std::uniform_int_distribution<size_t>(0, std::size(kConditions) - 1)(_rng)];
+    g.param = RandomParam(g.op);
+    g.then = RandomBlock(depth + 1, std::uniform_int_distribution<int>(1, 3)(_rng));
+    if (std::uniform_int_distribution<int>(0, 3)(_rng) == 0) g.otherwise = RandomBlock(depth + 1, 1);
+    return g;
+}
+
+std::vector<AstroGene> AstroEvolver::RandomBlock(int depth, int statements) {
+    std::vector<AstroGene> block;
+    for (int i = 0; i < statements; ++i) block.push_back(RandomStatement(depth));
+    return block;
+}
+
+AstroGenome AstroEvolver::RandomGenome() {
+    AstroGenome g;
+    g.body = RandomBlock(0, std::uniform_int_distribution<int>(2, 6)(_rng));
+    Repair(g);
+    return g;
+}
+
+void AstroEvolver::Repair(AstroGenome& g) {
+    TrimDepth(g.body, 0, _options.maxDepth);
+    std::vector<std::vector<AstroGene>*> blocks;
+    while (g.Cost() > ASTRO_MAX_SCRIPT_COST || g.Size() > _options.maxSize) {
+        // drop a random statement (with whatever it holds)
+        blocks.clear();
+        CollectBlocks(g.body, blocks);
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [](auto* b) { return b->empty(); }), blocks.end());
+        if (blocks.empty()) break;
+        auto& block = *blocks[std::uniform_int_distribution<size_t>(0, blocks.size() - 1)(_rng)];
+        block.erase(block.begin() + (std::ptrdiff_t)std::uniform_int_distribution<size_t>(0, block.size() - 1)(_rng));
+    }
+}
+
+void AstroEvolver::Mutate(AstroGenome& g) {
+    std::vector<std::vector<AstroGene>*> blocks;
+    CollectBlocks(g.body, blocks);
+    auto pick = [&](size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(_rng); };
+    std::vector<AstroGene>& block = *blocks[pick(blocks.size())];
+    if (block.empty()) {
+        block.push_back(RandomStatement(_options.maxDepth)); // an action
+        Repair(g);
+        return;
+    }
+    size_t i = pick(block.size());
+    AstroGene& s = block[i];
+    switch (std::uniform_int_distribution<int>(0, 7)(_rng)) {
+        case 0: case 1: { // nudge the operand; most of the search is tuning thresholds
+            ParamRange r = RangeOf(s.op);
+            if (r.hi == r.lo) break;
+            int d = std::uniform_int_distribution<int>(-r.step, r.step)(_rng);
+            s.param = std::clamp(s.param + (d ? d : 1), r.lo, r.hi);
+            break;
+        }
+        case 2: { // another opcode of the same kind, keeping the bodies
+            bool condition = AstroIsCondition(s.op);
+            s.op = condition ? kConditions[pick(std::size(kConditions))] : kActions[pick(std::size(kActions))];
+            ParamRange r = RangeOf(s.op);
+            if (s.param < r.lo || s.param > r.hi) s.param = RandomParam(s.op);
+            break;
+        }
+        case 3: // insert
+            block.insert(block.begin() + (std::ptrdiff_t)pick(block.size() + 1), RandomStatement(_options.maxDepth - 1));
+            break;
+        case 4: // delete
+            block.erase(block.begin() + (std::ptrdiff_t)i);
+            break;
+        case 5: { // wrap in a new condition
+            AstroGene c;
+            c.op = kConditions[pick(std::size(kConditions))];
+            c.param = RandomParam(c.op);
+            c.then.push_back(std::move(s));
+            block[i] = std::move(c);
+            break;
+        }
+        case 6: { // unwrap: the condition's THEN body takes its place
+            if (!AstroIsCondition(s.op)) break;
+            std::vector<AstroGene> then = std::move(s.then);
+            block.erase(block.begin() + (std::ptrdiff_t)i);
+            block.insert(block.begin() + (std::ptrdiff_t)i, then.begin(), then.end());
+            break;
+        }
+        default: // add or drop an ELSE body; an action moves down one instead
+            if (!AstroIsCondition(s.op)) {
+                if (i + 1 < block.size()) std::swap(block[i], block[i + 1]);
+            } else if (s.otherwise.empty()) {
+                s.otherwise.push_back(RandomStatement(_options.maxDepth));
+            } else {
+                s.otherwise.clear();
+            }
+            break;
+    }
+    Repair(g);
+}
+
+AstroGenome AstroEvolver::Crossover(const AstroGenome& a, const AstroGenome& b) {
+    // the tail of a statement list in a replaced by the tail of one in b
+    AstroGenome child = a;
+    AstroGenome donor = b;
+    std::vector<std::vector<AstroGene>*> to, from;
+    CollectBlocks(child.body, to);
+    CollectBlocks(donor.body, from);
+    auto pick = [&](size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(_rng); };
+    std::vector<AstroGene>& dst = *to[pick(to.size())];
+    std::vector<AstroGene>& src = *from[pick(from.size())];
+    size_t cut = pick(dst.size() + 1);
+    size_t graft = pick(src.size() + 1);
+    dst.resize(cut);
+    dst.insert(dst.end(), std::make_move_iterator(src.begin() + (std::ptrdiff_t)graft), std::make_move_iterator(src.end()));
+    Repair(child);
+    return child;
+}
+
+const AstroEvolveCandidate& AstroEvolver::Select() {
+    size_t best = std::uniform_int_distribution<size_t>(0, _population.size() - 1)(_rng);
+    for (int k = 1; k < _options.tournament; ++k) {
+        size_t c = std::uniform_int_distribution<size_t>(0, _population.size() - 1)(_rng);
+        if (_population[c].fitness > _population[best].fitness) best = c;
+    }
+    return _population[best];
+}
+
+AstroEvolveGeneration AstroEvolver::Evaluate(std::vector<AstroEvolveCandidate>& candidates, AstroThreadPool& pool) {
+    auto start = std::chrono::steady_clock::now();
+    AstroEvolveGeneration gen;
+
+    // one run per program not seen before; duplicates share it
+    std::vector<const AstroGenome*> programs;
+    std::vector<uint64_t> programHashes;
+    std::vector<int> runOf(candidates.size(), -1);
+    std::unordered_map<uint64_t, int> runOfHash;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        GenomeShip ship(candidates[i].genome, "Candidate");
+        ship.SetupShip();
+        candidates[i].hash = AstroProgramHash(ship.program);
+        if (_fitness.count(candidates[i].hash)) {
+            gen.cached++;
+            continue;
+        }
+        auto [it, added] = runOfHash.emplace(candidates[i].hash, (int)programs.size());
+        runOf[i] = it->second;
+        if (!added) {
+            gen.cached++;
+            continue;
+        }
+        programs.push_back(&candidates[i].genome);
+        programHashes.push_back(candidates[i].hash);
+    }
+    _cacheHits += gen.cached;
+    gen.simulated = (int)programs.size();
+
+    // every program against every opponent on both sides, one batch of seeds each
+    const int sides = 2;
+    const int games = _options.gamesPerSide;
+    const size_t perProgram = _opponents.size() * sides;
+    std::vector<float> scores(programs.size() * perProgram, 0.0f);
+    for (size_t p = 0; p < programs.size(); ++p) {
+        for (size_t o = 0; o < _opponents.size(); ++o) {
+            for (int side = 0; side < sides; ++side) {
+                pool.Submit([this, &programs, &scores, p, o, side, games, perProgram]() {
+                    std::vector<uint32_t> seeds;
+                    for (int k = 0; k < games; ++k) seeds.push_back(_options.seed + (uint32_t)(((o * 2) + side) * games + k));
+                    const AstroGenome& genome = *programs[p];
+                    const ShipType& opponent = _opponents[o];
+                    AstroBatch batch;
+                    batch.Setup([&]() {
+                        std::vector<std::unique_ptr<ShipBase>> roster;
+                        roster.push_back(std::make_unique<GenomeShip>(genome, "Candidate"));
+                        roster.push_back(opponent.make());
+                        if (side == 1) std::swap(roster[0], roster[1]);
+                        return roster;
+                    }, seeds, _options.simultaneous, _options.config);
+                    batch.Run(_options.maxTurns);
+                    float score = 0.0f;
+                    for (size_t k = 0; k < batch.Size(); ++k) {
+                        const AstroArena& arena = batch.Arena(k);
+                        const auto& me = arena.ships[side];
+                        int alive = arena.AliveCount();
+                        if (alive == 1) score += me.alive ? 1.0f : 0.0f;
+                        else score += 0.5f; // both out, or both still flying
+                        score += 0.1f * std::min(1.0f, (float)me.damageDealt / (float)ASTRO_START_HP);
+                    }
+                    scores[p * perProgram + o * sides + side] = score;
+                });
+            }
+        }
+    }
+    pool.Wait();
+    gen.matches = (long long)programs.size() * (long long)perProgram * games;
+    _matches += gen.matches;
+
+    const float matchesPerProgram = (float)(perProgram * games);
+    for (size_t p = 0; p < programs.size(); ++p) {
+        float sum = 0.0f;
+        for (size_t k = 0; k < perProgram; ++k) sum += scores[p * perProgram + k];
+        _fitness[programHashes[p]] = matchesPerProgram > 0 ? sum / matchesPerProgram : 0.0f;
+    }
+    float total = 0.0f;
+    gen.best = 0.0f;
+    for (auto& c : candidates) {
+        c.fitness = _fitness[c.hash];
+        total += c.fitness;
+        gen.best = std::max(gen.best, c.fitness);
+    }
+    gen.mean = candidates.empty() ? 0.0f : total / (float)candidates.size();
+    gen.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return gen;
+}
+
+const std::vector<AstroEvolveCandidate>& AstroEvolver::Run(const std::function<void(const AstroEvolveGeneration&)>& report) {
+    AstroThreadPool pool(_options.threads);
+    auto byFitness = [](const AstroEvolveCandidate& x, const AstroEvolveCandidate& y) { return x.fitness > y.fitness; };
+
+    _population.clear();
+    if (_options.seeded) {
+        // the opponents' own programs, where they are written as nested blocks
+        for (const ShipType& type : _opponents) {
+            if ((int)_population.size() >= _options.population) break;
+            auto ship = type.make();
+            ship->SetupShip();
+            AstroEvolveCandidate c;
+            if (!AstroDecodeGenome(ship->code, c.genome)) continue;
+            Repair(c.genome);
+            _population.push_back(std::move(c));
+        }
+    }
+    while ((int)_population.size() < _options.population) {
+        AstroEvolveCandidate c;
+        c.genome = RandomGenome();
+        _population.push_back(std::move(c));
+    }
+    AstroEvolveGeneration gen = Evaluate(_population, pool);
+    std::stable_sort(_population.begin(), _population.end(), byFitness);
+    if (report) report(gen);
+
+    std::vector<AstroEvolveCandidate> next;
+    for (int g = 1; g <= _options.generations; ++g) {
+        next.assign(_population.begin(), _population.begin() + _options.elite);
+        while ((int)next.size() < _options.population) {
+            AstroEvolveCandidate child;
+            if (std::uniform_real_distribution<float>(0.0f, 1.0f)(_rng) < _options.crossover) {
+                const AstroGenome& a = Select().genome;
+                child.genome = Crossover(a, Select().genome);
+                if (std::uniform_int_distribution<int>(0, 1)(_rng)) Mutate(child.genome);
+            } else {
+                child.genome = Select().genome;
+                int mutations = std::uniform_int_distribution<int>(1, 3)(_rng);
+                for (int m = 0; m < mutations; ++m) Mutate(child.genome);
+            }
+            next.push_back(std::move(child));
+        }
+        gen = Evaluate(next, pool);
+        gen.generation = g;
+        _population.swap(next);
+        std::stable_sort(_population.begin(), _population.end(), byFitness);
+        if (report) report(gen);
+    }
+    return _population;
+}
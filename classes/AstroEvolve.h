@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AstroTypes.h"
+#include "AstroShips.h"
+
+class AstroThreadPool;
+
+// ===== Ship program genomes =====
+// A ship program as the DSL writes it: a list of statements, each an action (THRUST(P),
+// SCAN(), ...) or a condition with a body and an optional ELSE body. Search works on this
+// tree rather than on raw code words, so every mutation and crossover still encodes to
+// bytecode the verifier accepts: blocks stay nested and jumps stay forward. Emit() writes
+// the same words the IF_* / ELSE() macros would.
+struct AstroGene {
+    int32_t op = ASTRO_OP_WAIT; // AstroOpCode: an action or a condition
+    int32_t param = 0;          // as in ShipBase::code: THRUST power * 10, degrees, thresholds
+    std::vector<AstroGene> then, otherwise; // conditions only; otherwise is the ELSE body
+};
+
+struct AstroGenome {
+    std::vector<AstroGene> body;
+
+    // code words ending in END, and the script cost the DSL macros would have added up
+    void Emit(std::vector<int>& code) const;
+    int Cost() const;
+    int Size() const;  // statements, nested ones included
+    int Depth() const; // deepest nesting of conditions, 0 for none
+    // the program in the macro DSL, as the body of a SetupShip()
+    std::string Source() const;
+};
+
+// Rebuilds the genome of code the DSL macros or AstroProgramBuilder emitted (the
+// sample ships); false for code that isn't nested blocks of that shape.
+bool AstroDecodeGenome(const std::vector<int>& code, AstroGenome& genome);
+
+// A ship running a genome's program
+struct GenomeShip : ShipBase {
+    GenomeShip(const AstroGenome& g, const std::string& shipName) : genome(g) { name = shipName; }
+    int SetupShip() override;
+    AstroGenome genome;
+};
+
+// ===== Evolutionary search =====
+// Evolves ship programs against a fixed field of opponents. Each generation keeps the
+// best programs (elitism) and breeds the rest by tournament selection, subtree
+// crossover and mutation: parameter nudges, swapped opcodes, inserted, deleted, moved,
+// wrapped and unwrapped statements, ELSE bodies added and dropped. Every child stays
+// within ASTRO_MAX_SCRIPT_COST and the size and depth limits.
+//
+// Fitness is the mean score over every opponent, both sides, and gamesPerSide seeds
+// each: 1 for a win, 0.5 for a draw, 0 for a loss, plus up to 0.1 for the share of the
+// opponent's hp it removed. Each pairing plays as one AstroBatch of its seeds, and
+// pairings are spread over a thread pool. The seeds are the same for every candidate in
+// every generation, so a program always gets the same fitness: it is cached by the hash
+// of its optimized program (AstroProgramHash()), and a candidate that compiles to a
+// program already seen, this generation or any earlier one, is never simulated again.
+struct AstroEvolveOptions {
+    int generations = 20;
+    int population = 32;
+    int elite = 4;              // best programs carried over unchanged
+    int tournament = 3;         // candidates drawn per selection
+    float crossover = 0.5f;     // share of children bred from two parents
+    int maxSize = 24;           // statements per program
+    int maxDepth = 3;           // nested conditions
+    int gamesPerSide = 2;       // seeds per opponent and side
+    int threads = 0;            // 0 = all cores
+    uint32_t seed = 1;          // the search's own RNG and the match seeds
+    int maxTurns = 3000;
+    bool simultaneous = false;
+    AstroArenaConfig config = DefaultConfig(); // ships is unused: matches are 1v1
+    bool seeded = true;         // start from the opponents' own programs besides random ones
+
+    static AstroArenaConfig DefaultConfig() {
+        AstroArenaConfig c;
+        c.stalemateTurns = 300; // quiet matches stop early: a draw either way
+        return c;
+    }
+};
+
+struct AstroEvolveCandidate {
+    AstroGenome genome;
+    uint64_t hash = 0;     // AstroProgramHash() of the compiled program
+    float fitness = 0.0f;
+};
+
+struct AstroEvolveGeneration {
+    int generation = 0;
+    float best = 0.0f;
+    float mean = 0.0f;
+    int simulated = 0;     // candidates played this generation
+    int cached = 0;        // candidates whose program had a fitness already
+    long long matches = 0; // played this generation
+    double ms = 0.0;
+};
+
+class AstroEvolver {
+public:
+    AstroEvolver(std::vector<ShipType> opponents, const AstroEvolveOptions& options);
+
+    // Runs the search; calls report after every generation (generation 0 is the initial
+    // population). Returns the final population, best first.
+    const std::vector<AstroEvolveCandidate>& Run(const std::function<void(const AstroEvolveGeneration&)>& report = {});
+
+    long long MatchesPlayed() const { return _matches; }
+    size_t CacheSize() const { return _fitness.size(); }
+    long long CacheHits() const { return _cacheHits; }
+
+private:
+    AstroGenome RandomGenome();
+    std::vector<AstroGene> RandomBlock(int depth, int statements);
+    AstroGene RandomStatement(int depth);
+    int RandomParam(int op);
+    void Mutate(AstroGenome& g);
+    AstroGenome Crossover(const AstroGenome& a, const AstroGenome& b);
+    // shrinks g until it fits the cost, size and depth limits
+    void Repair(AstroGenome& g);
+    const AstroEvolveCandidate& Select();
+    // fills in hash and fitness of every candidate, playing only programs not seen before
+    AstroEvolveGeneration Evaluate(std::vector<AstroEvolveCandidate>& candidates, AstroThreadPool& pool);
+
+    std::vector<ShipType> _opponents;
+    AstroEvolveOptions _options;
+    std::mt19937 _rng;
+    std::vector<AstroEvolveCandidate> _population;
+    std::unordered_map<uint64_t, float> _fitness; // program hash -> fitness
+    long long _matches = 0;
+    long long _cacheHits = 0;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// ===== 16.16 fixed point =====
+// The arena's kinematics in integers, for arenas with AstroArenaConfig::fixedPoint set.
+// Float arithmetic gives the same bits on every IEEE platform only as long as the compiler
+// emits exactly the operations written: x87 excess precision, contracted multiply-adds and
+// fast-math reassociation all change them, and which of those a toolchain does is not up
+// to the source. Integer adds, multiplies, shifts and divides give the same bits
+// everywhere, so a fixedPoint arena turns, moves, wraps, drags and thrusts its ships,
+// asteroids and torpedoes in these, with a quarter-wave sine table in place of trig.
+//
+// State stays in the arena's float fields. A step reads a value onto the 16.16 grid
+// (AstroToFixed: scaling by 65536 is exact and the rounding is a plain floor), does its
+// math on the grid and writes the result back (AstroFromFixed: one int to float
+// conversion), and both conversions are single IEEE operations with one possible result.
+// int32 holds +-32768 world units, so fixedPoint worlds are at most
+// ASTRO_FIXED_MAX_EXTENT on a side (leaving room for a position plus a velocity).
+
+typedef int32_t AstroFixed;
+
+inline constexpr int ASTRO_FIXED_BITS = 16;
+inline constexpr AstroFixed ASTRO_FIXED_ONE = 1 << ASTRO_FIXED_BITS;
+inline constexpr AstroFixed ASTRO_FIXED_90 = 90 * ASTRO_FIXED_ONE;   // degrees
+inline constexpr AstroFixed ASTRO_FIXED_180 = 180 * ASTRO_FIXED_ONE;
+inline constexpr AstroFixed ASTRO_FIXED_360 = 360 * ASTRO_FIXED_ONE;
+inline constexpr float ASTRO_FIXED_MAX_EXTENT = 16384.0f;
+
+// a compile-time constant on the grid, rounded to nearest
+constexpr AstroFixed AstroFixedConst(double v) {
+    return (AstroFixed)(v * ASTRO_FIXED_ONE + (v < 0 ? -0.5 : 0.5));
+}
+
+inline AstroFixed AstroToFixed(float v) {
+    return (AstroFixed)std::floor(v * (float)ASTRO_FIXED_ONE + 0.5f);
+}
+
+inline float AstroFromFixed(AstroFixed v) {
+    return (float)v * (1.0f / (float)ASTRO_FIXED_ONE);
+}
+
+// [0, 1) from 32 random bits: the top 24, exactly, as the std distributions need not be
+inline float AstroUnitFloat(uint32_t bits) {
+    return (float)(bits >> 8) * (1.0f / 16777216.0f);
+}
+
+// a * b, truncated toward zero so that scaling -v gives exactly -(scaling v)
+inline AstroFixed AstroFixedMul(AstroFixed a, AstroFixed b) {
+    return (AstroFixed)(((int64_t)a * b) / ASTRO_FIXED_ONE);
+}
+
+// v onto [0, extent). A power-of-two extent (the default 2048 world) is a mask.
+inline AstroFixed AstroFixedWrap(AstroFixed v, AstroFixed extent) {
+    if ((extent & (extent - 1)) == 0) return v & (extent - 1);
+    v %= extent;
+    return v < 0 ? v + extent : v;
+}
+
+// floor(sqrt(v)), bit by bit
+inline uint32_t AstroIsqrt(uint64_t v) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > v) bit >>= 2;
+    while (bit != 0) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+namespace AstroFixedTrig {
+// sin of 0..90 whole degrees on the grid; between them AstroFixedSinDeg interpolates,
+// within 6e-5 of the exact value (about four grid steps)
+inline constexpr AstroFixed QUARTER_SINE[91] = {
+    0, 1144, 2287, 3430, 4572, 5712, 6850, 7987, 9121, 10252,
+    11380, 12505, 13626, 14742, 15855, 16962, 18064, 19161, 20252, 21336,
+    22415, 23486, 24550, 25607, 26656, 27697, 28729, 29753, 30767, 31772,
+    32768, 33754, 34729, 35693, 36647, 37590, 38521, 39441, 40348, 41243,
+    42126, 42995, 43852, 44695, 45525, 46341, 47143, 47930, 48703, 49461,
+    50203, 50931, 51643, 52339, 53020, 53684, 54332, 54963, 55578, 56175,
+    56756, 57319, 57865, 58393, 58903, 59396, 59870, 60326, 60764, 61183,
+    61584, 61966, 62328, 62672, 62997, 63303, 63589, 63856, 64104, 64332,
+    64540, 64729, 64898, 65048, 65177, 65287, 65376, 65446, 65496, 65526,
+    65536,
+};
+
+// sin of deg on [0, 90] degrees
+inline AstroFixed QuarterSin(AstroFixed deg) {
+    const int i = deg >> ASTRO_FIXED_BITS;
+    if (i >= 90) return QUARTER_SINE[90];
+    const AstroFixed frac = deg & (ASTRO_FIXED_ONE - 1);
+    return QUARTER_SINE[i] + (AstroFixed)(((int64_t)(QUARTER_SINE[i + 1] - QUARTER_SINE[i]) * frac) >> ASTRO_FIXED_BITS);
+}
+} // namespace AstroFixedTrig
+
+// sin and cos of an angle in degrees, both on the grid
+inline AstroFixed AstroFixedSinDeg(AstroFixed deg) {
+    using namespace AstroFixedTrig;
+    deg = AstroFixedWrap(deg, ASTRO_FIXED_360);
+    const int quadrant = deg / ASTRO_FIXED_90;
+    const AstroFixed r = deg - quadrant * ASTRO_FIXED_90;
+    switch (quadrant) {
+        case 0: return QuarterSin(r);
+        case 1: return QuarterSin(ASTRO_FIXED_90 - r);
+        case 2: return -QuarterSin(r);
+        default: return -QuarterSin(ASTRO_FIXED_90 - r);
+    }
+}
+
+inline AstroFixed AstroFixedCosDeg(AstroFixed deg) {
+    return AstroFixedSinDeg(deg + ASTRO_FIXED_90);
+}
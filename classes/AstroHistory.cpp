@@ -0,0 +1,47 @@
+#include "AstroHistory.h"
+#include "AstroArena.h"
+#include <sstream>
+
+void AstroHistory::Begin(size_t shipCount, size_t capacity, int every) {
+    _shipCount = shipCount;
+    _capacity = capacity > 0 ? capacity : 1;
+    _every = every > 0 ? every : 1;
+    _headers.assign(_capacity, RecordHeader{ 0, 0 });
+    _ships.assign(_capacity * _shipCount, ShipSample{});
+    Clear();
+}
+
+void AstroHistory::Clear() {
+    _head = 0;
+    _count = 0;
+}
+
+void AstroHistory::Record(const AstroArena& arena) {
+    if (_capacity == 0 || arena.turn % _every != 0) return;
+    _headers[_head] = { arena.turn, arena.Checksum() };
+    ShipSample* out = _ships.data() + _head * _shipCount;
+    size_t n = std::min(_shipCount, arena.ships.size());
+    for (size_t i = 0; i < n; ++i) {
+        const auto& s = arena.ships[i];
+        out[i] = { s.x, s.y, s.vx, s.vy, s.angle, s.fuel, s.hp, (uint8_t)(s.alive ? 1 : 0) };
+    }
+    _head = (_head + 1) % _capacity;
+    if (_count < _capacity) _count++;
+}
+
+const AstroHistory::ShipSample* AstroHistory::ShipsAt(size_t i) const {
+    return _ships.data() + Slot(i) * _shipCount;
+}
+
+std::string AstroHistory::StateString(size_t i) const {
+    if (i >= _count) return std::string();
+    std::stringstream ss;
+    ss << TurnAt(i) << ";";
+    const ShipSample* ships = ShipsAt(i);
+    for (size_t k = 0; k < _shipCount; ++k) {
+        const ShipSample& s = ships[k];
+        ss << s.x << "," << s.y << "," << s.vx << "," << s.vy << ","
+           << s.angle << "," << s.hp << "," << s.fuel << "," << (bool)s.alive << ";";
+    }
+    return ss.str();
+}
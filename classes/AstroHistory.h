@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AstroTypes.h"
+
+struct AstroArena;
+
+static constexpr int ASTRO_HISTORY_CAPACITY = 2048; // turns kept by default
+
+// ===== Turn history =====
+// One fixed-size binary record per kept turn (turn number, state checksum and every
+// ship's kinematics) in a ring allocated once per match. When the ring is full the
+// oldest record is overwritten, so memory doesn't grow with match length. The text
+// form of a record is only built when asked for.
+class AstroHistory {
+public:
+    struct ShipSample {
+        float x, y;
+        float vx, vy;
+        float angle;
+        float fuel;
+        int32_t hp;
+        uint8_t alive;
+    };
+
+    // Sizes the ring for shipCount ships and drops all records. every = keep every Nth turn.
+    void Begin(size_t shipCount, size_t capacity = ASTRO_HISTORY_CAPACITY, int every = 1);
+    void Clear();
+    // Appends the arena's current state if its turn is one we keep.
+    void Record(const AstroArena& arena);
+
+    // records held, 0 = oldest
+    size_t Size() const { return _count; }
+    size_t Capacity() const { return _capacity; }
+    size_t ShipCount() const { return _shipCount; }
+    int TurnAt(size_t i) const { return Header(i).turn; }
+    uint64_t ChecksumAt(size_t i) const { return Header(i).checksum; }
+    const ShipSample* ShipsAt(size_t i) const;
+    // "turn;x,y,vx,vy,angle,hp,fuel,alive;..." for record i
+    std::string StateString(size_t i) const;
+
+private:
+    struct RecordHeader {
+        int32_t turn;
+        uint64_t checksum;
+    };
+    size_t Slot(size_t i) const { return (_head + _capacity - _count + i) % _capacity; }
+    const RecordHeader& Header(size_t i) const { return _headers[Slot(i)]; }
+
+    AstroVector<RecordHeader, ASTRO_MEM_HISTORY> _headers;  // one per slot
+    AstroVector<ShipSample, ASTRO_MEM_HISTORY> _ships;      // _shipCount per slot, slot-major
+    size_t _shipCount = 0;
+    size_t _capacity = 0;
+    size_t _head = 0;                    // next slot to write
+    size_t _count = 0;
+    int _every = 1;
+};
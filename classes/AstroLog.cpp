@@ -0,0 +1,63 @@
+#include "AstroLog.h"
+#include "AstroArena.h"
+#include "AstroShips.h"
+#include <cstdio>
+
+static const char* ShipName(const AstroArena& arena, int i) {
+    if (i < 0 || i >= (int)arena.programs.size() || !arena.programs[i]) return "Ship";
+    return arena.programs[i]->name.c_str();
+}
+
+int AstroFormatLog(const AstroLogEntry& e, const AstroArena& arena, char* buf, size_t size) {
+    if (size == 0) return 0;
+    const char* a = ShipName(arena, e.a);
+    int n = 0;
+    switch (e.type) {
+        case ASTRO_LOG_PHASER_HIT:
+            n = std::snprintf(buf, size, "%s hits %s with phaser for %d damage!", a, ShipName(arena, e.b), e.value);
+            break;
+        case ASTRO_LOG_PHASER_MISS:
+            n = std::snprintf(buf, size, "%s fires phaser and misses.", a);
+            break;
+        case ASTRO_LOG_PHOTON_FIRE:
+            n = std::snprintf(buf, size, "%s fires photon torpedo!", a);
+            break;
+        case ASTRO_LOG_TORPEDO_HIT:
+            n = std::snprintf(buf, size, "%s's torpedo hits %s for %d damage!", a, ShipName(arena, e.b), e.value);
+            break;
+        case ASTRO_LOG_SHIP_DESTROYED:
+            if (e.b < 0) n = std::snprintf(buf, size, "%s destroyed by asteroid collision!", a);
+            else n = std::snprintf(buf, size, "%s is destroyed!", a);
+            break;
+        case ASTRO_LOG_FUEL_PICKUP:
+            n = std::snprintf(buf, size, "%s collects fuel!", a);
+            break;
+        case ASTRO_LOG_SCRIPT_COST: {
+            // highlight if it exceeds the limit or the verifier rejected the program
+            const std::string* rejected = nullptr;
+            if (e.a >= 0 && e.a < (int)arena.programs.size() && arena.programs[e.a] && !arena.programs[e.a]->verifyError.empty())
+                rejected = &arena.programs[e.a]->verifyError;
+            n = std::snprintf(buf, size, "%s script cost %d/%d%s%s%s%s", a, e.value, ASTRO_MAX_SCRIPT_COST,
+                              e.value > ASTRO_MAX_SCRIPT_COST ? " (EXCEEDS LIMIT)" : "",
+                              rejected ? " (REJECTED: " : "", rejected ? rejected->c_str() : "", rejected ? ")" : "");
+            break;
+        }
+        case ASTRO_LOG_MATCH_SEED:
+            n = std::snprintf(buf, size, "Match seed %u", (uint32_t)e.value);
+            break;
+        case ASTRO_LOG_RESTORED:
+            n = std::snprintf(buf, size, "Restored turn %d", e.value);
+            break;
+        case ASTRO_LOG_RESTORE_FAILED:
+            n = std::snprintf(buf, size, "Restore failed: not a snapshot of this match");
+            break;
+        case ASTRO_LOG_STALEMATE:
+            n = std::snprintf(buf, size, "Stalemate: %d ships, %d turns without a fight", e.a, e.value);
+            break;
+        default:
+            n = std::snprintf(buf, size, "?");
+            break;
+    }
+    if (n < 0) n = 0;
+    return (size_t)n < size ? n : (int)size - 1;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "AstroMemory.h"
+
+struct AstroArena;
+
+static constexpr size_t ASTRO_LOG_CAPACITY = 1024; // entries kept, power of two
+
+// ===== Match log =====
+// The arena logs typed entries with small integer payloads; nothing is formatted until
+// someone wants to read a line (AstroFormatLog), so a headless run that never looks at
+// the log pays for a 20-byte store per event and nothing else.
+enum AstroLogType : uint8_t {
+    ASTRO_LOG_PHASER_HIT = 0,  // a = shooter, b = target, value = damage
+    ASTRO_LOG_PHASER_MISS,     // a = shooter
+    ASTRO_LOG_PHOTON_FIRE,     // a = shooter
+    ASTRO_LOG_TORPEDO_HIT,     // a = owner, b = target, value = damage
+    ASTRO_LOG_SHIP_DESTROYED,  // a = ship, b = killer (-1 = asteroid collision)
+    ASTRO_LOG_FUEL_PICKUP,     // a = ship
+    ASTRO_LOG_SCRIPT_COST,     // a = ship, value = script cost
+    ASTRO_LOG_MATCH_SEED,      // value = seed
+    ASTRO_LOG_RESTORED,        // value = turn restored
+    ASTRO_LOG_RESTORE_FAILED,
+    ASTRO_LOG_STALEMATE,       // a = ships alive, value = quiet turns
+};
+
+struct AstroLogEntry {
+    int32_t turn;
+    AstroLogType type;
+    int32_t a, b;
+    int32_t value;
+};
+
+// Fixed-size ring, one writer and any number of readers, no locks and no allocation
+// after construction. When full the oldest entries are overwritten; a reader that was
+// lapped gets false from Read() for the entries it lost. Indices count every entry ever
+// pushed, so readers can keep a cursor across frames.
+class AstroLogRing {
+public:
+    explicit AstroLogRing(size_t capacity = ASTRO_LOG_CAPACITY) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        _slots = AstroVector<Slot, ASTRO_MEM_LOG>(n);
+        _mask = n - 1;
+    }
+
+    // writer side
+    void Push(const AstroLogEntry& e) {
+        uint64_t h = _head.load(std::memory_order_relaxed);
+        Slot& s = _slots[h & _mask];
+        // seqlock: odd while the slot is being written, 2 * (index + 1) once it holds index
+        s.seq.store(2 * h + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.entry = e;
+        s.seq.store(2 * h + 2, std::memory_order_release);
+        _head.store(h + 1, std::memory_order_release);
+    }
+    // drops everything logged so far (readers just see an empty range)
+    void Clear() { _begin.store(_head.load(std::memory_order_relaxed), std::memory_order_release); }
+
+    // reader side: entries [Begin(), End()) are (or were, a moment ago) available
+    uint64_t End() const { return _head.load(std::memory_order_acquire); }
+    uint64_t Begin() const {
+        uint64_t end = End(), begin = _begin.load(std::memory_order_acquire);
+        uint64_t oldest = end > _mask + 1 ? end - (_mask + 1) : 0;
+        return begin > oldest ? begin : oldest;
+    }
+    size_t Capacity() const { return _mask + 1; }
+    bool Read(uint64_t index, AstroLogEntry& out) const {
+        const Slot& s = _slots[index & _mask];
+        uint64_t before = s.seq.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) return false;
+        out = s.entry;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return s.seq.load(std::memory_order_relaxed) == before;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq{ 0 };
+        AstroLogEntry entry{};
+    };
+    AstroVector<Slot, ASTRO_MEM_LOG> _slots;
+    size_t _mask = 0;
+    std::atomic<uint64_t> _head{ 0 };
+    std::atomic<uint64_t> _begin{ 0 };
+};
+
+// Writes the text of e into buf (always NUL-terminated) and returns its length. Ship names
+// come from arena's roster; entries for ships no longer in it print as "Ship".
+int AstroFormatLog(const AstroLogEntry& e, const AstroArena& arena, char* buf, size_t size);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include "AstroSimd.h"
+
+// ===== Arena trig =====
+// sin/cos/atan2 for the simulation. Built with ASTRO_FAST_TRIG (the CMake option of that
+// name, on by default) AstroSin/AstroCos/AstroSinCos/AstroAtan2 are the polynomials below
+// and AstroSinCosN their SIMD batch; otherwise they are the float overloads of libm. The
+// two builds play different matches from the same seed: compare hashes, replays and
+// snapshots only between builds with the same setting. The libm build is the reference
+// to check the fast one against.
+//
+// The polynomials are plain float adds and multiplies with no table and no libm call,
+// so, unlike libm, they give the same bits on every platform, and AstroFastSinCosN
+// (AstroSimd.h) gives the same bits as the scalar ones lane for lane.
+
+// Name of the trig compiled into the arena: "fast" or "libm".
+inline const char* AstroTrigPath() {
+#if defined(ASTRO_FAST_TRIG)
+    return "fast";
+#else
+    return "libm";
+#endif
+}
+
+namespace AstroTrig {
+// float(x + MAGIC) - MAGIC rounds x to the nearest integer for |x| < 2^22
+inline constexpr float ROUND_MAGIC = 12582912.0f; // 1.5 * 2^23
+inline constexpr float TWO_OVER_PI = 0.636619772f;
+// pi/2 split so that k * PIO2_1 and k * PIO2_2 are exact for the k the arena produces
+inline constexpr float PIO2_1 = 1.5703125f;
+inline constexpr float PIO2_2 = 4.837512969970703125e-4f;
+inline constexpr float PIO2_3 = 7.54978995489188216e-8f;
+// minimax sin and cos on [-pi/4, pi/4] (the Cephes sinf/cosf coefficients)
+inline constexpr float S1 = -1.6666654611e-1f, S2 = 8.3321608736e-3f, S3 = -1.9515295891e-4f;
+inline constexpr float C1 = 4.166664568298827e-2f, C2 = -1.388731625493765e-3f, C3 = 2.443315711809948e-5f;
+// atan on [0, 1], Abramowitz & Stegun 4.4.49 (|error| <= 2e-8)
+inline constexpr float A1 = 0.9999993329f, A3 = -0.3332985605f, A5 = 0.1994653599f, A7 = -0.1390853351f;
+inline constexpr float A9 = 0.0964200441f, A11 = -0.0559098861f, A13 = 0.0218612288f, A15 = -0.0040540580f;
+inline constexpr float HALF_PI = 1.57079637f;
+inline constexpr float PI = 3.14159274f;
+
+inline float Round(float v) { return (v + ROUND_MAGIC) - ROUND_MAGIC; }
+} // namespace AstroTrig
+
+// sin and cos of x radians, within 1e-7 of the exact values for |x| < 10^4 (the arena's
+// angles are within a few turns of zero). Reduces x by the nearest multiple k of pi/2 and evaluates
+// both polynomials on the remainder; the quadrant k mod 4 picks and signs them.
+inline void AstroFastSinCos(float x, float& s, float& c) {
+    using namespace AstroTrig;
+    const float k = Round(x * TWO_OVER_PI);
+    const float r = ((x - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+    const float r2 = r * r;
+    const float ps = r + r * r2 * (S1 + r2 * (S2 + r2 * S3));
+    const float pc = (1.0f - 0.5f * r2) + r2 * r2 * (C1 + r2 * (C2 + r2 * C3));
+    const float q = k - 4.0f * Round(k * 0.25f); // -2..2
+    const bool swap = (q > 0.5f && q < 1.5f) || (q < -0.5f && q > -1.5f);
+    const float sn = swap ? pc : ps;
+    const float cs = swap ? ps : pc;
+    s = (q > 1.5f || q < -0.5f) ? -sn : sn;
+    c = (q > 0.5f || q < -1.5f) ? -cs : cs;
+}
+
+// atan2(y, x) in radians on [-pi, pi], within 4e-7 (about an ulp of pi) of the exact
+// value. Returns 0 for (0, 0).
+inline float AstroFastAtan2(float y, float x) {
+    using namespace AstroTrig;
+    const float ax = std::fabs(x), ay = std::fabs(y);
+    const float hi = ax > ay ? ax : ay;
+    const float lo = ax > ay ? ay : ax;
+    if (hi == 0.0f) return 0.0f;
+    const float a = lo / hi;
+    const float s = a * a;
+    float r = a * (A1 + s * (A3 + s * (A5 + s * (A7 + s * (A9 + s * (A11 + s * (A13 + s * A15)))))));
+    if (ay > ax) r = HALF_PI - r;
+    if (x < 0.0f) r = PI - r;
+    return y < 0.0f ? -r : r;
+}
+
+#if defined(ASTRO_FAST_TRIG)
+inline void AstroSinCos(float x, float& s, float& c) { AstroFastSinCos(x, s, c); }
+inline float AstroSin(float x) { float s, c; AstroFastSinCos(x, s, c); return s; }
+inline float AstroCos(float x) { float s, c; AstroFastSinCos(x, s, c); return c; }
+inline float AstroAtan2(float y, float x) { return AstroFastAtan2(y, x); }
+inline void AstroSinCosN(const float* x, float* s, float* c, size_t n) { AstroFastSinCosN(x, s, c, n); }
+#else
+inline void AstroSinCos(float x, float& s, float& c) { s = std::sin(x); c = std::cos(x); }
+inline float AstroSin(float x) { return std::sin(x); }
+inline float AstroCos(float x) { return std::cos(x); }
+inline float AstroAtan2(float y, float x) { return std::atan2(y, x); }
+inline void AstroSinCosN(const float* x, float* s, float* c, size_t n) {
+    for (size_t i = 0; i < n; ++i) AstroSinCos(x[i], s[i], c[i]);
+}
+#endif
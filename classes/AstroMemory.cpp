@@ -0,0 +1,74 @@
+#include "AstroMemory.h"
+
+namespace {
+struct Counter {
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> frees{ 0 };
+    std::atomic<int64_t> liveBytes{ 0 };
+    std::atomic<int64_t> peakBytes{ 0 };
+};
+// constant-initialized, so containers built during static initialization (the asteroid
+// shape library) can count into it
+Counter g_counters[ASTRO_MEM_COUNT];
+}
+
+const char* AstroMemTagName(AstroMemTag tag) {
+    switch (tag) {
+        case ASTRO_MEM_PARTICLES: return "particles";
+        case ASTRO_MEM_TORPEDOES: return "torpedoes";
+        case ASTRO_MEM_BEAMS: return "beams";
+        case ASTRO_MEM_ASTEROIDS: return "asteroids";
+        case ASTRO_MEM_SHAPES: return "shapes";
+        case ASTRO_MEM_DEBRIS: return "debris";
+        case ASTRO_MEM_SIGNALS: return "signals";
+        case ASTRO_MEM_LOG: return "log";
+        case ASTRO_MEM_HISTORY: return "history";
+        case ASTRO_MEM_TURNS: return "turns";
+        default: return "unknown";
+    }
+}
+
+void AstroMemoryAllocated(AstroMemTag tag, size_t bytes) {
+    Counter& c = g_counters[tag];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    int64_t live = c.liveBytes.fetch_add((int64_t)bytes, std::memory_order_relaxed) + (int64_t)bytes;
+    int64_t peak = c.peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !c.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void AstroMemoryFreed(AstroMemTag tag, size_t bytes) {
+    Counter& c = g_counters[tag];
+    c.frees.fetch_add(1, std::memory_order_relaxed);
+    c.liveBytes.fetch_sub((int64_t)bytes, std::memory_order_relaxed);
+}
+
+AstroMemoryStats AstroMemoryStats::Read() {
+    AstroMemoryStats s;
+    for (int t = 0; t < ASTRO_MEM_COUNT; ++t) {
+        s.tags[t].allocations = g_counters[t].allocations.load(std::memory_order_relaxed);
+        s.tags[t].frees = g_counters[t].frees.load(std::memory_order_relaxed);
+        s.tags[t].liveBytes = g_counters[t].liveBytes.load(std::memory_order_relaxed);
+        s.tags[t].peakBytes = g_counters[t].peakBytes.load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+void AstroMemoryStats::ResetPeaks() {
+    for (Counter& c : g_counters) c.peakBytes.store(c.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+AstroMemoryStats AstroMemoryStats::Since(const AstroMemoryStats& earlier) const {
+    AstroMemoryStats d = *this;
+    for (int t = 0; t < ASTRO_MEM_COUNT; ++t) {
+        d.tags[t].allocations -= earlier.tags[t].allocations;
+        d.tags[t].frees -= earlier.tags[t].frees;
+    }
+    return d;
+}
+
+uint64_t AstroMemoryStats::Allocations() const {
+    uint64_t n = 0;
+    for (const Tag& t : tags) n += t.allocations;
+    return n;
+}
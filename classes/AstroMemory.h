@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ===== Memory counters =====
+// Per-subsystem accounting of what the long-lived containers allocate: the arena's
+// particles, torpedoes, beams, asteroids, debris and signals, the asteroid shape library,
+// the event log, the viewer's turn history and Game::_turns. Each is an AstroVector tagged
+// with its subsystem, and its allocator reports every allocation and free against the tag:
+// allocations, bytes live and the high-water mark. Built without ASTRO_MEMORY (the CMake
+// option of the same name, off by default) the allocator is std::allocator under another
+// name and the counters never move. The counters are process-wide: every arena adds to
+// the same ones, from any thread, the viewer's render copies included.
+enum AstroMemTag : uint8_t {
+    ASTRO_MEM_PARTICLES = 0,
+    ASTRO_MEM_TORPEDOES,
+    ASTRO_MEM_BEAMS,
+    ASTRO_MEM_ASTEROIDS,
+    ASTRO_MEM_SHAPES,      // AsteroidShapeLibrary, once per process
+    ASTRO_MEM_DEBRIS,
+    ASTRO_MEM_SIGNALS,
+    ASTRO_MEM_LOG,         // AstroLogRing
+    ASTRO_MEM_HISTORY,     // AstroHistory
+    ASTRO_MEM_TURNS,       // Game::_turns
+    ASTRO_MEM_COUNT
+};
+
+const char* AstroMemTagName(AstroMemTag tag);
+
+#if defined(ASTRO_MEMORY)
+static constexpr bool ASTRO_MEMORY_ENABLED = true;
+#else
+static constexpr bool ASTRO_MEMORY_ENABLED = false;
+#endif
+
+void AstroMemoryAllocated(AstroMemTag tag, size_t bytes);
+void AstroMemoryFreed(AstroMemTag tag, size_t bytes);
+
+// A copy of the counters at one moment
+struct AstroMemoryStats {
+    struct Tag {
+        uint64_t allocations = 0;
+        uint64_t frees = 0;
+        int64_t liveBytes = 0;
+        int64_t peakBytes = 0;  // high-water mark of liveBytes since the last ResetPeaks()
+    };
+    std::array<Tag, ASTRO_MEM_COUNT> tags{};
+
+    static AstroMemoryStats Read();
+    // every tag's peak starts again from its live bytes (at the start of a match, say)
+    static void ResetPeaks();
+
+    // allocations and frees counted since earlier; live and peak bytes as of this copy
+    AstroMemoryStats Since(const AstroMemoryStats& earlier) const;
+    uint64_t Allocations() const; // over every tag
+};
+
+template <typename T, AstroMemTag Tag> struct AstroAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = AstroAllocator<U, Tag>; };
+
+    AstroAllocator() noexcept = default;
+    template <typename U> AstroAllocator(const AstroAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if constexpr (ASTRO_MEMORY_ENABLED) AstroMemoryAllocated(Tag, n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        if constexpr (ASTRO_MEMORY_ENABLED) AstroMemoryFreed(Tag, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U> bool operator==(const AstroAllocator<U, Tag>&) const noexcept { return true; }
+    template <typename U> bool operator!=(const AstroAllocator<U, Tag>&) const noexcept { return false; }
+};
+
+template <typename T, AstroMemTag Tag> using AstroVector = std::vector<T, AstroAllocator<T, Tag>>;
@@ -0,0 +1,135 @@
+#include "AstroNative.h"
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+uint64_t AstroProgramHash(const std::vector<AstroInstr>& program) {
+    uint64_t h = 1469598103934665603ull;
+    auto add = [&h](const void* v, size_t n) {
+        const unsigned char* p = static_cast<const unsigned char*>(v);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    };
+    for (const AstroInstr& in : program) {
+        add(&in.op, sizeof(in.op));
+        add(&in.param, sizeof(in.param));
+        add(&in.fparam, sizeof(in.fparam));
+        add(&in.target, sizeof(in.target));
+    }
+    return h;
+}
+
+namespace {
+
+// hex float literal: the exact float back when compiled
+std::string FloatLiteral(float v) {
+    char buf[48];
+    std::snprintf(buf, sizeof(buf), "%af", (double)v);
+    return buf;
+}
+
+// the condition a decoded IF_* instruction sets the flag to, as the interpreter computes it
+std::string ConditionExpr(const AstroInstr& in) {
+    switch (in.op) {
+        case ASTRO_OP_IF_SEEN: return "s.scan_hit";
+        case ASTRO_OP_IF_SCAN_LE: return "(s.scan_hit && s.ScanDist() <= " + FloatLiteral(in.fparam) + ")";
+        case ASTRO_OP_IF_DAMAGED: return "(s.hp < ASTRO_START_HP)";
+        case ASTRO_OP_IF_HP_LE: return "(s.hp <= " + std::to_string(in.param) + ")";
+        case ASTRO_OP_IF_FUEL_LE: return "(s.fuel <= " + FloatLiteral(in.fparam) + ")";
+        case ASTRO_OP_IF_CAN_FIRE_PHASER: return "(s.phaser_cooldown == 0)";
+        case ASTRO_OP_IF_CAN_FIRE_PHOTON: return "(s.photon_cooldown == 0)";
+        case ASTRO_OP_IF_SIGNAL_LE: return "A->HeardWithin(id, " + FloatLiteral(in.fparam) + ")";
+        case ASTRO_OP_IF_SIGNAL_IS: return "A->HeardValue(id, " + std::to_string(in.param) + ")";
+        default: return "false";
+    }
+}
+
+struct Registry {
+    std::mutex lock;
+    std::vector<AstroNativeEntry> entries;
+};
+Registry& TheRegistry() {
+    static Registry r;
+    return r;
+}
+
+} // namespace
+
+std::string AstroEmitNative(const std::string& fn, const std::vector<AstroInstr>& program) {
+    const int n = (int)program.size();
+    std::vector<bool> labelled(n, false);
+    for (const AstroInstr& in : program) {
+        if (in.target >= 0 && in.target < n) labelled[in.target] = true;
+    }
+
+    std::string out = "static const AstroInstr " + fn + "_program[] = {\n";
+    for (const AstroInstr& in : program) {
+        out += "    { " + std::to_string(in.op) + ", " + std::to_string(in.param) + ", " + FloatLiteral(in.fparam) +
+               ", " + std::to_string(in.target) + " },\n";
+    }
+    out += "};\n\n";
+
+    out += "static void " + fn + "(AstroArena* A, int id) {\n";
+    out += "    AstroArena::ShipState& s = A->ships[id];\n";
+    out += "    [[maybe_unused]] bool flag = false;\n";
+    for (int i = 0; i < n; ++i) {
+        const AstroInstr& in = program[i];
+        std::string jump = (in.target >= 0 && in.target < n) ? "goto L" + std::to_string(in.target) + ";" : "return;";
+        if (labelled[i]) out += "L" + std::to_string(i) + ":\n";
+        std::string line;
+        switch (in.op) {
+            case ASTRO_OP_WAIT: line = ";"; break;
+            case ASTRO_OP_THRUST: line = "A->Thrust(id, " + FloatLiteral(in.fparam) + ");"; break;
+            case ASTRO_OP_TURN_DEG: line = "A->TurnDeg(id, " + std::to_string(in.param) + ");"; break;
+            case ASTRO_OP_FIRE_PHASER: line = "A->FirePhaser(id);"; break;
+            case ASTRO_OP_FIRE_PHOTON: line = "A->FirePhoton(id);"; break;
+            case ASTRO_OP_SCAN:
+                line = (in.param == ASTRO_SCAN_REUSE) ? "if (s.scanEpoch != A->worldEpoch) A->Scan(id);" : "A->Scan(id);";
+                break;
+            case ASTRO_OP_SCAN_SHIPS: line = "A->Scan(id, ASTRO_SCAN_SHIPS);"; break;
+            case ASTRO_OP_SCAN_ASTEROIDS: line = "A->Scan(id, ASTRO_SCAN_ASTEROIDS);"; break;
+            case ASTRO_OP_SCAN_TORPEDOES: line = "A->Scan(id, ASTRO_SCAN_TORPEDOES);"; break;
+            case ASTRO_OP_SIGNAL: line = "A->Signal(id, " + std::to_string(in.param) + ");"; break;
+            case ASTRO_OP_TURN_TO_SCAN: line = "A->TurnToScan(id);"; break;
+            case ASTRO_OP_TURN_TO_SIGNAL: line = "A->TurnToSignal(id);"; break;
+            case ASTRO_OP_JUMP_IF_FALSE: line = "if (!flag) " + jump; break;
+            case ASTRO_OP_JUMP: line = jump; break;
+            case ASTRO_OP_END: line = "return;"; break;
+            default:
+                if (AstroIsCondition(in.op)) {
+                    line = "flag = " + ConditionExpr(in) + ";";
+                    if (in.target >= 0) line += " if (!flag) " + jump;
+                } else {
+                    line = "return;"; // unknown opcode: the interpreter stops too
+                }
+                break;
+        }
+        out += "    " + line + "\n";
+    }
+    out += "}\n";
+    return out;
+}
+
+void AstroRegisterNative(const AstroNativeEntry* entries, size_t count) {
+    Registry& r = TheRegistry();
+    std::lock_guard<std::mutex> hold(r.lock);
+    r.entries.insert(r.entries.end(), entries, entries + count);
+}
+
+AstroNativeFn AstroFindNative(const std::vector<AstroInstr>& program) {
+    return program.empty() ? nullptr : AstroFindNative(program, AstroProgramHash(program));
+}
+
+AstroNativeFn AstroFindNative(const std::vector<AstroInstr>& program, uint64_t h) {
+    Registry& r = TheRegistry();
+    std::lock_guard<std::mutex> hold(r.lock);
+    for (const AstroNativeEntry& e : r.entries) {
+        if (e.hash == h && e.size == program.size() &&
+            std::memcmp(e.program, program.data(), program.size() * sizeof(AstroInstr)) == 0) {
+            return e.fn;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AstroBytecode.h"
+
+// ===== Ahead-of-time compiled ship programs =====
+// astro_aot (main_aot.cpp) runs at build time: it sets up every registered ship type,
+// translates each decoded, optimized program into a C++ function with AstroEmitNative(),
+// and writes them to one source file that registers them on startup. Built into a target
+// (the ASTRO_NATIVE_SHIPS CMake option), ShipBase::Compile() finds the function whose
+// program hash matches its own and ShipBase::Run() calls it instead of interpreting.
+// Branches are plain gotos and conditions read ShipState fields directly, so a turn is
+// exactly what the interpreter would do without the dispatch. A program that doesn't match
+// anything compiled in (changed since the build, or built at runtime) is interpreted.
+
+struct AstroArena;
+
+// one ship program's turn: what ShipBase::RunProgram<false>() does for ship id of A
+using AstroNativeFn = void (*)(AstroArena* A, int id);
+
+// FNV-1a over every field of every instruction; native functions are looked up by it
+uint64_t AstroProgramHash(const std::vector<AstroInstr>& program);
+
+// C++ source of static definitions of fn, a function running program, and fn_program, a
+// copy of program for the registry; needs AstroArena.h and nothing else
+std::string AstroEmitNative(const std::string& fn, const std::vector<AstroInstr>& program);
+
+struct AstroNativeEntry {
+    uint64_t hash;               // AstroProgramHash() of the program fn was emitted from
+    const AstroInstr* program;   // that program, compared in full on a hash match
+    size_t size;
+    AstroNativeFn fn;
+};
+// adds entries to the table AstroFindNative() searches (the generated source's static
+// initializer calls this)
+void AstroRegisterNative(const AstroNativeEntry* entries, size_t count);
+// the function compiled from a program equal to this one, nullptr if there is none
+AstroNativeFn AstroFindNative(const std::vector<AstroInstr>& program);
+// the same with the program's hash already known (a stored one: a wrong hash only misses)
+AstroNativeFn AstroFindNative(const std::vector<AstroInstr>& program, uint64_t hash);
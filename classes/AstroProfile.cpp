@@ -0,0 +1,98 @@
+#include "AstroProfile.h"
+#include <algorithm>
+#include <cstdio>
+
+const char* AstroPhaseName(AstroPhase phase) {
+    switch (phase) {
+        case ASTRO_PHASE_START_TURN: return "start_turn";
+        case ASTRO_PHASE_PROGRAMS: return "programs";
+        case ASTRO_PHASE_MOVE_SHIPS: return "move_ships";
+        case ASTRO_PHASE_MOVE_WORLD: return "move_world";
+        case ASTRO_PHASE_COLLISIONS: return "collisions";
+        case ASTRO_PHASE_TORPEDOES: return "torpedoes";
+        case ASTRO_PHASE_COMPACT: return "compact";
+        case ASTRO_PHASE_SPAWN: return "spawn";
+        case ASTRO_PHASE_TURN: return "turn";
+        case ASTRO_PHASE_DRAW_ASTEROIDS: return "draw_asteroids";
+        case ASTRO_PHASE_DRAW_BEAMS: return "draw_beams";
+        case ASTRO_PHASE_DRAW_PARTICLES: return "draw_particles";
+        case ASTRO_PHASE_DRAW_DEBRIS: return "draw_debris";
+        case ASTRO_PHASE_DRAW_TORPEDOES: return "draw_torpedoes";
+        case ASTRO_PHASE_DRAW_SHIPS: return "draw_ships";
+        case ASTRO_PHASE_DRAW_LOG: return "draw_log";
+        case ASTRO_PHASE_DRAW_FRAME: return "draw_frame";
+        default: return "unknown";
+    }
+}
+
+double AstroProfiler::BucketMidNs(int bucket) {
+    if (bucket < 4) return (double)bucket;
+    int log2 = bucket / 4;
+    double width = (double)(1ull << (log2 - 2));
+    return (double)(1ull << log2) + (bucket % 4) * width + width * 0.5;
+}
+
+AstroProfiler::Summary AstroProfiler::Recent(AstroPhase phase) const {
+    const Phase& p = _phases[phase];
+    Summary s;
+    size_t n = (size_t)std::min<uint64_t>(p.samples, ASTRO_PROFILE_WINDOW);
+    if (n == 0) return s;
+    std::array<uint32_t, ASTRO_PROFILE_WINDOW> sorted;
+    std::copy(p.recent.begin(), p.recent.begin() + n, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + n);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += sorted[i];
+    s.samples = n;
+    s.meanUs = (double)sum / (double)n * 1e-3;
+    s.p50Us = sorted[(n - 1) / 2] * 1e-3;
+    s.p99Us = sorted[(n - 1) * 99 / 100] * 1e-3;
+    s.maxUs = sorted[n - 1] * 1e-3;
+    return s;
+}
+
+AstroProfiler::Summary AstroProfiler::Total(AstroPhase phase) const {
+    const Phase& p = _phases[phase];
+    Summary s;
+    if (p.samples == 0) return s;
+    s.samples = p.samples;
+    s.meanUs = (double)p.totalNs / (double)p.samples * 1e-3;
+    s.maxUs = p.maxNs * 1e-3;
+    // the bucket holding the sample of rank (samples - 1) * q, clamped to the largest one seen
+    auto percentile = [&](uint64_t rank) {
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += p.histogram[b];
+            if (seen > rank) return std::min(BucketMidNs(b), (double)p.maxNs) * 1e-3;
+        }
+        return s.maxUs;
+    };
+    s.p50Us = percentile((p.samples - 1) / 2);
+    s.p99Us = percentile((p.samples - 1) * 99 / 100);
+    return s;
+}
+
+std::string AstroProfiler::Csv() const {
+    std::string out = "phase,samples,mean_us,p50_us,p99_us,max_us\n";
+    char line[128];
+    for (int i = 0; i < ASTRO_PHASE_COUNT; ++i) {
+        Summary s = Total((AstroPhase)i);
+        if (s.samples == 0) continue;
+        std::snprintf(line, sizeof(line), "%s,%llu,%.3f,%.3f,%.3f,%.3f\n", AstroPhaseName((AstroPhase)i),
+                      (unsigned long long)s.samples, s.meanUs, s.p50Us, s.p99Us, s.maxUs);
+        out += line;
+    }
+    return out;
+}
+
+bool AstroProfiler::WriteCsv(const std::string& path, std::string* error) const {
+    std::string csv = Csv();
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    bool ok = std::fwrite(csv.data(), 1, csv.size(), f) == csv.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok && error) *error = "cannot write " + path;
+    return ok;
+}
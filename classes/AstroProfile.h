@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ===== Phase profiler =====
+// Scoped timers around the phases of a turn (AstroArena::Step) and of a viewer frame
+// (AstroBots::drawFrame). Each phase keeps its last ASTRO_PROFILE_WINDOW samples for the
+// HUD's rolling p50/p99, and a log-scale histogram of every sample since Reset() for the
+// headless CSV dump. Built without ASTRO_PROFILE (the CMake option of the same name),
+// ASTRO_PROFILE_SCOPE expands to nothing and the profiler never gets a sample.
+enum AstroPhase : uint8_t {
+    // AstroArena::Step
+    ASTRO_PHASE_START_TURN = 0,
+    ASTRO_PHASE_PROGRAMS,      // every ship's program, plus resolving queued actions when simultaneous
+    ASTRO_PHASE_MOVE_SHIPS,
+    ASTRO_PHASE_MOVE_WORLD,    // asteroids, torpedoes, beams, particles, debris
+    ASTRO_PHASE_COLLISIONS,
+    ASTRO_PHASE_TORPEDOES,
+    ASTRO_PHASE_COMPACT,       // torpedo wrap, removing the dead
+    ASTRO_PHASE_SPAWN,
+    ASTRO_PHASE_TURN,          // the whole Step()
+    // AstroBots::drawFrame
+    ASTRO_PHASE_DRAW_ASTEROIDS,
+    ASTRO_PHASE_DRAW_BEAMS,
+    ASTRO_PHASE_DRAW_PARTICLES,
+    ASTRO_PHASE_DRAW_DEBRIS,
+    ASTRO_PHASE_DRAW_TORPEDOES,
+    ASTRO_PHASE_DRAW_SHIPS,
+    ASTRO_PHASE_DRAW_LOG,
+    ASTRO_PHASE_DRAW_FRAME,    // the whole drawFrame()
+    ASTRO_PHASE_COUNT
+};
+
+const char* AstroPhaseName(AstroPhase phase);
+
+static constexpr size_t ASTRO_PROFILE_WINDOW = 256; // recent samples kept per phase, power of two
+
+#if defined(ASTRO_PROFILE)
+static constexpr bool ASTRO_PROFILE_ENABLED = true;
+#else
+static constexpr bool ASTRO_PROFILE_ENABLED = false;
+#endif
+
+// One writer thread; the viewer reads it from the thread that steps the arena.
+class AstroProfiler {
+public:
+    struct Summary {
+        uint64_t samples = 0;
+        double meanUs = 0.0;
+        double p50Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+    };
+
+    void Record(AstroPhase phase, uint64_t ns) {
+        Phase& p = _phases[phase];
+        uint32_t v = ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+        p.recent[p.samples & (ASTRO_PROFILE_WINDOW - 1)] = v;
+        p.samples++;
+        p.totalNs += v;
+        if (v > p.maxNs) p.maxNs = v;
+        p.histogram[Bucket(v)]++;
+    }
+    void Reset() { _phases = {}; }
+
+    // over the last ASTRO_PROFILE_WINDOW samples
+    Summary Recent(AstroPhase phase) const;
+    // over every sample since Reset(); percentiles are good to a bucket, an eighth of a
+    // power of two either way
+    Summary Total(AstroPhase phase) const;
+
+    // phase,samples,mean_us,p50_us,p99_us,max_us: one row per phase that has samples
+    std::string Csv() const;
+    bool WriteCsv(const std::string& path, std::string* error = nullptr) const;
+
+private:
+    // four buckets per power of two
+    static constexpr int BUCKETS = 33 * 4;
+    static int Bucket(uint32_t ns) {
+        if (ns < 4) return (int)ns;
+        int log2 = std::bit_width(ns) - 1;
+        return log2 * 4 + (int)((ns >> (log2 - 2)) & 3);
+    }
+    static double BucketMidNs(int bucket);
+
+    struct Phase {
+        std::array<uint32_t, ASTRO_PROFILE_WINDOW> recent{};
+        std::array<uint64_t, BUCKETS> histogram{};
+        uint64_t samples = 0;
+        uint64_t totalNs = 0;
+        uint32_t maxNs = 0;
+    };
+    std::array<Phase, ASTRO_PHASE_COUNT> _phases{};
+};
+
+#if defined(ASTRO_PROFILE)
+// times its own lifetime into profiler (nothing when profiler is null)
+class AstroProfileScope {
+public:
+    AstroProfileScope(AstroProfiler* profiler, AstroPhase phase) : _profiler(profiler), _phase(phase) {
+        if (_profiler) _start = std::chrono::steady_clock::now();
+    }
+    ~AstroProfileScope() {
+        if (_profiler) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+            _profiler->Record(_phase, (uint64_t)ns);
+        }
+    }
+    AstroProfileScope(const AstroProfileScope&) = delete;
+    AstroProfileScope& operator=(const AstroProfileScope&) = delete;
+
+private:
+    AstroProfiler* _profiler;
+    AstroPhase _phase;
+    std::chrono::steady_clock::time_point _start;
+};
+
+#define ASTRO_PROFILE_CONCAT_(a, b) a##b
+#define ASTRO_PROFILE_CONCAT(a, b) ASTRO_PROFILE_CONCAT_(a, b)
+#define ASTRO_PROFILE_SCOPE(profiler, phase) AstroProfileScope ASTRO_PROFILE_CONCAT(astroProfileScope_, __LINE__)(profiler, phase)
+#else
+#define ASTRO_PROFILE_SCOPE(profiler, phase) ((void)0)
+#endif
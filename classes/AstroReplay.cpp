@@ -0,0 +1,303 @@
+#include "AstroReplay.h"
+#include "AstroShips.h"
+#include <cstdio>
+#include <cstring>
+
+static constexpr uint32_t REPLAY_MAGIC = 0x4C505241; // "ARPL"
+static constexpr uint32_t REPLAY_VERSION = 6; // 2: simultaneous, 3: arena config, 4: effects off the match rng,
+                                              // 5: stalemate turns, 6: fixed point
+
+const char* AstroEventName(AstroEventType type) {
+    switch (type) {
+        case ASTRO_EV_PHASER_MISS: return "phaser_miss";
+        case ASTRO_EV_PHASER_HIT_SHIP: return "phaser_hit_ship";
+        case ASTRO_EV_PHASER_HIT_ASTEROID: return "phaser_hit_asteroid";
+        case ASTRO_EV_PHOTON_FIRE: return "photon_fire";
+        case ASTRO_EV_TORPEDO_HIT_SHIP: return "torpedo_hit_ship";
+        case ASTRO_EV_TORPEDO_HIT_ASTEROID: return "torpedo_hit_asteroid";
+        case ASTRO_EV_SHIP_KILLED: return "ship_killed";
+        case ASTRO_EV_ASTEROID_BROKEN: return "asteroid_broken";
+        case ASTRO_EV_ASTEROID_SPAWNED: return "asteroid_spawned";
+        default: return "unknown";
+    }
+}
+
+namespace {
+
+// ===== Varints =====
+// fields are zigzag-encoded so a stray -1 (no owner) stays one byte
+void PutVarint(std::vector<uint8_t>& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+bool GetVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        v |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+uint32_t ZigZag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+int32_t UnZigZag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+template <typename T> void PutPod(std::vector<uint8_t>& out, const T& v) {
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(&v);
+    out.insert(out.end(), b, b + sizeof(T));
+}
+
+template <typename T> bool GetPod(const uint8_t*& p, const uint8_t* end, T& v) {
+    if ((size_t)(end - p) < sizeof(T)) return false;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+bool GetBytes(const uint8_t*& p, const uint8_t* end, size_t n, const uint8_t*& out) {
+    if ((size_t)(end - p) < n) return false;
+    out = p;
+    p += n;
+    return true;
+}
+
+} // namespace
+
+// ===== AstroReplay =====
+void AstroReplay::Save(std::vector<uint8_t>& out) const {
+    PutPod(out, REPLAY_MAGIC);
+    PutPod(out, REPLAY_VERSION);
+    PutPod(out, seed);
+    PutPod(out, (uint8_t)(simultaneous ? 1 : 0));
+    PutPod(out, config.width);
+    PutPod(out, config.height);
+    PutPod(out, (int32_t)config.asteroids);
+    PutPod(out, (int32_t)config.cellSize);
+    PutPod(out, (int32_t)config.stalemateTurns);
+    PutPod(out, (uint8_t)(config.fixedPoint ? 1 : 0));
+    PutPod(out, finalTurn);
+    PutPod(out, finalChecksum);
+    PutVarint(out, (uint32_t)roster.size());
+    for (const std::string& name : roster) {
+        PutVarint(out, (uint32_t)name.size());
+        out.insert(out.end(), name.begin(), name.end());
+    }
+    PutVarint(out, eventCount);
+    PutVarint(out, (uint32_t)events.size());
+    out.insert(out.end(), events.begin(), events.end());
+}
+
+bool AstroReplay::Load(const uint8_t* data, size_t size, std::string* error) {
+    auto fail = [error](const std::string& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    uint32_t magic = 0, version = 0;
+    if (!GetPod(p, end, magic) || magic != REPLAY_MAGIC) return fail("not a replay");
+    if (!GetPod(p, end, version) || version != REPLAY_VERSION) return fail("unsupported replay version " + std::to_string(version));
+
+    AstroReplay r;
+    uint32_t count = 0;
+    uint8_t simultaneous = 0, fixedPoint = 0;
+    int32_t asteroidCount = 0, cellSize = 0, stalemateTurns = 0;
+    if (!GetPod(p, end, r.seed) || !GetPod(p, end, simultaneous) || !GetPod(p, end, r.config.width) ||
+        !GetPod(p, end, r.config.height) || !GetPod(p, end, asteroidCount) || !GetPod(p, end, cellSize) ||
+        !GetPod(p, end, stalemateTurns) || !GetPod(p, end, fixedPoint) || !GetPod(p, end, r.finalTurn) || !GetPod(p, end, r.finalChecksum) || !GetVarint(p, end, count)) {
+        return fail("truncated replay");
+    }
+    r.simultaneous = simultaneous != 0;
+    r.config.asteroids = asteroidCount;
+    r.config.cellSize = cellSize;
+    r.config.stalemateTurns = stalemateTurns;
+    r.config.fixedPoint = fixedPoint != 0;
+    if (!r.config.FitsFixedPoint()) return fail("replay world too large for fixed point");
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t len = 0;
+        const uint8_t* name = nullptr;
+        if (!GetVarint(p, end, len) || !GetBytes(p, end, len, name)) return fail("truncated replay");
+        r.roster.emplace_back((const char*)name, len);
+    }
+    uint32_t bytes = 0;
+    const uint8_t* stream = nullptr;
+    if (!GetVarint(p, end, r.eventCount) || !GetVarint(p, end, bytes) || !GetBytes(p, end, bytes, stream)) {
+        return fail("truncated replay");
+    }
+    r.events.assign(stream, stream + bytes);
+    *this = std::move(r);
+    return true;
+}
+
+bool AstroReplay::SaveFile(const std::string& path, std::string* error) const {
+    std::vector<uint8_t> bytes;
+    Save(bytes);
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok && error) *error = "cannot write " + path;
+    return ok;
+}
+
+bool AstroReplay::LoadFile(const std::string& path, std::string* error) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+    std::fclose(f);
+    return Load(bytes.data(), bytes.size(), error);
+}
+
+bool AstroReplay::Decode(std::vector<AstroEvent>& out) const {
+    const uint8_t* p = events.data();
+    const uint8_t* end = p + events.size();
+    int32_t turn = 0;
+    for (uint32_t i = 0; i < eventCount; ++i) {
+        uint32_t dt, type, a, b, value;
+        if (!GetVarint(p, end, dt) || !GetVarint(p, end, type) || type >= ASTRO_EV_COUNT ||
+            !GetVarint(p, end, a) || !GetVarint(p, end, b) || !GetVarint(p, end, value)) {
+            return false;
+        }
+        turn += (int32_t)dt;
+        out.push_back({ turn, (AstroEventType)type, UnZigZag(a), UnZigZag(b), UnZigZag(value) });
+    }
+    return p == end;
+}
+
+// ===== AstroReplayRecorder =====
+void AstroReplayRecorder::Begin(const AstroArena& arena, int keyframeEvery) {
+    _replay = AstroReplay();
+    _replay.seed = arena.seed;
+    _replay.simultaneous = arena.simultaneous;
+    _replay.config = arena.config;
+    for (const auto& program : arena.programs) _replay.roster.push_back(program->name);
+    _replay.finalTurn = arena.turn;
+    _replay.finalChecksum = arena.Checksum();
+    _keyframes.clear();
+    _every = keyframeEvery;
+    _lastEventTurn = arena.turn;
+    if (_every > 0) {
+        _keyframes.push_back({ arena.turn, {} });
+        arena.SaveSnapshot(_keyframes.back().snapshot);
+    }
+}
+
+void AstroReplayRecorder::Event(int turn, AstroEventType type, int a, int b, int value) {
+    std::vector<uint8_t>& out = _replay.events;
+    PutVarint(out, (uint32_t)(turn - _lastEventTurn));
+    PutVarint(out, type);
+    PutVarint(out, ZigZag(a));
+    PutVarint(out, ZigZag(b));
+    PutVarint(out, ZigZag(value));
+    _replay.eventCount++;
+    _lastEventTurn = turn;
+}
+
+void AstroReplayRecorder::EndTurn(const AstroArena& arena) {
+    if (_every <= 0 || arena.turn % _every != 0) return;
+    if (!_keyframes.empty() && _keyframes.back().turn >= arena.turn) return;
+    _keyframes.push_back({ arena.turn, {} });
+    arena.SaveSnapshot(_keyframes.back().snapshot);
+}
+
+void AstroReplayRecorder::Finish(const AstroArena& arena) {
+    _replay.finalTurn = arena.turn;
+    _replay.finalChecksum = arena.Checksum();
+}
+
+bool AstroReplayRecorder::Seek(AstroArena& arena, int turn) {
+    if (_keyframes.empty() || turn < _keyframes.front().turn || turn > arena.turn) return false;
+    size_t k = _keyframes.size() - 1;
+    while (_keyframes[k].turn > turn) --k;
+    const Keyframe& kf = _keyframes[k];
+    if (!arena.LoadSnapshot(kf.snapshot.data(), kf.snapshot.size())) return false;
+    Truncate(kf.turn);
+    while (arena.turn < turn && arena.Step()) {
+    }
+    Finish(arena);
+    return true;
+}
+
+void AstroReplayRecorder::Truncate(int turn) {
+    while (!_keyframes.empty() && _keyframes.back().turn > turn) _keyframes.pop_back();
+    // walk the stream to the first event past turn
+    const uint8_t* begin = _replay.events.data();
+    const uint8_t* p = begin;
+    const uint8_t* end = begin + _replay.events.size();
+    int32_t eventTurn = 0, lastTurn = 0;
+    uint32_t kept = 0;
+    for (; kept < _replay.eventCount; ++kept) {
+        const uint8_t* start = p;
+        uint32_t dt, field;
+        if (!GetVarint(p, end, dt)) break;
+        eventTurn += (int32_t)dt;
+        if (eventTurn > turn) { p = start; break; }
+        for (int f = 0; f < 4; ++f) GetVarint(p, end, field);
+        lastTurn = eventTurn;
+    }
+    _replay.events.resize(p - begin);
+    _replay.eventCount = kept;
+    _lastEventTurn = lastTurn;
+}
+
+// ===== AstroReplayPlayer =====
+bool AstroReplayPlayer::Open(const AstroReplay& replay, std::vector<std::unique_ptr<ShipBase>> roster,
+                             std::string* error, int keyframeEvery) {
+    if (roster.size() != replay.roster.size()) {
+        if (error) *error = "replay has " + std::to_string(replay.roster.size()) + " ships, roster has " + std::to_string(roster.size());
+        return false;
+    }
+    for (size_t i = 0; i < roster.size(); ++i) {
+        if (roster[i]->name != replay.roster[i]) {
+            if (error) *error = "ship " + std::to_string(i) + " is " + replay.roster[i] + " in the replay";
+            return false;
+        }
+    }
+    _replay = replay;
+    _every = keyframeEvery > 0 ? keyframeEvery : ASTRO_REPLAY_KEYFRAME_EVERY;
+    _arena.eventLog = nullptr;
+    _arena.recorder = nullptr;
+    _arena.simultaneous = replay.simultaneous;
+    _arena.config = replay.config;
+    _arena.Setup(std::move(roster), replay.seed);
+    _keyframes.clear();
+    _keyframes.push_back({ 0, {} });
+    _arena.SaveSnapshot(_keyframes.back().snapshot);
+    return true;
+}
+
+bool AstroReplayPlayer::Step() {
+    if (AtEnd() || !_arena.Step()) return false;
+    if (_arena.turn % _every == 0 && _keyframes.back().turn < _arena.turn) {
+        _keyframes.push_back({ _arena.turn, {} });
+        _arena.SaveSnapshot(_keyframes.back().snapshot);
+    }
+    return true;
+}
+
+void AstroReplayPlayer::Seek(int turn) {
+    if (_keyframes.empty()) return;
+    turn = std::max(0, std::min(turn, (int)_replay.finalTurn));
+    // restore only when going back, or when a keyframe lets us skip ahead
+    size_t k = _keyframes.size() - 1;
+    while (k > 0 && _keyframes[k].turn > turn) --k;
+    if (turn < _arena.turn || _keyframes[k].turn > _arena.turn) {
+        _arena.LoadSnapshot(_keyframes[k].snapshot.data(), _keyframes[k].snapshot.size());
+    }
+    while (_arena.turn < turn && Step()) {
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AstroArena.h"
+
+struct ShipBase;
+
+static constexpr int ASTRO_REPLAY_KEYFRAME_EVERY = 256; // turns between seek snapshots
+
+// ===== Replays =====
+// A match is fully determined by (seed, roster, rules), so a replay stores just those plus the
+// gameplay events as they happened. Playback re-simulates; the events are there for
+// analysis (kill feeds, hit counts) and to check the re-simulation against.
+//
+// Events are delta-encoded: the turn as an increment over the previous event's turn,
+// then the type and three fields, all as LEB128 varints, so a typical event is 4-6 bytes.
+
+enum AstroEventType : uint8_t {
+    ASTRO_EV_PHASER_MISS = 0,     // a = ship
+    ASTRO_EV_PHASER_HIT_SHIP,     // a = ship, b = target ship, value = damage
+    ASTRO_EV_PHASER_HIT_ASTEROID, // a = ship, b = asteroid index
+    ASTRO_EV_PHOTON_FIRE,         // a = ship
+    ASTRO_EV_TORPEDO_HIT_SHIP,    // a = owner, b = target ship, value = damage
+    ASTRO_EV_TORPEDO_HIT_ASTEROID,// a = owner, b = asteroid index
+    ASTRO_EV_SHIP_KILLED,         // a = ship
+    ASTRO_EV_ASTEROID_BROKEN,     // a = asteroid index, b = fragments spawned
+    ASTRO_EV_ASTEROID_SPAWNED,    // a = asteroids spawned
+    ASTRO_EV_COUNT
+};
+
+const char* AstroEventName(AstroEventType type);
+
+struct AstroEvent {
+    int32_t turn = 0;
+    AstroEventType type = ASTRO_EV_PHASER_MISS;
+    int32_t a = 0, b = 0, value = 0;
+};
+
+// The archived form: what gets written to disk.
+struct AstroReplay {
+    uint32_t seed = 0;
+    bool simultaneous = false;       // AstroArena::simultaneous
+    AstroArenaConfig config;         // AstroArena::config (world size, asteroids, cell size, stalemate turns and fixed point are saved)
+    std::vector<std::string> roster; // ship names, in arena order
+    int32_t finalTurn = 0;
+    uint64_t finalChecksum = 0;      // AstroArena::Checksum() at finalTurn
+    uint32_t eventCount = 0;
+    std::vector<uint8_t> events;     // delta-encoded stream
+
+    void Save(std::vector<uint8_t>& out) const;
+    bool Load(const uint8_t* data, size_t size, std::string* error = nullptr);
+    bool SaveFile(const std::string& path, std::string* error = nullptr) const;
+    bool LoadFile(const std::string& path, std::string* error = nullptr);
+    // Decodes the event stream; false if it is corrupt (out keeps what decoded).
+    bool Decode(std::vector<AstroEvent>& out) const;
+};
+
+// Attach to AstroArena::recorder after Setup(); the arena reports events as they happen.
+class AstroReplayRecorder {
+public:
+    // Starts a new replay for the arena's seed and roster. With keyframeEvery > 0 a
+    // snapshot is kept in memory every that many turns so Seek() is cheap; keyframes are
+    // not part of the archive.
+    void Begin(const AstroArena& arena, int keyframeEvery = 0);
+    void Event(int turn, AstroEventType type, int a, int b = 0, int value = 0);
+    // called by AstroArena::Step() once the turn is done
+    void EndTurn(const AstroArena& arena);
+    // records the final turn and checksum
+    void Finish(const AstroArena& arena);
+    // Restores the arena to an earlier turn from the nearest keyframe and drops
+    // everything recorded after it; the arena re-records as it steps forward again.
+    bool Seek(AstroArena& arena, int turn);
+    // Drops events and keyframes after turn, e.g. after the arena was restored from a
+    // snapshot of this match taken at that turn.
+    void Truncate(int turn);
+
+    const AstroReplay& Replay() const { return _replay; }
+    int KeyframeCount() const { return (int)_keyframes.size(); }
+
+private:
+    struct Keyframe {
+        int turn;
+        std::vector<uint8_t> snapshot;
+    };
+    AstroReplay _replay;
+    std::vector<Keyframe> _keyframes;
+    int _every = 0;
+    int _lastEventTurn = 0; // delta base for the next event
+};
+
+// Re-simulates a replay with random access: keyframes are taken every keyframeEvery
+// turns the first time playback passes them, so seeking back is a restore plus at most
+// keyframeEvery - 1 steps.
+class AstroReplayPlayer {
+public:
+    // The roster must be the programs the replay was recorded with, in the same order.
+    bool Open(const AstroReplay& replay, std::vector<std::unique_ptr<ShipBase>> roster,
+              std::string* error = nullptr, int keyframeEvery = ASTRO_REPLAY_KEYFRAME_EVERY);
+    // Steps one turn; false at the end of the replay.
+    bool Step();
+    // Moves to turn (clamped to [0, finalTurn]).
+    void Seek(int turn);
+    int Turn() const { return _arena.turn; }
+    bool AtEnd() const { return _arena.turn >= _replay.finalTurn; }
+    // at the end: the re-simulation reproduced the recorded final state
+    bool Verified() const { return AtEnd() && _arena.Checksum() == _replay.finalChecksum; }
+    const AstroArena& Arena() const { return _arena; }
+    const AstroReplay& Replay() const { return _replay; }
+
+private:
+    struct Keyframe {
+        int turn;
+        std::vector<uint8_t> snapshot;
+    };
+    AstroArena _arena;
+    AstroReplay _replay;
+    std::vector<Keyframe> _keyframes; // ascending turn, keyframe 0 is turn 0
+    int _every = ASTRO_REPLAY_KEYFRAME_EVERY;
+};
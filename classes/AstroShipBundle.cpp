@@ -0,0 +1,325 @@
+#include "AstroShipBundle.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#define ASTRO_BUNDLE_NO_MMAP 1
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <sys/stat.h>
+
+static constexpr uint32_t BUNDLE_MAGIC = 0x42485341; // "ASHB"
+static constexpr uint32_t BUNDLE_VERSION = 1;
+
+namespace {
+struct ShipBundleHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t opCount;      // ASTRO_OP_COUNT of the writer: opcodes are only ever appended, so
+                           // a smaller set numbers the ones it has the same
+    uint32_t instrSize;    // sizeof(AstroInstr)
+    uint32_t shipCount;
+    uint32_t codeWords;    // code section size
+    uint32_t programSize;  // program section size, in instructions
+    uint32_t reserved;
+};
+
+// compiles a bundle's code as the ship that wrote it did, to check the program against
+struct BundleCompiler : ShipBase {
+    int SetupShip() override { return 0; }
+};
+}
+
+static_assert(sizeof(ShipBundleEntry) == 56, "ShipBundleEntry is an on-disk record");
+static_assert(sizeof(AstroInstr) == 16, "AstroInstr is stored in bundles as is");
+
+// ===== Writer =====
+bool AstroWriteShipBundle(const std::string& path, const std::vector<const ShipBase*>& ships, std::string* error) {
+    auto fail = [error](const std::string& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+    ShipBundleHeader header{};
+    header.magic = BUNDLE_MAGIC;
+    header.version = BUNDLE_VERSION;
+    header.opCount = ASTRO_OP_COUNT;
+    header.instrSize = sizeof(AstroInstr);
+    header.shipCount = (uint32_t)ships.size();
+    std::vector<ShipBundleEntry> entries;
+    entries.reserve(ships.size());
+    for (const ShipBase* ship : ships) {
+        if (!ship->verifyError.empty()) return fail(ship->name + " was rejected: " + ship->verifyError);
+        if (ship->name.size() >= ASTRO_BUNDLE_NAME_LEN) return fail("ship name too long: " + ship->name);
+        ShipBundleEntry e{};
+        std::strncpy(e.name, ship->name.c_str(), ASTRO_BUNDLE_NAME_LEN - 1);
+        e.codeOffset = header.codeWords;
+        e.codeWords = (uint32_t)ship->code.size();
+        e.programOffset = header.programSize;
+        e.programSize = (uint32_t)ship->program.size();
+        e.scriptCost = ship->script_cost;
+        e.hash = AstroProgramHash(ship->program);
+        header.codeWords += e.codeWords;
+        header.programSize += e.programSize;
+        entries.push_back(e);
+    }
+
+    // written beside the target and renamed over it, so readers see the old file or the new one
+    const std::string temp = path + ".tmp";
+    FILE* f = std::fopen(temp.c_str(), "wb");
+    if (!f) return fail("cannot open " + temp);
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    if (!entries.empty()) ok = ok && std::fwrite(entries.data(), sizeof(ShipBundleEntry), entries.size(), f) == entries.size();
+    for (const ShipBase* ship : ships) {
+        std::vector<int32_t> words(ship->code.begin(), ship->code.end());
+        if (!words.empty()) ok = ok && std::fwrite(words.data(), sizeof(int32_t), words.size(), f) == words.size();
+    }
+    for (const ShipBase* ship : ships) {
+        if (!ship->program.empty()) ok = ok && std::fwrite(ship->program.data(), sizeof(AstroInstr), ship->program.size(), f) == ship->program.size();
+    }
+    ok = (std::fclose(f) == 0) && ok;
+#if defined(_WIN32)
+    std::remove(path.c_str()); // rename() doesn't replace on Windows
+#endif
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return fail("cannot write " + path);
+    }
+    return true;
+}
+
+// ===== Reader =====
+AstroShipBundle::~AstroShipBundle() {
+    Close();
+}
+
+void AstroShipBundle::Close() {
+#if !defined(ASTRO_BUNDLE_NO_MMAP)
+    if (_data && _fallback.empty()) munmap((void*)_data, _size);
+#endif
+    _fallback.clear();
+    _data = nullptr;
+    _size = 0;
+    _shipCount = 0;
+    _entries = nullptr;
+    _code = nullptr;
+    _program = nullptr;
+}
+
+std::string AstroShipBundle::Name(size_t i) const {
+    const char* name = _entries[i].name;
+    return std::string(name, strnlen(name, ASTRO_BUNDLE_NAME_LEN));
+}
+
+bool AstroShipBundle::Open(const std::string& path, std::string* error) {
+    Close();
+    auto fail = [this, error](const std::string& msg) {
+        Close();
+        if (error) *error = msg;
+        return false;
+    };
+#if defined(ASTRO_BUNDLE_NO_MMAP)
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return fail("cannot open " + path);
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) _fallback.insert(_fallback.end(), chunk, chunk + n);
+    std::fclose(f);
+    _data = _fallback.data();
+    _size = _fallback.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail("cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(ShipBundleHeader)) {
+        ::close(fd);
+        return fail(path + " is not a ship bundle");
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return fail("cannot map " + path);
+    _data = (const uint8_t*)p;
+    _size = (size_t)st.st_size;
+#endif
+    if (_size < sizeof(ShipBundleHeader)) return fail(path + " is not a ship bundle");
+    ShipBundleHeader header;
+    std::memcpy(&header, _data, sizeof(header));
+    if (header.magic != BUNDLE_MAGIC) return fail(path + " is not a ship bundle");
+    if (header.version != BUNDLE_VERSION) return fail(path + ": unsupported bundle version " + std::to_string(header.version));
+    if (header.opCount > ASTRO_OP_COUNT || header.instrSize != sizeof(AstroInstr)) {
+        return fail(path + " was written by a build with a different instruction set");
+    }
+    const uint64_t codeAt = sizeof(ShipBundleHeader) + (uint64_t)header.shipCount * sizeof(ShipBundleEntry);
+    const uint64_t programAt = codeAt + (uint64_t)header.codeWords * sizeof(int32_t);
+    if (programAt + (uint64_t)header.programSize * sizeof(AstroInstr) > _size) return fail(path + " is truncated");
+    _shipCount = header.shipCount;
+    _entries = (const ShipBundleEntry*)(_data + sizeof(ShipBundleHeader));
+    _code = (const int32_t*)(_data + codeAt);
+    _program = (const AstroInstr*)(_data + programAt);
+
+    // nothing runs until every ship has been checked: its program has to be what the
+    // compiler makes of its verified code, and its cost what that code adds up to
+    BundleCompiler compiler;
+    for (size_t i = 0; i < _shipCount; ++i) {
+        const ShipBundleEntry& e = _entries[i];
+        if ((uint64_t)e.codeOffset + e.codeWords > header.codeWords ||
+            (uint64_t)e.programOffset + e.programSize > header.programSize) {
+            return fail(path + ": corrupt ship index");
+        }
+        compiler.code.assign(Code(i), Code(i) + e.codeWords);
+        compiler.Compile(true, false); // Read() looks the native form up by the stored hash
+        if (!compiler.verifyError.empty()) return fail(path + ": " + Name(i) + ": " + compiler.verifyError);
+        if (compiler.program.size() != e.programSize ||
+            std::memcmp(compiler.program.data(), Program(i), e.programSize * sizeof(AstroInstr)) != 0) {
+            return fail(path + ": " + Name(i) + ": program does not match its code");
+        }
+        const int cost = AstroScriptCost(compiler.code);
+        if (e.scriptCost != cost) {
+            return fail(path + ": " + Name(i) + ": script cost " + std::to_string(e.scriptCost) +
+                        " does not match its code (" + std::to_string(cost) + ")");
+        }
+    }
+    return true;
+}
+
+// ===== Registry =====
+BundleShip::BundleShip(std::shared_ptr<const AstroShipProgram> program) : source(std::move(program)) {
+    name = source->name;
+}
+
+int BundleShip::SetupShip() {
+    code = source->code;
+    program = source->program;
+    native = source->native;
+    verifyError.clear();
+    script_cost = source->scriptCost;
+    return script_cost;
+}
+
+std::shared_ptr<const AstroShipProgram> AstroShipRegistry::Slot::Get() const {
+    std::lock_guard<std::mutex> hold(lock);
+    return current;
+}
+
+void AstroShipRegistry::Slot::Set(std::shared_ptr<const AstroShipProgram> program) {
+    std::lock_guard<std::mutex> hold(lock);
+    current = std::move(program);
+}
+
+bool AstroShipRegistry::Read(const std::string& path, std::vector<std::shared_ptr<const AstroShipProgram>>& programs,
+                             std::string* error) {
+    AstroShipBundle bundle;
+    if (!bundle.Open(path, error)) return false;
+    programs.clear();
+    for (size_t i = 0; i < bundle.ShipCount(); ++i) {
+        const ShipBundleEntry& e = bundle.Entry(i);
+        auto p = std::make_shared<AstroShipProgram>();
+        p->name = bundle.Name(i);
+        p->code.assign(bundle.Code(i), bundle.Code(i) + e.codeWords);
+        p->program.assign(bundle.Program(i), bundle.Program(i) + e.programSize);
+        p->scriptCost = e.scriptCost;
+        p->hash = e.hash;
+        p->native = AstroFindNative(p->program, p->hash);
+        programs.push_back(std::move(p));
+    }
+    return true;
+}
+
+int AstroShipRegistry::Install(const std::vector<std::shared_ptr<const AstroShipProgram>>& programs) {
+    auto& types = ShipTypes();
+    std::unordered_map<std::string, size_t> typeIndex; // built on the first name new to the registry
+    int changed = 0;
+    for (const auto& program : programs) {
+        auto known = _slotIndex.find(program->name);
+        if (known != _slotIndex.end()) {
+            Slot& slot = *_slots[known->second];
+            auto old = slot.Get();
+            if (old->hash != program->hash || old->code != program->code || old->scriptCost != program->scriptCost) {
+                slot.Set(program);
+                changed++;
+            }
+            continue;
+        }
+        auto s = std::make_shared<Slot>();
+        s->Set(program);
+        _slotIndex.emplace(program->name, _slots.size());
+        _slots.push_back(s);
+        changed++;
+        if (typeIndex.empty()) {
+            for (size_t t = 0; t < types.size(); ++t) typeIndex.emplace(types[t].name, t);
+        }
+        ShipFactory make = [s]() -> std::unique_ptr<ShipBase> { return std::make_unique<BundleShip>(s->Get()); };
+        auto type = typeIndex.find(program->name);
+        if (type != typeIndex.end()) {
+            types[type->second].make = std::move(make);
+        } else {
+            typeIndex.emplace(program->name, types.size());
+            RegisterShipType(program->name, std::move(make));
+        }
+    }
+    return changed;
+}
+
+void AstroShipRegistry::Stamp(File& file) {
+    struct stat st;
+    if (stat(file.path.c_str(), &st) != 0) {
+        file.size = file.mtime = -1;
+        return;
+    }
+    file.size = (int64_t)st.st_size;
+#if defined(__APPLE__)
+    file.mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    file.mtime = (int64_t)st.st_mtime;
+#else
+    file.mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+bool AstroShipRegistry::Load(const std::string& path, std::string* error) {
+    File file;
+    file.path = path;
+    Stamp(file);
+    std::vector<std::shared_ptr<const AstroShipProgram>> programs;
+    if (!Read(path, programs, error)) return false;
+    Install(programs);
+    auto known = std::find_if(_files.begin(), _files.end(), [&](const File& f) { return f.path == path; });
+    if (known != _files.end()) {
+        *known = file;
+    } else {
+        _files.push_back(file);
+        _fileNames.push_back(path);
+    }
+    return true;
+}
+
+int AstroShipRegistry::Poll(std::string* error) {
+    int changed = 0;
+    for (File& file : _files) {
+        File now = file;
+        Stamp(now);
+        if (now.size == file.size && now.mtime == file.mtime) continue;
+        file = now; // a file that fails is retried when it changes again, not every poll
+        std::vector<std::shared_ptr<const AstroShipProgram>> programs;
+        std::string why;
+        if (!Read(file.path, programs, &why)) {
+            if (error) *error += why + "\n";
+            continue;
+        }
+        changed += Install(programs);
+    }
+    return changed;
+}
+
+std::vector<std::unique_ptr<ShipBase>> AstroShipRegistry::MakeShips(int count) const {
+    std::vector<std::unique_ptr<ShipBase>> v;
+    if (_slots.empty()) return v;
+    const int n = count > 0 ? count : (int)_slots.size();
+    v.reserve(n);
+    for (int i = 0; i < n; ++i) v.push_back(std::make_unique<BundleShip>(_slots[i % _slots.size()]->Get()));
+    return v;
+}
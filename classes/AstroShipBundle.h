@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AstroBytecode.h"
+#include "AstroNative.h"
+#include "AstroShips.h"
+
+// ===== Ship bundles =====
+// Compiled ship programs in one file: each ship's name, verified bytecode and the decoded,
+// optimized program ShipBase::Compile() made from it, so ships can be loaded without
+// being built in. One file holds one ship or a whole ladder. The file is mapped read-only
+// and checked on open: the code is verified and compiled again, and has to give the stored
+// program and script cost, so a damaged or hand-edited bundle is rejected rather than run.
+//
+// File layout (version 1, host byte order):
+//   ShipBundleHeader
+//   ShipBundleEntry[shipCount]
+//   int32_t code words, every ship's back to back
+//   AstroInstr program, every ship's back to back
+//
+// Bundles are written to a temporary file renamed over the old one, so a registry
+// hot-reloading it never maps half a file.
+
+static constexpr int ASTRO_BUNDLE_NAME_LEN = 24;
+
+struct ShipBundleEntry {
+    char name[ASTRO_BUNDLE_NAME_LEN]; // zero-padded
+    uint32_t codeOffset;              // words [codeOffset, codeOffset + codeWords) of the code section
+    uint32_t codeWords;
+    uint32_t programOffset;           // instructions of the program section
+    uint32_t programSize;
+    int32_t scriptCost;
+    uint32_t reserved;
+    uint64_t hash;                    // AstroProgramHash() of the program
+};
+
+// writes ships that passed verification (set up already) to path; false and error otherwise
+bool AstroWriteShipBundle(const std::string& path, const std::vector<const ShipBase*>& ships, std::string* error = nullptr);
+
+// Read-only view of a bundle file. Pointers stay valid while the bundle is open.
+class AstroShipBundle {
+public:
+    AstroShipBundle() = default;
+    ~AstroShipBundle();
+    AstroShipBundle(const AstroShipBundle&) = delete;
+    AstroShipBundle& operator=(const AstroShipBundle&) = delete;
+
+    bool Open(const std::string& path, std::string* error = nullptr);
+    void Close();
+
+    size_t ShipCount() const { return _shipCount; }
+    const ShipBundleEntry& Entry(size_t i) const { return _entries[i]; }
+    std::string Name(size_t i) const;
+    const int32_t* Code(size_t i) const { return _code + _entries[i].codeOffset; }
+    const AstroInstr* Program(size_t i) const { return _program + _entries[i].programOffset; }
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+    std::vector<uint8_t> _fallback; // file contents when mapping isn't available
+    size_t _shipCount = 0;
+    const ShipBundleEntry* _entries = nullptr;
+    const int32_t* _code = nullptr;
+    const AstroInstr* _program = nullptr;
+};
+
+// ===== Ship registry =====
+// One compiled ship program out of a bundle, shared by every ship made from it
+struct AstroShipProgram {
+    std::string name;
+    std::vector<int> code;
+    std::vector<AstroInstr> program;
+    int scriptCost = 0;
+    uint64_t hash = 0;
+    AstroNativeFn native = nullptr;  // looked up once per load (AstroFindNative())
+};
+
+// A ship whose program comes from a bundle: SetupShip() copies it, nothing is compiled
+struct BundleShip : ShipBase {
+    explicit BundleShip(std::shared_ptr<const AstroShipProgram> source);
+    int SetupShip() override;
+
+    std::shared_ptr<const AstroShipProgram> source;
+};
+
+// Loads bundle files and registers their ships as ship types (ShipTypes()): a name that
+// is already registered, built-in or from another bundle, is replaced by the newest load.
+// Poll() reloads the files that changed on disk; ship types keep their place, and ships
+// made from then on run the new programs (matches already set up keep theirs). A file
+// that no longer loads keeps its old programs. The registry must outlive the ship types
+// it registered; factories may be called from any thread.
+class AstroShipRegistry {
+public:
+    // loads path and registers its ships; false and error if it can't be loaded
+    bool Load(const std::string& path, std::string* error = nullptr);
+    // reloads every loaded file whose size or modification time changed; returns how
+    // many ships changed program, and appends one line per file that failed to error
+    int Poll(std::string* error = nullptr);
+
+    bool Empty() const { return _slots.empty(); }
+    size_t ShipCount() const { return _slots.size(); }
+    const std::vector<std::string>& Files() const { return _fileNames; }
+    // count ships cycling through the loaded ships in load order, one of each if count is 0
+    std::vector<std::unique_ptr<ShipBase>> MakeShips(int count = 0) const;
+
+private:
+    // what a ship type's factory holds: the program it makes ships with, swapped on reload
+    struct Slot {
+        mutable std::mutex lock;
+        std::shared_ptr<const AstroShipProgram> current;
+        std::shared_ptr<const AstroShipProgram> Get() const;
+        void Set(std::shared_ptr<const AstroShipProgram> program);
+    };
+    struct File {
+        std::string path;
+        int64_t size = -1;
+        int64_t mtime = -1;
+    };
+
+    // loads path into programs; false and error if it can't be
+    static bool Read(const std::string& path, std::vector<std::shared_ptr<const AstroShipProgram>>& programs, std::string* error);
+    // installs programs, registering new names; returns how many changed
+    int Install(const std::vector<std::shared_ptr<const AstroShipProgram>>& programs);
+    static void Stamp(File& file);
+
+    std::vector<File> _files;
+    std::vector<std::string> _fileNames;
+    std::vector<std::shared_ptr<Slot>> _slots; // load order
+    std::unordered_map<std::string, size_t> _slotIndex; // ship name -> _slots index
+};
@@ -0,0 +1,490 @@
+#include "AstroShips.h"
+#include "AstroStaticShip.h"
+
+// ===== VM implementation =====
+
+// computed-goto dispatch where the compiler supports labels-as-values, switch otherwise
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(ASTRO_VM_NO_THREADED)
+#define ASTRO_VM_THREADED 1
+#else
+#define ASTRO_VM_THREADED 0
+#endif
+
+void ShipBase::Compile(bool optimize, bool findNative) {
+    program.clear();
+    verifyError.clear();
+    native = nullptr;
+    if (!AstroVerifyBytecode(code, &verifyError)) {
+        program.push_back({ ASTRO_OP_END, 0, 0.0f, -1 });
+        return;
+    }
+    const int n = (int)code.size();
+    // pass 1: find instruction starts and every offset a jump lands on
+    std::vector<bool> isStart(n + 1, false), isTarget(n + 1, false);
+    for (int pc = 0; pc < n; pc += 1 + AstroOperandCount(code[pc])) {
+        isStart[pc] = true;
+        int op = code[pc];
+        if ((op == ASTRO_OP_JUMP || op == ASTRO_OP_JUMP_IF_FALSE) && pc + 1 < n) {
+            int tgt = code[pc + 1];
+            if (tgt >= 0 && tgt <= n) isTarget[tgt] = true;
+        }
+    }
+    isStart[n] = true;
+
+    // pass 2: emit decoded instructions, remembering where each code offset went
+    std::vector<int> indexOf(n + 1, -1);
+    std::vector<int> rawTarget; // code offset each instruction jumps to (-1 = none)
+    int pc = 0;
+    while (pc < n) {
+        int op = code[pc];
+        int operands = AstroOperandCount(op);
+        indexOf[pc] = (int)program.size();
+        if (op < 0 || op >= ASTRO_OP_COUNT || (operands && pc + operands >= n)) {
+            break; // unknown opcode or truncated operand: stop like the reference VM
+        }
+        int param = operands ? code[pc + 1] : 0;
+        AstroInstr in{ op, param, 0.0f, -1 };
+        int jumpTo = -1;
+        switch (op) {
+            case ASTRO_OP_THRUST: in.fparam = param / 10.0f; break;
+            case ASTRO_OP_IF_SCAN_LE:
+            case ASTRO_OP_IF_FUEL_LE:
+            case ASTRO_OP_IF_SIGNAL_LE: in.fparam = (float)param; break;
+            case ASTRO_OP_JUMP:
+            case ASTRO_OP_JUMP_IF_FALSE: jumpTo = param; break;
+            default: break;
+        }
+        pc += 1 + operands;
+        // fuse "cond; JUMP_IF_FALSE t" unless something jumps straight to the JUMP_IF_FALSE
+        if (AstroIsCondition(op) && pc + 1 < n && code[pc] == ASTRO_OP_JUMP_IF_FALSE && !isTarget[pc]) {
+            jumpTo = code[pc + 1];
+            pc += 2;
+        }
+        program.push_back(in);
+        rawTarget.push_back(jumpTo);
+    }
+    // trailing END so jumps to the end of the program (and falling off it) stop cleanly
+    indexOf[n] = (int)program.size();
+    program.push_back({ ASTRO_OP_END, 0, 0.0f, -1 });
+    rawTarget.push_back(-1);
+
+    // pass 3: resolve code offsets to instruction indices
+    for (size_t i = 0; i < program.size(); ++i) {
+        int tgt = rawTarget[i];
+        if (tgt < 0) continue;
+        int idx = (tgt <= n && isStart[tgt]) ? indexOf[tgt] : -1;
+        program[i].target = (idx >= 0) ? idx : (int)program.size() - 1;
+    }
+
+    if (optimize) AstroOptimizeProgram(program);
+    if (findNative) native = AstroFindNative(program);
+}
+
+void ShipBase::Run(int turn) {
+    if (program.empty()) {
+        RunBytecode(turn);
+        return;
+    }
+    // two instantiations so the uncounted one carries no trace of the counters; the
+    // native form has none at all
+    if (A->countVm) RunProgram<true>(&A->vmCounters[id]);
+    else if (native && A->nativePrograms) native(A, id);
+    else RunProgram<false>(nullptr);
+}
+
+template <bool Count> void ShipBase::RunProgram(AstroVmCounters* counters) {
+    AstroArena::ShipState& s = A->ships[id];
+    const AstroInstr* const base = program.data();
+    const AstroInstr* ip = base;
+    bool flag = false;
+    #define VM_COUNT(stat) do { if constexpr (Count) counters->stat; } while (0)
+
+#if ASTRO_VM_THREADED
+    static void* const dispatch[] = {
+        &&L_ASTRO_OP_WAIT, &&L_ASTRO_OP_THRUST, &&L_ASTRO_OP_TURN_DEG, &&L_ASTRO_OP_FIRE_PHASER,
+        &&L_ASTRO_OP_FIRE_PHOTON, &&L_ASTRO_OP_SCAN, &&L_ASTRO_OP_SIGNAL, &&L_ASTRO_OP_TURN_TO_SCAN,
+        &&L_ASTRO_OP_SCAN_SHIPS, &&L_ASTRO_OP_SCAN_ASTEROIDS, &&L_ASTRO_OP_SCAN_TORPEDOES,
+        &&L_ASTRO_OP_IF_SEEN, &&L_ASTRO_OP_IF_SCAN_LE, &&L_ASTRO_OP_IF_DAMAGED, &&L_ASTRO_OP_IF_HP_LE,
+        &&L_ASTRO_OP_IF_FUEL_LE, &&L_ASTRO_OP_IF_CAN_FIRE_PHASER, &&L_ASTRO_OP_IF_CAN_FIRE_PHOTON,
+        &&L_ASTRO_OP_JUMP, &&L_ASTRO_OP_JUMP_IF_FALSE, &&L_ASTRO_OP_END,
+        &&L_ASTRO_OP_TURN_TO_SIGNAL, &&L_ASTRO_OP_IF_SIGNAL_LE, &&L_ASTRO_OP_IF_SIGNAL_IS
+    };
+    static_assert(sizeof(dispatch) / sizeof(dispatch[0]) == ASTRO_OP_COUNT, "dispatch table out of sync with AstroOpCode");
+    #define VM_OP(op) L_##op:
+    #define VM_GOTO(next) do { ip = (next); VM_COUNT(instructions++); goto *dispatch[ip->op]; } while (0)
+    VM_COUNT(turns++);
+    VM_GOTO(ip);
+#else
+    #define VM_OP(op) case op:
+    #define VM_GOTO(next) do { ip = (next); VM_COUNT(instructions++); goto vm_dispatch; } while (0)
+    VM_COUNT(turns++);
+    VM_COUNT(instructions++);
+vm_dispatch:
+    switch (ip->op) {
+#endif
+    #define VM_NEXT() VM_GOTO(ip + 1)
+    #define VM_BRANCH() do { \
+            if (flag || ip->target < 0) VM_NEXT(); \
+            VM_COUNT(branchesTaken++); \
+            VM_GOTO(base + ip->target); \
+        } while (0)
+
+    VM_OP(ASTRO_OP_WAIT)
+        VM_NEXT();
+    VM_OP(ASTRO_OP_THRUST)
+        VM_COUNT(arenaCalls++);
+        A->Thrust(id, ip->fparam);
+        VM_NEXT();
+    VM_OP(ASTRO_OP_TURN_DEG)
+        VM_COUNT(arenaCalls++);
+        A->TurnDeg(id, ip->param);
+        VM_NEXT();
+    VM_OP(ASTRO_OP_FIRE_PHASER)
+        VM_COUNT(arenaCalls++);
+        if (s.phaser_cooldown == 0) VM_COUNT(raycasts++);
+        A->FirePhaser(id);
+        VM_NEXT();
+    VM_OP(ASTRO_OP_FIRE_PHOTON)
+        VM_COUNT(arenaCalls++);
+        A->FirePhoton(id);
+        VM_NEXT();
+    VM_OP(ASTRO_OP_SCAN)
+        // the optimizer marks scans that follow another scan on every path: if nothing
+        // Scan() looks at has changed since, the previous result is still exact
+        if (ip->param != ASTRO_SCAN_REUSE || s.scanEpoch != A->worldEpoch) {
+            VM_COUNT(arenaCalls++);
+            if (A->Scan(id)) VM_COUNT(scans++);
+            else VM_COUNT(scansReused++);
+        } else {
+            VM_COUNT(scansReused++);
+        }
+        VM_NEXT();
+    VM_OP(ASTRO_OP_SIGNAL)
+        VM_COUNT(arenaCalls++);
+        A->Signal(id, ip->param);
+        VM_NEXT();
+    VM_OP(ASTRO_OP_TURN_TO_SCAN)
+        VM_COUNT(arenaCalls++);
+        A->TurnToScan(id);
+        VM_NEXT();
+    VM_OP(ASTRO_OP_SCAN_SHIPS)
+    VM_OP(ASTRO_OP_SCAN_ASTEROIDS)
+    VM_OP(ASTRO_OP_SCAN_TORPEDOES)
+        VM_COUNT(arenaCalls++);
+        if (A->Scan(id, AstroScanFilterOf(ip->op))) VM_COUNT(scans++);
+        else VM_COUNT(scansReused++);
+        VM_NEXT();
+    VM_OP(ASTRO_OP_IF_SEEN)
+        flag = s.scan_hit;
+        VM_BRANCH();
+    VM_OP(ASTRO_OP_IF_SCAN_LE)
+        flag = (s.scan_hit && s.ScanDist() <= ip->fparam);
+        VM_BRANCH();
+    VM_OP(ASTRO_OP_IF_DAMAGED)
+        flag = (s.hp < ASTRO_START_HP);
+        VM_BRANCH();
+    VM_OP(ASTRO_OP_IF_HP_LE)
+        flag = (s.hp <= ip->param);
+        VM_BRANCH();
+    VM_OP(ASTRO_OP_IF_FUEL_LE)
+        flag = (s.fuel <= ip->fparam);
+        VM_BRANCH();
+    VM_OP(ASTRO_OP_IF_CAN_FIRE_PHASER)
+        flag = (s.phaser_cooldown == 0);
+        VM_BRANCH();
+    VM_OP(ASTRO_OP_IF_CAN_FIRE_PHOTON)
+        flag = (s.photon_cooldown == 0);
+        VM_BRANCH();
+    VM_OP(ASTRO_OP_TURN_TO_SIGNAL)
+        VM_COUNT(arenaCalls++);
+        A->TurnToSignal(id);
+        VM_NEXT();
+    VM_OP(ASTRO_OP_IF_SIGNAL_LE)
+        flag = A->HeardWithin(id, ip->fparam);
+        VM_BRANCH();
+    VM_OP(ASTRO_OP_IF_SIGNAL_IS)
+        flag = A->HeardValue(id, ip->param);
+        VM_BRANCH();
+    VM_OP(ASTRO_OP_JUMP_IF_FALSE)
+        if (flag) VM_NEXT();
+        VM_COUNT(branchesTaken++);
+        VM_GOTO(base + ip->target);
+    VM_OP(ASTRO_OP_JUMP)
+        VM_COUNT(branchesTaken++);
+        VM_GOTO(base + ip->target);
+    VM_OP(ASTRO_OP_END)
+        return;
+#if !ASTRO_VM_THREADED
+    default:
+        return;
+    }
+#endif
+    #undef VM_COUNT
+    #undef VM_OP
+    #undef VM_GOTO
+    #undef VM_NEXT
+    #undef VM_BRANCH
+}
+
+void ShipBase::RunBytecode(int turn) {
+    int pc = 0;
+    bool flag = false;
+    while (pc < (int)code.size()) {
+        int op = code[pc++];
+        switch(op) {
+            case ASTRO_OP_WAIT:
+                break;
+            case ASTRO_OP_THRUST: {
+                int powerInt = code[pc++];
+                float power = powerInt / 10.0f;
+                A->Thrust(id, power);
+                break;
+            }
+            case ASTRO_OP_TURN_DEG: {
+                int degrees = code[pc++];
+                A->TurnDeg(id, degrees);
+                break;
+            }
+            case ASTRO_OP_FIRE_PHASER:
+                A->FirePhaser(id);
+                break;
+            case ASTRO_OP_FIRE_PHOTON:
+                A->FirePhoton(id);
+                break;
+            case ASTRO_OP_SCAN:
+                A->Scan(id);
+                break;
+            case ASTRO_OP_SIGNAL: {
+                int value = code[pc++];
+                A->Signal(id, value);
+                break;
+            }
+            case ASTRO_OP_TURN_TO_SCAN:
+                A->TurnToScan(id);
+                break;
+            case ASTRO_OP_SCAN_SHIPS:
+            case ASTRO_OP_SCAN_ASTEROIDS:
+            case ASTRO_OP_SCAN_TORPEDOES:
+                A->Scan(id, AstroScanFilterOf(op));
+                break;
+            case ASTRO_OP_IF_SEEN:
+                pc++; // skip param
+                flag = A->ships[id].scan_hit;
+                break;
+            case ASTRO_OP_IF_SCAN_LE: {
+                int range = code[pc++];
+                flag = (A->ships[id].scan_hit && A->ships[id].ScanDist() <= range);
+                break;
+            }
+            case ASTRO_OP_IF_DAMAGED:
+                pc++; // skip param
+                flag = (A->ships[id].hp < ASTRO_START_HP);
+                break;
+            case ASTRO_OP_IF_HP_LE: {
+                int hp = code[pc++];
+                flag = (A->ships[id].hp <= hp);
+                break;
+            }
+            case ASTRO_OP_IF_FUEL_LE: {
+                int fuel = code[pc++];
+                flag = (A->ships[id].fuel <= fuel);
+                break;
+            }
+            case ASTRO_OP_IF_CAN_FIRE_PHASER:
+                pc++; // skip param
+                flag = (A->ships[id].phaser_cooldown == 0);
+                break;
+            case ASTRO_OP_IF_CAN_FIRE_PHOTON:
+                pc++; // skip param
+                flag = (A->ships[id].photon_cooldown == 0);
+                break;
+            case ASTRO_OP_TURN_TO_SIGNAL:
+                A->TurnToSignal(id);
+                break;
+            case ASTRO_OP_IF_SIGNAL_LE: {
+                int range = code[pc++];
+                flag = A->HeardWithin(id, (float)range);
+                break;
+            }
+            case ASTRO_OP_IF_SIGNAL_IS: {
+                int value = code[pc++];
+                flag = A->HeardValue(id, value);
+                break;
+            }
+            case ASTRO_OP_JUMP_IF_FALSE: {
+                int target = code[pc++];
+                if (!flag) pc = target;
+                break;
+            }
+            case ASTRO_OP_JUMP: { 
+                int tgt=code[pc++]; 
+                pc=tgt; break; 
+            }
+            case ASTRO_OP_END:
+                return;
+            default:
+                return;
+        }
+    }
+}
+
+// ===== Sample ship implementations =====
+int HunterShip::SetupShip() {
+    SCAN();
+    IF_SEEN() {
+        // Always turn toward and pursue what we see
+        TURN_TO_SCAN();
+        IF_SCAN_LE(500) {  // within phaser range: shoot
+            IF_SHIP_CAN_FIRE_PHASER() {
+                FIRE_PHASER();
+            }
+            IF_SHIP_CAN_FIRE_PHOTON() {
+                FIRE_PHOTON();
+            }
+        }
+        THRUST(2);  // close distance if not in range
+    } ELSE() {
+        THRUST(4);
+    }
+    IF_SHIP_FUEL_LE(40) {
+        SCAN_ASTEROIDS();  // hits refuel, and rocks don't shoot back
+        IF_SCAN_LE(300) {  // Increased from 100 - look for fuel further away
+            TURN_TO_SCAN();
+            THRUST(2);
+        }
+    }
+    return Finalize();
+}
+
+// Drone is built at compile time (AstroStaticShip.h), the same program Graeme builds with the macros
+static constexpr auto kDroneProgram = AstroMakeStaticProgram<[](AstroProgramBuilder& b) {
+    b.Scan();
+    b.IfSeen();
+        b.IfScanLe(450);  // Increased from 400 - be more cautious
+            // Thrust away from threat
+            b.Thrust(3);
+            b.IfCanFirePhoton();
+                b.FirePhoton();  // Fire while retreating
+            b.End();
+        b.End();
+    b.End();
+    b.IfHpLe(6);  // Emergency threshold
+        b.Thrust(2);
+    b.End();
+    b.IfFuelLe(35);
+        b.Scan();
+        b.IfScanLe(200);  // Increased from 100
+            b.TurnToScan();
+            b.Thrust(2);
+        b.End();
+    b.End();
+}>();
+
+int DroneShip::SetupShip() {
+    return AstroSetupStaticProgram<kDroneProgram>(*this);
+}
+
+int MinerShip::SetupShip() {
+    // Move toward asteroids and fire when close
+    SCAN_ASTEROIDS();
+    IF_SEEN() {
+        TURN_TO_SCAN();
+        THRUST(2);
+        IF_SCAN_LE(150) {  // close range work
+            IF_SHIP_CAN_FIRE_PHASER() {
+                FIRE_PHASER();
+            }
+        }
+    }
+    IF_SHIP_DAMAGED() {
+        SCAN_SHIPS();
+        IF_SEEN() {
+            IF_SCAN_LE(350) {  // Increased from 200 - flee earlier
+                THRUST(3);
+            }
+        }
+    }
+    return Finalize();
+}
+
+int GraemeShip::SetupShip() {
+    SCAN();
+    IF_SEEN() {
+        IF_SCAN_LE(450) {  // Increased from 400 - be more cautious
+            // Thrust away from threat
+            THRUST(3);
+            IF_SHIP_CAN_FIRE_PHOTON() {
+                FIRE_PHOTON();  // Fire while retreating
+            }
+        }
+    }
+    IF_SHIP_HP_LE(6) {  // Emergency threshold
+        THRUST(2);
+    }
+    IF_SHIP_FUEL_LE(35) {
+        SCAN();
+        IF_SCAN_LE(200) {  // Increased from 100
+            TURN_TO_SCAN();
+            THRUST(2);
+        }
+    }
+    return Finalize();
+}
+
+int MandeezShip::SetupShip() {
+    SCAN();
+    IF_SEEN() {
+        // Always turn toward and pursue what we see
+        TURN_TO_SCAN();
+        IF_SCAN_LE(450) {  // within phaser range: shoot
+            IF_SHIP_CAN_FIRE_PHASER() {
+                FIRE_PHASER();
+            }
+            IF_SHIP_CAN_FIRE_PHOTON() {
+                FIRE_PHOTON();
+            }
+        }
+        THRUST(2);  // close distance if not in range
+    } ELSE() {
+        THRUST(4);
+    }
+    IF_SHIP_FUEL_LE(40) {
+        SCAN();
+        IF_SCAN_LE(200) {  // Increased from 100 - look for fuel further away
+            TURN_TO_SCAN();
+            THRUST(2);
+        }
+    }
+    return Finalize();
+}
+
+std::vector<std::unique_ptr<ShipBase>> MakeDefaultShips(int count) {
+    std::vector<std::unique_ptr<ShipBase>> v;
+    const int n = count > 0 ? count : 5;
+    v.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        switch (i % 5) {
+            case 0: v.emplace_back(std::make_unique<HunterShip>()); break;
+            case 1: v.emplace_back(std::make_unique<DroneShip>()); break;
+            case 2: v.emplace_back(std::make_unique<MinerShip>()); break;
+            case 3: v.emplace_back(std::make_unique<GraemeShip>()); break;
+            default: v.emplace_back(std::make_unique<MandeezShip>()); break;
+        }
+    }
+    return v;
+}
+
+std::vector<ShipType>& ShipTypes() {
+    static std::vector<ShipType> types = {
+        { "Hunter",  []() -> std::unique_ptr<ShipBase> { return std::make_unique<HunterShip>(); } },
+        { "Drone",   []() -> std::unique_ptr<ShipBase> { return std::make_unique<DroneShip>(); } },
+        { "Miner",   []() -> std::unique_ptr<ShipBase> { return std::make_unique<MinerShip>(); } },
+        { "Graeme",  []() -> std::unique_ptr<ShipBase> { return std::make_unique<GraemeShip>(); } },
+        { "Mandeez", []() -> std::unique_ptr<ShipBase> { return std::make_unique<MandeezShip>(); } },
+    };
+    return types;
+}
+
+void RegisterShipType(const std::string& name, ShipFactory make) {
+    ShipTypes().push_back({ name, std::move(make) });
+}
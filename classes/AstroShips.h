@@ -0,0 +1,154 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AstroTypes.h"
+#include "AstroArena.h"
+#include "AstroBytecode.h"
+#include "AstroNative.h"
+
+// ===== ShipBase: tiny VM with space combat Domain-Specific Language =====
+struct ShipBase {
+    std::vector<int> code;
+    std::vector<AstroInstr> program; // decoded form of code, what Run() executes
+    AstroNativeFn native = nullptr;  // program compiled ahead of time, if the build has it (AstroNative.h)
+    std::string verifyError;         // why code was rejected by the verifier, empty if it passed
+    std::vector<float> floatParams; // for storing float parameters like thrust power
+    int script_cost = 0;
+    std::string name = "Ship";
+    struct IfContext { int jumpIfFalseIndex=-1; int jumpToEndIndex=-1; };
+    std::vector<IfContext> _ifCtx;
+
+   struct IfBlock {
+        ShipBase* self; IfBlock(ShipBase* s, AstroOpCode cond, int param): self(s){
+            self->code.push_back(cond); self->code.push_back(param);
+            self->code.push_back(ASTRO_OP_JUMP_IF_FALSE); self->code.push_back(0); // placeholder
+            ShipBase::IfContext ctx; ctx.jumpIfFalseIndex = (int)self->code.size()-1; ctx.jumpToEndIndex = -1;
+            self->_ifCtx.push_back(ctx);
+        }
+        ~IfBlock(){
+            if (!self->_ifCtx.empty()){
+                ShipBase::IfContext &ctx = self->_ifCtx.back();
+                // If no ELSE() was emitted, patch false-jump to end of IF block
+                if (ctx.jumpToEndIndex == -1){
+                    self->code[ctx.jumpIfFalseIndex] = (int)self->code.size();
+                }
+                self->_ifCtx.pop_back();
+            }
+        }
+        explicit operator bool() const { return true; }
+    };
+    struct ElseBlock {
+        ShipBase* self;
+        ElseBlock(ShipBase* s): self(s){
+            // Begin ELSE: jump over else body, patch IF's false to here
+            self->code.push_back(ASTRO_OP_JUMP); self->code.push_back(0); // placeholder to end of else
+            int jumpToEndIdx = (int)self->code.size()-1;
+            if (!self->_ifCtx.empty()){
+                ShipBase::IfContext &ctx = self->_ifCtx.back();
+                self->code[ctx.jumpIfFalseIndex] = (int)self->code.size(); // start of ELSE
+                ctx.jumpToEndIndex = jumpToEndIdx;
+            }
+        }
+        ~ElseBlock(){
+            if (!self->_ifCtx.empty()){
+                ShipBase::IfContext &ctx = self->_ifCtx.back();
+                if (ctx.jumpToEndIndex != -1){
+                    self->code[ctx.jumpToEndIndex] = (int)self->code.size(); // end of ELSE
+                }
+            }
+        }
+        explicit operator bool() const { return true; }
+    };
+
+    // DSL: bot coders will use these in SetupShip()
+    #define THRUST(P)    do{ code.push_back(ASTRO_OP_THRUST); code.push_back((int)((P)*10)); script_cost += ASTRO_COST_THRUST; }while(0)
+    #define TURN_DEG(D)  do{ code.push_back(ASTRO_OP_TURN_DEG); code.push_back((D)); script_cost += ASTRO_COST_TURN; }while(0)
+    #define FIRE_PHASER() do{ code.push_back(ASTRO_OP_FIRE_PHASER); script_cost += ASTRO_COST_PHASER; }while(0)
+    #define FIRE_PHOTON() do{ code.push_back(ASTRO_OP_FIRE_PHOTON); script_cost += ASTRO_COST_PHOTON; }while(0)
+    #define SCAN()       do{ code.push_back(ASTRO_OP_SCAN); script_cost += ASTRO_COST_SCAN; }while(0)
+    #define SIGNAL(V)    do{ code.push_back(ASTRO_OP_SIGNAL); code.push_back((V)); script_cost += ASTRO_COST_SIGNAL; }while(0)
+    #define WAIT_()      do{ code.push_back(ASTRO_OP_WAIT); script_cost += ASTRO_COST_WAIT; }while(0)
+    #define TURN_TO_SCAN() do{ code.push_back(ASTRO_OP_TURN_TO_SCAN); script_cost += ASTRO_COST_TURN; }while(0)
+    // SCAN() narrowed to one kind of object (AstroScanFilter); IF_SEEN() and friends test the result the same way
+    #define SCAN_SHIPS()     do{ code.push_back(ASTRO_OP_SCAN_SHIPS); script_cost += ASTRO_COST_SCAN; }while(0)
+    #define SCAN_ASTEROIDS() do{ code.push_back(ASTRO_OP_SCAN_ASTEROIDS); script_cost += ASTRO_COST_SCAN; }while(0)
+    #define SCAN_TORPEDOES() do{ code.push_back(ASTRO_OP_SCAN_TORPEDOES); script_cost += ASTRO_COST_SCAN; }while(0)
+    // listening: the nearest SIGNAL() another ship of the same program sent last turn
+    #define TURN_TO_SIGNAL() do{ code.push_back(ASTRO_OP_TURN_TO_SIGNAL); script_cost += ASTRO_COST_TURN; }while(0)
+
+    #define IF_SEEN()      if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SEEN, 0})
+    #define IF_SCAN_LE(R)  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SCAN_LE, (R)})
+    #define IF_SHIP_DAMAGED()   if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_DAMAGED, 0})
+    #define IF_SHIP_HP_LE(N)    if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_HP_LE, (N)})
+    #define IF_SHIP_FUEL_LE(N)  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_FUEL_LE, (N)})
+    #define IF_SHIP_CAN_FIRE_PHASER()  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_CAN_FIRE_PHASER, 0})
+    #define IF_SHIP_CAN_FIRE_PHOTON()  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_CAN_FIRE_PHOTON, 0})
+    #define IF_SIGNAL_LE(R) if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SIGNAL_LE, (R)})
+    #define IF_SIGNAL_IS(V) if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SIGNAL_IS, (V)})
+    #define ELSE() else if (ElseBlock _cb##__LINE__{this})
+
+    int Finalize() { code.push_back(ASTRO_OP_END); Compile(); return script_cost; }
+    // verify code, then decode it into program (resolved operands, absolute jump targets,
+    // fused branches), optimize and look up its native form; a program that fails
+    // verification just idles
+    void Compile(bool optimize = true, bool findNative = true);
+
+    // hooks provided by Arena at runtime
+    AstroArena* A = nullptr;
+    int id = -1;
+    virtual int SetupShip() = 0; // bot coders will implement this
+    virtual ~ShipBase() = default;
+
+    // interpreter: threaded over program when compiled, RunBytecode() otherwise; adds to
+    // A->vmCounters[id] when A->countVm is set (RunBytecode() is never counted). Calls
+    // native instead when there is one, A->nativePrograms is set and nothing is counted.
+    void Run(int turn);
+    // reference switch interpreter over the raw code words
+    void RunBytecode(int turn);
+
+private:
+    template <bool Count> void RunProgram(AstroVmCounters* counters);
+};
+
+// ===== Sample ships =====
+struct HunterShip : ShipBase {
+    HunterShip() { name = "Hunter"; }
+    int SetupShip() override;
+};
+
+struct DroneShip : ShipBase {
+    DroneShip() { name = "Drone"; }
+    int SetupShip() override;
+};
+
+struct MinerShip : ShipBase {
+    MinerShip() { name = "Miner"; }
+    int SetupShip() override;
+};
+
+struct GraemeShip : ShipBase {
+    GraemeShip() { name = "Graeme"; }
+    int SetupShip() override;
+};
+struct MandeezShip : ShipBase {
+    MandeezShip() { name = "Mandeez"; }
+    int SetupShip() override;
+};
+
+// default roster used by the viewer and the headless runner: one of each sample ship, or
+// count ships cycling through them in that order (AstroArenaConfig::ships)
+std::vector<std::unique_ptr<ShipBase>> MakeDefaultShips(int count = 0);
+
+// ===== Ship type registry (tournaments, ladders) =====
+using ShipFactory = std::function<std::unique_ptr<ShipBase>()>;
+struct ShipType {
+    std::string name;
+    ShipFactory make;
+};
+// the built-in sample ships followed by everything added with RegisterShipType()
+std::vector<ShipType>& ShipTypes();
+void RegisterShipType(const std::string& name, ShipFactory make);
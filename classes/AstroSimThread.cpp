@@ -0,0 +1,137 @@
+#include "AstroSimThread.h"
+#include "AstroClock.h"
+
+void AstroRenderState::CopyFrom(const AstroArena& arena) {
+    turn = arena.turn;
+    over = arena.IsOver();
+    stalemate = arena.Stalemated();
+    ships = arena.ships;
+    asteroids = arena.asteroids;
+    torpedoes.assign(arena.torpedoes.begin(), arena.torpedoes.end());
+    phaserBeams.assign(arena.phaserBeams.begin(), arena.phaserBeams.end());
+    particles = arena.particles;
+    shipDebris = arena.shipDebris;
+    vmCounters = arena.vmCounters;
+    if (arena.profiler) turnProfile = *arena.profiler;
+}
+
+AstroSimThread::~AstroSimThread() {
+    Stop();
+}
+
+void AstroSimThread::Start(AstroArena& arena, StepFn step, DecorateFn decorate) {
+    Stop();
+    _arena = &arena;
+    _step = std::move(step);
+    _decorate = std::move(decorate);
+    _poses.clear();
+    _turnMs = 0.0;
+    Publish();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = false;
+    }
+    _thread = std::thread([this]() { WorkerLoop(); });
+}
+
+void AstroSimThread::Stop() {
+    if (!_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+    // commands that never got their turn still run, in order
+    RunCommands();
+}
+
+void AstroSimThread::Post(std::function<void()> command) {
+    if (!_thread.joinable()) {
+        command();
+        if (_arena) {
+            _poses.clear();
+            Publish();
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _commands.push_back(std::move(command));
+    }
+    _wake.notify_one();
+}
+
+bool AstroSimThread::RunCommands() {
+    std::vector<std::function<void()>> commands;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        commands.swap(_commands);
+    }
+    for (auto& command : commands) command();
+    return !commands.empty();
+}
+
+void AstroSimThread::Publish() {
+    AstroRenderState& state = _states.Back();
+    state.CopyFrom(*_arena);
+    // no pose from before the turn (just started, or a command moved the arena): no interpolation
+    if (_poses.size() == state.ships.size()) {
+        state.prevShips = _poses;
+    } else {
+        state.prevShips.resize(state.ships.size());
+        for (size_t i = 0; i < state.ships.size(); ++i) {
+            state.prevShips[i] = { state.ships[i].x, state.ships[i].y, state.ships[i].angle };
+        }
+    }
+    state.turnMs = _turnMs;
+    state.publishedAt = std::chrono::steady_clock::now();
+    if (_decorate) _decorate(state);
+    _states.Publish();
+}
+
+void AstroSimThread::WorkerLoop() {
+    AstroClock clock;
+    auto last = std::chrono::steady_clock::now();
+    for (;;) {
+        if (RunCommands()) {
+            _poses.clear();
+            Publish();
+        }
+        clock.speed = Speed();
+        auto start = std::chrono::steady_clock::now();
+        double frameMs = std::chrono::duration<double, std::milli>(start - last).count();
+        last = start;
+        int due = _arena->IsOver() ? 0 : clock.Advance(frameMs);
+        int played = 0;
+        while (played < due && !_arena->IsOver()) {
+            _poses.resize(_arena->ships.size());
+            for (size_t i = 0; i < _arena->ships.size(); ++i) {
+                const auto& s = _arena->ships[i];
+                _poses[i] = { s.x, s.y, s.angle };
+            }
+            _arena->renderScale = _renderScale.load(std::memory_order_relaxed);
+            _step();
+            ++played;
+            if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= clock.budgetMs) break;
+        }
+        clock.Dropped(played, due);
+        if (played > 0) {
+            _turnMs = clock.speed > 0 ? clock.stepMs / clock.speed : 0.0;
+            Publish();
+        }
+
+        // sleep until the next turn is due, a command comes in or we're told to stop
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto woken = [this]() { return _stop || !_commands.empty(); };
+        if (_arena->IsOver()) {
+            // nothing to play until a command (a rewind) says otherwise
+            _wake.wait(lock, woken);
+            clock.Reset();
+            last = std::chrono::steady_clock::now();
+        } else if (clock.speed > 0) {
+            _wake.wait_for(lock, std::chrono::duration<double, std::milli>(clock.MsUntilNextStep()), woken);
+        }
+        if (_stop) return;
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AstroTypes.h"
+#include "AstroArena.h"
+#include "AstroProfile.h"
+
+// ===== Render snapshot =====
+// What the viewer draws of one turn, copied out of the arena by the sim worker. The
+// buffers are reused from publish to publish, so steady-state copies don't allocate.
+struct AstroRenderState {
+    struct Pose { float x, y, angle; };
+
+    int turn = 0;
+    bool over = false;
+    bool stalemate = false;             // over with ships alive, AstroArena::Stalemated()
+    std::vector<AstroArena::ShipState> ships;
+    std::vector<Pose> prevShips;        // ships before this turn, for interpolated drawing
+    AsteroidPool asteroids;
+    std::vector<PhotonTorpedo> torpedoes;
+    std::vector<PhaserBeam> phaserBeams;
+    ParticlePool particles;
+    decltype(AstroArena::shipDebris) shipDebris;
+    std::vector<AstroVmCounters> vmCounters;
+    AstroProfiler turnProfile;          // the arena's phase timings so far
+
+    // set by the owner's decorate hook (AstroSimThread::Start)
+    int checkpointTurn = -1;            // -1 = no checkpoint
+    uint32_t replayEvents = 0;
+    size_t replayBytes = 0;
+    std::string stateString;            // Game::stateString() of this turn
+    int spectators = -1;                // broadcast: spectators connected, -1 when not listening
+
+    std::chrono::steady_clock::time_point publishedAt;
+    double turnMs = 0.0;                // wall time per turn at the speed it was played at, 0 = max
+
+    void CopyFrom(const AstroArena& arena);
+};
+
+// ===== Triple buffer =====
+// One writer, one reader, no locks: the writer fills Back() and publishes it, the
+// reader picks up the newest published slot with Front(). Neither ever waits on the
+// other, and the slot the reader holds is never written until it lets go of it by
+// calling Front() again.
+template <typename T> class AstroTripleBuffer {
+public:
+    // writer
+    T& Back() { return _slots[_back]; }
+    void Publish() { _back = _middle.exchange(_back | FRESH, std::memory_order_acq_rel) & INDEX; }
+
+    // reader: the newest published slot (the previous one if nothing new came in)
+    const T& Front() {
+        if (_middle.load(std::memory_order_relaxed) & FRESH) {
+            _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+        }
+        return _slots[_front];
+    }
+
+private:
+    static constexpr int INDEX = 3;
+    static constexpr int FRESH = 4;
+    T _slots[3];
+    int _back = 0;
+    int _front = 1;
+    std::atomic<int> _middle{ 2 };
+};
+
+// ===== Sim worker =====
+// Plays an arena's turns on its own thread at the selected speed (AstroClock pacing)
+// and publishes an AstroRenderState after each batch of turns, so a slow frame doesn't
+// hold up the sim and a slow turn doesn't hold up the frame. While it runs, the arena
+// (and whatever the step and decorate hooks touch) belongs to the worker: everyone
+// else changes it only through Post().
+class AstroSimThread {
+public:
+    using StepFn = std::function<void()>;                        // plays one turn
+    using DecorateFn = std::function<void(AstroRenderState&)>;   // adds the owner's fields
+
+    ~AstroSimThread();
+
+    // Publishes the arena's current state, then starts playing it. step plays one turn
+    // and decorate fills in the owner's extra fields; both run on the worker.
+    void Start(AstroArena& arena, StepFn step, DecorateFn decorate);
+    // waits for the turn in progress, then stops; the arena is the caller's again
+    void Stop();
+    bool Running() const { return _thread.joinable(); }
+
+    // Runs command on the worker before its next turn, then publishes. Runs it right
+    // away on the calling thread when the worker isn't running.
+    void Post(std::function<void()> command);
+
+    // 1 = 30 turns a second, 0 = as many as fit in the budget (AstroClock::speed)
+    void SetSpeed(int speed) { _speed.store(speed, std::memory_order_relaxed); }
+    int Speed() const { return _speed.load(std::memory_order_relaxed); }
+    // forwarded to AstroArena::renderScale before each turn
+    void SetRenderScale(float scale) { _renderScale.store(scale, std::memory_order_relaxed); }
+
+    // reader side: the newest published state; stays valid until the next call
+    const AstroRenderState& Latest() { return _states.Front(); }
+
+private:
+    void WorkerLoop();
+    void Publish();
+    bool RunCommands();
+
+    AstroArena* _arena = nullptr;
+    StepFn _step;
+    DecorateFn _decorate;
+    AstroTripleBuffer<AstroRenderState> _states;
+    std::vector<AstroRenderState::Pose> _poses; // ships before the last turn played
+    double _turnMs = 0.0;
+
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::vector<std::function<void()>> _commands; // guarded by _mutex
+    bool _stop = false;                           // guarded by _mutex
+    std::atomic<int> _speed{ 1 };
+    std::atomic<float> _renderScale{ 1.0f };
+};
@@ -0,0 +1,353 @@
+#include "AstroSimd.h"
+#include "AstroMath.h"
+#include <cstring>
+
+#if !defined(ASTRO_SIMD_SCALAR)
+#if defined(__AVX2__)
+#define ASTRO_SIMD_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ASTRO_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ASTRO_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace {
+
+// ===== Scalar rows (also used for the tail of every batch) =====
+inline void IntegrateRow(float& x, float& y, float vx, float vy, float w, float h) {
+    x = AstroWrapCoord(x + vx, w);
+    y = AstroWrapCoord(y + vy, h);
+}
+
+inline void ParticleRow(float& x, float& y, float& vx, float& vy, int& lifetime, uint8_t& alive,
+                        float drag, bool wrap, float w, float h) {
+    x += vx;
+    y += vy;
+    if (wrap) {
+        x = AstroWrapCoord(x, w);
+        y = AstroWrapCoord(y, h);
+    }
+    vx *= drag;
+    vy *= drag;
+    lifetime--;
+    if (lifetime <= 0) alive = 0;
+}
+
+// AstroArena::UpdatePhysics() for one ship: turn toward target by at most rotSpeed,
+// integrate and wrap, then drag and snap tiny velocities to zero
+inline void ShipRow(float& angle, float target, float& x, float& y, float& vx, float& vy,
+                    float rotSpeed, float drag, float minVelocity, float w, float h) {
+    float diff = target - angle;
+    while (diff < -180.0f) diff += 360.0f;
+    while (diff > 180.0f) diff -= 360.0f;
+    if (std::abs(diff) > rotSpeed) angle += (diff > 0 ? rotSpeed : -rotSpeed);
+    else angle = target;
+    while (angle < 0) angle += 360.0f;
+    while (angle >= 360.0f) angle -= 360.0f;
+    IntegrateRow(x, y, vx, vy, w, h);
+    vx *= drag;
+    vy *= drag;
+    if (std::abs(vx) < minVelocity) vx = 0;
+    if (std::abs(vy) < minVelocity) vy = 0;
+}
+
+// ===== Lane wrappers =====
+// Each provides the same handful of operations so the batch kernels below are written once.
+// Masks are integer vectors with all bits set in selected lanes.
+#if defined(ASTRO_SIMD_AVX2)
+struct Lanes {
+    static constexpr int N = 8;
+    using F = __m256;
+    using I = __m256i;
+    static F Load(const float* p) { return _mm256_loadu_ps(p); }
+    static void Store(float* p, F v) { _mm256_storeu_ps(p, v); }
+    static I LoadI(const int* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static void StoreI(int* p, I v) { _mm256_storeu_si256((__m256i*)p, v); }
+    static F Set(float v) { return _mm256_set1_ps(v); }
+    static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F Neg(F v) { return _mm256_xor_ps(v, _mm256_set1_ps(-0.0f)); }
+    static I Ge(F a, F b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GE_OQ)); }
+    static I Lt(F a, F b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+    static I Gt(F a, F b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+    static F And(I m, F v) { return _mm256_and_ps(_mm256_castsi256_ps(m), v); }
+    static F AndNot(I m, F v) { return _mm256_andnot_ps(_mm256_castsi256_ps(m), v); }
+    static F Select(I m, F a, F b) { return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(m)); }
+    static I AddI(I a, I b) { return _mm256_add_epi32(a, b); }
+    static I AndI(I a, I b) { return _mm256_and_si256(a, b); }
+    static I OrI(I a, I b) { return _mm256_or_si256(a, b); }
+    static bool Any(I m) { return _mm256_movemask_ps(_mm256_castsi256_ps(m)) != 0; }
+    static I GtZeroI(I a) { return _mm256_cmpgt_epi32(a, _mm256_setzero_si256()); }
+    static I AliveMask(const uint8_t* p) {
+        __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p));
+        return _mm256_cmpgt_epi32(v, _mm256_setzero_si256());
+    }
+    static void StoreAlive(uint8_t* p, I m) {
+        int bits = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+        for (int k = 0; k < N; ++k) p[k] = (uint8_t)((bits >> k) & 1);
+    }
+};
+#elif defined(ASTRO_SIMD_SSE2)
+struct Lanes {
+    static constexpr int N = 4;
+    using F = __m128;
+    using I = __m128i;
+    static F Load(const float* p) { return _mm_loadu_ps(p); }
+    static void Store(float* p, F v) { _mm_storeu_ps(p, v); }
+    static I LoadI(const int* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static void StoreI(int* p, I v) { _mm_storeu_si128((__m128i*)p, v); }
+    static F Set(float v) { return _mm_set1_ps(v); }
+    static F Add(F a, F b) { return _mm_add_ps(a, b); }
+    static F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F Neg(F v) { return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+    static I Ge(F a, F b) { return _mm_castps_si128(_mm_cmpge_ps(a, b)); }
+    static I Lt(F a, F b) { return _mm_castps_si128(_mm_cmplt_ps(a, b)); }
+    static I Gt(F a, F b) { return _mm_castps_si128(_mm_cmpgt_ps(a, b)); }
+    static F And(I m, F v) { return _mm_and_ps(_mm_castsi128_ps(m), v); }
+    static F AndNot(I m, F v) { return _mm_andnot_ps(_mm_castsi128_ps(m), v); }
+    static F Select(I m, F a, F b) { return _mm_or_ps(And(m, a), AndNot(m, b)); }
+    static I AddI(I a, I b) { return _mm_add_epi32(a, b); }
+    static I AndI(I a, I b) { return _mm_and_si128(a, b); }
+    static I OrI(I a, I b) { return _mm_or_si128(a, b); }
+    static bool Any(I m) { return _mm_movemask_ps(_mm_castsi128_ps(m)) != 0; }
+    static I GtZeroI(I a) { return _mm_cmpgt_epi32(a, _mm_setzero_si128()); }
+    static I AliveMask(const uint8_t* p) {
+        int32_t bytes;
+        std::memcpy(&bytes, p, sizeof(bytes));
+        __m128i zero = _mm_setzero_si128();
+        __m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+        return _mm_cmpgt_epi32(v, zero);
+    }
+    static void StoreAlive(uint8_t* p, I m) {
+        int bits = _mm_movemask_ps(_mm_castsi128_ps(m));
+        for (int k = 0; k < N; ++k) p[k] = (uint8_t)((bits >> k) & 1);
+    }
+};
+#elif defined(ASTRO_SIMD_NEON)
+struct Lanes {
+    static constexpr int N = 4;
+    using F = float32x4_t;
+    using I = uint32x4_t;
+    static F Load(const float* p) { return vld1q_f32(p); }
+    static void Store(float* p, F v) { vst1q_f32(p, v); }
+    static I LoadI(const int* p) { return vreinterpretq_u32_s32(vld1q_s32(p)); }
+    static void StoreI(int* p, I v) { vst1q_s32(p, vreinterpretq_s32_u32(v)); }
+    static F Set(float v) { return vdupq_n_f32(v); }
+    static F Add(F a, F b) { return vaddq_f32(a, b); }
+    static F Sub(F a, F b) { return vsubq_f32(a, b); }
+    static F Mul(F a, F b) { return vmulq_f32(a, b); }
+    static F Neg(F v) { return vnegq_f32(v); }
+    static I Ge(F a, F b) { return vcgeq_f32(a, b); }
+    static I Lt(F a, F b) { return vcltq_f32(a, b); }
+    static I Gt(F a, F b) { return vcgtq_f32(a, b); }
+    static F And(I m, F v) { return vreinterpretq_f32_u32(vandq_u32(m, vreinterpretq_u32_f32(v))); }
+    static F AndNot(I m, F v) { return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(v), m)); }
+    static F Select(I m, F a, F b) { return vbslq_f32(m, a, b); }
+    static I AddI(I a, I b) { return vaddq_u32(a, b); }
+    static I AndI(I a, I b) { return vandq_u32(a, b); }
+    static I OrI(I a, I b) { return vorrq_u32(a, b); }
+    static bool Any(I m) {
+        uint32x2_t half = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+        return (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) != 0;
+    }
+    static I GtZeroI(I a) { return vcgtq_s32(vreinterpretq_s32_u32(a), vdupq_n_s32(0)); }
+    static I AliveMask(const uint8_t* p) {
+        uint32_t bytes;
+        std::memcpy(&bytes, p, sizeof(bytes));
+        uint8x8_t b8 = vreinterpret_u8_u32(vdup_n_u32(bytes));
+        uint32x4_t v = vmovl_u16(vget_low_u16(vmovl_u8(b8)));
+        return vcgtq_u32(v, vdupq_n_u32(0));
+    }
+    static void StoreAlive(uint8_t* p, I m) {
+        uint32_t lanes[N];
+        vst1q_u32(lanes, m);
+        for (int k = 0; k < N; ++k) p[k] = (uint8_t)(lanes[k] & 1);
+    }
+};
+#endif
+
+#if defined(ASTRO_SIMD_AVX2) || defined(ASTRO_SIMD_SSE2) || defined(ASTRO_SIMD_NEON)
+#define ASTRO_SIMD_LANES 1
+
+// same steps as AstroWrapCoord, minus the fmod fallback: a single step never moves
+// anything by more than one extent
+inline Lanes::F WrapLanes(Lanes::F v, Lanes::F extent) {
+    v = Lanes::Sub(v, Lanes::And(Lanes::Ge(v, extent), extent));
+    v = Lanes::Add(v, Lanes::And(Lanes::Lt(v, Lanes::Set(0.0f)), extent));
+    return Lanes::AndNot(Lanes::Ge(v, extent), v);
+}
+#endif
+
+} // namespace
+
+const char* AstroSimdPath() {
+#if defined(ASTRO_SIMD_AVX2)
+    return "avx2";
+#elif defined(ASTRO_SIMD_SSE2)
+    return "sse2";
+#elif defined(ASTRO_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void AstroIntegrateWrap(float* x, float* y, const float* vx, const float* vy, const uint8_t* alive,
+                        size_t n, float w, float h) {
+    size_t i = 0;
+#if defined(ASTRO_SIMD_LANES)
+    const Lanes::F W = Lanes::Set(w), H = Lanes::Set(h);
+    for (; i + Lanes::N <= n; i += Lanes::N) {
+        Lanes::I live = Lanes::AliveMask(alive + i);
+        Lanes::F px = Lanes::Load(x + i), py = Lanes::Load(y + i);
+        Lanes::F nx = WrapLanes(Lanes::Add(px, Lanes::Load(vx + i)), W);
+        Lanes::F ny = WrapLanes(Lanes::Add(py, Lanes::Load(vy + i)), H);
+        Lanes::Store(x + i, Lanes::Select(live, nx, px));
+        Lanes::Store(y + i, Lanes::Select(live, ny, py));
+    }
+#endif
+    for (; i < n; ++i) {
+        if (alive[i]) IntegrateRow(x[i], y[i], vx[i], vy[i], w, h);
+    }
+}
+
+void AstroMoveShips(float* angle, const float* target, float* x, float* y, float* vx, float* vy,
+                    const uint8_t* alive, size_t n, float rotSpeed, float drag, float minVelocity,
+                    float w, float h) {
+    size_t i = 0;
+#if defined(ASTRO_SIMD_LANES)
+    const Lanes::F W = Lanes::Set(w), H = Lanes::Set(h), D = Lanes::Set(drag);
+    const Lanes::F zero = Lanes::Set(0.0f), full = Lanes::Set(360.0f), half = Lanes::Set(180.0f);
+    const Lanes::F R = Lanes::Set(rotSpeed), negR = Lanes::Set(-rotSpeed);
+    const Lanes::F M = Lanes::Set(minVelocity), negM = Lanes::Set(-minVelocity);
+    for (; i + Lanes::N <= n; i += Lanes::N) {
+        Lanes::I live = Lanes::AliveMask(alive + i);
+        Lanes::F a = Lanes::Load(angle + i), t = Lanes::Load(target + i);
+        // one wrap step per loop in ShipRow is exact only for angles already on [0, 360),
+        // which is all the arena ever stores; anything else takes the scalar rows
+        Lanes::I off = Lanes::OrI(Lanes::OrI(Lanes::Lt(a, zero), Lanes::Ge(a, full)),
+                                  Lanes::OrI(Lanes::Lt(t, zero), Lanes::Ge(t, full)));
+        if (Lanes::Any(Lanes::AndI(live, off))) {
+            for (size_t k = i; k < i + Lanes::N; ++k) {
+                if (alive[k]) ShipRow(angle[k], target[k], x[k], y[k], vx[k], vy[k], rotSpeed, drag, minVelocity, w, h);
+            }
+            continue;
+        }
+        Lanes::F d = Lanes::Sub(t, a);
+        d = Lanes::Add(d, Lanes::And(Lanes::Lt(d, Lanes::Set(-180.0f)), full));
+        d = Lanes::Sub(d, Lanes::And(Lanes::Gt(d, half), full));
+        Lanes::I turning = Lanes::OrI(Lanes::Gt(d, R), Lanes::Lt(d, negR));
+        Lanes::F na = Lanes::Select(turning, Lanes::Add(a, Lanes::Select(Lanes::Gt(d, zero), R, negR)), t);
+        na = Lanes::Add(na, Lanes::And(Lanes::Lt(na, zero), full));
+        na = Lanes::Sub(na, Lanes::And(Lanes::Ge(na, full), full));
+
+        Lanes::F px = Lanes::Load(x + i), py = Lanes::Load(y + i);
+        Lanes::F pvx = Lanes::Load(vx + i), pvy = Lanes::Load(vy + i);
+        Lanes::F nx = WrapLanes(Lanes::Add(px, pvx), W);
+        Lanes::F ny = WrapLanes(Lanes::Add(py, pvy), H);
+        Lanes::F nvx = Lanes::Mul(pvx, D), nvy = Lanes::Mul(pvy, D);
+        nvx = Lanes::AndNot(Lanes::AndI(Lanes::Lt(nvx, M), Lanes::Gt(nvx, negM)), nvx);
+        nvy = Lanes::AndNot(Lanes::AndI(Lanes::Lt(nvy, M), Lanes::Gt(nvy, negM)), nvy);
+
+        Lanes::Store(angle + i, Lanes::Select(live, na, a));
+        Lanes::Store(x + i, Lanes::Select(live, nx, px));
+        Lanes::Store(y + i, Lanes::Select(live, ny, py));
+        Lanes::Store(vx + i, Lanes::Select(live, nvx, pvx));
+        Lanes::Store(vy + i, Lanes::Select(live, nvy, pvy));
+    }
+#endif
+    for (; i < n; ++i) {
+        if (alive[i]) ShipRow(angle[i], target[i], x[i], y[i], vx[i], vy[i], rotSpeed, drag, minVelocity, w, h);
+    }
+}
+
+void AstroIntegrateParticles(float* x, float* y, float* vx, float* vy, int* lifetime, uint8_t* alive,
+                             size_t n, float drag, bool wrap, float w, float h) {
+    size_t i = 0;
+#if defined(ASTRO_SIMD_LANES)
+    const Lanes::F W = Lanes::Set(w), H = Lanes::Set(h), D = Lanes::Set(drag);
+    for (; i + Lanes::N <= n; i += Lanes::N) {
+        Lanes::I live = Lanes::AliveMask(alive + i);
+        Lanes::F pvx = Lanes::Load(vx + i), pvy = Lanes::Load(vy + i);
+        Lanes::F px = Lanes::Load(x + i), py = Lanes::Load(y + i);
+        Lanes::F nx = Lanes::Add(px, pvx), ny = Lanes::Add(py, pvy);
+        if (wrap) {
+            nx = WrapLanes(nx, W);
+            ny = WrapLanes(ny, H);
+        }
+        Lanes::Store(x + i, Lanes::Select(live, nx, px));
+        Lanes::Store(y + i, Lanes::Select(live, ny, py));
+        Lanes::Store(vx + i, Lanes::Select(live, Lanes::Mul(pvx, D), pvx));
+        Lanes::Store(vy + i, Lanes::Select(live, Lanes::Mul(pvy, D), pvy));
+        // live lanes are all ones, i.e. -1: adding the mask counts lifetime down
+        Lanes::I life = Lanes::AddI(Lanes::LoadI(lifetime + i), live);
+        Lanes::StoreI(lifetime + i, life);
+        Lanes::StoreAlive(alive + i, Lanes::AndI(live, Lanes::GtZeroI(life)));
+    }
+#endif
+    for (; i < n; ++i) {
+        if (alive[i]) ParticleRow(x[i], y[i], vx[i], vy[i], lifetime[i], alive[i], drag, wrap, w, h);
+    }
+}
+
+void AstroTransformPoints(const float* in, float* out, size_t n, float scale, float ox, float oy) {
+    const size_t floats = 2 * n;
+    size_t i = 0;
+#if defined(ASTRO_SIMD_LANES)
+    // lanes alternate x, y (N is even), so the offset does too
+    float offsets[Lanes::N];
+    for (int k = 0; k < Lanes::N; k += 2) {
+        offsets[k] = ox;
+        offsets[k + 1] = oy;
+    }
+    const Lanes::F S = Lanes::Set(scale), O = Lanes::Load(offsets);
+    for (; i + Lanes::N <= floats; i += Lanes::N) {
+        Lanes::Store(out + i, Lanes::Add(Lanes::Mul(Lanes::Load(in + i), S), O));
+    }
+#endif
+    for (; i < floats; i += 2) {
+        out[i] = in[i] * scale + ox;
+        out[i + 1] = in[i + 1] * scale + oy;
+    }
+}
+
+void AstroFastSinCosN(const float* x, float* s, float* c, size_t n) {
+    size_t i = 0;
+#if defined(ASTRO_SIMD_LANES)
+    using namespace AstroTrig;
+    const Lanes::F magic = Lanes::Set(ROUND_MAGIC);
+    const Lanes::F S1v = Lanes::Set(S1), S2v = Lanes::Set(S2), S3v = Lanes::Set(S3);
+    const Lanes::F C1v = Lanes::Set(C1), C2v = Lanes::Set(C2), C3v = Lanes::Set(C3);
+    const Lanes::F one = Lanes::Set(1.0f), half = Lanes::Set(0.5f);
+    const Lanes::F q05 = Lanes::Set(0.5f), q15 = Lanes::Set(1.5f), nq05 = Lanes::Set(-0.5f), nq15 = Lanes::Set(-1.5f);
+    auto round = [&](Lanes::F v) { return Lanes::Sub(Lanes::Add(v, magic), magic); };
+    for (; i + Lanes::N <= n; i += Lanes::N) {
+        // AstroFastSinCos, lane for lane
+        Lanes::F v = Lanes::Load(x + i);
+        Lanes::F k = round(Lanes::Mul(v, Lanes::Set(TWO_OVER_PI)));
+        Lanes::F r = Lanes::Sub(Lanes::Sub(Lanes::Sub(v, Lanes::Mul(k, Lanes::Set(PIO2_1))),
+                                           Lanes::Mul(k, Lanes::Set(PIO2_2))),
+                                Lanes::Mul(k, Lanes::Set(PIO2_3)));
+        Lanes::F r2 = Lanes::Mul(r, r);
+        Lanes::F ps = Lanes::Add(r, Lanes::Mul(Lanes::Mul(r, r2),
+                                               Lanes::Add(S1v, Lanes::Mul(r2, Lanes::Add(S2v, Lanes::Mul(r2, S3v))))));
+        Lanes::F pc = Lanes::Add(Lanes::Sub(one, Lanes::Mul(half, r2)),
+                                 Lanes::Mul(Lanes::Mul(r2, r2),
+                                            Lanes::Add(C1v, Lanes::Mul(r2, Lanes::Add(C2v, Lanes::Mul(r2, C3v))))));
+        Lanes::F q = Lanes::Sub(k, Lanes::Mul(Lanes::Set(4.0f), round(Lanes::Mul(k, Lanes::Set(0.25f)))));
+        Lanes::I swap = Lanes::OrI(Lanes::AndI(Lanes::Gt(q, q05), Lanes::Lt(q, q15)),
+                                   Lanes::AndI(Lanes::Lt(q, nq05), Lanes::Gt(q, nq15)));
+        Lanes::F sn = Lanes::Select(swap, pc, ps);
+        Lanes::F cs = Lanes::Select(swap, ps, pc);
+        Lanes::Store(s + i, Lanes::Select(Lanes::OrI(Lanes::Gt(q, q15), Lanes::Lt(q, nq05)), Lanes::Neg(sn), sn));
+        Lanes::Store(c + i, Lanes::Select(Lanes::OrI(Lanes::Gt(q, q05), Lanes::Lt(q, nq15)), Lanes::Neg(cs), cs));
+    }
+#endif
+    for (; i < n; ++i) AstroFastSinCos(x[i], s[i], c[i]);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// ===== Batched physics kernels =====
+// Integration loops over the SoA pools (AstroBodies columns), 8 lanes at a time with
+// AVX2, 4 with SSE2/NEON, scalar otherwise (or when built with ASTRO_SIMD_SCALAR).
+// Every path does the same IEEE float operations in the same order as the scalar one,
+// so results are bit-identical whichever is compiled in.
+
+// Name of the kernel set compiled in: "avx2", "sse2", "neon" or "scalar".
+const char* AstroSimdPath();
+
+// Wrap one coordinate onto [0, extent). Positions only ever move a few units per turn,
+// so the fmod in the original WrapPosition reduces to one conditional subtract/add;
+// fmod is kept for anything further out than one extent.
+inline float AstroWrapCoord(float v, float extent) {
+    if (v < -extent || v >= 2.0f * extent) v = std::fmod(v, extent);
+    v -= (v >= extent) ? extent : 0.0f;
+    v += (v < 0.0f) ? extent : 0.0f;
+    return (v >= extent) ? 0.0f : v; // -tiny + extent can round up to extent
+}
+
+// x += vx, y += vy, then wrap onto the w x h torus. Rows with alive == 0 are untouched.
+void AstroIntegrateWrap(float* x, float* y, const float* vx, const float* vy, const uint8_t* alive,
+                        size_t n, float w, float h);
+
+// Ship step (the ship loop of AstroArena::UpdatePhysics): turn angle toward target by at
+// most rotSpeed degrees, integrate and wrap, velocity *= drag and zero any component
+// below minVelocity. Rows with alive == 0 are untouched.
+void AstroMoveShips(float* angle, const float* target, float* x, float* y, float* vx, float* vy,
+                    const uint8_t* alive, size_t n, float rotSpeed, float drag, float minVelocity,
+                    float w, float h);
+
+// out = in * scale + (ox, oy) for n interleaved x,y points (ImVec2 arrays): a local
+// polygon onto the screen. in and out may be the same array.
+void AstroTransformPoints(const float* in, float* out, size_t n, float scale, float ox, float oy);
+
+// Particle step: integrate (wrapping if wrap), velocity *= drag, lifetime--, and clear
+// alive once lifetime reaches 0. Rows with alive == 0 are untouched.
+void AstroIntegrateParticles(float* x, float* y, float* vx, float* vy, int* lifetime, uint8_t* alive,
+                             size_t n, float drag, bool wrap, float w, float h);
+
+// AstroFastSinCos (AstroMath.h) of n angles in radians: s[i], c[i] = sin, cos of x[i].
+void AstroFastSinCosN(const float* x, float* s, float* c, size_t n);
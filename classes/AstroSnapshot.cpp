@@ -0,0 +1,246 @@
+#include "AstroArena.h"
+#include "AstroShips.h"
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+
+// ===== Binary snapshots =====
+// Layout (version 9), all fields in host byte order:
+//   magic, version, turn, edgeSpawnCooldown, quietTurns, seed, simultaneous
+//   world width, height, asteroid count, cell size, stalemate turns, fixed point (AstroArenaConfig),
+//   rng state
+//   ship count, name per ship, ShipState[]
+//   asteroid count, x/y/vx/vy/alive/radius/hp/shape id columns
+//   torpedo count, PhotonTorpedo[]
+//   beam count, PhaserBeam[]
+//   signal count, SignalRecord[] (sent this turn, heard the next)
+// Fixed-size records are copied as raw bytes, so snapshots are only portable between
+// builds with the same struct layout; bump the version when one of them changes.
+
+static constexpr uint32_t SNAPSHOT_MAGIC = 0x504E5341; // "ASNP"
+static constexpr uint32_t SNAPSHOT_VERSION = 9; // 2: ShipState::killedBy, 3: simultaneous, 4: arena config, 5: shape ids,
+                                                // 6: scan offsets, 7: stalemates, 8: signal senders and values,
+                                                // 9: fixed point
+
+static_assert(std::is_trivially_copyable_v<AstroArena::ShipState>, "ShipState is snapshotted as raw bytes");
+static_assert(std::is_trivially_copyable_v<PhotonTorpedo>, "PhotonTorpedo is snapshotted as raw bytes");
+static_assert(std::is_trivially_copyable_v<PhaserBeam>, "PhaserBeam is snapshotted as raw bytes");
+static_assert(std::is_trivially_copyable_v<AstroArena::SignalRecord>, "SignalRecord is snapshotted as raw bytes");
+
+namespace {
+
+struct Writer {
+    std::vector<uint8_t>& out;
+    void Bytes(const void* p, size_t n) {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        out.insert(out.end(), b, b + n);
+    }
+    template <typename T> void Pod(const T& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Bytes(&v, sizeof(T));
+    }
+    template <typename T, typename A> void Array(const std::vector<T, A>& v) {
+        Pod((uint32_t)v.size());
+        if (!v.empty()) Bytes(v.data(), v.size() * sizeof(T));
+    }
+    // a column whose length is already known from an earlier count
+    template <typename T, typename A> void Column(const std::vector<T, A>& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (!v.empty()) Bytes(v.data(), v.size() * sizeof(T));
+    }
+};
+
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+    bool Bytes(void* dst, size_t n) {
+        if (!ok || (size_t)(end - p) < n) { ok = false; return false; }
+        std::memcpy(dst, p, n);
+        p += n;
+        return true;
+    }
+    template <typename T> bool Pod(T& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return Bytes(&v, sizeof(T));
+    }
+    template <typename T, typename A> bool Array(std::vector<T, A>& v) {
+        uint32_t n = 0;
+        if (!Pod(n)) return false;
+        return Column(v, n);
+    }
+    template <typename T, typename A> bool Column(std::vector<T, A>& v, size_t n) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (!ok || (size_t)(end - p) / sizeof(T) < n) { ok = false; return false; }
+        v.resize(n);
+        return n == 0 || Bytes(v.data(), n * sizeof(T));
+    }
+};
+
+} // namespace
+
+void AstroArena::SaveSnapshot(std::vector<uint8_t>& out) const {
+    Writer w{ out };
+    w.Pod(SNAPSHOT_MAGIC);
+    w.Pod(SNAPSHOT_VERSION);
+    w.Pod((int32_t)turn);
+    w.Pod((int32_t)edgeSpawnCooldown);
+    w.Pod((int32_t)quietTurns);
+    w.Pod(seed);
+    w.Pod((uint8_t)(simultaneous ? 1 : 0));
+    w.Pod(config.width);
+    w.Pod(config.height);
+    w.Pod((int32_t)config.asteroids);
+    w.Pod((int32_t)config.cellSize);
+    w.Pod((int32_t)config.stalemateTurns);
+    w.Pod((uint8_t)(config.fixedPoint ? 1 : 0));
+    if constexpr (std::is_trivially_copyable_v<std::mt19937>) {
+        w.Pod(rng);
+    } else {
+        std::stringstream ss;
+        ss << rng;
+        std::string s = ss.str();
+        w.Pod((uint32_t)s.size());
+        w.Bytes(s.data(), s.size());
+    }
+
+    w.Pod((uint32_t)ships.size());
+    for (size_t i = 0; i < ships.size(); ++i) {
+        const std::string& name = (i < programs.size() && programs[i]) ? programs[i]->name : std::string();
+        w.Pod((uint32_t)name.size());
+        w.Bytes(name.data(), name.size());
+    }
+    w.Column(ships);
+
+    w.Pod((uint32_t)asteroids.size());
+    w.Column(asteroids.x); w.Column(asteroids.y);
+    w.Column(asteroids.vx); w.Column(asteroids.vy);
+    w.Column(asteroids.alive);
+    w.Column(asteroids.radius); w.Column(asteroids.hp);
+    w.Column(asteroids.shapeId);
+
+    w.Array(torpedoes.Items());
+    w.Array(phaserBeams.Items());
+    w.Array(signals);
+}
+
+bool AstroArena::LoadSnapshot(const uint8_t* data, size_t size, std::string* error) {
+    auto fail = [error](const std::string& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+    Reader r{ data, data + size };
+    uint32_t magic = 0, version = 0;
+    r.Pod(magic);
+    r.Pod(version);
+    if (!r.ok || magic != SNAPSHOT_MAGIC) return fail("not an arena snapshot");
+    if (version != SNAPSHOT_VERSION) return fail("unsupported snapshot version " + std::to_string(version));
+
+    int32_t snapTurn = 0, snapCooldown = 0, snapQuietTurns = 0;
+    uint32_t snapSeed = 0;
+    uint8_t snapSimultaneous = 0;
+    std::mt19937 snapRng;
+    r.Pod(snapTurn);
+    r.Pod(snapCooldown);
+    r.Pod(snapQuietTurns);
+    r.Pod(snapSeed);
+    r.Pod(snapSimultaneous);
+    AstroArenaConfig snapConfig = config;
+    int32_t snapAsteroidCount = 0, snapCellSize = 0, snapStalemateTurns = 0;
+    r.Pod(snapConfig.width);
+    r.Pod(snapConfig.height);
+    r.Pod(snapAsteroidCount);
+    r.Pod(snapCellSize);
+    r.Pod(snapStalemateTurns);
+    uint8_t snapFixedPoint = 0;
+    r.Pod(snapFixedPoint);
+    snapConfig.fixedPoint = snapFixedPoint != 0;
+    snapConfig.asteroids = snapAsteroidCount;
+    snapConfig.cellSize = snapCellSize;
+    snapConfig.stalemateTurns = snapStalemateTurns;
+    // the broadphase and every wrap were set up for this arena's world in Setup()
+    if (r.ok && (!snapConfig.SameRules(config) || !snapConfig.FitsFixedPoint())) {
+        return fail("snapshot is for a " + std::to_string((int)snapConfig.width) + "x" + std::to_string((int)snapConfig.height) +
+                    " arena with " + std::to_string(snapConfig.asteroids) + " asteroids" +
+                    (snapConfig.fixedPoint ? " in fixed point" : ""));
+    }
+    if constexpr (std::is_trivially_copyable_v<std::mt19937>) {
+        r.Pod(snapRng);
+    } else {
+        std::string s;
+        uint32_t n = 0;
+        if (r.Pod(n) && (size_t)(r.end - r.p) >= n) {
+            s.assign((const char*)r.p, n);
+            r.p += n;
+            std::stringstream ss(s);
+            ss >> snapRng;
+        } else {
+            r.ok = false;
+        }
+    }
+
+    // the programs driving the ships aren't serialized: the roster must match
+    uint32_t shipCount = 0;
+    if (!r.Pod(shipCount)) return fail("truncated snapshot");
+    if (shipCount != programs.size()) {
+        return fail("snapshot has " + std::to_string(shipCount) + " ships, arena has " + std::to_string(programs.size()));
+    }
+    for (uint32_t i = 0; i < shipCount; ++i) {
+        uint32_t len = 0;
+        std::string name;
+        if (!r.Pod(len) || (size_t)(r.end - r.p) < len) return fail("truncated snapshot");
+        name.assign((const char*)r.p, len);
+        r.p += len;
+        if (name != programs[i]->name) return fail("ship " + std::to_string(i) + " is " + name + " in the snapshot");
+    }
+    std::vector<ShipState> snapShips;
+    r.Column(snapShips, shipCount);
+
+    uint32_t asteroidCount = 0;
+    AsteroidPool snapAsteroids;
+    r.Pod(asteroidCount);
+    r.Column(snapAsteroids.x, asteroidCount); r.Column(snapAsteroids.y, asteroidCount);
+    r.Column(snapAsteroids.vx, asteroidCount); r.Column(snapAsteroids.vy, asteroidCount);
+    r.Column(snapAsteroids.alive, asteroidCount);
+    r.Column(snapAsteroids.radius, asteroidCount); r.Column(snapAsteroids.hp, asteroidCount);
+    r.Column(snapAsteroids.shapeId, asteroidCount);
+
+    decltype(torpedoes)::Storage snapTorpedoes;
+    decltype(phaserBeams)::Storage snapBeams;
+    decltype(signals) snapSignals;
+    r.Array(snapTorpedoes);
+    r.Array(snapBeams);
+    r.Array(snapSignals);
+    if (!r.ok) return fail("truncated snapshot");
+    for (const SignalRecord& sig : snapSignals) {
+        if (sig.ship < 0 || sig.ship >= (int)shipCount) return fail("signal from ship " + std::to_string(sig.ship) + " out of range");
+    }
+    for (uint16_t id : snapAsteroids.shapeId) {
+        if (id >= AsteroidShapeLibrary::Get().size()) return fail("asteroid shape " + std::to_string(id) + " out of range");
+    }
+
+    // everything parsed: commit
+    turn = snapTurn;
+    edgeSpawnCooldown = snapCooldown;
+    quietTurns = snapQuietTurns;
+    seed = snapSeed;
+    simultaneous = snapSimultaneous != 0;
+    rng = snapRng;
+    for (uint32_t i = 0; i < shipCount; ++i) {
+        snapShips[i].ship = programs[i].get();
+        snapShips[i].scanEpoch = 0;
+        snapShips[i].heardTurn = -1;
+    }
+    ships.swap(snapShips);
+    asteroids.Replace(std::move(snapAsteroids));
+    torpedoes.Replace(std::move(snapTorpedoes));
+    phaserBeams.Replace(std::move(snapBeams));
+    signals.swap(snapSignals);
+    heardSignals.clear();
+    pairCache.assign(ships.size() * PAIR_CACHE_WAYS, PairCacheEntry{}); // the turns it kept are another match's
+    // effects aren't part of the snapshot
+    particles.clear();
+    shipDebris.clear();
+    worldEpoch++;
+    return true;
+}
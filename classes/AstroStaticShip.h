@@ -0,0 +1,201 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "AstroTypes.h"
+#include "AstroArena.h"
+#include "AstroShips.h"
+
+// ===== Compile-time ship programs =====
+// The macro DSL in ShipBase builds code at runtime. This one builds the same bytecode in a
+// constant expression, together with the decoded program (conditions fused with their
+// branch, jump targets resolved), and checks it while compiling: blocks closed, and the
+// script cost within ASTRO_MAX_SCRIPT_COST as a static_assert rather than a log line.
+//
+//   static constexpr auto kProgram = AstroMakeStaticProgram<[](AstroProgramBuilder& b) {
+//       b.Scan();
+//       b.IfSeen();
+//           b.TurnToScan();
+//           b.Thrust(2);
+//       b.Else();
+//           b.Thrust(4);
+//       b.End();
+//   }>();
+//   int MyShip::SetupShip() { return AstroSetupStaticProgram<kProgram>(*this); }
+//
+// AstroRunStaticProgram<kProgram> unrolls the program into one function, one template
+// instance per instruction, with every opcode and operand a constant: no dispatch and no
+// instruction array. AstroSetupStaticProgram() installs it as the ship's native code
+// (ShipBase::native), and still fills code and program, so counted runs, the verifier,
+// --interpret and everything else that reads them see an ordinary ship.
+
+struct AstroProgramBuilder {
+    static constexpr int CAPACITY = 256;  // code words
+    static constexpr int MAX_DEPTH = 16;  // nested IF blocks
+
+    std::array<int, CAPACITY> code{};
+    std::array<AstroInstr, CAPACITY> program{};
+    int words = 0;
+    int instrs = 0;
+    int cost = 0;
+    bool ok = true; // false after overflow or an Else()/End() with no open block
+
+    // thresholds are compared as floats, like ShipBase::Compile() decodes them
+    constexpr void Thrust(float power) { Action(ASTRO_OP_THRUST, (int)(power * 10), (int)(power * 10) / 10.0f, ASTRO_COST_THRUST); }
+    constexpr void TurnDeg(int degrees) { Action(ASTRO_OP_TURN_DEG, degrees, 0.0f, ASTRO_COST_TURN); }
+    constexpr void FirePhaser() { Action(ASTRO_OP_FIRE_PHASER, 0, 0.0f, ASTRO_COST_PHASER); }
+    constexpr void FirePhoton() { Action(ASTRO_OP_FIRE_PHOTON, 0, 0.0f, ASTRO_COST_PHOTON); }
+    constexpr void Scan() { Action(ASTRO_OP_SCAN, 0, 0.0f, ASTRO_COST_SCAN); }
+    constexpr void ScanShips() { Action(ASTRO_OP_SCAN_SHIPS, 0, 0.0f, ASTRO_COST_SCAN); }
+    constexpr void ScanAsteroids() { Action(ASTRO_OP_SCAN_ASTEROIDS, 0, 0.0f, ASTRO_COST_SCAN); }
+    constexpr void ScanTorpedoes() { Action(ASTRO_OP_SCAN_TORPEDOES, 0, 0.0f, ASTRO_COST_SCAN); }
+    constexpr void Signal(int value) { Action(ASTRO_OP_SIGNAL, value, 0.0f, ASTRO_COST_SIGNAL); }
+    constexpr void Wait() { Action(ASTRO_OP_WAIT, 0, 0.0f, ASTRO_COST_WAIT); }
+    constexpr void TurnToScan() { Action(ASTRO_OP_TURN_TO_SCAN, 0, 0.0f, ASTRO_COST_TURN); }
+    constexpr void TurnToSignal() { Action(ASTRO_OP_TURN_TO_SIGNAL, 0, 0.0f, ASTRO_COST_TURN); }
+
+    // each opens a block closed by End(), optionally split by Else()
+    constexpr void IfSeen() { If(ASTRO_OP_IF_SEEN, 0, 0.0f); }
+    constexpr void IfScanLe(int range) { If(ASTRO_OP_IF_SCAN_LE, range, (float)range); }
+    constexpr void IfDamaged() { If(ASTRO_OP_IF_DAMAGED, 0, 0.0f); }
+    constexpr void IfHpLe(int hp) { If(ASTRO_OP_IF_HP_LE, hp, 0.0f); }
+    constexpr void IfFuelLe(int fuel) { If(ASTRO_OP_IF_FUEL_LE, fuel, (float)fuel); }
+    constexpr void IfCanFirePhaser() { If(ASTRO_OP_IF_CAN_FIRE_PHASER, 0, 0.0f); }
+    constexpr void IfCanFirePhoton() { If(ASTRO_OP_IF_CAN_FIRE_PHOTON, 0, 0.0f); }
+    constexpr void IfSignalLe(int range) { If(ASTRO_OP_IF_SIGNAL_LE, range, (float)range); }
+    constexpr void IfSignalIs(int value) { If(ASTRO_OP_IF_SIGNAL_IS, value, 0.0f); }
+
+    constexpr void Else() {
+        if (depth == 0 || blocks[depth - 1].elseWord >= 0) { ok = false; return; }
+        Block& b = blocks[depth - 1];
+        b.elseWord = words + 1;
+        b.elseInstr = instrs;
+        Emit(ASTRO_OP_JUMP, 0, 0.0f, 2, 0);
+        code[b.condWord] = words;        // the JUMP_IF_FALSE lands on the ELSE body
+        program[b.condInstr].target = instrs;
+    }
+    constexpr void End() {
+        if (depth == 0) { ok = false; return; }
+        Block& b = blocks[--depth];
+        if (b.elseWord >= 0) {
+            code[b.elseWord] = words;
+            program[b.elseInstr].target = instrs;
+        } else {
+            code[b.condWord] = words;
+            program[b.condInstr].target = instrs;
+        }
+    }
+    // closes the program like ShipBase::Finalize(); AstroMakeStaticProgram() calls it
+    constexpr void Finish() {
+        if (depth != 0) ok = false;
+        Emit(ASTRO_OP_END, 0, 0.0f, 1, 0);
+    }
+
+private:
+    struct Block {
+        int condWord = 0, condInstr = 0;   // JUMP_IF_FALSE operand, fused condition
+        int elseWord = -1, elseInstr = -1; // JUMP over the ELSE body, -1 until Else()
+    };
+    std::array<Block, MAX_DEPTH> blocks{};
+    int depth = 0;
+
+    constexpr void Emit(int op, int param, float fparam, int nwords, int addCost) {
+        if (words + nwords > CAPACITY) { ok = false; return; }
+        code[words] = op;
+        if (nwords > 1) code[words + 1] = param;
+        words += nwords;
+        program[instrs++] = { op, param, fparam, -1 };
+        cost += addCost;
+    }
+    constexpr void Action(int op, int param, float fparam, int addCost) {
+        Emit(op, param, fparam, 1 + AstroOperandCount(op), addCost);
+    }
+    constexpr void If(int op, int param, float fparam) {
+        if (depth == MAX_DEPTH || words + 4 > CAPACITY) { ok = false; return; }
+        Block& b = blocks[depth++];
+        b = Block{};
+        b.condInstr = instrs;
+        Emit(op, param, fparam, 2, 0);
+        code[words] = ASTRO_OP_JUMP_IF_FALSE;
+        b.condWord = words + 1;
+        words += 2;
+    }
+};
+
+// bytecode and decoded program of exactly the size the builder produced
+template <size_t Words, size_t Instrs>
+struct AstroStaticProgram {
+    std::array<int, Words> code;
+    std::array<AstroInstr, Instrs> program;
+    int cost;
+};
+
+template <auto Build>
+consteval auto AstroMakeStaticProgram() {
+    constexpr AstroProgramBuilder built = [] {
+        AstroProgramBuilder b;
+        Build(b);
+        b.Finish();
+        return b;
+    }();
+    static_assert(built.ok, "ship program overflows AstroProgramBuilder or has an unmatched Else()/End()");
+    static_assert(built.cost <= ASTRO_MAX_SCRIPT_COST, "ship program exceeds ASTRO_MAX_SCRIPT_COST");
+    AstroStaticProgram<(size_t)built.words, (size_t)built.instrs> p{};
+    for (int i = 0; i < built.words; ++i) p.code[i] = built.code[i];
+    for (int i = 0; i < built.instrs; ++i) p.program[i] = built.program[i];
+    p.cost = built.cost;
+    return p;
+}
+
+// instruction I of P onwards; every jump is forward, so the instantiations end at END
+template <const auto& P, int I>
+inline void AstroRunStaticFrom(AstroArena* A, int id, AstroArena::ShipState& s) {
+    constexpr AstroInstr in = P.program[I];
+    if constexpr (in.op == ASTRO_OP_END) {
+        return;
+    } else if constexpr (in.op == ASTRO_OP_JUMP) {
+        return AstroRunStaticFrom<P, in.target>(A, id, s);
+    } else if constexpr (AstroIsCondition(in.op)) {
+        bool flag = false;
+        if constexpr (in.op == ASTRO_OP_IF_SEEN) flag = s.scan_hit;
+        else if constexpr (in.op == ASTRO_OP_IF_SCAN_LE) flag = s.scan_hit && s.ScanDist() <= in.fparam;
+        else if constexpr (in.op == ASTRO_OP_IF_DAMAGED) flag = s.hp < ASTRO_START_HP;
+        else if constexpr (in.op == ASTRO_OP_IF_HP_LE) flag = s.hp <= in.param;
+        else if constexpr (in.op == ASTRO_OP_IF_FUEL_LE) flag = s.fuel <= in.fparam;
+        else if constexpr (in.op == ASTRO_OP_IF_CAN_FIRE_PHASER) flag = s.phaser_cooldown == 0;
+        else if constexpr (in.op == ASTRO_OP_IF_SIGNAL_LE) flag = A->HeardWithin(id, in.fparam);
+        else if constexpr (in.op == ASTRO_OP_IF_SIGNAL_IS) flag = A->HeardValue(id, in.param);
+        else flag = s.photon_cooldown == 0;
+        if (!flag) return AstroRunStaticFrom<P, in.target>(A, id, s);
+        return AstroRunStaticFrom<P, I + 1>(A, id, s);
+    } else {
+        if constexpr (in.op == ASTRO_OP_THRUST) A->Thrust(id, in.fparam);
+        else if constexpr (in.op == ASTRO_OP_TURN_DEG) A->TurnDeg(id, in.param);
+        else if constexpr (in.op == ASTRO_OP_FIRE_PHASER) A->FirePhaser(id);
+        else if constexpr (in.op == ASTRO_OP_FIRE_PHOTON) A->FirePhoton(id);
+        else if constexpr (in.op == ASTRO_OP_SCAN) A->Scan(id);
+        else if constexpr (AstroScanFilterOf(in.op) != ASTRO_SCAN_ANY) A->Scan(id, AstroScanFilterOf(in.op));
+        else if constexpr (in.op == ASTRO_OP_SIGNAL) A->Signal(id, in.param);
+        else if constexpr (in.op == ASTRO_OP_TURN_TO_SCAN) A->TurnToScan(id);
+        else if constexpr (in.op == ASTRO_OP_TURN_TO_SIGNAL) A->TurnToSignal(id);
+        return AstroRunStaticFrom<P, I + 1>(A, id, s);
+    }
+}
+
+// one turn of P for ship id, an AstroNativeFn
+template <const auto& P>
+void AstroRunStaticProgram(AstroArena* A, int id) {
+    AstroRunStaticFrom<P, 0>(A, id, A->ships[id]);
+}
+
+// SetupShip() body for a ship running P: fills code/program like Finalize() and installs
+// the unrolled program as its native code
+template <const auto& P>
+int AstroSetupStaticProgram(ShipBase& ship) {
+    ship.code.assign(P.code.begin(), P.code.end());
+    ship.script_cost = P.cost;
+    ship.Compile();
+    if (ship.verifyError.empty()) ship.native = &AstroRunStaticProgram<P>;
+    return ship.script_cost;
+}
@@ -0,0 +1,749 @@
+#include "AstroStream.h"
+#include "AstroShips.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+enum StreamShipBits : uint8_t {
+    SHIP_MOTION = 1, SHIP_ANGLE = 2, SHIP_HP = 4, SHIP_FUEL = 8, SHIP_ALIVE = 16, SHIP_PHASER = 32, SHIP_PHOTON = 64
+};
+enum StreamBodyBits : uint8_t { BODY_MOTION = 1, BODY_HP = 2 };
+constexpr uint8_t FLAG_KEYFRAME = 1;
+constexpr uint32_t MAX_SLOTS = 1u << 20; // more than any match spawns; bounds what a bad frame can allocate
+
+struct Writer {
+    std::vector<uint8_t>& b;
+    void U8(uint8_t v) { b.push_back(v); }
+    void Var(uint32_t v) {
+        while (v >= 0x80) { b.push_back((uint8_t)(v | 0x80)); v >>= 7; }
+        b.push_back((uint8_t)v);
+    }
+    void SVar(int32_t v) { Var(((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); }
+    void F32(float v) {
+        uint32_t u;
+        std::memcpy(&u, &v, 4);
+        for (int i = 0; i < 4; ++i) b.push_back((uint8_t)(u >> (8 * i)));
+    }
+    void Str(const std::string& s) {
+        Var((uint32_t)s.size());
+        b.insert(b.end(), s.begin(), s.end());
+    }
+    // a section: count, then the records already written to body
+    void Section(uint32_t count, const std::vector<uint8_t>& body) {
+        Var(count);
+        b.insert(b.end(), body.begin(), body.end());
+    }
+};
+
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+    uint8_t U8() {
+        if (!ok || p == end) { ok = false; return 0; }
+        return *p++;
+    }
+    uint32_t Var() {
+        uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t c = U8();
+            v |= (uint32_t)(c & 0x7f) << shift;
+            if (!(c & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+    int32_t SVar() {
+        uint32_t v = Var();
+        return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+    }
+    float F32() {
+        uint32_t u = 0;
+        for (int i = 0; i < 4; ++i) u |= (uint32_t)U8() << (8 * i);
+        float v;
+        std::memcpy(&v, &u, 4);
+        return v;
+    }
+    std::string Str() {
+        uint32_t n = Var();
+        if (!ok || (size_t)(end - p) < n) { ok = false; return {}; }
+        std::string s((const char*)p, n);
+        p += n;
+        return s;
+    }
+};
+
+int32_t Quant(float v) { return (int32_t)std::lround(v * (float)ASTRO_STREAM_POS_SCALE); }
+uint16_t QuantAngle(float degrees) { return (uint16_t)(std::lround(degrees * (65536.0f / 360.0f)) & 0xffff); }
+
+// into [0, wrap)
+int32_t Wrap(int64_t q, int32_t wrap) {
+    if (wrap <= 0) return (int32_t)q;
+    int64_t r = q % wrap;
+    return (int32_t)(r < 0 ? r + wrap : r);
+}
+// the shorter way round from b to a
+int32_t WrapDelta(int32_t a, int32_t b, int32_t wrap) {
+    int32_t d = a - b;
+    if (wrap <= 0) return d;
+    d %= wrap;
+    if (d > wrap / 2) d -= wrap;
+    if (d < -wrap / 2) d += wrap;
+    return d;
+}
+
+bool OffBy(int32_t d, int32_t tolerance) { return d > tolerance || d < -tolerance; }
+
+} // namespace
+
+// ===== View =====
+
+size_t AstroStreamView::Count(const std::vector<Body>& bodies) const {
+    size_t n = 0;
+    for (const auto& b : bodies) n += b.present ? 1 : 0;
+    return n;
+}
+
+void AstroStreamView::Clear(float worldWidth, float worldHeight, size_t shipCount) {
+    width = worldWidth;
+    height = worldHeight;
+    wrapX = Quant(worldWidth);
+    wrapY = Quant(worldHeight);
+    ships.assign(shipCount, Ship{});
+    asteroids.clear();
+    torpedoes.clear();
+    beams.clear();
+}
+
+void AstroStreamView::Predict() {
+    for (auto& s : ships) {
+        if (!s.alive) continue;
+        s.x = Wrap((int64_t)s.x + s.vx, wrapX);
+        s.y = Wrap((int64_t)s.y + s.vy, wrapY);
+        // DRAG, truncating: components below a step stop, like MIN_VELOCITY
+        s.vx = (int32_t)((int64_t)s.vx * 49 / 50);
+        s.vy = (int32_t)((int64_t)s.vy * 49 / 50);
+    }
+    for (auto* bodies : { &asteroids, &torpedoes }) {
+        for (auto& b : *bodies) {
+            if (!b.present) continue;
+            b.x = Wrap((int64_t)b.x + b.vx, wrapX);
+            b.y = Wrap((int64_t)b.y + b.vy, wrapY);
+        }
+    }
+}
+
+namespace {
+
+bool ApplyBodies(Reader& r, std::vector<AstroStreamView::Body>& bodies, bool asteroid, int32_t wrapX, int32_t wrapY) {
+    uint32_t destroyed = r.Var();
+    for (uint32_t k = 0; k < destroyed && r.ok; ++k) {
+        uint32_t slot = r.Var();
+        if (slot >= bodies.size() || !bodies[slot].present) return false;
+        bodies[slot] = AstroStreamView::Body{};
+    }
+    uint32_t spawned = r.Var();
+    for (uint32_t k = 0; k < spawned && r.ok; ++k) {
+        uint32_t slot = r.Var();
+        if (slot >= MAX_SLOTS) return false;
+        if (slot >= bodies.size()) bodies.resize(slot + 1);
+        auto& b = bodies[slot];
+        if (b.present) return false;
+        b.present = true;
+        b.x = Wrap(r.Var(), wrapX);
+        b.y = Wrap(r.Var(), wrapY);
+        b.vx = r.SVar();
+        b.vy = r.SVar();
+        if (asteroid) {
+            b.radius = (int32_t)r.Var();
+            b.hp = r.SVar();
+            b.shape = (int32_t)r.Var();
+        } else {
+            b.owner = (int32_t)r.Var() - 1;
+        }
+    }
+    uint32_t corrected = r.Var();
+    for (uint32_t k = 0; k < corrected && r.ok; ++k) {
+        uint32_t slot = r.Var();
+        if (slot >= bodies.size() || !bodies[slot].present) return false;
+        auto& b = bodies[slot];
+        uint8_t mask = r.U8();
+        if (mask & BODY_MOTION) {
+            b.x = Wrap((int64_t)b.x + r.SVar(), wrapX);
+            b.y = Wrap((int64_t)b.y + r.SVar(), wrapY);
+            b.vx += r.SVar();
+            b.vy += r.SVar();
+        }
+        if (mask & BODY_HP) b.hp += r.SVar();
+    }
+    return r.ok;
+}
+
+} // namespace
+
+bool AstroStreamView::Apply(const uint8_t* data, size_t size, bool predict) {
+    Reader r{ data, data + size };
+    int frameTurn = (int)r.Var();
+    uint8_t flags = r.U8();
+    if (!r.ok) return false;
+    if (flags & FLAG_KEYFRAME) {
+        float w = r.F32(), h = r.F32();
+        uint32_t n = r.Var();
+        if (!r.ok || n > 4096 || !(w > 0) || !(h > 0)) return false;
+        Clear(w, h, n);
+        for (auto& s : ships) s.name = r.Str();
+        synced = true;
+    } else {
+        if (!synced) return true; // joined mid-stream: wait for a keyframe
+        if (predict) Predict();
+    }
+    turn = frameTurn;
+
+    for (auto& s : ships) s.firedPhaser = s.firedPhoton = false;
+    uint32_t changed = r.Var();
+    for (uint32_t k = 0; k < changed && r.ok; ++k) {
+        uint32_t i = r.Var();
+        if (i >= ships.size()) return false;
+        Ship& s = ships[i];
+        uint8_t mask = r.U8();
+        if (mask & SHIP_MOTION) {
+            s.x = Wrap((int64_t)s.x + r.SVar(), wrapX);
+            s.y = Wrap((int64_t)s.y + r.SVar(), wrapY);
+            s.vx += r.SVar();
+            s.vy += r.SVar();
+        }
+        if (mask & SHIP_ANGLE) s.angle = (uint16_t)(s.angle + r.SVar());
+        if (mask & SHIP_HP) s.hp += r.SVar();
+        if (mask & SHIP_FUEL) s.fuel += r.SVar();
+        if (mask & SHIP_ALIVE) s.alive = !s.alive;
+        s.firedPhaser = (mask & SHIP_PHASER) != 0;
+        s.firedPhoton = (mask & SHIP_PHOTON) != 0;
+    }
+    if (!r.ok) return false;
+    if (!ApplyBodies(r, asteroids, true, wrapX, wrapY)) return false;
+    if (!ApplyBodies(r, torpedoes, false, wrapX, wrapY)) return false;
+
+    uint32_t destroyed = r.Var();
+    for (uint32_t k = 0; k < destroyed && r.ok; ++k) {
+        uint32_t slot = r.Var();
+        if (slot >= beams.size() || !beams[slot].present) return false;
+        beams[slot] = Beam{};
+    }
+    uint32_t spawned = r.Var();
+    for (uint32_t k = 0; k < spawned && r.ok; ++k) {
+        uint32_t slot = r.Var();
+        if (slot >= MAX_SLOTS) return false;
+        if (slot >= beams.size()) beams.resize(slot + 1);
+        Beam& b = beams[slot];
+        if (b.present) return false;
+        b.present = true;
+        b.x1 = r.SVar(); b.y1 = r.SVar();
+        b.x2 = r.SVar(); b.y2 = r.SVar();
+        b.color = r.Var();
+    }
+    return r.ok && r.p == r.end;
+}
+
+bool AstroStreamView::Matches(const AstroArena& arena, std::string* why) const {
+    auto fail = [why](const std::string& msg) {
+        if (why) *why = msg;
+        return false;
+    };
+    if (ships.size() != arena.ships.size()) return fail("ship count");
+    for (size_t i = 0; i < ships.size(); ++i) {
+        const auto& s = arena.ships[i];
+        const Ship& v = ships[i];
+        if (v.alive != s.alive || v.hp != s.hp || v.fuel != (int32_t)std::lround(s.fuel)) return fail("ship " + std::to_string(i) + " status");
+        if (OffBy(WrapDelta(Wrap(Quant(s.x), wrapX), v.x, wrapX), ASTRO_STREAM_POS_TOLERANCE) ||
+            OffBy(WrapDelta(Wrap(Quant(s.y), wrapY), v.y, wrapY), ASTRO_STREAM_POS_TOLERANCE)) {
+            return fail("ship " + std::to_string(i) + " position");
+        }
+        if (v.angle != QuantAngle(s.angle)) return fail("ship " + std::to_string(i) + " angle");
+    }
+    auto check = [&](const char* what, const std::vector<Body>& bodies, size_t rows, auto&& get) {
+        size_t alive = 0;
+        for (size_t i = 0; i < rows; ++i) {
+            float x, y;
+            AstroHandle h;
+            if (!get(i, x, y, h)) continue;
+            ++alive;
+            if (h.slot >= bodies.size() || !bodies[h.slot].present) return fail(std::string(what) + " missing");
+            const Body& b = bodies[h.slot];
+            if (OffBy(WrapDelta(Wrap(Quant(x), wrapX), b.x, wrapX), ASTRO_STREAM_POS_TOLERANCE) ||
+                OffBy(WrapDelta(Wrap(Quant(y), wrapY), b.y, wrapY), ASTRO_STREAM_POS_TOLERANCE)) {
+                return fail(std::string(what) + " position");
+            }
+        }
+        return alive == Count(bodies) ? true : fail(std::string(what) + " count");
+    };
+    const auto& a = arena.asteroids;
+    if (!check("asteroid", asteroids, a.size(), [&](size_t i, float& x, float& y, AstroHandle& h) {
+            x = a.x[i]; y = a.y[i]; h = a.HandleAt(i);
+            return a.alive[i] != 0;
+        })) return false;
+    const auto& t = arena.torpedoes;
+    return check("torpedo", torpedoes, t.size(), [&](size_t i, float& x, float& y, AstroHandle& h) {
+        x = t[i].x; y = t[i].y; h = t.HandleAt(i);
+        return t[i].alive;
+    });
+}
+
+// ===== Encoder =====
+
+template <typename Get>
+void AstroStreamEncoder::EncodeBodies(std::vector<AstroStreamView::Body>& mirror, std::vector<uint32_t>& gens, size_t rows,
+                                      bool asteroid, std::vector<uint8_t>& out, Get&& get) {
+    _destroyed.clear(); _spawned.clear(); _corrected.clear();
+    Writer d{ _destroyed }, s{ _spawned }, c{ _corrected };
+    uint32_t destroyedCount = 0, spawnedCount = 0, correctedCount = 0;
+    const int32_t wrapX = _mirror.wrapX, wrapY = _mirror.wrapY;
+
+    _seen.assign(mirror.size(), 0);
+    AstroStreamView::Body cur;
+    AstroHandle h;
+    for (size_t i = 0; i < rows; ++i) {
+        if (!get(i, cur, h)) continue;
+        cur.x = Wrap(cur.x, wrapX);
+        cur.y = Wrap(cur.y, wrapY);
+        if (h.slot >= mirror.size()) {
+            // slots past the end are absent; Apply() grows the mirror to match
+            mirror.resize(h.slot + 1);
+            _seen.resize(h.slot + 1, 0);
+        }
+        if (h.slot >= gens.size()) gens.resize(h.slot + 1);
+        _seen[h.slot] = 1;
+        const auto& m = mirror[h.slot];
+        if (m.present && gens[h.slot] == h.generation) {
+            int32_t dx = WrapDelta(cur.x, m.x, wrapX), dy = WrapDelta(cur.y, m.y, wrapY);
+            int32_t dvx = cur.vx - m.vx, dvy = cur.vy - m.vy;
+            uint8_t mask = 0;
+            if (OffBy(dx, ASTRO_STREAM_POS_TOLERANCE) || OffBy(dy, ASTRO_STREAM_POS_TOLERANCE) ||
+                OffBy(dvx, ASTRO_STREAM_VEL_TOLERANCE) || OffBy(dvy, ASTRO_STREAM_VEL_TOLERANCE)) mask |= BODY_MOTION;
+            if (cur.hp != m.hp) mask |= BODY_HP;
+            if (!mask) continue;
+            c.Var(h.slot);
+            c.U8(mask);
+            if (mask & BODY_MOTION) { c.SVar(dx); c.SVar(dy); c.SVar(dvx); c.SVar(dvy); }
+            if (mask & BODY_HP) c.SVar(cur.hp - m.hp);
+            ++correctedCount;
+            continue;
+        }
+        // new, or its slot was reused since the last frame
+        if (m.present) { d.Var(h.slot); ++destroyedCount; }
+        gens[h.slot] = h.generation;
+        s.Var(h.slot);
+        s.Var((uint32_t)cur.x); s.Var((uint32_t)cur.y);
+        s.SVar(cur.vx); s.SVar(cur.vy);
+        if (asteroid) { s.Var((uint32_t)cur.radius); s.SVar(cur.hp); s.Var((uint32_t)cur.shape); }
+        else s.Var((uint32_t)(cur.owner + 1));
+        ++spawnedCount;
+    }
+    for (size_t slot = 0; slot < mirror.size(); ++slot) {
+        if (mirror[slot].present && !_seen[slot]) { d.Var((uint32_t)slot); ++destroyedCount; }
+    }
+    Writer w{ out };
+    w.Section(destroyedCount, _destroyed);
+    w.Section(spawnedCount, _spawned);
+    w.Section(correctedCount, _corrected);
+}
+
+bool AstroStreamEncoder::Encode(const AstroArena& arena, std::vector<uint8_t>& out) {
+    bool key = _lastTurn < 0 || arena.turn != _lastTurn + 1 || _mirror.ships.size() != arena.ships.size() ||
+               _mirror.width != arena.config.width || _mirror.height != arena.config.height ||
+               (keyframeEvery > 0 && _sinceKey >= keyframeEvery);
+    out.clear();
+    Writer w{ out };
+    w.Var((uint32_t)arena.turn);
+    w.U8(key ? FLAG_KEYFRAME : 0);
+    if (key) {
+        w.F32(arena.config.width);
+        w.F32(arena.config.height);
+        w.Var((uint32_t)arena.ships.size());
+        for (size_t i = 0; i < arena.ships.size(); ++i) {
+            w.Str(i < arena.programs.size() && arena.programs[i] ? arena.programs[i]->name : std::string());
+        }
+        // what the spectators start from
+        _mirror.Clear(arena.config.width, arena.config.height, arena.ships.size());
+        _asteroidGen.clear();
+        _torpedoGen.clear();
+        _beamGen.clear();
+    } else {
+        _mirror.Predict();
+    }
+    const int32_t wrapX = _mirror.wrapX, wrapY = _mirror.wrapY;
+
+    _lastPhaser.resize(arena.ships.size(), 0);
+    _lastPhoton.resize(arena.ships.size(), 0);
+    _corrected.clear();
+    Writer c{ _corrected };
+    uint32_t changed = 0;
+    for (size_t i = 0; i < arena.ships.size(); ++i) {
+        const auto& s = arena.ships[i];
+        const auto& m = _mirror.ships[i];
+        int32_t dx = WrapDelta(Wrap(Quant(s.x), wrapX), m.x, wrapX), dy = WrapDelta(Wrap(Quant(s.y), wrapY), m.y, wrapY);
+        int32_t dvx = Quant(s.vx) - m.vx, dvy = Quant(s.vy) - m.vy;
+        int16_t dAngle = (int16_t)(uint16_t)(QuantAngle(s.angle) - m.angle);
+        int32_t fuel = (int32_t)std::lround(s.fuel);
+        uint8_t mask = 0;
+        if (key || OffBy(dx, ASTRO_STREAM_POS_TOLERANCE) || OffBy(dy, ASTRO_STREAM_POS_TOLERANCE) ||
+            OffBy(dvx, ASTRO_STREAM_VEL_TOLERANCE) || OffBy(dvy, ASTRO_STREAM_VEL_TOLERANCE)) mask |= SHIP_MOTION;
+        if (dAngle != 0) mask |= SHIP_ANGLE;
+        if (s.hp != m.hp) mask |= SHIP_HP;
+        if (fuel != m.fuel) mask |= SHIP_FUEL;
+        if (s.alive != m.alive) mask |= SHIP_ALIVE;
+        // a shot puts the cooldown back up
+        if (!key && s.phaser_cooldown > _lastPhaser[i]) mask |= SHIP_PHASER;
+        if (!key && s.photon_cooldown > _lastPhoton[i]) mask |= SHIP_PHOTON;
+        _lastPhaser[i] = s.phaser_cooldown;
+        _lastPhoton[i] = s.photon_cooldown;
+        if (!mask) continue;
+        c.Var((uint32_t)i);
+        c.U8(mask);
+        if (mask & SHIP_MOTION) { c.SVar(dx); c.SVar(dy); c.SVar(dvx); c.SVar(dvy); }
+        if (mask & SHIP_ANGLE) c.SVar(dAngle);
+        if (mask & SHIP_HP) c.SVar(s.hp - m.hp);
+        if (mask & SHIP_FUEL) c.SVar(fuel - m.fuel);
+        ++changed;
+    }
+    w.Section(changed, _corrected);
+
+    const auto& a = arena.asteroids;
+    EncodeBodies(_mirror.asteroids, _asteroidGen, a.size(), true, out,
+                 [&](size_t i, AstroStreamView::Body& b, AstroHandle& h) {
+                     if (!a.alive[i]) return false;
+                     b.x = Quant(a.x[i]); b.y = Quant(a.y[i]);
+                     b.vx = Quant(a.vx[i]); b.vy = Quant(a.vy[i]);
+                     b.radius = (int32_t)std::lround(a.radius[i]);
+                     b.hp = a.hp[i];
+                     b.shape = a.shapeId[i];
+                     h = a.HandleAt(i);
+                     return true;
+                 });
+    const auto& t = arena.torpedoes;
+    EncodeBodies(_mirror.torpedoes, _torpedoGen, t.size(), false, out,
+                 [&](size_t i, AstroStreamView::Body& b, AstroHandle& h) {
+                     if (!t[i].alive) return false;
+                     b.x = Quant(t[i].x); b.y = Quant(t[i].y);
+                     b.vx = Quant(t[i].vx); b.vy = Quant(t[i].vy);
+                     b.hp = 0;
+                     b.owner = t[i].owner;
+                     h = t.HandleAt(i);
+                     return true;
+                 });
+
+    // beams don't move: spawned and gone
+    _destroyed.clear(); _spawned.clear();
+    Writer d{ _destroyed }, s{ _spawned };
+    uint32_t destroyedCount = 0, spawnedCount = 0;
+    const auto& beams = arena.phaserBeams;
+    auto& mirrorBeams = _mirror.beams;
+    _seen.assign(mirrorBeams.size(), 0);
+    for (size_t i = 0; i < beams.size(); ++i) {
+        if (!beams[i].alive) continue;
+        AstroHandle h = beams.HandleAt(i);
+        if (h.slot >= mirrorBeams.size()) {
+            mirrorBeams.resize(h.slot + 1);
+            _seen.resize(h.slot + 1, 0);
+        }
+        if (h.slot >= _beamGen.size()) _beamGen.resize(h.slot + 1);
+        _seen[h.slot] = 1;
+        if (mirrorBeams[h.slot].present && _beamGen[h.slot] == h.generation) continue;
+        if (mirrorBeams[h.slot].present) { d.Var(h.slot); ++destroyedCount; }
+        _beamGen[h.slot] = h.generation;
+        const PhaserBeam& b = beams[i];
+        s.Var(h.slot);
+        s.SVar(Quant(b.x1)); s.SVar(Quant(b.y1));
+        s.SVar(Quant(b.x2)); s.SVar(Quant(b.y2));
+        s.Var(b.color);
+        ++spawnedCount;
+    }
+    for (size_t slot = 0; slot < mirrorBeams.size(); ++slot) {
+        if (mirrorBeams[slot].present && !_seen[slot]) { d.Var((uint32_t)slot); ++destroyedCount; }
+    }
+    w.Section(destroyedCount, _destroyed);
+    w.Section(spawnedCount, _spawned);
+
+    // the mirror takes the same frame the spectators do, already moved on
+    _mirror.Apply(out.data(), out.size(), false);
+    _lastTurn = arena.turn;
+    _sinceKey = key ? 1 : _sinceKey + 1;
+    return key;
+}
+
+// ===== Server and client =====
+
+#if defined(_WIN32)
+
+struct AstroStreamServer::Spectator {};
+AstroStreamServer::AstroStreamServer() = default;
+AstroStreamServer::~AstroStreamServer() = default;
+bool AstroStreamServer::Listen(uint16_t, std::string* error) {
+    if (error) *error = "match streaming is not supported on Windows";
+    return false;
+}
+void AstroStreamServer::Close() {}
+void AstroStreamServer::Publish(const std::vector<uint8_t>&, bool) {}
+void AstroStreamServer::Poll() {}
+size_t AstroStreamServer::Pending() const { return 0; }
+bool AstroStreamServer::Flush(Spectator&) { return false; }
+
+AstroStreamClient::~AstroStreamClient() = default;
+bool AstroStreamClient::Connect(const std::string&, uint16_t, std::string* error) {
+    if (error) *error = "match streaming is not supported on Windows";
+    return false;
+}
+int AstroStreamClient::Receive(int) { return -1; }
+
+#else
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t STREAM_MAGIC = 0x54534141; // "AAST"
+constexpr uint16_t STREAM_VERSION = 1;
+constexpr uint32_t MAX_FRAME = 1u << 24;
+
+enum StreamFrame : uint8_t { FRAME_HELLO = 1, FRAME_TURN };
+
+#if defined(MSG_NOSIGNAL)
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0; // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+void PutU32(std::vector<uint8_t>& b, uint32_t v) {
+    for (int i = 0; i < 4; ++i) b.push_back((uint8_t)(v >> (8 * i)));
+}
+uint32_t GetU32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+void AppendFrame(std::vector<uint8_t>& b, uint8_t type, const uint8_t* payload, size_t size) {
+    PutU32(b, (uint32_t)(size + 1));
+    b.push_back(type);
+    b.insert(b.end(), payload, payload + size);
+}
+
+void PrepareSocket(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+} // namespace
+
+struct AstroStreamServer::Spectator {
+    int fd = -1;
+    bool waiting = false;     // fell behind: takes nothing until the next keyframe
+    size_t partial = 0;       // bytes of out's first frame still to send when it went out in part
+    std::vector<uint8_t> out; // unsent, whole frames apart from the first
+};
+
+AstroStreamServer::AstroStreamServer() = default;
+
+AstroStreamServer::~AstroStreamServer() { Close(); }
+
+bool AstroStreamServer::Listen(uint16_t port, std::string* error) {
+    Close();
+    _listen = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listen < 0) {
+        if (error) *error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    int one = 1;
+    setsockopt(_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(_listen, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(_listen, 64) < 0) {
+        if (error) *error = "port " + std::to_string(port) + ": " + std::strerror(errno);
+        close(_listen);
+        _listen = -1;
+        return false;
+    }
+    fcntl(_listen, F_SETFL, fcntl(_listen, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void AstroStreamServer::Close() {
+    for (auto& s : _spectators) close(s->fd);
+    _spectators.clear();
+    _catchUp.clear();
+    if (_listen >= 0) close(_listen);
+    _listen = -1;
+}
+
+void AstroStreamServer::Publish(const std::vector<uint8_t>& frame, bool keyframe) {
+    stats.frames++;
+    stats.keyframes += keyframe ? 1 : 0;
+    stats.bytesPublished += frame.size();
+    if (keyframe) _catchUp.clear();
+    size_t start = _catchUp.size();
+    if (keyframe || !_catchUp.empty()) AppendFrame(_catchUp, FRAME_TURN, frame.data(), frame.size());
+    if (_catchUp.size() == start) return; // nothing a spectator could use before the first keyframe
+    for (auto& s : _spectators) {
+        if (s->waiting && !keyframe) continue;
+        s->waiting = false;
+        if (s->out.size() + (_catchUp.size() - start) > ASTRO_STREAM_MAX_BACKLOG) {
+            // drop everything but the rest of the frame on the wire
+            s->out.resize(s->partial);
+            s->waiting = !keyframe;
+            stats.resyncs++;
+            if (s->waiting) continue;
+        }
+        s->out.insert(s->out.end(), _catchUp.begin() + (std::ptrdiff_t)start, _catchUp.end());
+    }
+    Poll();
+}
+
+void AstroStreamServer::Poll() {
+    if (_listen < 0) return;
+    for (;;) {
+        int fd = accept(_listen, nullptr, nullptr);
+        if (fd < 0) break;
+        PrepareSocket(fd);
+        auto s = std::make_unique<Spectator>();
+        s->fd = fd;
+        std::vector<uint8_t> hello;
+        PutU32(hello, STREAM_MAGIC);
+        hello.push_back((uint8_t)STREAM_VERSION);
+        hello.push_back((uint8_t)(STREAM_VERSION >> 8));
+        AppendFrame(s->out, FRAME_HELLO, hello.data(), hello.size());
+        s->out.insert(s->out.end(), _catchUp.begin(), _catchUp.end());
+        _spectators.push_back(std::move(s));
+        stats.spectatorsSeen++;
+    }
+    for (size_t i = 0; i < _spectators.size();) {
+        if (Flush(*_spectators[i])) { ++i; continue; }
+        close(_spectators[i]->fd);
+        _spectators.erase(_spectators.begin() + (std::ptrdiff_t)i);
+    }
+}
+
+size_t AstroStreamServer::Pending() const {
+    size_t n = 0;
+    for (const auto& s : _spectators) n += s->out.size();
+    return n;
+}
+
+bool AstroStreamServer::Flush(Spectator& s) {
+    // spectators don't talk; reading only notices the ones that hung up
+    uint8_t sink[256];
+    for (;;) {
+        ssize_t n = recv(s.fd, sink, sizeof(sink), 0);
+        if (n > 0) continue;
+        if (n == 0) return false;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        if (errno != EINTR) return false;
+    }
+    size_t sent = 0;
+    while (sent < s.out.size()) {
+        ssize_t n = send(s.fd, s.out.data() + sent, s.out.size() - sent, SEND_FLAGS);
+        if (n > 0) { sent += (size_t)n; continue; }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0 && errno == EINTR) continue;
+        return false;
+    }
+    if (sent == 0) return true;
+    stats.bytesSent += sent;
+    // where the first frame not fully sent now ends
+    size_t pos = s.partial;
+    while (pos < sent) pos += 4 + GetU32(s.out.data() + pos);
+    s.partial = pos - sent;
+    s.out.erase(s.out.begin(), s.out.begin() + (std::ptrdiff_t)sent);
+    return true;
+}
+
+AstroStreamClient::~AstroStreamClient() {
+    if (_fd >= 0) close(_fd);
+}
+
+bool AstroStreamClient::Connect(const std::string& host, uint16_t port, std::string* error) {
+    auto fail = [error](const std::string& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found) != 0 || !found) {
+        return fail("cannot resolve " + host);
+    }
+    for (addrinfo* a = found; a && _fd < 0; a = a->ai_next) {
+        _fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (_fd >= 0 && connect(_fd, a->ai_addr, a->ai_addrlen) < 0) {
+            close(_fd);
+            _fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (_fd < 0) return fail("cannot connect to " + host + ":" + std::to_string(port));
+    PrepareSocket(_fd);
+    return true;
+}
+
+int AstroStreamClient::Receive(int timeoutMs) {
+    if (_fd < 0) return -1;
+    pollfd p{ _fd, POLLIN, 0 };
+    if (poll(&p, 1, timeoutMs) <= 0) return 0;
+    bool closed = false;
+    uint8_t chunk[16384];
+    for (;;) {
+        ssize_t n = recv(_fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            _in.insert(_in.end(), chunk, chunk + n);
+            _bytes += (uint64_t)n;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0 && errno == EINTR) continue;
+        closed = true;
+        break;
+    }
+    int applied = 0;
+    size_t pos = 0;
+    while (_in.size() - pos >= 4) {
+        uint32_t len = GetU32(_in.data() + pos);
+        if (len == 0 || len > MAX_FRAME) { _error = "bad frame"; closed = true; break; }
+        if (_in.size() - pos - 4 < len) break;
+        const uint8_t* frame = _in.data() + pos + 4;
+        pos += 4 + len;
+        if (frame[0] == FRAME_HELLO) {
+            if (len < 7 || GetU32(frame + 1) != STREAM_MAGIC) { _error = "not a match stream"; closed = true; break; }
+            uint16_t version = (uint16_t)(frame[5] | frame[6] << 8);
+            if (version != STREAM_VERSION) {
+                _error = "stream version " + std::to_string(version) + ", expected " + std::to_string(STREAM_VERSION);
+                closed = true;
+                break;
+            }
+            _hello = true;
+        } else if (frame[0] == FRAME_TURN && _hello) {
+            if (!_view.Apply(frame + 1, len - 1)) { _error = "malformed turn frame"; closed = true; break; }
+            ++applied;
+        }
+    }
+    _in.erase(_in.begin(), _in.begin() + (std::ptrdiff_t)pos);
+    if (closed) {
+        close(_fd);
+        _fd = -1;
+        return applied > 0 ? applied : -1;
+    }
+    return applied;
+}
+
+#endif
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AstroArena.h"
+
+static constexpr int ASTRO_STREAM_KEYFRAME_EVERY = 128;   // turns between keyframes
+static constexpr uint16_t ASTRO_STREAM_DEFAULT_PORT = 4780;
+static constexpr int ASTRO_STREAM_POS_SCALE = 256;        // quantization steps per world unit
+static constexpr int32_t ASTRO_STREAM_POS_TOLERANCE = 64; // steps a prediction may be off before a correction (1/4 unit)
+static constexpr int32_t ASTRO_STREAM_VEL_TOLERANCE = 4;  // steps per turn, likewise for velocities
+static constexpr size_t ASTRO_STREAM_MAX_BACKLOG = 1u << 20; // bytes queued for a spectator before it has to resync
+
+// ===== Match telemetry stream =====
+// What a remote spectator needs to draw a match, one frame per turn: ships, asteroids,
+// torpedoes and phaser beams, quantized to 1/ASTRO_STREAM_POS_SCALE of a world unit.
+// Both ends keep the same view (AstroStreamView) and move it forward the same way every
+// turn: bodies by their velocity, ships with drag, all in integers so the two never
+// drift apart. A frame then only carries what the prediction got wrong: bodies spawned
+// and removed (by AstroHandle slot, so ids stay put while rows shift), corrections for
+// the ones that were knocked, thrusted or turned further than the tolerances, and per ship
+// the hp, fuel and alive flag when they changed and whether it fired this turn. A quiet
+// turn of drifting asteroids is a few bytes; bandwidth follows what happened, not the
+// size of the world.
+//
+// Every ASTRO_STREAM_KEYFRAME_EVERY turns (and whenever the arena didn't just move one turn
+// on, after a restore or a new match) the frame is a keyframe instead: world size, roster
+// and every entity, on a cleared view, so a spectator can start from it.
+//
+// Frame payload: varint turn, u8 flags (bit 0 keyframe), [keyframe: f32 width, f32 height,
+// varint ship count, names], then the ship, asteroid, torpedo and beam sections. Integers
+// are LEB128 varints, signed ones zigzagged.
+struct AstroStreamView {
+    struct Ship {
+        int32_t x = 0, y = 0, vx = 0, vy = 0; // quantized
+        uint16_t angle = 0;                   // 1/65536 of a full turn
+        int32_t hp = 0;
+        int32_t fuel = 0;                     // rounded
+        bool alive = false;
+        bool firedPhaser = false, firedPhoton = false; // this turn
+        std::string name;
+        bool operator==(const Ship&) const = default;
+    };
+    struct Body {
+        bool present = false;
+        int32_t x = 0, y = 0, vx = 0, vy = 0;
+        int32_t radius = 0; // asteroids: nominal size, rounded
+        int32_t hp = 0;     // asteroids
+        int32_t shape = 0;  // asteroids: AsteroidShapeLibrary id
+        int32_t owner = -1; // torpedoes: ship that fired it
+        bool operator==(const Body&) const = default;
+    };
+    struct Beam {
+        bool present = false;
+        int32_t x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+        uint32_t color = 0;
+        bool operator==(const Beam&) const = default;
+    };
+
+    int turn = 0;
+    bool synced = false;            // a keyframe has been applied
+    float width = 0, height = 0;    // world size
+    int32_t wrapX = 0, wrapY = 0;   // world size in quantization steps
+    std::vector<Ship> ships;
+    std::vector<Body> asteroids;    // indexed by handle slot
+    std::vector<Body> torpedoes;    // indexed by handle slot
+    std::vector<Beam> beams;        // indexed by handle slot
+
+    // Applies one frame. A delta before the first keyframe is skipped (returns true, view
+    // not synced); false if the frame is malformed. predict = false when the view has
+    // already been moved on for this turn (the encoder's own mirror).
+    bool Apply(const uint8_t* data, size_t size, bool predict = true);
+    // Moves everything forward one turn the way both ends predict it.
+    void Predict();
+    // empties the view for a world of this size, ships all dead at the origin
+    void Clear(float worldWidth, float worldHeight, size_t shipCount);
+    // true if every ship and body the arena has live is in the view and within the
+    // tolerances of where it really is; why says what isn't
+    bool Matches(const AstroArena& arena, std::string* why = nullptr) const;
+    static float ToWorld(int32_t q) { return (float)q / (float)ASTRO_STREAM_POS_SCALE; }
+    size_t Count(const std::vector<Body>& bodies) const;
+    bool operator==(const AstroStreamView&) const = default;
+};
+
+class AstroStreamEncoder {
+public:
+    int keyframeEvery = ASTRO_STREAM_KEYFRAME_EVERY;
+
+    // Encodes the arena's current turn into out (cleared first) and returns true if it is a
+    // keyframe. Call once per turn, after Step().
+    bool Encode(const AstroArena& arena, std::vector<uint8_t>& out);
+    // the next Encode() sends a keyframe
+    void Restart() { _lastTurn = -1; }
+    // what the spectators hold after the last frame
+    const AstroStreamView& View() const { return _mirror; }
+
+private:
+    // the destroyed, spawned and corrected sections of one pool; get(row, body, handle)
+    // fills in a row's quantized body and returns false if it is dead
+    template <typename Get>
+    void EncodeBodies(std::vector<AstroStreamView::Body>& mirror, std::vector<uint32_t>& gens, size_t rows,
+                      bool asteroid, std::vector<uint8_t>& out, Get&& get);
+
+    AstroStreamView _mirror;
+    std::vector<uint32_t> _asteroidGen, _torpedoGen, _beamGen; // generation of each mirrored slot
+    std::vector<int> _lastPhaser, _lastPhoton;                 // cooldowns last turn, to spot shots
+    std::vector<uint8_t> _destroyed, _spawned, _corrected;     // section scratch
+    std::vector<uint8_t> _seen;                                // slots found live this turn
+    int _lastTurn = -1;
+    int _sinceKey = 0;
+};
+
+// ===== Streaming to spectators =====
+// A TCP listener that hands every spectator the same encoded frames. Frames are
+// length-prefixed (u32 length, u8 type, payload; little-endian) and the first one a
+// spectator gets is a HELLO (magic, version). A spectator that joins mid-match is sent the
+// last keyframe and the deltas since, so it is in sync straight away. One that falls more
+// than ASTRO_STREAM_MAX_BACKLOG behind has its queue dropped and picks up again at the
+// next keyframe. Nothing blocks: Publish() queues, Poll() accepts and writes what the
+// sockets take. POSIX sockets; on Windows Listen() fails.
+struct AstroStreamStats {
+    uint64_t frames = 0;
+    uint64_t keyframes = 0;
+    uint64_t bytesPublished = 0; // encoded frames, once each
+    uint64_t bytesSent = 0;      // over all spectators
+    int spectatorsSeen = 0;
+    int resyncs = 0;             // spectators that fell behind and waited for a keyframe
+};
+
+class AstroStreamServer {
+public:
+    AstroStreamServer();
+    ~AstroStreamServer();
+    bool Listen(uint16_t port, std::string* error = nullptr);
+    bool Listening() const { return _listen >= 0; }
+    void Close();
+    void Publish(const std::vector<uint8_t>& frame, bool keyframe);
+    void Poll();
+    int SpectatorCount() const { return (int)_spectators.size(); }
+    // bytes queued for spectators and not yet taken by their sockets
+    size_t Pending() const;
+    AstroStreamStats stats;
+
+private:
+    struct Spectator;
+    bool Flush(Spectator& s);
+    int _listen = -1;
+    std::vector<std::unique_ptr<Spectator>> _spectators;
+    std::vector<uint8_t> _catchUp; // the last keyframe and the deltas after it, framed
+};
+
+// The spectator end: connects, reads frames and applies them to View().
+class AstroStreamClient {
+public:
+    ~AstroStreamClient();
+    bool Connect(const std::string& host, uint16_t port, std::string* error = nullptr);
+    // Waits up to timeoutMs for data and applies every whole frame that arrived. Returns
+    // the number of frames applied, -1 once the connection is closed or broken.
+    int Receive(int timeoutMs);
+    const AstroStreamView& View() const { return _view; }
+    uint64_t BytesReceived() const { return _bytes; }
+    const std::string& Error() const { return _error; }
+
+private:
+    int _fd = -1;
+    bool _hello = false;
+    std::vector<uint8_t> _in;
+    AstroStreamView _view;
+    uint64_t _bytes = 0;
+    std::string _error;
+};
@@ -0,0 +1,77 @@
+#include "AstroThreadPool.h"
+
+AstroThreadPool::AstroThreadPool(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    for (int i = 0; i < threads; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < threads; ++i) {
+        _threads.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+}
+
+AstroThreadPool::~AstroThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& t : _threads) {
+        t.join();
+    }
+}
+
+void AstroThreadPool::Submit(std::function<void()> job) {
+    unsigned q = _next++ % (unsigned)_queues.size();
+    _pending++;
+    {
+        std::lock_guard<std::mutex> lock(_queues[q]->mutex);
+        _queues[q]->jobs.push_back(std::move(job));
+    }
+    _queued++;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _wake.notify_one();
+}
+
+void AstroThreadPool::Wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this]() { return _pending == 0; });
+}
+
+bool AstroThreadPool::TryPop(int self, std::function<void()>& job) {
+    // own queue first (LIFO keeps caches warm), then steal oldest work from the others
+    int n = (int)_queues.size();
+    for (int k = 0; k < n; ++k) {
+        Queue& q = *_queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.jobs.empty()) continue;
+        if (k == 0) {
+            job = std::move(q.jobs.back());
+            q.jobs.pop_back();
+        } else {
+            job = std::move(q.jobs.front());
+            q.jobs.pop_front();
+        }
+        _queued--;
+        return true;
+    }
+    return false;
+}
+
+void AstroThreadPool::WorkerLoop(int self) {
+    while (true) {
+        std::function<void()> job;
+        if (TryPop(self, job)) {
+            job();
+            if (--_pending == 0) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _done.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wake.wait(lock, [this]() { return _stop || _queued > 0; });
+        if (_stop && _queued == 0) return;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ===== Work-stealing thread pool =====
+// Each worker owns a deque: it pops its own jobs from the back and steals from the
+// front of the other workers' deques when it runs dry. Jobs are submitted round-robin.
+class AstroThreadPool {
+public:
+    explicit AstroThreadPool(int threads = 0); // 0 = one worker per hardware thread
+    ~AstroThreadPool();
+
+    void Submit(std::function<void()> job);
+    // blocks until every job submitted so far has finished
+    void Wait();
+    int ThreadCount() const { return (int)_threads.size(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+    bool TryPop(int self, std::function<void()>& job);
+    void WorkerLoop(int self);
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    std::atomic<int> _queued{0};   // jobs sitting in a deque
+    std::atomic<int> _pending{0};  // jobs submitted but not finished
+    std::atomic<unsigned> _next{0};
+    bool _stop = false;
+};
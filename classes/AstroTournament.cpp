@@ -0,0 +1,145 @@
+#include "AstroTournament.h"
+#include "AstroArena.h"
+#include "AstroThreadPool.h"
+#include "AstroCluster.h"
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <utility>
+
+namespace {
+
+void PlayRound(AstroThreadPool& pool, const std::vector<ShipType>& entrants, const std::vector<TournamentMatch>& pairings,
+               const TournamentOptions& options, uint32_t& nextSeed, std::vector<TournamentStanding>& standings) {
+    std::vector<TournamentMatch> jobs;
+    for (const auto& p : pairings) {
+        for (int g = 0; g < options.gamesPerPairing; ++g) {
+            jobs.push_back(p);
+            jobs.back().seed = nextSeed++;
+        }
+    }
+    std::vector<TournamentOutcome> outcomes;
+    if (options.cluster) {
+        outcomes = options.cluster->Play(entrants, jobs, options);
+    } else {
+        outcomes.resize(jobs.size());
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            pool.Submit([&entrants, &jobs, &outcomes, &options, i]() {
+                outcomes[i] = PlayTournamentMatch(entrants, jobs[i], options);
+            });
+        }
+        pool.Wait();
+    }
+
+    // fold results in job order so standings don't depend on thread scheduling
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const TournamentOutcome& o = outcomes[i];
+        int idx[2] = { jobs[i].a, jobs[i].b };
+        for (int slot = 0; slot < 2; ++slot) {
+            TournamentStanding& st = standings[idx[slot]];
+            st.matches++;
+            st.turnsSurvived += o.turnsSurvived[slot];
+            st.damageDealt += o.damageDealt[slot];
+            if (o.stalemate) st.stalemates++;
+            if (o.winner < 0) st.draws++;
+            else if (o.winner == slot) st.wins++;
+            else st.losses++;
+        }
+    }
+}
+
+std::vector<TournamentMatch> RoundRobinPairings(int n) {
+    std::vector<TournamentMatch> pairings;
+    for (int a = 0; a < n; ++a) {
+        for (int b = a + 1; b < n; ++b) {
+            pairings.push_back({ a, b });
+        }
+    }
+    return pairings;
+}
+
+std::vector<TournamentMatch> SwissPairings(std::vector<TournamentStanding>& standings, std::set<std::pair<int, int>>& played) {
+    // rank by points, then pair each entrant with the best-ranked opponent it hasn't met yet
+    std::vector<int> order(standings.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int x, int y) {
+        return standings[x].Points() > standings[y].Points();
+    });
+    std::vector<bool> paired(order.size(), false);
+    if (order.size() % 2) {
+        // odd field: the lowest-ranked entrant with the fewest byes sits this round out
+        int bye = (int)order.size() - 1;
+        for (int i = bye - 1; i >= 0; --i) {
+            if (standings[order[i]].byes < standings[order[bye]].byes) bye = i;
+        }
+        paired[bye] = true;
+        standings[order[bye]].byes++;
+    }
+    std::vector<TournamentMatch> pairings;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (paired[i]) continue;
+        int fallback = -1;
+        int chosen = -1;
+        for (size_t j = i + 1; j < order.size(); ++j) {
+            if (paired[j]) continue;
+            if (fallback < 0) fallback = (int)j;
+            auto key = std::minmax(order[i], order[j]);
+            if (!played.count(key)) { chosen = (int)j; break; }
+        }
+        if (chosen < 0) chosen = fallback; // everybody left is a rematch
+        if (chosen < 0) break;
+        paired[i] = paired[chosen] = true;
+        played.insert(std::minmax(order[i], order[chosen]));
+        pairings.push_back({ order[i], order[chosen] });
+    }
+    return pairings;
+}
+
+} // namespace
+
+TournamentOutcome PlayTournamentMatch(const std::vector<ShipType>& entrants, const TournamentMatch& match,
+                                      const TournamentOptions& options) {
+    // every match gets its own arena, nothing is shared between worker threads
+    AstroArena arena;
+    std::vector<std::unique_ptr<ShipBase>> roster;
+    roster.push_back(entrants[match.a].make());
+    roster.push_back(entrants[match.b].make());
+    arena.simultaneous = options.simultaneous;
+    arena.config = options.config;
+    arena.Setup(std::move(roster), match.seed);
+    while (arena.turn < options.maxTurns && arena.Step()) {
+    }
+
+    TournamentOutcome out;
+    for (int slot = 0; slot < 2; ++slot) {
+        const auto& s = arena.ships[slot];
+        out.turnsSurvived[slot] = s.alive ? arena.turn : s.deathTurn;
+        out.damageDealt[slot] = s.damageDealt;
+    }
+    if (arena.AliveCount() == 1) {
+        out.winner = arena.ships[0].alive ? 0 : 1;
+    }
+    out.stalemate = arena.Stalemated();
+    out.checksum = arena.Checksum();
+    return out;
+}
+
+std::vector<TournamentStanding> RunTournament(const std::vector<ShipType>& entrants, const TournamentOptions& options) {
+    std::vector<TournamentStanding> standings(entrants.size());
+    for (size_t i = 0; i < entrants.size(); ++i) {
+        standings[i].name = entrants[i].name;
+    }
+    if (entrants.size() < 2) return standings;
+
+    AstroThreadPool pool(options.cluster ? 1 : options.threads); // idle when the cluster plays
+    uint32_t nextSeed = options.seed;
+    if (options.format == TournamentOptions::ROUND_ROBIN) {
+        PlayRound(pool, entrants, RoundRobinPairings((int)entrants.size()), options, nextSeed, standings);
+    } else {
+        std::set<std::pair<int, int>> played;
+        for (int r = 0; r < options.swissRounds; ++r) {
+            PlayRound(pool, entrants, SwissPairings(standings, played), options, nextSeed, standings);
+        }
+    }
+    return standings;
+}
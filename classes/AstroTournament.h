@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "AstroTypes.h"
+#include "AstroShips.h"
+
+class AstroClusterCoordinator;
+
+// ===== Tournament runner =====
+// Every match runs 1v1 in its own AstroArena on a work-stealing pool, so a ladder
+// scales with the number of cores, or on the worker processes of a cluster
+// (AstroCluster.h), so it scales with the number of machines.
+struct TournamentOptions {
+    enum Format { ROUND_ROBIN, SWISS };
+    Format format = ROUND_ROBIN;
+    int gamesPerPairing = 1;   // round-robin: matches played by every pair
+    int swissRounds = 5;       // swiss: number of rounds
+    int threads = 0;           // 0 = all cores
+    int maxTurns = ASTRO_MAX_TURNS;
+    uint32_t seed = 1;         // match k of the tournament is played with seed + k
+    bool simultaneous = false; // AstroArena::simultaneous for every match
+    AstroArenaConfig config;   // AstroArena::config for every match (ships is unused: matches are 1v1)
+    AstroClusterCoordinator* cluster = nullptr; // play the matches on its workers instead of local threads
+};
+
+// One match of a tournament: entrants a and b (indices into the entrant list) in slots 0 and 1
+struct TournamentMatch {
+    int a = 0, b = 0;
+    uint32_t seed = 0;
+};
+
+struct TournamentOutcome {
+    int winner = -1;            // 0 or 1 (slot), -1 for a draw
+    bool stalemate = false;     // a draw called early (AstroArena::Stalemated())
+    int turnsSurvived[2] = {0, 0};
+    int damageDealt[2] = {0, 0};
+    uint64_t checksum = 0;      // AstroArena::Checksum() of the final state, to compare reruns
+};
+
+// plays one match in a fresh arena; the same match and options always give the same outcome
+TournamentOutcome PlayTournamentMatch(const std::vector<ShipType>& entrants, const TournamentMatch& match,
+                                      const TournamentOptions& options);
+
+struct TournamentStanding {
+    std::string name;
+    int matches = 0;
+    int wins = 0;
+    int losses = 0;
+    int draws = 0;
+    int stalemates = 0;        // of the draws, those called early as stalemates
+    int byes = 0;              // swiss rounds sat out (odd entrant count), scored as a win
+    long long turnsSurvived = 0;
+    long long damageDealt = 0;
+
+    float WinRate() const { return matches ? (float)wins / (float)matches : 0.0f; }
+    float MeanTurnsSurvived() const { return matches ? (float)turnsSurvived / (float)matches : 0.0f; }
+    float MeanDamageDealt() const { return matches ? (float)damageDealt / (float)matches : 0.0f; }
+    int Points() const { return (wins + byes) * 2 + draws; }
+};
+
+// One standing per entrant, in entrant order.
+std::vector<TournamentStanding> RunTournament(const std::vector<ShipType>& entrants, const TournamentOptions& options);
@@ -3,8 +3,11 @@
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <random>
+#include <algorithm>
 #include "../imgui/imgui.h"
 #include "cute_c2.h"
+#include "AstroMemory.h"
 
 // ===== Arena config =====
 static constexpr float ASTROBOTS_W = 2048.0f;
@@ -20,6 +23,7 @@ static constexpr float THRUST_FUEL_COST = 0.05f;
 static constexpr float MAX_VELOCITY = 4.0f;          
 static constexpr float ROTATION_SPEED = 3.0f;        // degrees per turn, slightly slower
 static constexpr float DRAG = 0.98f;                 // velocity damping
+static constexpr float MIN_VELOCITY = 0.001f;        // slower components snap to zero
 
 // Weapons
 static constexpr float PHASER_RANGE = 500.0f;
@@ -38,12 +42,15 @@ static constexpr float PHOTON_PULSE_SPEED = 0.20f;    // cycles per frame
 
 // Scan
 static constexpr float ASTRO_SCAN_RANGE = 600.0f;
+static constexpr float ASTRO_SIGNAL_RANGE = 1024.0f; // furthest an ally's signal is heard from
+static constexpr size_t ASTRO_STALEMATE_PAIRWISE_SHIPS = 32; // rosters up to this size check every pair for stalemates
 
 // Asteroids
 static constexpr int NUM_INITIAL_ASTEROIDS = 8;
 static constexpr float LARGE_ASTEROID_SIZE = 75.0f;   
 static constexpr float MEDIUM_ASTEROID_SIZE = 37.5f;  
 static constexpr float SMALL_ASTEROID_SIZE = 18.0f;    
+static constexpr float ASTEROID_MAX_RADIUS_SCALE = 1.3f; // outline vertices lie within size * this
 static constexpr float ASTEROID_MAX_SPEED = 2.0f;
 static constexpr int LARGE_ASTEROID_HP = 3;
 static constexpr int MEDIUM_ASTEROID_HP = 2;
@@ -58,6 +65,8 @@ static constexpr float PARTICLE_MAX_SPEED = 6.0f;
 static constexpr float PARTICLE_DRAG = 0.96f;
 static constexpr float PARTICLE_LENGTH = 28.0f;        // line length scaling
 static constexpr float PARTICLE_WRAP = 1;              // wrap particles? (1=true)
+static constexpr int ASTRO_MAX_PARTICLES = 4096;       // default ParticlePool capacity
+static constexpr int ASTRO_MAX_SHIP_DEBRIS = 256;      // live debris segments kept at once
 
 // Ship debris (Asteroids-style breakup)
 static constexpr int SHIP_DEBRIS_LIFETIME = 60;        // frames
@@ -65,27 +74,236 @@ static constexpr float SHIP_DEBRIS_DRAG = 0.97f;
 static constexpr int SHIP_DEBRIS_COUNT_PER_EDGE = 2;   // segments per triangle edge
 static constexpr float SHIP_DRAW_SIZE = 55.0f;         // matches ship triangle size used in rendering
 
+// ===== Runtime arena config =====
+// What a match is played in, set on AstroArena::config before Setup(); the defaults are
+// the constants above. Snapshots and replays carry the fields that change gameplay (world
+// size, asteroid count, cell size), so those can't differ between a match and its restore.
+static constexpr int ASTRO_GRID_CELLS_PER_ENTITY = 32; // auto cell size: coarser cells above this many per entity
+
+// which AstroBroadphase indexes the world (AstroBroadphase.h); results don't depend on it
+enum AstroBroadphaseKind : uint8_t {
+    ASTRO_BROADPHASE_GRID = 0,  // uniform grid, cellSize below
+    ASTRO_BROADPHASE_QUADTREE,  // loose quadtree, for worlds where objects bunch up
+};
+
+struct AstroArenaConfig {
+    float width = ASTROBOTS_W;
+    float height = ASTROBOTS_H;
+    int ships = 0;                              // roster size for MakeDefaultShips(), 0 = one of each default ship
+    int asteroids = NUM_INITIAL_ASTEROIDS;      // large asteroids at the start, and the population edge spawns keep up
+    int maxParticles = ASTRO_MAX_PARTICLES;
+    int maxShipDebris = ASTRO_MAX_SHIP_DEBRIS;
+    int cellSize = 0;                           // broadphase cell size in world units, 0 = pick from density
+    AstroBroadphaseKind broadphase = ASTRO_BROADPHASE_GRID;
+    // End the match as a stalemate after this many turns in a row in which no ship lost hp
+    // and no two live ships were within ASTRO_SCAN_RANGE of each other; 0 = play to the
+    // turn limit (AstroArena::Stalemated())
+    int stalemateTurns = 0;
+    // Move everything in 16.16 fixed point (AstroFixed.h) and draw from the rng with
+    // portable mappings instead of the std distributions, so that the match comes out the
+    // same on every compiler and platform: for lockstep across builds. A different match
+    // from the same seed than the float arena's; worlds of at most ASTRO_FIXED_MAX_EXTENT.
+    bool fixedPoint = false;
+
+    // The broadphase cell size for shipCount ships: cellSize when set, otherwise the
+    // smallest power of two that holds the largest asteroid (so an object's 3x3 block
+    // reaches everything it can touch), doubled while the grid would have more than
+    // ASTRO_GRID_CELLS_PER_ENTITY cells per ship and asteroid, so sparse worlds don't pay
+    // per turn for cells nothing is in.
+    int CellSizeFor(size_t shipCount) const;
+    // false for a fixedPoint world wider or taller than ASTRO_FIXED_MAX_EXTENT, which the
+    // 16.16 grid can't hold; Setup() clamps such a world, the decoders reject it
+    bool FitsFixedPoint() const;
+    bool SameRules(const AstroArenaConfig& o) const {
+        return width == o.width && height == o.height && asteroids == o.asteroids && cellSize == o.cellSize &&
+               stalemateTurns == o.stalemateTurns && fixedPoint == o.fixedPoint;
+    }
+};
+
 // ===== Opcodes / DSL =====
 enum AstroOpCode {
     // actions
     ASTRO_OP_WAIT, ASTRO_OP_THRUST, ASTRO_OP_TURN_DEG, ASTRO_OP_FIRE_PHASER,
     ASTRO_OP_FIRE_PHOTON, ASTRO_OP_SCAN, ASTRO_OP_SIGNAL, ASTRO_OP_TURN_TO_SCAN,
+    ASTRO_OP_SCAN_SHIPS, ASTRO_OP_SCAN_ASTEROIDS, ASTRO_OP_SCAN_TORPEDOES,
     // conditions
     ASTRO_OP_IF_SEEN, ASTRO_OP_IF_SCAN_LE, ASTRO_OP_IF_DAMAGED, ASTRO_OP_IF_HP_LE,
     ASTRO_OP_IF_FUEL_LE, ASTRO_OP_IF_CAN_FIRE_PHASER, ASTRO_OP_IF_CAN_FIRE_PHOTON,
     // flow control
-    ASTRO_OP_JUMP, ASTRO_OP_JUMP_IF_FALSE, ASTRO_OP_END
+    ASTRO_OP_JUMP, ASTRO_OP_JUMP_IF_FALSE, ASTRO_OP_END,
+    // listening, after the rest so the codes above stay what stored programs hold: turn
+    // towards / test the nearest ally signal sent last turn (AstroArena::Hear())
+    ASTRO_OP_TURN_TO_SIGNAL, ASTRO_OP_IF_SIGNAL_LE, ASTRO_OP_IF_SIGNAL_IS,
+    ASTRO_OP_COUNT
 };
 
+// operand words that follow each opcode in ShipBase::code
+constexpr int AstroOperandCount(int op) {
+    switch (op) {
+        case ASTRO_OP_WAIT: case ASTRO_OP_FIRE_PHASER: case ASTRO_OP_FIRE_PHOTON:
+        case ASTRO_OP_SCAN: case ASTRO_OP_TURN_TO_SCAN: case ASTRO_OP_END:
+        case ASTRO_OP_SCAN_SHIPS: case ASTRO_OP_SCAN_ASTEROIDS: case ASTRO_OP_SCAN_TORPEDOES:
+        case ASTRO_OP_TURN_TO_SIGNAL:
+            return 0;
+        default:
+            return 1;
+    }
+}
+constexpr bool AstroIsCondition(int op) {
+    return (op >= ASTRO_OP_IF_SEEN && op <= ASTRO_OP_IF_CAN_FIRE_PHOTON) || op == ASTRO_OP_IF_SIGNAL_LE || op == ASTRO_OP_IF_SIGNAL_IS;
+}
+
+// What a scan looks for. Every kind of scan leaves its answer in the same ShipState
+// fields, so IF_SEEN, IF_SCAN_LE and TURN_TO_SCAN read whichever ran last.
+enum AstroScanFilter : uint8_t {
+    ASTRO_SCAN_ANY,        // SCAN: nearest ship or asteroid
+    ASTRO_SCAN_SHIPS,      // SCAN_SHIPS: nearest other ship
+    ASTRO_SCAN_ASTEROIDS,  // SCAN_ASTEROIDS: nearest asteroid
+    ASTRO_SCAN_TORPEDOES,  // SCAN_TORPEDOES: nearest torpedo of another ship's that is closing in
+    ASTRO_SCAN_FILTER_COUNT
+};
+constexpr AstroScanFilter AstroScanFilterOf(int op) {
+    switch (op) {
+        case ASTRO_OP_SCAN_SHIPS: return ASTRO_SCAN_SHIPS;
+        case ASTRO_OP_SCAN_ASTEROIDS: return ASTRO_SCAN_ASTEROIDS;
+        case ASTRO_OP_SCAN_TORPEDOES: return ASTRO_SCAN_TORPEDOES;
+        default: return ASTRO_SCAN_ANY;
+    }
+}
+
 // energy costs (for compile-time budget)
 enum AstroActionCost {
     ASTRO_COST_WAIT=0, ASTRO_COST_THRUST=2, ASTRO_COST_TURN=1,
     ASTRO_COST_PHASER=3, ASTRO_COST_PHOTON=4, ASTRO_COST_SCAN=1, ASTRO_COST_SIGNAL=1
 };
+// what the DSL macro for op adds to script_cost (conditions and flow control are free)
+constexpr int AstroOpCost(int op) {
+    switch (op) {
+        case ASTRO_OP_THRUST: return ASTRO_COST_THRUST;
+        case ASTRO_OP_TURN_DEG: case ASTRO_OP_TURN_TO_SCAN: case ASTRO_OP_TURN_TO_SIGNAL: return ASTRO_COST_TURN;
+        case ASTRO_OP_FIRE_PHASER: return ASTRO_COST_PHASER;
+        case ASTRO_OP_FIRE_PHOTON: return ASTRO_COST_PHOTON;
+        case ASTRO_OP_SCAN: case ASTRO_OP_SCAN_SHIPS: case ASTRO_OP_SCAN_ASTEROIDS: case ASTRO_OP_SCAN_TORPEDOES:
+            return ASTRO_COST_SCAN;
+        case ASTRO_OP_SIGNAL: return ASTRO_COST_SIGNAL;
+        default: return ASTRO_COST_WAIT;
+    }
+}
 
 // Forward declarations
 struct AstroArena;
 
+// ===== Entity handles =====
+// Entity pools keep their rows dense and in spawn order: removing the dead shifts the
+// survivors down once a turn, keeping their order, which is what collision ties and the
+// checksum go by. So a row index is only good until the end of the turn. A handle names
+// the entity instead: it resolves to wherever the entity's row is now, until the entity
+// is removed, and never to whatever reuses its slot afterwards. Handles don't survive a
+// snapshot restore.
+struct AstroHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+    bool operator==(const AstroHandle&) const = default;
+};
+
+// handle slot -> row, with a free list, so spawning and removing reuse slots rather than
+// growing the table once a match has warmed up; counted against its pool's tag
+template <AstroMemTag Tag> class AstroSlotTable {
+public:
+    uint32_t Acquire(uint32_t row) {
+        uint32_t s;
+        if (!_free.empty()) { s = _free.back(); _free.pop_back(); }
+        else { s = (uint32_t)_slots.size(); _slots.push_back({}); }
+        _slots[s].row = row;
+        return s;
+    }
+    // every handle to the slot goes stale
+    void Release(uint32_t s) {
+        _slots[s].row = NO_ROW;
+        _slots[s].generation++;
+        _free.push_back(s);
+    }
+    void Move(uint32_t s, uint32_t row) { _slots[s].row = row; }
+    AstroHandle HandleOf(uint32_t s) const { return { s, _slots[s].generation }; }
+    // the row h names, -1 once its entity has been removed
+    int RowOf(AstroHandle h) const {
+        if (h.slot >= _slots.size() || _slots[h.slot].generation != h.generation) return -1;
+        return _slots[h.slot].row == NO_ROW ? -1 : (int)_slots[h.slot].row;
+    }
+    void Reserve(size_t n) { _slots.reserve(n); _free.reserve(n); }
+
+private:
+    static constexpr uint32_t NO_ROW = UINT32_MAX;
+    struct Slot { uint32_t row = NO_ROW; uint32_t generation = 0; };
+    AstroVector<Slot, Tag> _slots;
+    AstroVector<uint32_t, Tag> _free;
+};
+
+// Dense, ordered pool of records with an alive flag (torpedoes, beams), iterated like the
+// vector it wraps. Add() and killing (clearing alive) are O(1); RemoveDead() drops the dead
+// in one pass at the end of the turn. Neither allocates once the pool has reached its
+// match's peak. Tag is what its memory counts as (AstroMemory.h).
+template <typename T, AstroMemTag Tag> class AstroEntityPool {
+public:
+    using Storage = AstroVector<T, Tag>;
+    using iterator = typename Storage::iterator;
+    using const_iterator = typename Storage::const_iterator;
+
+    size_t size() const { return _items.size(); }
+    bool empty() const { return _items.empty(); }
+    T& operator[](size_t i) { return _items[i]; }
+    const T& operator[](size_t i) const { return _items[i]; }
+    iterator begin() { return _items.begin(); }
+    iterator end() { return _items.end(); }
+    const_iterator begin() const { return _items.begin(); }
+    const_iterator end() const { return _items.end(); }
+    const Storage& Items() const { return _items; }
+
+    T& Add(const T& item) {
+        _slotOf.push_back(_handles.Acquire((uint32_t)_items.size()));
+        _items.push_back(item);
+        return _items.back();
+    }
+    AstroHandle HandleAt(size_t i) const { return _handles.HandleOf(_slotOf[i]); }
+    // the live record h names, nullptr once it's dead
+    T* Find(AstroHandle h) {
+        int i = _handles.RowOf(h);
+        return i >= 0 && _items[i].alive ? &_items[i] : nullptr;
+    }
+    // drops the dead, keeping the survivors in order; their handles follow them
+    void RemoveDead() {
+        size_t out = 0;
+        for (size_t i = 0; i < _items.size(); ++i) {
+            if (!_items[i].alive) { _handles.Release(_slotOf[i]); continue; }
+            if (out != i) {
+                _items[out] = _items[i];
+                _slotOf[out] = _slotOf[i];
+                _handles.Move(_slotOf[out], (uint32_t)out);
+            }
+            ++out;
+        }
+        _items.resize(out);
+        _slotOf.resize(out);
+    }
+    void clear() {
+        for (uint32_t s : _slotOf) _handles.Release(s);
+        _items.clear();
+        _slotOf.clear();
+    }
+    // the pool's contents become items (a snapshot restore), under fresh handles
+    void Replace(Storage&& items) {
+        clear();
+        _items.swap(items);
+        for (size_t i = 0; i < _items.size(); ++i) _slotOf.push_back(_handles.Acquire((uint32_t)i));
+    }
+    void reserve(size_t n) { _items.reserve(n); _slotOf.reserve(n); _handles.Reserve(n); }
+
+private:
+    Storage _items;
+    AstroVector<uint32_t, Tag> _slotOf; // handle slot of each row
+    AstroSlotTable<Tag> _handles;
+};
+
 // ===== Photon Torpedo =====
 struct PhotonTorpedo {
     float x, y;
@@ -107,15 +325,100 @@ struct PhaserBeam {
     bool alive;
 };
 
-// ===== Vector Particle =====
-struct Particle {
-    float x, y;
-    float vx, vy;
-    float length;    // visual line length scale
-    int lifetime;    // frames remaining
-    int startLifetime;
-    ImU32 color;
-    bool alive;
+// ===== SoA entity storage =====
+// The per-turn integration loops only touch position, velocity, liveness and lifetime,
+// so those live in parallel columns; render and shape data sit in side columns that
+// physics never reads. Row i of every column belongs to entity i.
+template <AstroMemTag Tag> struct AstroBodies {
+    template <typename T> using Column = AstroVector<T, Tag>;
+    Column<float> x, y;
+    Column<float> vx, vy;
+    Column<uint8_t> alive;
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+
+protected:
+    void PushBody(float px, float py, float pvx, float pvy) {
+        x.push_back(px); y.push_back(py);
+        vx.push_back(pvx); vy.push_back(pvy);
+        alive.push_back(1);
+    }
+    void ClearBodies() { x.clear(); y.clear(); vx.clear(); vy.clear(); alive.clear(); }
+    void ReserveBodies(size_t n) { x.reserve(n); y.reserve(n); vx.reserve(n); vy.reserve(n); alive.reserve(n); }
+    // drops rows whose alive flag is 0 from one column, keeping order (call before compacting alive)
+    template <typename T> void CompactColumn(Column<T>& col) const {
+        size_t out = 0;
+        for (size_t i = 0; i < col.size(); ++i) {
+            if (!alive[i]) continue;
+            if (out != i) col[out] = std::move(col[i]);
+            ++out;
+        }
+        col.resize(out);
+    }
+    void CompactBodies() {
+        CompactColumn(x); CompactColumn(y); CompactColumn(vx); CompactColumn(vy);
+        alive.erase(std::remove(alive.begin(), alive.end(), (uint8_t)0), alive.end());
+    }
+};
+
+// ===== Vector Particles =====
+// Fixed capacity: columns are allocated once, dead slots go on a free list and are
+// reused, and when every slot is live a new particle evicts the slot after the last
+// eviction. Memory and per-turn cost are bounded by the capacity, not by match length.
+struct ParticlePool : AstroBodies<ASTRO_MEM_PARTICLES> {
+    Column<int> lifetime;            // frames remaining
+    // cold: render only
+    Column<int> startLifetime;
+    Column<float> length;            // visual line length scale
+    Column<ImU32> color;
+
+    // slots in use are [0, size()); dead ones inside that range are on the free list
+    size_t size() const { return used; }
+    bool empty() const { return used == 0; }
+    size_t Capacity() const { return x.size(); }
+
+    // drops every particle; reallocates only if the capacity changes
+    void SetCapacity(size_t cap) {
+        x.assign(cap, 0.0f); y.assign(cap, 0.0f); vx.assign(cap, 0.0f); vy.assign(cap, 0.0f);
+        alive.assign(cap, 0);
+        lifetime.assign(cap, 0); startLifetime.assign(cap, 0);
+        length.assign(cap, 0.0f); color.assign(cap, 0);
+        freeSlots.clear();
+        freeSlots.reserve(cap);
+        used = 0;
+        evict = 0;
+    }
+    void Add(float px, float py, float pvx, float pvy, int life, float len, ImU32 col) {
+        if (Capacity() == 0) SetCapacity(ASTRO_MAX_PARTICLES);
+        size_t i;
+        if (!freeSlots.empty()) { i = freeSlots.back(); freeSlots.pop_back(); }
+        else if (used < Capacity()) i = used++;
+        else { i = evict; evict = (evict + 1) % Capacity(); }
+        x[i] = px; y[i] = py; vx[i] = pvx; vy[i] = pvy; alive[i] = 1;
+        lifetime[i] = life; startLifetime[i] = life;
+        length[i] = len; color[i] = col;
+    }
+    // after a physics step: shrink the used range past trailing dead slots and rebuild the free list
+    void Recycle() {
+        while (used > 0 && !alive[used - 1]) --used;
+        freeSlots.clear();
+        for (size_t i = 0; i < used; ++i) {
+            if (!alive[i]) freeSlots.push_back((int)i);
+        }
+        if (evict >= used) evict = 0;
+    }
+    void clear() {
+        std::fill(alive.begin(), alive.end(), (uint8_t)0);
+        freeSlots.clear();
+        used = 0;
+        evict = 0;
+    }
+
+private:
+    Column<int> freeSlots;
+    size_t used = 0;
+    size_t evict = 0;
 };
 
 // ===== Ship Debris Segment =====
@@ -130,19 +433,96 @@ struct ShipDebrisSegment {
     bool alive;
 };
 
-// ===== Asteroid =====
-struct Asteroid {
-    float x, y;
-    float vx, vy;
-    float size;
-    int hp;
-    bool alive;
-    std::vector<ImVec2> shape; // polygon vertices (relative to center)
-    // cute_c2 cached convex polygon (local space)
-    c2Poly poly;
-    bool hasPoly = false;
+// ===== Asteroids =====
+// Outline for rendering and the cute_c2 convex poly for collisions. Asteroids don't own
+// one: they share the entries of AsteroidShapeLibrary.
+struct AsteroidShape {
+    AstroVector<ImVec2, ASTRO_MEM_SHAPES> outline; // polygon vertices (relative to center)
+    c2Poly poly;                 // cute_c2 cached convex polygon (local space)
+    c2AABB bounds{};             // box around poly (local space; asteroids never rotate)
+
+    // portable: radii and trig that give the same bits everywhere (AstroUnitFloat(),
+    // AstroFastSinCos()) rather than the std distribution and the build's trig
+    void Generate(int sides, float radius, float phase, std::mt19937& rng, bool portable);
+    void ComputeBounds();
+};
+
+// Every asteroid outline in play, SHAPES_PER_CLASS of them per size class, generated once
+// per process from a fixed seed so that shape ids mean the same thing in every arena,
+// replay and snapshot. Each variant starts its outline at a different angle, which stands
+// in for rotating asteroids (they never turn, so their polys stay in local space).
+// config.fixedPoint arenas pick from a second, portable set after the first, so that
+// their collisions don't depend on the standard library or the trig build either.
+class AsteroidShapeLibrary {
+public:
+    static constexpr int SHAPES_PER_CLASS = 64;
+    static const AsteroidShapeLibrary& Get() { return _library; }
+
+    // variant (0..SHAPES_PER_CLASS-1) of the class an asteroid of nominal size sz belongs to,
+    // from the portable set when fixedPoint
+    uint16_t Pick(float sz, int variant, bool fixedPoint) const;
+    const AsteroidShape& operator[](uint16_t id) const { return _shapes[id]; }
+    size_t size() const { return _shapes.size(); }
 
-    void GenerateShape(int sides, float radius);
+private:
+    AsteroidShapeLibrary();
+    static const AsteroidShapeLibrary _library; // built during static initialization
+    AstroVector<AsteroidShape, ASTRO_MEM_SHAPES> _shapes; // large, then medium, then small; twice
 };
 
+// Rows and handles work as in AstroEntityPool.
+struct AsteroidPool : AstroBodies<ASTRO_MEM_ASTEROIDS> {
+    Column<float> radius;            // nominal size: LARGE/MEDIUM/SMALL_ASTEROID_SIZE
+    Column<int> hp;
+    Column<uint16_t> shapeId;        // index into AsteroidShapeLibrary
 
+    void Add(float px, float py, float pvx, float pvy, float sz, int hitPoints, uint16_t shape) {
+        _slotOf.push_back(_handles.Acquire((uint32_t)size()));
+        PushBody(px, py, pvx, pvy);
+        radius.push_back(sz);
+        hp.push_back(hitPoints);
+        shapeId.push_back(shape);
+    }
+    const AsteroidShape& Shape(size_t i) const { return AsteroidShapeLibrary::Get()[shapeId[i]]; }
+    AstroHandle HandleAt(size_t i) const { return _handles.HandleOf(_slotOf[i]); }
+    // the row of the live asteroid h names, -1 once it's broken
+    int Find(AstroHandle h) const {
+        int i = _handles.RowOf(h);
+        return i >= 0 && alive[i] ? i : -1;
+    }
+    // removes dead asteroids, keeping the survivors in order
+    void RemoveDead() {
+        size_t out = 0;
+        for (size_t i = 0; i < size(); ++i) {
+            if (!alive[i]) { _handles.Release(_slotOf[i]); continue; }
+            if (out != i) {
+                _slotOf[out] = _slotOf[i];
+                _handles.Move(_slotOf[out], (uint32_t)out);
+            }
+            ++out;
+        }
+        _slotOf.resize(out);
+        CompactColumn(radius); CompactColumn(hp); CompactColumn(shapeId);
+        CompactBodies();
+    }
+    void clear() {
+        for (uint32_t s : _slotOf) _handles.Release(s);
+        ClearBodies(); radius.clear(); hp.clear(); shapeId.clear(); _slotOf.clear();
+    }
+    // takes over the columns of from (a snapshot restore), under fresh handles
+    void Replace(AsteroidPool&& from) {
+        for (uint32_t s : _slotOf) _handles.Release(s);
+        _slotOf.clear();
+        x.swap(from.x); y.swap(from.y); vx.swap(from.vx); vy.swap(from.vy); alive.swap(from.alive);
+        radius.swap(from.radius); hp.swap(from.hp); shapeId.swap(from.shapeId);
+        for (size_t i = 0; i < size(); ++i) _slotOf.push_back(_handles.Acquire((uint32_t)i));
+    }
+    void reserve(size_t n) {
+        ReserveBodies(n); radius.reserve(n); hp.reserve(n); shapeId.reserve(n);
+        _slotOf.reserve(n); _handles.Reserve(n);
+    }
+
+private:
+    Column<uint32_t> _slotOf; // handle slot of each row
+    AstroSlotTable<ASTRO_MEM_ASTEROIDS> _handles;
+};
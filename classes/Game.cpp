@@ -91,7 +91,6 @@ void Game::startGame()
 void Game::endTurn()
 {
 	_gameOptions.currentTurnNo++;
-	std::string startState = stateString();
 	Turn *turn = new Turn;
 	turn->_boardState = stateString();
 	turn->_date = (int)_gameOptions.currentTurnNo;
@@ -180,39 +179,50 @@ void Game::findDropTarget(ImVec2 &pos)
 //
 void Game::drawFrame()
 {
+	// sprite images decoded since the last frame go into the atlas before anything is drawn
+	TextureCache::get().update();
 	scanForMouse();
 
 	Grid* grid = getGrid();
 	if (grid) {
-		// Paint squares
-		grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
+		// One pass over the board: squares paint as they come, pieces are bucketed by
+		// layer (stationary, moving, picked up) and painted on top in that order
+		_paintStationary.clear();
+		_paintMoving.clear();
+		_paintPickedUp.clear();
+		grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
 			square->paintSprite();
-		});
-
-		// Paint stationary pieces
-		grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-			if (square->bit() && !square->bit()->getPickedUp() && !square->bit()->getMoving())
+			Bit *bit = square->bit();
+			if (!bit)
 			{
-				square->bit()->paintSprite();
+				return;
 			}
-		});
-
-		// Paint moving pieces
-		grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-			if (square->bit() && square->bit()->getMoving() && !square->bit()->getPickedUp())
+			if (bit->getPickedUp())
 			{
-				square->bit()->update();
-				square->bit()->paintSprite();
+				_paintPickedUp.push_back(bit);
 			}
-		});
-
-		// Paint picked up pieces
-		grid->forEachEnabledSquare([](ChessSquare* square, int x, int y) {
-			if (square->bit() && square->bit()->getPickedUp())
+			else if (bit->getMoving())
 			{
-				square->bit()->paintSprite();
+				_paintMoving.push_back(bit);
+			}
+			else
+			{
+				_paintStationary.push_back(bit);
 			}
 		});
+		for (Bit *bit : _paintStationary)
+		{
+			bit->paintSprite();
+		}
+		for (Bit *bit : _paintMoving)
+		{
+			bit->update();
+			bit->paintSprite();
+		}
+		for (Bit *bit : _paintPickedUp)
+		{
+			bit->paintSprite();
+		}
 	}
 }
 
@@ -22,6 +22,7 @@
 #include "Bit.h"
 #include "BitHolder.h"
 #include "Grid.h"
+#include "AstroMemory.h"
 
 
 const int AI_PLAYER = 1;
@@ -131,7 +132,7 @@ public:
 	Player *_winner;
 
 	std::vector<Player *> _players;
-	std::vector<Turn *> _turns;
+	AstroVector<Turn *, ASTRO_MEM_TURNS> _turns; // counted by the memory stats (AstroMemory.h)
 
 	std::string _lastMove;
 
@@ -151,4 +152,9 @@ protected:
 	BitHolder *_dropTarget;
 	BitHolder *_oldHolder;
 	bool _dragMoved;
+
+	// drawFrame() scratch, kept so a frame doesn't allocate: the pieces in each layer
+	std::vector<Bit *> _paintStationary;
+	std::vector<Bit *> _paintMoving;
+	std::vector<Bit *> _paintPickedUp;
 };
@@ -1,35 +1,21 @@
 #include "Grid.h"
+#include <algorithm>
 
 Grid::Grid(int width, int height) : _width(width), _height(height)
 {
-    // Initialize 2D vectors
-    _squares.resize(height);
-    _enabled.resize(height);
-
-    for (int y = 0; y < height; y++) {
-        _squares[y].resize(width);
-        _enabled[y].resize(width);
-
-        for (int x = 0; x < width; x++) {
-            _squares[y][x] = new ChessSquare();
-            _enabled[y][x] = true; // All squares enabled by default
-        }
-    }
+    // All squares enabled by default
+    _squares.resize(width * height);
+    _enabled.assign((width * height + 63) / 64, ~uint64_t(0));
 }
 
 Grid::~Grid()
 {
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            delete _squares[y][x];
-        }
-    }
 }
 
 ChessSquare* Grid::getSquare(int x, int y)
 {
     if (!isValid(x, y)) return nullptr;
-    return _squares[y][x];
+    return &_squares[getIndex(x, y)];
 }
 
 ChessSquare* Grid::getSquareByIndex(int index)
@@ -47,13 +33,19 @@ bool Grid::isValid(int x, int y) const
 bool Grid::isEnabled(int x, int y) const
 {
     if (!isValid(x, y)) return false;
-    return _enabled[y][x];
+    return enabledAt(getIndex(x, y));
 }
 
 void Grid::setEnabled(int x, int y, bool enabled)
 {
     if (isValid(x, y)) {
-        _enabled[y][x] = enabled;
+        int index = getIndex(x, y);
+        uint64_t bit = uint64_t(1) << (index & 63);
+        if (enabled) {
+            _enabled[index >> 6] |= bit;
+        } else {
+            _enabled[index >> 6] &= ~bit;
+        }
     }
 }
 
@@ -149,27 +141,6 @@ bool Grid::areConnected(int fromX, int fromY, int toX, int toY)
     return false;
 }
 
-// Iterator support
-void Grid::forEachSquare(std::function<void(ChessSquare*, int x, int y)> func)
-{
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            func(_squares[y][x], x, y);
-        }
-    }
-}
-
-void Grid::forEachEnabledSquare(std::function<void(ChessSquare*, int x, int y)> func)
-{
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            if (_enabled[y][x]) {
-                func(_squares[y][x], x, y);
-            }
-        }
-    }
-}
-
 // Initialize squares
 void Grid::initializeSquares(float squareSize, const char* spriteName)
 {
@@ -186,7 +157,7 @@ void Grid::initializeChessSquares(float squareSize, const char* spriteName)
     for (int y = 0; y < _height; y++) {
         for (int x = 0; x < _width; x++) {
             ImVec2 position(squareSize * x + squareSize/2, squareSize * (7-y) + squareSize/2);
-            _squares[y][x]->initHolder(position, spriteName, x, y);
+            _squares[getIndex(x, y)].initHolder(position, spriteName, x, y);
         }
     }
 }
@@ -195,7 +166,7 @@ void Grid::initializeSquare(int x, int y, float squareSize, const char* spriteNa
 {
     if (isValid(x, y)) {
         ImVec2 position(squareSize * x + squareSize/2, squareSize * y + squareSize/2);
-        _squares[y][x]->initHolder(position, spriteName, x, y);
+        _squares[getIndex(x, y)].initHolder(position, spriteName, x, y);
     }
 }
 
@@ -206,8 +177,8 @@ std::string Grid::getStateString() const
 
     for (int y = 0; y < _height; y++) {
         for (int x = 0; x < _width; x++) {
-            if (_enabled[y][x]) {
-                Bit* bit = _squares[y][x]->bit();
+            if (enabledAt(getIndex(x, y))) {
+                Bit* bit = _squares[getIndex(x, y)].bit();
                 if (bit) {
                     state += std::to_string(bit->gameTag());
                 } else {
@@ -226,11 +197,11 @@ void Grid::setStateString(const std::string& state)
 
     for (int y = 0; y < _height && index < state.length(); y++) {
         for (int x = 0; x < _width && index < state.length(); x++) {
-            if (_enabled[y][x]) {
+            if (enabledAt(getIndex(x, y))) {
                 char pieceChar = state[index++];
 
                 // Clear existing piece
-                _squares[y][x]->destroyBit();
+                _squares[getIndex(x, y)].destroyBit();
 
                 // This method just sets the state - games need to create their own pieces
                 // when loading from state string based on the piece type
@@ -1,9 +1,9 @@
 #pragma once
 
 #include "ChessSquare.h"
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
-#include <functional>
 #include <string>
 
 class Grid
@@ -49,9 +49,29 @@ public:
     std::vector<ChessSquare*> getConnectedSquares(int x, int y);
     bool areConnected(int fromX, int fromY, int toX, int toY);
 
-    // Iterator support
-    void forEachSquare(std::function<void(ChessSquare*, int x, int y)> func);
-    void forEachEnabledSquare(std::function<void(ChessSquare*, int x, int y)> func);
+    // Iterator support: func(ChessSquare*, int x, int y) for each square in row order.
+    // Templates so the callback inlines; drawFrame() and scanForMouse() run these every frame.
+    template <typename Func> void forEachSquare(Func&& func)
+    {
+        ChessSquare* square = _squares.data();
+        for (int y = 0; y < _height; y++) {
+            for (int x = 0; x < _width; x++, square++) {
+                func(square, x, y);
+            }
+        }
+    }
+    template <typename Func> void forEachEnabledSquare(Func&& func)
+    {
+        ChessSquare* square = _squares.data();
+        int index = 0;
+        for (int y = 0; y < _height; y++) {
+            for (int x = 0; x < _width; x++, square++, index++) {
+                if (enabledAt(index)) {
+                    func(square, x, y);
+                }
+            }
+        }
+    }
 
     // Initialize squares with positions and sprites
     void initializeChessSquares(float squareSize, const char* spriteName);
@@ -63,9 +83,11 @@ public:
     void setStateString(const std::string& state);
 
 private:
-    std::vector<std::vector<ChessSquare*>> _squares;
-    std::vector<std::vector<bool>> _enabled;
+    bool enabledAt(int index) const { return (_enabled[index >> 6] >> (index & 63)) & 1; }
+
+    std::vector<ChessSquare> _squares;  // row-major, getIndex(x, y)
+    std::vector<uint64_t> _enabled;     // one bit per square, same order
     std::unordered_map<int, std::vector<int>> _connections;
     int _width;
     int _height;
-};
\ No newline at end of file
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include "Entity.h"
+#include "TextureCache.h"
 #include "../imgui/imgui.h"
 
 class Sprite : public Entity
@@ -63,11 +64,12 @@ public:
     // draw the sprite
     void paintSprite()
     {
-        if (_size.x > 0.0f && _size.y > 0.0f) 
+        // nothing until the image has been decoded and uploaded (TextureCache)
+        if (_size.x > 0.0f && _size.y > 0.0f && _image && _image->ready())
         {
             ImGui::SetCursorPos(_location);
             ImVec4 highlight = _highlighted ? ImVec4(1, 1, 0, 1) : ImVec4(0, 0, 0, 0);
-            ImGui::Image((void*)(intptr_t)_texture, _size, ImVec2(0, 0), ImVec2(1, 1), _color, highlight);
+            ImGui::Image(_image->texture, _size, _image->uv0, _image->uv1, _color, highlight);
         }
     }
 	// is the mouse over this position?
@@ -76,6 +78,7 @@ public:
         return (mousePos.x >= _location.x && mousePos.x <= _location.x + _size.x && mousePos.y >= _location.y && mousePos.y <= _location.y + _size.y);
     }
 
+    // the image comes from TextureCache: the size is set now, the pixels arrive a frame or so later
     bool LoadTextureFromFile(const char* filename);
 	
     // set the highlighted state
@@ -101,10 +104,8 @@ protected:
     ImVec4  _color;
     // the local Z order
     int _localZOrder;
-    // the texture we're going to draw
-    ImTextureID _texture;
+    // the image we're going to draw: an atlas page and where we are on it
+    const TextureRegion *_image = nullptr;
     // currently highlighted
    	bool	_highlighted;
-    // private platform specific texture loading
-    ImTextureID _loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height);
 };
@@ -0,0 +1,236 @@
+#include "TextureCache.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+// imgui_draw.cpp compiles its own copy with STBRP_STATIC, so this one is private too
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "../imgui/imstb_rectpack.h"
+
+// ===== Platform textures =====
+// createTexture() makes a size x size RGBA texture cleared to transparent;
+// uploadRect() copies width x height RGBA pixels into it at (x, y)
+
+#if defined(__APPLE__) || defined(__linux__)
+#include "../imgui/imgui_impl_opengl3_loader.h"
+
+struct PlatformTexture {
+    ImTextureID id = 0;
+};
+
+static PlatformTexture createTexture(int size)
+{
+    std::vector<unsigned char> clear((size_t)size * size * 4, 0);
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, clear.data());
+    return { static_cast<ImTextureID>(texture) };
+}
+
+static void uploadRect(const PlatformTexture &texture, int x, int y, int width, int height, const unsigned char *pixels)
+{
+    glBindTexture(GL_TEXTURE_2D, (GLuint)texture.id);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+#else
+
+// DirectX
+#include <d3d11.h>
+
+struct PlatformTexture {
+    ImTextureID id = 0;
+    ID3D11Texture2D *resource = nullptr; // what UpdateSubresource() writes; the view is id
+};
+
+static PlatformTexture createTexture(int size)
+{
+    extern ID3D11Device* g_pd3dDevice;
+    std::vector<unsigned char> clear((size_t)size * size * 4, 0);
+    D3D11_TEXTURE2D_DESC desc;
+    ZeroMemory(&desc, sizeof(desc));
+    desc.Width = size;
+    desc.Height = size;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    D3D11_SUBRESOURCE_DATA subResource;
+    subResource.pSysMem = clear.data();
+    subResource.SysMemPitch = desc.Width * 4;
+    subResource.SysMemSlicePitch = 0;
+
+    PlatformTexture texture;
+    if (FAILED(g_pd3dDevice->CreateTexture2D(&desc, &subResource, &texture.resource)) || !texture.resource) {
+        return {};
+    }
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+    ZeroMemory(&srvDesc, sizeof(srvDesc));
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = desc.MipLevels;
+    ID3D11ShaderResourceView *view = nullptr;
+    if (FAILED(g_pd3dDevice->CreateShaderResourceView(texture.resource, &srvDesc, &view)) || !view) {
+        texture.resource->Release();
+        return {};
+    }
+    texture.id = reinterpret_cast<ImTextureID>(view);
+    return texture;
+}
+
+static void uploadRect(const PlatformTexture &texture, int x, int y, int width, int height, const unsigned char *pixels)
+{
+    extern ID3D11Device* g_pd3dDevice;
+    ID3D11DeviceContext *context = nullptr;
+    g_pd3dDevice->GetImmediateContext(&context);
+    D3D11_BOX box = { (UINT)x, (UINT)y, 0, (UINT)(x + width), (UINT)(y + height), 1 };
+    context->UpdateSubresource(texture.resource, 0, &box, pixels, width * 4, 0);
+    context->Release();
+}
+#endif
+
+// ===== Cache =====
+struct TextureCache::Page {
+    PlatformTexture texture;
+    int size = 0;
+    stbrp_context packer;
+    std::vector<stbrp_node> nodes;
+};
+
+TextureCache &TextureCache::get()
+{
+    static TextureCache cache;
+    return cache;
+}
+
+TextureCache::~TextureCache()
+{
+    // the textures go with the graphics context; only the worker and its pixels are ours
+    {
+        std::lock_guard<std::mutex> hold(_lock);
+        _stop = true;
+    }
+    _wake.notify_all();
+    if (_thread.joinable()) _thread.join();
+    for (Decoded &d : _decoded) stbi_image_free(d.pixels);
+}
+
+const TextureRegion *TextureCache::request(const std::string &filename)
+{
+    auto found = _regions.find(filename);
+    if (found != _regions.end()) return found->second.get();
+
+    std::string path = (std::filesystem::path("resources") / filename).string();
+    int width = 0, height = 0, channels = 0;
+    if (!stbi_info(path.c_str(), &width, &height, &channels)) {
+        std::cout << "Failed to load texture: " << path << std::endl;
+        return nullptr;
+    }
+    auto region = std::make_unique<TextureRegion>();
+    region->width = width;
+    region->height = height;
+    TextureRegion *result = region.get();
+    _regions.emplace(filename, std::move(region));
+    {
+        std::lock_guard<std::mutex> hold(_lock);
+        _toDecode.emplace_back(std::move(path), result);
+        if (!_thread.joinable()) _thread = std::thread([this]() { worker(); });
+    }
+    _wake.notify_one();
+    return result;
+}
+
+void TextureCache::worker()
+{
+    std::unique_lock<std::mutex> hold(_lock);
+    for (;;) {
+        _wake.wait(hold, [this]() { return _stop || !_toDecode.empty(); });
+        if (_stop) return;
+        auto [path, region] = std::move(_toDecode.front());
+        _toDecode.pop_front();
+        hold.unlock();
+        int width = 0, height = 0;
+        unsigned char *pixels = stbi_load(path.c_str(), &width, &height, nullptr, 4);
+        // the header promised this size; anything else is a file that changed under us
+        if (pixels && (width != region->width || height != region->height)) {
+            stbi_image_free(pixels);
+            pixels = nullptr;
+        }
+        hold.lock();
+        _decoded.push_back({ region, pixels, std::move(path) });
+    }
+}
+
+void TextureCache::update()
+{
+    std::vector<Decoded> images;
+    {
+        std::lock_guard<std::mutex> hold(_lock);
+        if (_decoded.empty()) return;
+        images.swap(_decoded);
+    }
+    pack(images);
+    for (Decoded &d : images) stbi_image_free(d.pixels);
+}
+
+TextureCache::Page *TextureCache::newPage(int size)
+{
+    auto page = std::make_unique<Page>();
+    page->texture = createTexture(size);
+    page->size = size;
+    page->nodes.resize(size);
+    stbrp_init_target(&page->packer, size, size, page->nodes.data(), (int)page->nodes.size());
+    _pages.push_back(std::move(page));
+    return _pages.back().get();
+}
+
+void TextureCache::pack(std::vector<Decoded> &images)
+{
+    std::vector<stbrp_rect> rects;
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!images[i].pixels) {
+            std::cout << "Failed to load texture: " << images[i].path << std::endl;
+            continue;
+        }
+        stbrp_rect r = {};
+        r.id = (int)i;
+        r.w = images[i].region->width + 2 * TEXTURE_ATLAS_PADDING;
+        r.h = images[i].region->height + 2 * TEXTURE_ATLAS_PADDING;
+        rects.push_back(r);
+    }
+    // the newest page first, then fresh ones, until every image has a place
+    Page *page = _pages.empty() ? nullptr : _pages.back().get();
+    while (!rects.empty()) {
+        if (!page) {
+            int need = 0;
+            for (const stbrp_rect &r : rects) need = std::max({ need, (int)r.w, (int)r.h });
+            page = newPage(std::max(need, TEXTURE_ATLAS_PAGE_SIZE));
+        }
+        stbrp_pack_rects(&page->packer, rects.data(), (int)rects.size());
+        std::vector<stbrp_rect> left;
+        for (const stbrp_rect &r : rects) {
+            if (!r.was_packed) {
+                left.push_back(r);
+                continue;
+            }
+            TextureRegion *region = images[r.id].region;
+            const int x = r.x + TEXTURE_ATLAS_PADDING, y = r.y + TEXTURE_ATLAS_PADDING;
+            if (!page->texture.id) continue; // the page couldn't be created; the image stays undrawn
+            uploadRect(page->texture, x, y, region->width, region->height, images[r.id].pixels);
+            const float scale = 1.0f / (float)page->size;
+            region->uv0 = ImVec2(x * scale, y * scale);
+            region->uv1 = ImVec2((x + region->width) * scale, (y + region->height) * scale);
+            region->texture = page->texture.id;
+        }
+        rects.swap(left);
+        page = nullptr;
+    }
+}
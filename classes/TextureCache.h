@@ -0,0 +1,79 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../imgui/imgui.h"
+
+// ===== Sprite textures =====
+// Every image a Sprite loads comes from one cache, keyed by filename: the header is read
+// when the sprite asks (so its size is known right away), the pixels are decoded on a
+// worker thread, and the render thread packs them into shared atlas pages with
+// imstb_rectpack.h and uploads them. Sprites draw their region of a page, so a board of
+// pieces is a handful of textures (one per page) instead of one per sprite, and ImGui
+// batches the images on a page into one draw call. A sprite whose image hasn't arrived yet
+// draws nothing.
+
+static constexpr int TEXTURE_ATLAS_PAGE_SIZE = 2048; // pixels square; bigger images get a page of their own
+static constexpr int TEXTURE_ATLAS_PADDING = 1;      // transparent pixels around each image against filtering bleed
+
+// One image's place in the atlas. Set by update() on the render thread once the image is
+// uploaded and unchanged after that; the cache owns it for the life of the program.
+struct TextureRegion {
+    ImTextureID texture = 0;  // atlas page, 0 until the image is uploaded (or if it failed to decode)
+    ImVec2 uv0 = ImVec2(0, 0);
+    ImVec2 uv1 = ImVec2(1, 1);
+    int width = 0;
+    int height = 0;
+
+    bool ready() const { return texture != 0; }
+};
+
+class TextureCache
+{
+public:
+    static TextureCache &get();
+    ~TextureCache();
+
+    // The region for filename (under resources/), queued for decoding the first time it is
+    // asked for; nullptr if the file can't be read as an image. width and height are set
+    // on return.
+    const TextureRegion *request(const std::string &filename);
+    // Render thread, once per frame before sprites are drawn: packs and uploads whatever
+    // the worker has decoded since the last call.
+    void update();
+
+    size_t pageCount() const { return _pages.size(); }
+
+private:
+    TextureCache() = default;
+    TextureCache(const TextureCache &) = delete;
+    TextureCache &operator=(const TextureCache &) = delete;
+
+    struct Decoded {
+        TextureRegion *region;
+        unsigned char *pixels; // stbi_load() RGBA, nullptr if decoding failed
+        std::string path;
+    };
+    struct Page;
+
+    void worker();
+    // finds room for the images on the pages, opening new ones as needed, and uploads them
+    void pack(std::vector<Decoded> &images);
+    Page *newPage(int size);
+
+    std::unordered_map<std::string, std::unique_ptr<TextureRegion>> _regions;
+    std::vector<std::unique_ptr<Page>> _pages;
+
+    // shared with the worker
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::deque<std::pair<std::string, TextureRegion *>> _toDecode;
+    std::vector<Decoded> _decoded;
+    bool _stop = false;
+    std::thread _thread; // started by the first request()
+};
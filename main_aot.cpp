@@ -0,0 +1,92 @@
+// AstroBots ahead-of-time ship compiler: writes the registered ship programs as C++.
+//
+// usage: astro_aot OUTPUT.cpp
+//
+// Sets up one ship of every type in ShipTypes(), and for each distinct decoded program
+// emits a native function (AstroEmitNative(), AstroNative.h) plus a table that registers
+// them all when the program starts. The build runs this and compiles OUTPUT.cpp into the
+// simulation targets when ASTRO_NATIVE_SHIPS is on. OUTPUT.cpp is only rewritten when its
+// contents change, so an unchanged roster doesn't rebuild anything.
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "classes/AstroTypes.h"
+#include "classes/AstroArena.h"
+#include "classes/AstroShips.h"
+#include "classes/AstroNative.h"
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::printf("usage: astro_aot OUTPUT.cpp\n");
+        return 1;
+    }
+
+    struct Compiled {
+        std::string fn;
+        std::string ships; // type names sharing this program
+        uint64_t hash = 0;
+        std::vector<AstroInstr> program;
+    };
+    std::vector<Compiled> compiled;
+    for (const ShipType& type : ShipTypes()) {
+        std::unique_ptr<ShipBase> ship = type.make();
+        ship->SetupShip();
+        // a rejected program idles in the interpreter; nothing to gain compiling END
+        if (!ship->verifyError.empty()) {
+            std::fprintf(stderr, "astro_aot: skipping %s: %s\n", type.name.c_str(), ship->verifyError.c_str());
+            continue;
+        }
+        uint64_t hash = AstroProgramHash(ship->program);
+        bool shared = false;
+        for (Compiled& c : compiled) {
+            if (c.hash == hash && c.program.size() == ship->program.size() &&
+                std::equal(c.program.begin(), c.program.end(), ship->program.begin(), [](const AstroInstr& a, const AstroInstr& b) {
+                    return a.op == b.op && a.param == b.param && a.fparam == b.fparam && a.target == b.target;
+                })) {
+                c.ships += ", " + type.name;
+                shared = true;
+                break;
+            }
+        }
+        if (!shared) compiled.push_back({ "AstroNativeShip" + std::to_string(compiled.size()), type.name, hash, ship->program });
+    }
+
+    std::ostringstream out;
+    out << "// Generated by astro_aot (main_aot.cpp) from the ship types in ShipTypes(); do not edit.\n\n"
+        << "#include \"AstroArena.h\"\n"
+        << "#include \"AstroNative.h\"\n\n";
+    for (const Compiled& c : compiled) {
+        out << "// " << c.ships << "\n" << AstroEmitNative(c.fn, c.program) << "\n";
+    }
+    if (!compiled.empty()) {
+        out << "static const AstroNativeEntry astroNativeShips[] = {\n";
+        for (const Compiled& c : compiled) {
+            char hash[24];
+            std::snprintf(hash, sizeof(hash), "0x%016llxull", (unsigned long long)c.hash);
+            out << "    { " << hash << ", " << c.fn << "_program, " << c.program.size() << ", " << c.fn << " },\n";
+        }
+        out << "};\n"
+            << "[[maybe_unused]] static const bool astroNativeShipsRegistered =\n"
+            << "    (AstroRegisterNative(astroNativeShips, sizeof(astroNativeShips) / sizeof(astroNativeShips[0])), true);\n";
+    }
+
+    const std::string text = out.str();
+    std::ifstream existing(argv[1], std::ios::binary);
+    std::stringstream old;
+    old << existing.rdbuf();
+    if (existing && old.str() == text) return 0;
+    existing.close();
+    std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+    file << text;
+    if (!file) {
+        std::fprintf(stderr, "astro_aot: cannot write %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
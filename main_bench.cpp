@@ -0,0 +1,490 @@
+// AstroBots benchmarks: fixed-seed scenarios timing the arena's hot paths, headless.
+//
+// usage: astro_bench [--filter SUBSTR] [--min-ms MS] [--seed S] [--broadphase grid|quadtree] [--effects]
+//                    [--check-steady]
+//
+// Scenarios cross 5/50/500 ships with 8/100/1000 asteroids, plus a particle storm after
+// killing every ship but two, a scale run of 1000 ships and 10000 asteroids in a
+// 16384x16384 world (AstroArenaConfig, which also keeps the asteroid population there),
+// and a cluster run that piles 500 ships and 4000 asteroids into four tight clumps of an
+// 8192x8192 world. Every scenario runs once per broadphase (AstroBroadphase.h), or only
+// under the one --broadphase names. Each benchmark restores the scenario from a snapshot
+// before every timed repetition, so mutating calls (collisions, torpedoes, whole turns)
+// always start from the same state. Prints one line per benchmark:
+//   bench=scan scenario=mixed ships=50 asteroids=100 broadphase=grid ops=52800 ns_per_op=312.4 ops_per_sec=3201024 allocs_per_op=0.000
+// ops_per_sec of the turn benchmarks is turns per second. --filter keeps benchmarks whose
+// "name/ships/asteroids/broadphase/" label ("name/storm/ships/asteroids/broadphase/" for
+// the storms, "name/scale/..." and "name/cluster/..." for the scale and cluster runs)
+// contains SUBSTR, e.g. --filter turn or --filter /500/ or --filter /quadtree/.
+// The trig benchmarks ("trig/NAME/IMPL/") and the ladder startup ones ("startup/IMPL/",
+// setting up a 200-ship roster from SetupShip() or from a ship bundle) come first.
+// Arenas run headless, without visual effects (AstroArena::visualEffects), except in the
+// storms, which are there to measure them; --effects turns them on everywhere, as in the viewer.
+// In an ASTRO_MEMORY build each benchmark line also splits allocs_per_op by subsystem
+// (AstroMemory.h), e.g. "mem_particles=0.500 untracked=0.125", untracked being whatever no
+// tagged container accounts for. The steady benchmark plays 64 turns untimed after the
+// restore and times the 64 after them (after one pass of both untimed, so the arena's
+// scratch has grown to what those turns need), when nothing should be growing any more;
+// --check-steady exits 1 if any steady run allocated at all, naming the subsystems.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "classes/AstroTypes.h"
+#include "classes/AstroArena.h"
+#include "classes/AstroShips.h"
+#include "classes/AstroMath.h"
+#include "classes/AstroMemory.h"
+#include "classes/AstroShipBundle.h"
+
+// ===== Allocation counter =====
+// every operator new in the process goes through here; benchmarks read the count around
+// their timed sections
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+struct Scenario {
+    std::string label; // "ships/asteroids/", "storm/ships/asteroids/", "scale/..." or "cluster/..."
+    int ships = 0;
+    int asteroids = 0;
+    bool storm = false;
+    float world = 0.0f; // square world side, 0 = the default arena (and population)
+    int clusters = 0;   // 0 = scattered over the whole torus, else this many clumps
+};
+
+static constexpr float BENCH_CLUSTER_SPREAD = 100.0f; // std dev of a clump, world units
+
+struct BenchOptions {
+    std::string filter;
+    double minMs = 100.0;
+    uint32_t seed = 1;
+    std::vector<AstroBroadphaseKind> broadphases{ ASTRO_BROADPHASE_GRID, ASTRO_BROADPHASE_QUADTREE };
+    bool effects = false; // visual effects in every scenario, not only the storms
+    bool checkSteady = false; // exit 1 if a steady run allocates
+};
+
+// ships cycle through the registered types and are scattered over the whole torus (the
+// spawn circle would pile 500 ships on top of each other), or, with clusters, ships and
+// asteroids alike are dropped around a few centres; a few turns in, every ship fires a
+// photon so HandleTorpedoes has work
+static void BuildScenario(AstroArena& arena, const Scenario& sc, AstroBroadphaseKind broadphase, uint32_t seed) {
+    std::vector<std::unique_ptr<ShipBase>> roster;
+    const auto& types = ShipTypes();
+    for (int i = 0; i < sc.ships; ++i) roster.push_back(types[i % types.size()].make());
+    arena.eventLog = nullptr;
+    arena.recorder = nullptr;
+    if (sc.world > 0.0f) {
+        arena.config.width = arena.config.height = sc.world;
+        arena.config.asteroids = sc.asteroids;
+    }
+    arena.config.broadphase = broadphase;
+    arena.Setup(std::move(roster), seed);
+    std::mt19937 place(seed ^ 0x5bd1e995u);
+    std::uniform_real_distribution<float> px(0.0f, arena.config.width), py(0.0f, arena.config.height), pa(0.0f, 360.0f);
+    std::vector<std::pair<float, float>> centres;
+    for (int c = 0; c < sc.clusters; ++c) centres.emplace_back(px(place), py(place));
+    std::normal_distribution<float> spread(0.0f, BENCH_CLUSTER_SPREAD);
+    std::uniform_int_distribution<int> pick(0, std::max(0, sc.clusters - 1));
+    auto position = [&](float& x, float& y) {
+        if (centres.empty()) {
+            x = px(place);
+            y = py(place);
+            return;
+        }
+        const auto& c = centres[pick(place)];
+        x = c.first + spread(place);
+        y = c.second + spread(place);
+        arena.WrapPosition(x, y);
+    };
+    for (auto& s : arena.ships) {
+        position(s.x, s.y);
+        s.angle = s.targetAngle = pa(place);
+    }
+    if (sc.asteroids > (int)arena.asteroids.size()) arena.SpawnAsteroids(sc.asteroids - (int)arena.asteroids.size());
+    if (!centres.empty()) {
+        for (size_t i = 0; i < arena.asteroids.size(); ++i) position(arena.asteroids.x[i], arena.asteroids.y[i]);
+    }
+    arena.worldEpoch++;
+    for (int t = 0; t < 3 && arena.Step(); ++t) {
+    }
+    for (size_t i = 0; i < arena.ships.size(); ++i) {
+        arena.ships[i].photon_cooldown = 0;
+        arena.FirePhoton((int)i);
+    }
+    arena.MoveWorld();
+}
+
+// particles aren't in snapshots, so the storm is set off again after every restore
+static void SetOffStorm(AstroArena& arena) {
+    for (size_t i = 2; i < arena.ships.size(); ++i) arena.KillShip(arena.ships[i], -1);
+}
+
+struct Measurement {
+    uint64_t ops = 0;
+    double ns = 0.0;
+    uint64_t allocs = 0;
+    std::array<uint64_t, ASTRO_MEM_COUNT> tagAllocs{}; // the part of allocs each subsystem made
+};
+
+// Repeats restore + setup + body until minMs of body time has been spent. body returns the
+// number of operations it did, and only it is timed and counted. A body that did nothing
+// (the match ended during setup) ends the measurement.
+static Measurement Measure(AstroArena& arena, const std::vector<uint8_t>& snapshot, bool storm, double minMs,
+                           const std::function<uint64_t()>& body, const std::function<void()>& setup = nullptr) {
+    Measurement m;
+    do {
+        arena.LoadSnapshot(snapshot.data(), snapshot.size());
+        if (storm) SetOffStorm(arena);
+        if (setup) setup();
+        arena.EnsureBroadphase();
+        AstroMemoryStats tags = AstroMemoryStats::Read();
+        uint64_t allocs = g_allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t ops = body();
+        m.ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        m.allocs += g_allocations.load(std::memory_order_relaxed) - allocs;
+        tags = AstroMemoryStats::Read().Since(tags);
+        for (int t = 0; t < ASTRO_MEM_COUNT; ++t) m.tagAllocs[t] += tags.tags[t].allocations;
+        if (ops == 0) break;
+        m.ops += ops;
+    } while (m.ns < minMs * 1e6);
+    return m;
+}
+
+static void Report(const char* name, const Scenario& sc, const AstroArena& arena, const Measurement& m) {
+    double perOp = m.ops ? m.ns / (double)m.ops : 0.0;
+    double ops = m.ops ? (double)m.ops : 1.0;
+    const char* kind = sc.storm ? "storm" : sc.clusters > 0 ? "cluster" : (sc.world > 0.0f ? "scale" : "mixed");
+    std::printf("bench=%s scenario=%s ships=%d asteroids=%d broadphase=%s ops=%llu ns_per_op=%.1f ops_per_sec=%.0f allocs_per_op=%.3f",
+                name, kind, sc.ships, sc.asteroids, arena.broadphase->Name(), (unsigned long long)m.ops, perOp,
+                perOp > 0.0 ? 1e9 / perOp : 0.0, (double)m.allocs / ops);
+    if (ASTRO_MEMORY_ENABLED) {
+        uint64_t tagged = 0;
+        for (int t = 0; t < ASTRO_MEM_COUNT; ++t) {
+            tagged += m.tagAllocs[t];
+            if (m.tagAllocs[t]) std::printf(" mem_%s=%.3f", AstroMemTagName((AstroMemTag)t), (double)m.tagAllocs[t] / ops);
+        }
+        std::printf(" untracked=%.3f", (double)(m.allocs - std::min(tagged, m.allocs)) / ops);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+// steady runs that allocated, for --check-steady
+static std::vector<std::string> g_steadyFailures;
+
+static uint64_t AliveShips(const AstroArena& arena) {
+    return (uint64_t)arena.AliveCount();
+}
+
+static void RunScenario(const Scenario& sc, AstroBroadphaseKind broadphase, const BenchOptions& options) {
+    AstroArena arena;
+    arena.visualEffects = sc.storm || options.effects;
+    BuildScenario(arena, sc, broadphase, options.seed);
+    std::vector<uint8_t> snapshot;
+    arena.SaveSnapshot(snapshot);
+
+    using Body = std::function<uint64_t()>;
+    const std::pair<const char*, Body> benches[] = {
+        { "scan", [&] {
+            for (size_t i = 0; i < arena.ships.size(); ++i) arena.Scan((int)i);
+            return AliveShips(arena);
+        } },
+        // every filter in turn: one broadphase walk and one torpedo pass per ship, the rest
+        // come out of the scan cache
+        { "scankinds", [&] {
+            for (size_t i = 0; i < arena.ships.size(); ++i) {
+                for (int f = 0; f < ASTRO_SCAN_FILTER_COUNT; ++f) arena.Scan((int)i, (AstroScanFilter)f);
+            }
+            return AliveShips(arena) * ASTRO_SCAN_FILTER_COUNT;
+        } },
+        // the raycast half of FirePhaser; the other half is a handful of stores
+        { "phaser", [&] {
+            uint64_t n = 0;
+            for (size_t i = 0; i < arena.ships.size(); ++i) {
+                if (!arena.ships[i].alive) continue;
+                volatile int hit = arena.TracePhaser((int)i).hitShip;
+                (void)hit;
+                ++n;
+            }
+            return n;
+        } },
+        { "collisions", [&] { arena.HandleCollisions(); return (uint64_t)1; } },
+        { "torpedoes", [&] { arena.HandleTorpedoes(); return (uint64_t)1; } },
+        { "physics", [&] { arena.UpdatePhysics(); return (uint64_t)1; } },
+        { "run", [&] {
+            uint64_t n = 0;
+            for (size_t i = 0; i < arena.ships.size(); ++i) {
+                if (!arena.ships[i].alive) continue;
+                arena.programs[i]->Run(arena.turn);
+                ++n;
+            }
+            return n;
+        } },
+        // the same programs in the VM, for comparison with run's native code (AstroNative.h)
+        { "runvm", [&] {
+            arena.nativePrograms = false;
+            uint64_t n = 0;
+            for (size_t i = 0; i < arena.ships.size(); ++i) {
+                if (!arena.ships[i].alive) continue;
+                arena.programs[i]->Run(arena.turn);
+                ++n;
+            }
+            arena.nativePrograms = true;
+            return n;
+        } },
+        { "turn", [&] { return (uint64_t)(arena.Step() ? 1 : 0); } },
+        // a run of turns from the same start, for steady-state turns/sec and allocations
+        { "turns64", [&] {
+            uint64_t n = 0;
+            while (n < 64 && arena.Step()) ++n;
+            return n;
+        } },
+        // the same after 64 untimed turns (see below), by when every buffer has its size
+        { "steady", [&] {
+            uint64_t n = 0;
+            while (n < 64 && arena.Step()) ++n;
+            return n;
+        } },
+    };
+    auto warmUp = [&] {
+        for (int n = 0; n < 64 && arena.Step(); ++n) {
+        }
+    };
+    for (const auto& [name, body] : benches) {
+        std::string label = std::string(name) + "/" + sc.label + arena.broadphase->Name() + "/";
+        if (!options.filter.empty() && label.find(options.filter) == std::string::npos) continue;
+        bool steady = !std::strcmp(name, "steady");
+        if (steady) {
+            // one pass first, so scratch that outlives restores (broadphase hits and the
+            // like) is already at its high-water mark for the turns measured
+            arena.LoadSnapshot(snapshot.data(), snapshot.size());
+            if (sc.storm) SetOffStorm(arena);
+            warmUp();
+            body();
+        }
+        Measurement m = Measure(arena, snapshot, sc.storm, options.minMs, body, steady ? std::function<void()>(warmUp) : nullptr);
+        Report(name, sc, arena, m);
+        if (steady && m.allocs > 0) {
+            std::string failure = label + " allocs=" + std::to_string(m.allocs);
+            for (int t = 0; t < ASTRO_MEM_COUNT; ++t) {
+                if (m.tagAllocs[t]) failure += std::string(" ") + AstroMemTagName((AstroMemTag)t) + "=" + std::to_string(m.tagAllocs[t]);
+            }
+            g_steadyFailures.push_back(failure);
+        }
+    }
+}
+
+// ===== Trig =====
+// AstroMath.h's polynomials against libm on the same inputs, whichever of them the arena
+// was built with: headings over a few turns either way, and scan-like offsets within range.
+// Labels are "trig/NAME/IMPL/"; each line also gives the largest difference from libm.
+static constexpr size_t TRIG_INPUTS = 4096;
+
+static void ReportTrig(const char* name, const char* impl, uint64_t ops, double ns, double maxErr) {
+    double perOp = ops ? ns / (double)ops : 0.0;
+    std::printf("bench=%s impl=%s ops=%llu ns_per_op=%.2f ops_per_sec=%.0f max_err=%.3g\n", name, impl,
+                (unsigned long long)ops, perOp, perOp > 0.0 ? 1e9 / perOp : 0.0, maxErr);
+    std::fflush(stdout);
+}
+
+// runs body over all the inputs until minMs has been spent; returns ns per input
+template <typename Body> static double TimeTrig(double minMs, uint64_t& ops, Body&& body) {
+    double ns = 0.0;
+    ops = 0;
+    do {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        ops += TRIG_INPUTS;
+    } while (ns < minMs * 1e6);
+    return ns;
+}
+
+static void RunTrigBenches(const BenchOptions& options) {
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<float> angle(-4.0f * AstroTrig::PI, 4.0f * AstroTrig::PI);
+    std::uniform_real_distribution<float> offset(-ASTRO_SCAN_RANGE, ASTRO_SCAN_RANGE);
+    std::vector<float> x(TRIG_INPUTS), dy(TRIG_INPUTS), dx(TRIG_INPUTS);
+    for (size_t i = 0; i < TRIG_INPUTS; ++i) {
+        x[i] = angle(rng);
+        dy[i] = offset(rng);
+        dx[i] = offset(rng);
+    }
+    std::vector<float> s(TRIG_INPUTS), c(TRIG_INPUTS), a(TRIG_INPUTS);
+    std::vector<float> refS(TRIG_INPUTS), refC(TRIG_INPUTS), refA(TRIG_INPUTS);
+    for (size_t i = 0; i < TRIG_INPUTS; ++i) {
+        refS[i] = std::sin(x[i]);
+        refC[i] = std::cos(x[i]);
+        refA[i] = std::atan2(dy[i], dx[i]);
+    }
+    auto sinCosErr = [&] {
+        double e = 0.0;
+        for (size_t i = 0; i < TRIG_INPUTS; ++i) e = std::max({ e, (double)std::fabs(s[i] - refS[i]), (double)std::fabs(c[i] - refC[i]) });
+        return e;
+    };
+    auto atanErr = [&] {
+        double e = 0.0;
+        for (size_t i = 0; i < TRIG_INPUTS; ++i) e = std::max(e, (double)std::fabs(a[i] - refA[i]));
+        return e;
+    };
+
+    using Bench = std::function<double(uint64_t&)>; // returns ns, sets ops
+    const std::tuple<const char*, const char*, Bench, std::function<double()>> benches[] = {
+        { "sincos", "libm", [&](uint64_t& ops) {
+            return TimeTrig(options.minMs, ops, [&] {
+                for (size_t i = 0; i < TRIG_INPUTS; ++i) { s[i] = std::sin(x[i]); c[i] = std::cos(x[i]); }
+            });
+        }, sinCosErr },
+        { "sincos", "fast", [&](uint64_t& ops) {
+            return TimeTrig(options.minMs, ops, [&] {
+                for (size_t i = 0; i < TRIG_INPUTS; ++i) AstroFastSinCos(x[i], s[i], c[i]);
+            });
+        }, sinCosErr },
+        { "sincos", "fast_simd", [&](uint64_t& ops) {
+            return TimeTrig(options.minMs, ops, [&] { AstroFastSinCosN(x.data(), s.data(), c.data(), TRIG_INPUTS); });
+        }, sinCosErr },
+        { "atan2", "libm", [&](uint64_t& ops) {
+            return TimeTrig(options.minMs, ops, [&] {
+                for (size_t i = 0; i < TRIG_INPUTS; ++i) a[i] = std::atan2(dy[i], dx[i]);
+            });
+        }, atanErr },
+        { "atan2", "fast", [&](uint64_t& ops) {
+            return TimeTrig(options.minMs, ops, [&] {
+                for (size_t i = 0; i < TRIG_INPUTS; ++i) a[i] = AstroFastAtan2(dy[i], dx[i]);
+            });
+        }, atanErr },
+    };
+    for (const auto& [name, impl, body, err] : benches) {
+        std::string label = std::string("trig/") + name + "/" + impl + "/";
+        if (!options.filter.empty() && label.find(options.filter) == std::string::npos) continue;
+        uint64_t ops = 0;
+        double ns = body(ops);
+        ReportTrig(name, impl, ops, ns, err());
+    }
+}
+
+// ===== Ladder startup =====
+// A 200-ship roster set up the way AstroArena::Setup() does it: every SetupShip() building
+// and compiling its program, against opening a bundle of the same ships (AstroShipBundle.h),
+// which compiles them again to check them, and copying theirs. Labels are "startup/IMPL/"; ops are ships.
+static constexpr int STARTUP_SHIPS = 200;
+
+static void RunStartupBenches(const BenchOptions& options) {
+    const std::string path = "astro_bench_startup.bundle";
+    {
+        std::vector<std::unique_ptr<ShipBase>> ships = MakeDefaultShips(STARTUP_SHIPS);
+        std::vector<const ShipBase*> written;
+        for (auto& ship : ships) {
+            ship->SetupShip();
+            ship->name += std::to_string(written.size()); // 200 distinct ship types
+            written.push_back(ship.get());
+        }
+        std::string error;
+        if (!AstroWriteShipBundle(path, written, &error)) {
+            std::printf("bench=startup error=\"%s\"\n", error.c_str());
+            return;
+        }
+    }
+    using Bench = std::function<size_t()>; // sets up one roster, returns its size
+    const std::pair<const char*, Bench> benches[] = {
+        { "dsl", [&] {
+            std::vector<std::unique_ptr<ShipBase>> ships = MakeDefaultShips(STARTUP_SHIPS);
+            for (auto& ship : ships) ship->SetupShip();
+            return ships.size();
+        } },
+        { "bundle", [&] {
+            AstroShipRegistry registry;
+            if (!registry.Load(path)) return (size_t)0;
+            std::vector<std::unique_ptr<ShipBase>> ships = registry.MakeShips(STARTUP_SHIPS);
+            for (auto& ship : ships) ship->SetupShip();
+            return ships.size();
+        } },
+    };
+    for (const auto& [impl, body] : benches) {
+        std::string label = std::string("startup/") + impl + "/";
+        if (!options.filter.empty() && label.find(options.filter) == std::string::npos) continue;
+        uint64_t ops = 0, allocs = g_allocations.load(std::memory_order_relaxed);
+        double ns = 0.0;
+        do {
+            auto start = std::chrono::steady_clock::now();
+            ops += body();
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        } while (ns < options.minMs * 1e6);
+        allocs = g_allocations.load(std::memory_order_relaxed) - allocs;
+        double perOp = ops ? ns / (double)ops : 0.0;
+        std::printf("bench=startup impl=%s ships=%d ops=%llu ns_per_op=%.1f ops_per_sec=%.0f allocs_per_op=%.3f\n", impl,
+                    STARTUP_SHIPS, (unsigned long long)ops, perOp, perOp > 0.0 ? 1e9 / perOp : 0.0,
+                    ops ? (double)allocs / (double)ops : 0.0);
+        std::fflush(stdout);
+    }
+    std::remove(path.c_str());
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--filter") && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (!std::strcmp(argv[i], "--min-ms") && i + 1 < argc) {
+            options.minMs = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+            options.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--broadphase") && i + 1 < argc && !std::strcmp(argv[i + 1], "grid")) {
+            options.broadphases = { ASTRO_BROADPHASE_GRID };
+            ++i;
+        } else if (!std::strcmp(argv[i], "--broadphase") && i + 1 < argc && !std::strcmp(argv[i + 1], "quadtree")) {
+            options.broadphases = { ASTRO_BROADPHASE_QUADTREE };
+            ++i;
+        } else if (!std::strcmp(argv[i], "--effects")) {
+            options.effects = true;
+        } else if (!std::strcmp(argv[i], "--check-steady")) {
+            options.checkSteady = true;
+        } else {
+            std::printf("usage: astro_bench [--filter SUBSTR] [--min-ms MS] [--seed S] [--broadphase grid|quadtree] [--effects]\n"
+                        "                   [--check-steady]\n");
+            return 1;
+        }
+    }
+    RunTrigBenches(options);
+    RunStartupBenches(options);
+    std::vector<Scenario> scenarios;
+    for (int ships : { 5, 50, 500 }) {
+        for (int asteroids : { 8, 100, 1000 }) {
+            scenarios.push_back({ std::to_string(ships) + "/" + std::to_string(asteroids) + "/", ships, asteroids, false });
+        }
+    }
+    scenarios.push_back({ "storm/50/100/", 50, 100, true });
+    scenarios.push_back({ "storm/500/100/", 500, 100, true });
+    scenarios.push_back({ "scale/1000/10000/", 1000, 10000, false, 16384.0f });
+    scenarios.push_back({ "cluster/500/4000/", 500, 4000, false, 8192.0f, 4 });
+    for (const Scenario& sc : scenarios) {
+        for (AstroBroadphaseKind broadphase : options.broadphases) RunScenario(sc, broadphase, options);
+    }
+    if (options.checkSteady && !g_steadyFailures.empty()) {
+        for (const std::string& failure : g_steadyFailures) std::fprintf(stderr, "astro_bench: steady %s\n", failure.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,813 @@
+// Headless AstroBots runner: steps matches as fast as the CPU allows, no ImGui/GLFW/DX11.
+//
+// usage: astro_sim [--matches N] [--seed S] [--turns N] [--fork T] [--replay] [--record PREFIX]
+//                  [--archive FILE] [--simultaneous [--vm-threads N]] [--profile FILE] [--vm-stats] [--interpret]
+//                  [--effects] [--mem-stats] [--verbose] [--stream-check]
+//                  [--stream PORT [--stream-wait N] [--stream-keyframe N] [--stream-tps N]] [arena options]
+//        astro_sim --batch K [--matches N] [--seed S] [--turns N] [--simultaneous] [arena options]
+//        astro_sim --query FILE
+//        astro_sim --tournament roundrobin|swiss [--games N] [--rounds N] [--threads N] [--seed S] [--turns N]
+//                  [--simultaneous] [--coordinator PORT [--lease N] [--verify F]] [arena options]
+//        astro_sim --worker HOST:PORT [--threads N]
+//        astro_sim --spectate HOST:PORT
+//        astro_sim --evolve GENERATIONS [--population N] [--games N] [--threads N] [--seed S] [--turns N]
+//                  [--simultaneous] [--evolve-random] [--evolve-out FILE [--evolve-top K]] [arena options]
+//        astro_sim --export-ships FILE
+// any mode: [--load-ships FILE]...
+// arena options: [--world W[xH]] [--ships N] [--asteroids N] [--cell N] [--broadphase grid|quadtree]
+//                [--stalemate N] [--fixed-point]
+//
+// Match m is played with seed S+m; the same seed and roster always replay the same match.
+// Prints one results line per match, e.g.
+//   match=0 seed=1 turns=1834 result=win winner=Hunter alive=1 hash=8c1f0e2a7d3b5c49 ms=41.250
+// or, in tournament mode, one standings line per ship type. readme.md describes what each
+// option does. Exits 1 when a check it was asked for (fork_ok, effects_ok, replay_ok,
+// stream_ok) reports 0.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "classes/AstroTypes.h"
+#include "classes/AstroArena.h"
+#include "classes/AstroShips.h"
+#include "classes/AstroArchive.h"
+#include "classes/AstroBatch.h"
+#include "classes/AstroMemory.h"
+#include "classes/AstroProfile.h"
+#include "classes/AstroReplay.h"
+#include "classes/AstroShipBundle.h"
+#include "classes/AstroThreadPool.h"
+#include "classes/AstroTournament.h"
+#include "classes/AstroCluster.h"
+#include "classes/AstroStream.h"
+#include "classes/AstroEvolve.h"
+#include <thread>
+
+struct MatchResult {
+    int turns = 0;
+    int alive = 0;
+    int winner = -1; // ship index, -1 for a draw
+    uint64_t hash = 0;
+    double ms = 0.0;
+    std::vector<uint8_t> fork; // snapshot taken at the fork turn, empty if none
+    AstroMemoryStats memory;   // what the turns allocated (peaks from Setup() on)
+    // telemetry stream (--stream, --stream-check)
+    uint64_t streamBytes = 0, streamKeyBytes = 0;
+    int streamFrames = 0, streamKeyframes = 0;
+    bool streamOk = true;
+    std::string streamError;
+};
+
+struct ReplayCheck {
+    size_t bytes = 0;
+    bool ok = false;
+    std::string error;
+};
+
+// ships loaded with --load-ships, which replace the sample ships in every roster
+static AstroShipRegistry shipRegistry;
+
+static std::vector<std::unique_ptr<ShipBase>> MakeRoster(int count) {
+    return shipRegistry.Empty() ? MakeDefaultShips(count) : shipRegistry.MakeShips(count);
+}
+
+// archive -> bytes -> archive -> re-simulation, seeking back to a third of the match and
+// forward again on the way
+static ReplayCheck CheckReplay(const AstroReplay& recorded, int ships) {
+    ReplayCheck check;
+    std::vector<uint8_t> bytes;
+    recorded.Save(bytes);
+    check.bytes = bytes.size();
+    AstroReplay loaded;
+    AstroReplayPlayer player;
+    if (!loaded.Load(bytes.data(), bytes.size(), &check.error) ||
+        !player.Open(loaded, MakeRoster(ships), &check.error)) {
+        return check;
+    }
+    player.Seek(loaded.finalTurn);
+    bool first = player.Verified();
+    player.Seek(loaded.finalTurn / 3);
+    player.Seek(loaded.finalTurn);
+    std::vector<AstroEvent> events;
+    check.ok = first && player.Verified() && loaded.Decode(events) && events.size() == loaded.eventCount;
+    return check;
+}
+
+// what RunMatch does besides playing the match
+struct MatchOptions {
+    int maxTurns = ASTRO_MAX_TURNS;
+    int forkTurn = 0;                        // snapshot at this turn (0 = none)
+    AstroReplayRecorder* recorder = nullptr; // records the event replay
+    AstroArchiveWriter* archive = nullptr;   // collects per-turn ship state
+    bool simultaneous = false;
+    AstroArenaConfig config;
+    AstroThreadPool* vmPool = nullptr;       // simultaneous turns: runs the programs
+    AstroProfiler* profiler = nullptr;       // gets the phase timings of every turn
+    bool vmStats = false;                    // count what every program executes
+    bool native = true;                      // run programs compiled into the build
+    bool visualEffects = false;              // spawn particles, debris and beams as the viewer would
+    bool verbose = false;
+    AstroStreamEncoder* stream = nullptr;    // encodes every turn for spectators
+    AstroStreamServer* streamServer = nullptr; // and publishes it
+    int streamTps = 0;                       // turns a second while publishing, 0 = unpaced
+    bool streamCheck = false;                // decode every frame again and compare with the arena
+};
+
+// prints the log entries from cursor on and moves cursor past them
+static void PrintLog(const AstroLogRing& ring, const AstroArena& arena, uint64_t& cursor) {
+    char line[160];
+    for (cursor = std::max(cursor, ring.Begin()); cursor < ring.End(); ++cursor) {
+        AstroLogEntry e;
+        if (!ring.Read(cursor, e)) continue;
+        AstroFormatLog(e, arena, line, sizeof(line));
+        std::printf("  %s\n", line);
+    }
+}
+
+static MatchResult RunMatch(AstroArena& arena, uint32_t seed, const MatchOptions& options) {
+    // without --verbose nothing is logged, let alone formatted
+    AstroLogRing ring;
+    uint64_t logCursor = 0;
+    arena.eventLog = options.verbose ? &ring : nullptr;
+    arena.recorder = nullptr;
+    arena.simultaneous = options.simultaneous;
+    arena.config = options.config;
+    arena.vmPool = options.vmPool;
+    arena.profiler = options.profiler;
+    arena.countVm = options.vmStats;
+    arena.nativePrograms = options.native;
+    arena.visualEffects = options.visualEffects;
+    AstroMemoryStats::ResetPeaks();
+    arena.Setup(MakeRoster(options.config.ships), seed);
+    if (options.recorder) {
+        options.recorder->Begin(arena);
+        arena.recorder = options.recorder;
+    }
+    if (options.archive) options.archive->BeginMatch(arena);
+    if (arena.eventLog) PrintLog(ring, arena, logCursor);
+
+    MatchResult result;
+    std::vector<uint8_t> frame;
+    AstroStreamView decoded; // what a spectator would have, for --stream-check
+    auto publish = [&]() {
+        bool key = options.stream->Encode(arena, frame);
+        result.streamFrames++;
+        result.streamBytes += frame.size();
+        if (key) { result.streamKeyframes++; result.streamKeyBytes += frame.size(); }
+        if (options.streamServer) options.streamServer->Publish(frame, key);
+        if (options.streamCheck && result.streamOk) {
+            if (!decoded.Apply(frame.data(), frame.size())) result.streamError = "frame did not decode";
+            else if (!(decoded == options.stream->View())) result.streamError = "decoded view differs from the encoder's";
+            else decoded.Matches(arena, &result.streamError);
+            result.streamOk = result.streamError.empty();
+            if (!result.streamOk) result.streamError = "turn " + std::to_string(arena.turn) + ": " + result.streamError;
+        }
+    };
+    if (options.stream) publish();
+    AstroMemoryStats memoryAtStart = AstroMemoryStats::Read();
+    auto start = std::chrono::steady_clock::now();
+    auto nextTurnAt = start;
+    while (arena.turn < options.maxTurns && arena.Step()) {
+        if (arena.turn == options.forkTurn) arena.SaveSnapshot(result.fork);
+        if (options.archive) options.archive->RecordTurn(arena);
+        if (arena.eventLog) PrintLog(ring, arena, logCursor);
+        if (options.stream) publish();
+        if (options.streamServer && options.streamTps > 0) {
+            nextTurnAt += std::chrono::microseconds(1000000 / options.streamTps);
+            std::this_thread::sleep_until(nextTurnAt);
+        }
+    }
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.memory = AstroMemoryStats::Read().Since(memoryAtStart);
+    result.turns = arena.turn;
+    result.alive = arena.AliveCount();
+    result.hash = arena.Checksum();
+    if (options.recorder) {
+        options.recorder->Finish(arena);
+        arena.recorder = nullptr;
+    }
+    if (options.archive) options.archive->EndMatch(arena);
+    arena.eventLog = nullptr;
+    arena.profiler = nullptr;
+    if (result.alive == 1) {
+        for (size_t i = 0; i < arena.ships.size(); ++i) {
+            if (arena.ships[i].alive) result.winner = (int)i;
+        }
+    }
+    return result;
+}
+
+static void PrintUsage() {
+    std::cout << "usage: astro_sim [--matches N] [--seed S] [--turns N] [--fork T] [--replay] [--record PREFIX] [--archive FILE]\n"
+              << "                 [--simultaneous [--vm-threads N]] [--profile FILE] [--vm-stats] [--interpret]\n"
+              << "                 [--effects] [--mem-stats] [--verbose] [--stream-check]\n"
+              << "                 [--stream PORT [--stream-wait N] [--stream-keyframe N] [--stream-tps N]] [arena options]\n"
+              << "       astro_sim --batch K [--matches N] [--seed S] [--turns N] [--simultaneous] [arena options]\n"
+              << "       astro_sim --query FILE\n"
+              << "       astro_sim --tournament roundrobin|swiss [--games N] [--rounds N] [--threads N] [--seed S] [--turns N] [--simultaneous]\n"
+              << "                 [--coordinator PORT [--lease N] [--verify F]] [arena options]\n"
+              << "       astro_sim --worker HOST:PORT [--threads N]\n"
+              << "       astro_sim --spectate HOST:PORT\n"
+              << "       astro_sim --evolve GENERATIONS [--population N] [--games N] [--threads N] [--seed S] [--turns N]\n"
+              << "                 [--simultaneous] [--evolve-random] [--evolve-out FILE [--evolve-top K]] [arena options]\n"
+              << "       astro_sim --export-ships FILE\n"
+              << "any mode: [--load-ships FILE]...\n"
+              << "arena options: [--world W[xH]] [--ships N] [--asteroids N] [--cell N] [--broadphase grid|quadtree]\n"
+              << "               [--stalemate N] [--fixed-point]\n";
+}
+
+// per ship type over a whole trajectory archive: how its matches ended, how it died
+// and its mean fuel over every turn it was alive (a full column scan)
+static int RunQueryMode(const std::string& path) {
+    AstroArchive archive;
+    std::string error;
+    if (!archive.Open(path, &error)) {
+        std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+        return 1;
+    }
+    struct Stats {
+        int tracks = 0, wins = 0, asteroidDeaths = 0, weaponDeaths = 0;
+        double fuel = 0.0;
+        long long aliveTurns = 0;
+    };
+    std::vector<std::pair<std::string, Stats>> byName;
+    const float* fuel = archive.Fuel();
+    const uint8_t* alive = archive.Alive();
+    for (size_t t = 0; t < archive.TrackCount(); ++t) {
+        const ArchiveTrack& track = archive.Track(t);
+        std::string name(track.name, strnlen(track.name, ASTRO_ARCHIVE_NAME_LEN));
+        auto it = std::find_if(byName.begin(), byName.end(), [&](const auto& e) { return e.first == name; });
+        if (it == byName.end()) it = byName.insert(byName.end(), { name, Stats{} });
+        Stats& st = it->second;
+        st.tracks++;
+        if (archive.Match(track.match).winner == (int32_t)track.ship) st.wins++;
+        if (track.deathTurn > 0) (track.killedBy < 0 ? st.asteroidDeaths : st.weaponDeaths)++;
+        for (uint64_t r = track.firstRow; r < track.firstRow + track.rowCount; ++r) {
+            if (!alive[r]) continue;
+            st.fuel += fuel[r];
+            st.aliveTurns++;
+        }
+    }
+    for (const auto& [name, st] : byName) {
+        std::printf("ship=%s tracks=%d wins=%d asteroid_deaths=%d weapon_deaths=%d mean_turns=%.1f mean_fuel=%.2f\n",
+                    name.c_str(), st.tracks, st.wins, st.asteroidDeaths, st.weaponDeaths,
+                    st.tracks ? (double)st.aliveTurns / st.tracks : 0.0,
+                    st.aliveTurns ? st.fuel / (double)st.aliveTurns : 0.0);
+    }
+    std::printf("archive matches=%zu tracks=%zu rows=%llu\n", archive.MatchCount(), archive.TrackCount(),
+                (unsigned long long)archive.RowCount());
+    return 0;
+}
+
+static void PrintResult(int m, uint32_t seed, const AstroArena& arena, const MatchResult& r) {
+    const char* outcome = (r.alive == 1) ? "win" : (r.alive == 0 ? "wipeout" : (arena.Stalemated() ? "stalemate" : "draw"));
+    const char* winner = (r.winner >= 0) ? arena.programs[r.winner]->name.c_str() : "-";
+    std::printf("match=%d seed=%u turns=%d result=%s winner=%s alive=%d hash=%016llx ms=%.3f",
+                m, seed, r.turns, outcome, winner, r.alive, (unsigned long long)r.hash, r.ms);
+}
+
+static void PrintVmStats(const AstroArena& arena) {
+    for (size_t i = 0; i < arena.vmCounters.size(); ++i) {
+        const AstroVmCounters& c = arena.vmCounters[i];
+        std::printf("  ship=%zu name=%s script_cost=%d turns=%llu instructions=%llu instr_per_turn=%.1f arena_calls=%llu "
+                    "scans=%llu scans_reused=%llu raycasts=%llu branches_taken=%llu\n",
+                    i, arena.programs[i]->name.c_str(), arena.programs[i]->script_cost,
+                    (unsigned long long)c.turns, (unsigned long long)c.instructions, c.InstructionsPerTurn(),
+                    (unsigned long long)c.arenaCalls, (unsigned long long)c.scans, (unsigned long long)c.scansReused,
+                    (unsigned long long)c.raycasts, (unsigned long long)c.branchesTaken);
+    }
+}
+
+static void PrintMemStats(const MatchResult& r) {
+    for (int t = 0; t < ASTRO_MEM_COUNT; ++t) {
+        const AstroMemoryStats::Tag& tag = r.memory.tags[t];
+        if (tag.allocations == 0 && tag.peakBytes == 0) continue;
+        std::printf("  mem=%s allocs=%llu allocs_per_turn=%.3f live_bytes=%lld peak_bytes=%lld\n",
+                    AstroMemTagName((AstroMemTag)t), (unsigned long long)tag.allocations,
+                    r.turns > 0 ? (double)tag.allocations / r.turns : 0.0,
+                    (long long)tag.liveBytes, (long long)tag.peakBytes);
+    }
+}
+
+static int RunBatchMode(int batch, int matches, uint32_t seed, int maxTurns, bool simultaneous, const AstroArenaConfig& config) {
+    AstroBatch arenas;
+    for (int first = 0; first < matches; first += batch) {
+        std::vector<uint32_t> seeds;
+        for (int m = first; m < std::min(matches, first + batch); ++m) seeds.push_back(seed + (uint32_t)m);
+        arenas.Setup([&]() { return MakeRoster(config.ships); }, seeds, simultaneous, config);
+        auto start = std::chrono::steady_clock::now();
+        arenas.Run(maxTurns);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        for (size_t k = 0; k < arenas.Size(); ++k) {
+            const AstroArena& arena = arenas.Arena(k);
+            MatchResult r;
+            r.turns = arena.turn;
+            r.alive = arena.AliveCount();
+            r.hash = arena.Checksum();
+            r.ms = ms / (double)arenas.Size();
+            if (r.alive == 1) {
+                for (size_t i = 0; i < arena.ships.size(); ++i) {
+                    if (arena.ships[i].alive) r.winner = (int)i;
+                }
+            }
+            PrintResult(first + (int)k, seeds[k], arena, r);
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
+
+static int RunTournamentMode(const TournamentOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<TournamentStanding> standings = RunTournament(ShipTypes(), options);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& st : standings) {
+        std::printf("ship=%s matches=%d wins=%d losses=%d draws=%d stalemates=%d byes=%d win_rate=%.3f mean_turns=%.1f damage=%lld damage_per_match=%.2f\n",
+                    st.name.c_str(), st.matches, st.wins, st.losses, st.draws, st.stalemates, st.byes,
+                    st.WinRate(), st.MeanTurnsSurvived(), st.damageDealt, st.MeanDamageDealt());
+    }
+    std::printf("tournament entrants=%d ms=%.3f\n", (int)standings.size(), ms);
+    if (options.cluster) {
+        const AstroClusterStats& cs = options.cluster->stats;
+        std::printf("cluster workers=%d lost=%d leased=%llu reissued=%llu stolen=%llu verified=%llu mismatches=%llu\n",
+                    cs.workersSeen, cs.workersLost, (unsigned long long)cs.leased, (unsigned long long)cs.reissued,
+                    (unsigned long long)cs.stolen, (unsigned long long)cs.verified, (unsigned long long)cs.mismatches);
+        options.cluster->Shutdown();
+        if (cs.mismatches) return 1;
+    }
+    return 0;
+}
+
+// one ship of every registered type, set up and written to one bundle
+static int RunExportMode(const std::string& path) {
+    std::vector<std::unique_ptr<ShipBase>> ships;
+    std::vector<const ShipBase*> written;
+    for (const ShipType& type : ShipTypes()) {
+        ships.push_back(type.make());
+        ships.back()->SetupShip();
+        ships.back()->name = type.name;
+        written.push_back(ships.back().get());
+    }
+    std::string error;
+    if (!AstroWriteShipBundle(path, written, &error)) {
+        std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("ships=%d file=%s\n", (int)written.size(), path.c_str());
+    return 0;
+}
+
+static int RunWorkerMode(const std::string& address, int threads) {
+    size_t colon = address.rfind(':');
+    int port = colon == std::string::npos ? 0 : std::atoi(address.c_str() + colon + 1);
+    if (colon == std::string::npos || port <= 0 || port > 65535) {
+        PrintUsage();
+        return 1;
+    }
+    std::string error;
+    if (!AstroRunClusterWorker(address.substr(0, colon), (uint16_t)port, threads, &error)) {
+        std::fprintf(stderr, "astro_sim: worker: %s\n", error.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+// follows a --stream: a line per keyframe, totals when the stream ends
+static int RunSpectateMode(const std::string& address) {
+    size_t colon = address.rfind(':');
+    int port = colon == std::string::npos ? 0 : std::atoi(address.c_str() + colon + 1);
+    if (colon == std::string::npos || port <= 0 || port > 65535) {
+        PrintUsage();
+        return 1;
+    }
+    AstroStreamClient client;
+    std::string error;
+    if (!client.Connect(address.substr(0, colon), (uint16_t)port, &error)) {
+        std::fprintf(stderr, "astro_sim: spectate: %s\n", error.c_str());
+        return 1;
+    }
+    long long frames = 0;
+    int lastTurn = -1;
+    for (;;) {
+        int n = client.Receive(1000);
+        if (n < 0) break;
+        const AstroStreamView& v = client.View();
+        frames += n;
+        // a turn that didn't follow on came with a keyframe
+        if (n > 0 && v.synced && (v.turn % ASTRO_STREAM_KEYFRAME_EVERY == 0 || v.turn < lastTurn)) {
+            int alive = 0;
+            for (const auto& ship : v.ships) alive += ship.alive ? 1 : 0;
+            std::printf("turn=%d world=%.0fx%.0f ships=%zu alive=%d asteroids=%zu torpedoes=%zu bytes=%llu\n",
+                        v.turn, v.width, v.height, v.ships.size(), alive, v.Count(v.asteroids), v.Count(v.torpedoes),
+                        (unsigned long long)client.BytesReceived());
+            std::fflush(stdout);
+        }
+        if (n > 0) lastTurn = v.turn;
+    }
+    if (!client.Error().empty()) {
+        std::fprintf(stderr, "astro_sim: spectate: %s\n", client.Error().c_str());
+        return 1;
+    }
+    std::printf("spectate frames=%lld bytes=%llu bytes_per_frame=%.1f\n", frames, (unsigned long long)client.BytesReceived(),
+                frames ? (double)client.BytesReceived() / (double)frames : 0.0);
+    return 0;
+}
+
+// searches for a program that beats every ship type, then prints (and writes) the best
+static int RunEvolveMode(const AstroEvolveOptions& options, const std::string& outPath, int top) {
+    auto start = std::chrono::steady_clock::now();
+    AstroEvolver evolver(ShipTypes(), options);
+    const std::vector<AstroEvolveCandidate>& population = evolver.Run([](const AstroEvolveGeneration& g) {
+        std::printf("generation=%d best=%.4f mean=%.4f simulated=%d cached=%d matches=%lld ms=%.1f\n",
+                    g.generation, g.best, g.mean, g.simulated, g.cached, g.matches, g.ms);
+        std::fflush(stdout);
+    });
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("evolve generations=%d programs=%zu cache_hits=%lld matches=%lld matches_per_sec=%.1f ms=%.1f\n",
+                options.generations, evolver.CacheSize(), evolver.CacheHits(), evolver.MatchesPlayed(),
+                ms > 0.0 ? (double)evolver.MatchesPlayed() * 1000.0 / ms : 0.0, ms);
+    const AstroEvolveCandidate& best = population.front();
+    std::printf("best fitness=%.4f cost=%d size=%d hash=%016llx\n", best.fitness, best.genome.Cost(), best.genome.Size(),
+                (unsigned long long)best.hash);
+    std::printf("%s", best.genome.Source().c_str());
+    if (outPath.empty()) return 0;
+
+    // the population is sorted best first; programs that compile the same are written once
+    std::vector<std::unique_ptr<GenomeShip>> ships;
+    std::vector<const ShipBase*> written;
+    std::vector<uint64_t> hashes;
+    for (const AstroEvolveCandidate& c : population) {
+        if ((int)ships.size() >= top) break;
+        if (std::find(hashes.begin(), hashes.end(), c.hash) != hashes.end()) continue;
+        hashes.push_back(c.hash);
+        ships.push_back(std::make_unique<GenomeShip>(c.genome, "Evolved" + std::to_string(ships.size() + 1)));
+        ships.back()->SetupShip();
+        written.push_back(ships.back().get());
+    }
+    std::string error;
+    if (!AstroWriteShipBundle(outPath, written, &error)) {
+        std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("ships=%d file=%s\n", (int)written.size(), outPath.c_str());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int matches = 1;
+    int maxTurns = ASTRO_MAX_TURNS;
+    uint32_t seed = 1;
+    int forkTurn = 0;
+    bool replay = false;
+    std::string recordPrefix;
+    std::string archivePath;
+    std::string queryPath;
+    std::string profilePath;
+    bool verbose = false;
+    bool vmStats = false;
+    bool interpret = false;
+    bool checkEffects = false;
+    bool memStats = false;
+    bool simultaneous = false;
+    int vmThreads = 0;
+    int batch = 0;
+    bool tournament = false;
+    TournamentOptions topt;
+    int coordinatorPort = 0;
+    int leaseSize = 0;
+    double verifyFraction = 0.0;
+    std::string workerAddress;
+    int streamPort = 0;
+    int streamWait = 0;
+    int streamKeyframe = ASTRO_STREAM_KEYFRAME_EVERY;
+    int streamTps = 30;
+    bool streamCheck = false;
+    std::string spectateAddress;
+    std::vector<std::string> loadShips;
+    std::string exportShips;
+    int evolveGenerations = -1;
+    AstroEvolveOptions eopt;
+    std::string evolveOut;
+    int evolveTop = 3;
+    bool turnsGiven = false, gamesGiven = false, stalemateGiven = false;
+    AstroArenaConfig config;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--matches") && i + 1 < argc) {
+            matches = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--turns") && i + 1 < argc) {
+            maxTurns = std::atoi(argv[++i]);
+            turnsGiven = true;
+        } else if (!std::strcmp(argv[i], "--tournament") && i + 1 < argc) {
+            tournament = true;
+            const char* fmt = argv[++i];
+            if (!std::strcmp(fmt, "swiss")) topt.format = TournamentOptions::SWISS;
+            else if (!std::strcmp(fmt, "roundrobin")) topt.format = TournamentOptions::ROUND_ROBIN;
+            else { PrintUsage(); return 1; }
+        } else if (!std::strcmp(argv[i], "--games") && i + 1 < argc) {
+            topt.gamesPerPairing = std::atoi(argv[++i]);
+            gamesGiven = true;
+        } else if (!std::strcmp(argv[i], "--rounds") && i + 1 < argc) {
+            topt.swissRounds = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            topt.threads = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--coordinator") && i + 1 < argc) {
+            coordinatorPort = std::atoi(argv[++i]);
+            if (coordinatorPort <= 0 || coordinatorPort > 65535) { PrintUsage(); return 1; }
+        } else if (!std::strcmp(argv[i], "--lease") && i + 1 < argc) {
+            leaseSize = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--verify") && i + 1 < argc) {
+            verifyFraction = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--worker") && i + 1 < argc) {
+            workerAddress = argv[++i];
+        } else if (!std::strcmp(argv[i], "--stream") && i + 1 < argc) {
+            streamPort = std::atoi(argv[++i]);
+            if (streamPort <= 0 || streamPort > 65535) { PrintUsage(); return 1; }
+        } else if (!std::strcmp(argv[i], "--stream-wait") && i + 1 < argc) {
+            streamWait = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--stream-keyframe") && i + 1 < argc) {
+            streamKeyframe = std::atoi(argv[++i]);
+            if (streamKeyframe <= 0) { PrintUsage(); return 1; }
+        } else if (!std::strcmp(argv[i], "--stream-tps") && i + 1 < argc) {
+            streamTps = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--stream-check")) {
+            streamCheck = true;
+        } else if (!std::strcmp(argv[i], "--spectate") && i + 1 < argc) {
+            spectateAddress = argv[++i];
+        } else if (!std::strcmp(argv[i], "--evolve") && i + 1 < argc) {
+            evolveGenerations = std::atoi(argv[++i]);
+            if (evolveGenerations < 0) { PrintUsage(); return 1; }
+        } else if (!std::strcmp(argv[i], "--population") && i + 1 < argc) {
+            eopt.population = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--evolve-random")) {
+            eopt.seeded = false;
+        } else if (!std::strcmp(argv[i], "--evolve-out") && i + 1 < argc) {
+            evolveOut = argv[++i];
+        } else if (!std::strcmp(argv[i], "--evolve-top") && i + 1 < argc) {
+            evolveTop = std::atoi(argv[++i]);
+            if (evolveTop <= 0) { PrintUsage(); return 1; }
+        } else if (!std::strcmp(argv[i], "--load-ships") && i + 1 < argc) {
+            loadShips.push_back(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--export-ships") && i + 1 < argc) {
+            exportShips = argv[++i];
+        } else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--fork") && i + 1 < argc) {
+            forkTurn = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--replay")) {
+            replay = true;
+        } else if (!std::strcmp(argv[i], "--record") && i + 1 < argc) {
+            recordPrefix = argv[++i];
+            replay = true;
+        } else if (!std::strcmp(argv[i], "--archive") && i + 1 < argc) {
+            archivePath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--query") && i + 1 < argc) {
+            queryPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--simultaneous")) {
+            simultaneous = true;
+        } else if (!std::strcmp(argv[i], "--vm-threads") && i + 1 < argc) {
+            vmThreads = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--batch") && i + 1 < argc) {
+            batch = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--profile") && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--vm-stats")) {
+            vmStats = true;
+        } else if (!std::strcmp(argv[i], "--interpret")) {
+            interpret = true;
+        } else if (!std::strcmp(argv[i], "--effects")) {
+            checkEffects = true;
+        } else if (!std::strcmp(argv[i], "--mem-stats")) {
+            memStats = true;
+        } else if (!std::strcmp(argv[i], "--verbose")) {
+            verbose = true;
+        } else if (!std::strcmp(argv[i], "--world") && i + 1 < argc) {
+            // W or WxH
+            char* rest = nullptr;
+            config.width = std::strtof(argv[++i], &rest);
+            config.height = (*rest == 'x') ? std::strtof(rest + 1, nullptr) : config.width;
+            if (config.width <= 0.0f || config.height <= 0.0f) { PrintUsage(); return 1; }
+        } else if (!std::strcmp(argv[i], "--ships") && i + 1 < argc) {
+            config.ships = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--asteroids") && i + 1 < argc) {
+            config.asteroids = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--cell") && i + 1 < argc) {
+            config.cellSize = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--stalemate") && i + 1 < argc) {
+            config.stalemateTurns = std::atoi(argv[++i]);
+            if (config.stalemateTurns < 0) { PrintUsage(); return 1; }
+            stalemateGiven = true;
+        } else if (!std::strcmp(argv[i], "--fixed-point")) {
+            config.fixedPoint = true;
+        } else if (!std::strcmp(argv[i], "--broadphase") && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (!std::strcmp(name, "grid")) config.broadphase = ASTRO_BROADPHASE_GRID;
+            else if (!std::strcmp(name, "quadtree")) config.broadphase = ASTRO_BROADPHASE_QUADTREE;
+            else {
+                PrintUsage();
+                return 1;
+            }
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    for (const std::string& path : loadShips) {
+        std::string error;
+        if (!shipRegistry.Load(path, &error)) {
+            std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    if (!exportShips.empty()) return RunExportMode(exportShips);
+    if (!queryPath.empty()) return RunQueryMode(queryPath);
+    if (!workerAddress.empty()) return RunWorkerMode(workerAddress, topt.threads);
+    if (!spectateAddress.empty()) return RunSpectateMode(spectateAddress);
+    if (!config.FitsFixedPoint()) {
+        PrintUsage();
+        return 1;
+    }
+    if ((leaseSize || verifyFraction > 0.0) && !coordinatorPort) {
+        PrintUsage();
+        return 1;
+    }
+    if (evolveGenerations >= 0) {
+        eopt.generations = evolveGenerations;
+        if (gamesGiven) eopt.gamesPerSide = topt.gamesPerPairing;
+        eopt.threads = topt.threads;
+        eopt.seed = seed;
+        if (turnsGiven) eopt.maxTurns = maxTurns;
+        eopt.simultaneous = simultaneous;
+        int stalemateTurns = eopt.config.stalemateTurns;
+        eopt.config = config;
+        if (!stalemateGiven) eopt.config.stalemateTurns = stalemateTurns;
+        return RunEvolveMode(eopt, evolveOut, evolveTop);
+    }
+    if (tournament) {
+        topt.maxTurns = maxTurns;
+        topt.seed = seed;
+        topt.simultaneous = simultaneous;
+        topt.config = config;
+        AstroClusterCoordinator cluster;
+        if (coordinatorPort) {
+            std::string error;
+            if (!cluster.Listen((uint16_t)coordinatorPort, &error)) {
+                std::fprintf(stderr, "astro_sim: coordinator: %s\n", error.c_str());
+                return 1;
+            }
+            if (leaseSize > 0) cluster.leaseSize = leaseSize;
+            cluster.verifyFraction = std::clamp(verifyFraction, 0.0, 1.0);
+            topt.cluster = &cluster;
+        }
+        return RunTournamentMode(topt);
+    }
+    if (batch > 0) {
+        if (forkTurn > 0 || replay || !archivePath.empty() || !profilePath.empty() || verbose || vmStats || interpret || checkEffects || memStats || vmThreads > 0 ||
+            streamPort || streamCheck) {
+            PrintUsage();
+            return 1;
+        }
+        return RunBatchMode(batch, matches, seed, maxTurns, simultaneous, config);
+    }
+
+    AstroArena arena;
+    AstroReplayRecorder recorder;
+    AstroArchiveWriter archive;
+    AstroProfiler profiler;
+    MatchOptions options;
+    options.maxTurns = maxTurns;
+    options.forkTurn = forkTurn;
+    options.recorder = replay ? &recorder : nullptr;
+    options.archive = archivePath.empty() ? nullptr : &archive;
+    options.verbose = verbose;
+    options.simultaneous = simultaneous;
+    options.config = config;
+    options.profiler = profilePath.empty() ? nullptr : &profiler;
+    options.vmStats = vmStats;
+    options.native = !interpret;
+    if (options.profiler && !ASTRO_PROFILE_ENABLED) {
+        std::fprintf(stderr, "astro_sim: built without ASTRO_PROFILE, %s will have no rows\n", profilePath.c_str());
+    }
+    if (memStats && !ASTRO_MEMORY_ENABLED) {
+        std::fprintf(stderr, "astro_sim: built without ASTRO_MEMORY, --mem-stats will have no lines\n");
+    }
+    AstroStreamEncoder stream;
+    AstroStreamServer streamServer;
+    stream.keyframeEvery = streamKeyframe;
+    if (streamPort || streamCheck) options.stream = &stream;
+    options.streamCheck = streamCheck;
+    options.streamTps = streamTps;
+    if (streamPort) {
+        std::string error;
+        if (!streamServer.Listen((uint16_t)streamPort, &error)) {
+            std::fprintf(stderr, "astro_sim: stream: %s\n", error.c_str());
+            return 1;
+        }
+        options.streamServer = &streamServer;
+        while (streamServer.SpectatorCount() < streamWait) {
+            streamServer.Poll();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    std::unique_ptr<AstroThreadPool> vmPool;
+    if (simultaneous && vmThreads > 1) {
+        vmPool = std::make_unique<AstroThreadPool>(vmThreads);
+        options.vmPool = vmPool.get();
+    }
+    bool checkFailed = false;
+    for (int m = 0; m < matches; ++m) {
+        uint32_t matchSeed = seed + (uint32_t)m;
+        MatchResult r = RunMatch(arena, matchSeed, options);
+        PrintResult(m, matchSeed, arena, r);
+        if (!r.fork.empty()) {
+            // same roster, different seed: everything that matters has to come from the snapshot
+            AstroArena forked;
+            forked.config = config;
+            forked.Setup(MakeRoster(config.ships), matchSeed + 0x9e3779b9u);
+            std::string error;
+            if (!forked.LoadSnapshot(r.fork.data(), r.fork.size(), &error)) {
+                std::printf(" fork=%d fork_error=\"%s\"", forkTurn, error.c_str());
+                checkFailed = true;
+            } else {
+                while (forked.turn < maxTurns && forked.Step()) {
+                }
+                bool same = forked.turn == r.turns && forked.Checksum() == r.hash;
+                std::printf(" fork=%d fork_bytes=%zu fork_ok=%d", forkTurn, r.fork.size(), same ? 1 : 0);
+                if (!same) checkFailed = true;
+            }
+        }
+        if (checkEffects) {
+            // the same match with everything the viewer draws spawned along the way
+            MatchOptions watched;
+            watched.maxTurns = maxTurns;
+            watched.simultaneous = simultaneous;
+            watched.config = config;
+            watched.vmPool = options.vmPool;
+            watched.native = options.native;
+            watched.visualEffects = true;
+            AstroArena effects;
+            MatchResult w = RunMatch(effects, matchSeed, watched);
+            bool same = w.turns == r.turns && w.hash == r.hash;
+            std::printf(" effects_ms=%.3f effects_ok=%d", w.ms, same ? 1 : 0);
+            if (!same) checkFailed = true;
+        }
+        if (replay) {
+            ReplayCheck check = CheckReplay(recorder.Replay(), config.ships);
+            std::printf(" replay_events=%u replay_bytes=%zu replay_ok=%d",
+                        recorder.Replay().eventCount, check.bytes, check.ok ? 1 : 0);
+            if (!check.error.empty()) std::printf(" replay_error=\"%s\"", check.error.c_str());
+            if (!check.ok) checkFailed = true;
+            std::string error;
+            if (!recordPrefix.empty() && !recorder.Replay().SaveFile(recordPrefix + std::to_string(m) + ".replay", &error)) {
+                std::printf(" record_error=\"%s\"", error.c_str());
+            }
+        }
+        if (streamCheck) {
+            int deltas = r.streamFrames - r.streamKeyframes;
+            std::printf(" stream_bytes=%llu stream_turn_bytes=%.1f stream_key_bytes=%.1f stream_ok=%d",
+                        (unsigned long long)r.streamBytes,
+                        deltas ? (double)(r.streamBytes - r.streamKeyBytes) / deltas : 0.0,
+                        r.streamKeyframes ? (double)r.streamKeyBytes / r.streamKeyframes : 0.0, r.streamOk ? 1 : 0);
+            if (!r.streamOk) std::printf(" stream_error=\"%s\"", r.streamError.c_str());
+            if (!r.streamOk) checkFailed = true;
+        }
+        std::printf("\n");
+        if (vmStats) PrintVmStats(arena);
+        if (memStats) PrintMemStats(r);
+    }
+    if (streamServer.Listening()) {
+        // give the spectators what is still queued, for a few seconds at most
+        auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (streamServer.Pending() > 0 && std::chrono::steady_clock::now() < giveUp) {
+            streamServer.Poll();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        const AstroStreamStats& st = streamServer.stats;
+        std::printf("stream port=%d spectators=%d frames=%llu keyframes=%llu bytes_published=%llu bytes_sent=%llu resyncs=%d\n",
+                    streamPort, st.spectatorsSeen, (unsigned long long)st.frames, (unsigned long long)st.keyframes,
+                    (unsigned long long)st.bytesPublished, (unsigned long long)st.bytesSent, st.resyncs);
+        streamServer.Close();
+    }
+    if (options.archive) {
+        std::string error;
+        if (!archive.Write(archivePath, &error)) {
+            std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    if (options.profiler) {
+        std::string error;
+        if (!profiler.WriteCsv(profilePath, &error)) {
+            std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    return checkFailed ? 1 : 0;
+}